@@ -0,0 +1,276 @@
+/*****************************************************************************\
+ *  fwd_bench.c - Model the delivery of a message through the forwarding tree
+ *	of a large cluster with dead and slow nodes, without any daemons
+ *
+ *  Build with (from a configured build directory, after "make"):
+ *    gcc -DHAVE_CONFIG_H -I<top_srcdir> -I. -o fwd_bench \
+ *        <top_srcdir>/contribs/sim/fwd_bench.c \
+ *        src/api/.libs/libslurmhelper.a -ldl -lpthread -lm
+ *  and see the README file in this directory.
+ *
+ *  Usage: fwd_bench [node_count [seed [dead_pct [slow_pct]]]]
+ *****************************************************************************
+ *  node_count nodes (default 10000) named n00000, n00001, ... are connected
+ *  32 to a leaf switch, and are sent a message in node name order.
+ *  dead_pct percent of them (default 1) never answer and cost their parent
+ *  the 5 second connect timeout, slow_pct percent (default 2) take 300 msec
+ *  more than the 2 msec any other node takes to accept a message. The
+ *  forwarding tree is built by splitting the node list the way forward.c
+ *  does at every level, and the time each live node receives the message is
+ *  computed from these costs, each node sending to its subtrees in turn.
+ *
+ *  Three trees are reported: the one built by plain set_span() splitting
+ *  (the old behavior), the one built by _fwd_split_hosts() with the leaf
+ *  switches known, and the same once the dead nodes have failed to respond
+ *  to a first message and are kept at the leaves of the tree. For each, the
+ *  mean and maximum arrival time of the live nodes, the number of them
+ *  delayed by a dead node and the number of tree edges crossing switches
+ *  are printed. slurm.conf is read for TreeWidth, no daemon is contacted.
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://www.schedmd.com/slurmdocs/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/* The tree splitting and failed node tracking are static to forward.c */
+#include "src/common/forward.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SWITCH_SIZE	32	/* nodes per leaf switch */
+#define DEAD_MSEC	5000.0	/* connect timeout to a dead node */
+#define SLOW_MSEC	300.0	/* extra time taken by a slow node */
+#define HOP_MSEC	2.0	/* time taken by any other node */
+#define LATE_MSEC	1000.0	/* arrival later than this was held by a
+				 * dead node */
+
+enum { TREE_SPAN, TREE_SWITCH, TREE_SUSPECT };
+
+static int node_cnt = 10000;
+static bool *node_dead = NULL, *node_slow = NULL;
+static double *node_arrive = NULL;
+static int tree_type;
+static long cross_cnt;
+
+static double _run_subtree(hostlist_t hl, int parent, double start);
+
+static int _node_inx(char *name)
+{
+	return atoi(name + 1);
+}
+
+/* Split hl (emptied here) the way forward.c does */
+static hostlist_t *_split_hosts(hostlist_t hl, int *tree_cnt)
+{
+	hostlist_t *trees;
+	int *span, i;
+	char *name;
+
+	if (tree_type != TREE_SPAN)
+		return _fwd_split_hosts(hl, tree_cnt);
+
+	span = set_span(hostlist_count(hl), 0);
+	trees = xmalloc(sizeof(hostlist_t) * (hostlist_count(hl) + 1));
+	*tree_cnt = 0;
+	while ((name = hostlist_shift(hl))) {
+		trees[*tree_cnt] = hostlist_create(name);
+		free(name);
+		for (i = 0; i < span[*tree_cnt]; i++) {
+			if (!(name = hostlist_shift(hl)))
+				break;
+			hostlist_push_host(trees[*tree_cnt], name);
+			free(name);
+		}
+		(*tree_cnt)++;
+	}
+	xfree(span);
+
+	return trees;
+}
+
+/* Send from node "parent" (-1 for slurmctld) starting at time "start" to
+ * the nodes of hl, return the time the last of them gets the message */
+static double _run_tree(hostlist_t hl, int parent, double start)
+{
+	hostlist_t *trees;
+	double end = start, t;
+	int tree_cnt, i, switch_cnt = 0, suspect_cnt = 0;
+
+	if (hostlist_count(hl) == 0)
+		return start;
+
+	/* only slurmctld knows the switches and the failed nodes, slurmd
+	 * keeps the order of the nodes it was sent */
+	if (parent >= 0) {
+		switch_cnt = fwd_switch_cnt;
+		suspect_cnt = fwd_suspect_cnt;
+		fwd_switch_cnt = fwd_suspect_cnt = 0;
+	}
+	trees = _split_hosts(hl, &tree_cnt);
+	if (parent >= 0) {
+		fwd_switch_cnt = switch_cnt;
+		fwd_suspect_cnt = suspect_cnt;
+	}
+
+	for (i = 0; i < tree_cnt; i++) {
+		t = _run_subtree(trees[i], parent, start);
+		end = MAX(end, t);
+		hostlist_destroy(trees[i]);
+	}
+	xfree(trees);
+
+	return end;
+}
+
+/* The first node of hl is sent the message, it forwards it to the others.
+ * A dead first node makes the sender try the next one after a timeout. */
+static double _run_subtree(hostlist_t hl, int parent, double start)
+{
+	double t = start, end;
+	char *name;
+	int inx;
+
+	while ((name = hostlist_shift(hl))) {
+		inx = _node_inx(name);
+		free(name);
+		if ((parent >= 0) &&
+		    ((inx / SWITCH_SIZE) != (parent / SWITCH_SIZE)))
+			cross_cnt++;
+		if (node_dead[inx]) {
+			t += DEAD_MSEC;
+			continue;
+		}
+		t += HOP_MSEC;
+		if (node_slow[inx])
+			t += SLOW_MSEC;
+		node_arrive[inx] = t;
+		end = _run_tree(hl, inx, t);
+		return MAX(t, end);
+	}
+
+	return t;
+}
+
+static void _set_switches(void)
+{
+	int switch_cnt = (node_cnt + SWITCH_SIZE - 1) / SWITCH_SIZE, i;
+	char **switch_nodes = xmalloc(sizeof(char *) * switch_cnt);
+
+	for (i = 0; i < switch_cnt; i++) {
+		switch_nodes[i] = xstrdup_printf("n[%05d-%05d]",
+						 i * SWITCH_SIZE,
+						 MIN((i + 1) * SWITCH_SIZE,
+						     node_cnt) - 1);
+	}
+	forward_set_switches(switch_nodes, switch_cnt);
+	for (i = 0; i < switch_cnt; i++)
+		xfree(switch_nodes[i]);
+	xfree(switch_nodes);
+}
+
+/* Report the dead nodes as failed to respond, as forward_wait() would */
+static void _note_dead(void)
+{
+	List ret_list = list_create(destroy_data_info);
+	char name[16];
+	int i;
+
+	for (i = 0; i < node_cnt; i++) {
+		if (!node_dead[i])
+			continue;
+		snprintf(name, sizeof(name), "n%05d", i);
+		mark_as_failed_forward(&ret_list, name, SLURM_ERROR);
+	}
+	_fwd_note_responses(ret_list);
+	list_destroy(ret_list);
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *tree_name[] = { "span", "switch", "suspect" };
+	int seed = 1, dead_pct = 1, slow_pct = 2;
+	int i, live_cnt, late_cnt;
+	double end, sum, max;
+	hostlist_t hl;
+	char name[16];
+
+	if (argc > 1)
+		node_cnt = atoi(argv[1]);
+	if (argc > 2)
+		seed = atoi(argv[2]);
+	if (argc > 3)
+		dead_pct = atoi(argv[3]);
+	if (argc > 4)
+		slow_pct = atoi(argv[4]);
+	if ((node_cnt < 1) || (node_cnt > 100000)) {
+		fprintf(stderr, "node_count must be 1 to 100000\n");
+		exit(1);
+	}
+
+	node_dead = xmalloc(sizeof(bool) * node_cnt);
+	node_slow = xmalloc(sizeof(bool) * node_cnt);
+	node_arrive = xmalloc(sizeof(double) * node_cnt);
+	srand(seed);
+	for (i = 0; i < node_cnt; i++) {
+		node_dead[i] = ((rand() % 100) < dead_pct);
+		node_slow[i] = ((rand() % 100) < slow_pct);
+	}
+	printf("%d nodes, %d per switch, TreeWidth=%u\n",
+	       node_cnt, SWITCH_SIZE, slurm_get_tree_width());
+
+	for (tree_type = TREE_SPAN; tree_type <= TREE_SUSPECT; tree_type++) {
+		if (tree_type == TREE_SWITCH)
+			_set_switches();
+		else if (tree_type == TREE_SUSPECT)
+			_note_dead();
+
+		hl = hostlist_create(NULL);
+		for (i = 0; i < node_cnt; i++) {
+			snprintf(name, sizeof(name), "n%05d", i);
+			hostlist_push_host(hl, name);
+		}
+		memset(node_arrive, 0, sizeof(double) * node_cnt);
+		cross_cnt = 0;
+		end = _run_tree(hl, -1, 0.0);
+		hostlist_destroy(hl);
+
+		live_cnt = late_cnt = 0;
+		sum = max = 0.0;
+		for (i = 0; i < node_cnt; i++) {
+			if (node_dead[i])
+				continue;
+			live_cnt++;
+			sum += node_arrive[i];
+			max = MAX(max, node_arrive[i]);
+			if (node_arrive[i] > LATE_MSEC)
+				late_cnt++;
+		}
+		printf("%-8s done %.0f msec, live nodes: mean %.0f msec, "
+		       "max %.0f msec, %d delayed by a dead node, "
+		       "%ld cross-switch edges\n",
+		       tree_name[tree_type], end,
+		       live_cnt ? (sum / live_cnt) : 0.0, max, late_cnt,
+		       cross_cnt);
+	}
+
+	forward_set_switches(NULL, 0);
+	xfree(node_dead);
+	xfree(node_slow);
+	xfree(node_arrive);
+	exit(0);
+}
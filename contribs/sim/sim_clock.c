@@ -0,0 +1,203 @@
+/*****************************************************************************\
+ *  sim_clock.c - Accelerated clock for replaying workloads through SLURM
+ *
+ *  Build with:
+ *    gcc -shared -fPIC -o sim_clock.so sim_clock.c -ldl
+ *****************************************************************************
+ *  This library is pre-loaded into slurmctld, slurmd and sim_replay (see the
+ *  README file in this directory). It replaces the time functions used by
+ *  the daemons with a clock that advances SIM_CLOCK_SPEEDUP times faster
+ *  than the real clock, starting from the real time SIM_CLOCK_ANCHOR (in
+ *  seconds since the epoch). Since the virtual time is a pure function of the
+ *  real time, every process started with the same two environment variables
+ *  sees the same clock without any shared state. Sleeps and timed condition
+ *  waits are shortened by the same factor, so that periodic activities such
+ *  as backfill scheduling, time limit enforcement and node ping happen at
+ *  their configured virtual rates.
+ *
+ *  If SIM_CLOCK_ANCHOR or SIM_CLOCK_SPEEDUP are not set, the real clock is
+ *  used unchanged.
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://www.schedmd.com/slurmdocs/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+#endif
+
+/* Hide the system prototype, whose timezone argument type varies */
+#define gettimeofday __sim_hidden_gettimeofday
+#include <sys/time.h>
+#undef gettimeofday
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static int  (*real_clock_gettime)(clockid_t, struct timespec *) = NULL;
+static int  (*real_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *,
+				   const struct timespec *) = NULL;
+static int  (*real_nanosleep)(const struct timespec *,
+			      struct timespec *) = NULL;
+static pthread_once_t sim_once = PTHREAD_ONCE_INIT;
+static double sim_anchor  = 0.0;
+static double sim_speedup = 1.0;
+
+static void   _sim_init(void);
+static double _real_now(void);
+static double _virt_now(void);
+static void   _virt_to_real_ts(const struct timespec *virt,
+			       struct timespec *real);
+
+static void _sim_init(void)
+{
+	char *anchor, *speedup;
+
+	real_clock_gettime  = dlsym(RTLD_NEXT, "clock_gettime");
+	real_cond_timedwait = dlsym(RTLD_NEXT, "pthread_cond_timedwait");
+	real_nanosleep      = dlsym(RTLD_NEXT, "nanosleep");
+
+	anchor  = getenv("SIM_CLOCK_ANCHOR");
+	speedup = getenv("SIM_CLOCK_SPEEDUP");
+	if (anchor && speedup && (atof(speedup) > 0.0)) {
+		sim_anchor  = atof(anchor);
+		sim_speedup = atof(speedup);
+	}
+}
+
+static double _real_now(void)
+{
+	struct timespec ts;
+
+	(void) real_clock_gettime(CLOCK_REALTIME, &ts);
+	return (double) ts.tv_sec + ((double) ts.tv_nsec / 1.0e9);
+}
+
+static double _virt_now(void)
+{
+	double now;
+
+	pthread_once(&sim_once, _sim_init);
+	now = _real_now();
+	if (sim_speedup == 1.0)
+		return now;
+	return sim_anchor + ((now - sim_anchor) * sim_speedup);
+}
+
+/* Convert an absolute virtual time to the equivalent absolute real time */
+static void _virt_to_real_ts(const struct timespec *virt,
+			     struct timespec *real)
+{
+	double t;
+
+	t  = (double) virt->tv_sec + ((double) virt->tv_nsec / 1.0e9);
+	t  = sim_anchor + ((t - sim_anchor) / sim_speedup);
+	real->tv_sec  = (time_t) t;
+	real->tv_nsec = (long) ((t - (double) real->tv_sec) * 1.0e9);
+}
+
+extern time_t time(time_t *tloc)
+{
+	time_t now = (time_t) _virt_now();
+
+	if (tloc)
+		*tloc = now;
+	return now;
+}
+
+extern int gettimeofday(struct timeval *tv, void *tz)
+{
+	double now = _virt_now();
+
+	if (tv) {
+		tv->tv_sec  = (time_t) now;
+		tv->tv_usec = (suseconds_t) ((now - (double) tv->tv_sec) *
+					     1.0e6);
+	}
+	return 0;
+}
+
+extern int clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+	double now;
+
+	pthread_once(&sim_once, _sim_init);
+	if ((clk_id != CLOCK_REALTIME) || (sim_speedup == 1.0))
+		return real_clock_gettime(clk_id, tp);
+
+	now = _virt_now();
+	tp->tv_sec  = (time_t) now;
+	tp->tv_nsec = (long) ((now - (double) tp->tv_sec) * 1.0e9);
+	return 0;
+}
+
+extern int nanosleep(const struct timespec *req, struct timespec *rem)
+{
+	struct timespec real_req;
+	double t;
+
+	pthread_once(&sim_once, _sim_init);
+	if (sim_speedup == 1.0)
+		return real_nanosleep(req, rem);
+
+	t = ((double) req->tv_sec + ((double) req->tv_nsec / 1.0e9)) /
+	    sim_speedup;
+	real_req.tv_sec  = (time_t) t;
+	real_req.tv_nsec = (long) ((t - (double) real_req.tv_sec) * 1.0e9);
+	if (rem) {
+		rem->tv_sec  = 0;
+		rem->tv_nsec = 0;
+	}
+	return real_nanosleep(&real_req, NULL);
+}
+
+extern unsigned int sleep(unsigned int seconds)
+{
+	struct timespec req;
+
+	req.tv_sec  = seconds;
+	req.tv_nsec = 0;
+	(void) nanosleep(&req, NULL);
+	return 0;
+}
+
+extern int usleep(useconds_t usec)
+{
+	struct timespec req;
+
+	req.tv_sec  = usec / 1000000;
+	req.tv_nsec = (usec % 1000000) * 1000;
+	return nanosleep(&req, NULL);
+}
+
+extern int pthread_cond_timedwait(pthread_cond_t *cond,
+				  pthread_mutex_t *mutex,
+				  const struct timespec *abstime)
+{
+	struct timespec real_abstime;
+
+	pthread_once(&sim_once, _sim_init);
+	if (sim_speedup == 1.0)
+		return real_cond_timedwait(cond, mutex, abstime);
+
+	_virt_to_real_ts(abstime, &real_abstime);
+	return real_cond_timedwait(cond, mutex, &real_abstime);
+}
@@ -0,0 +1,575 @@
+/*****************************************************************************\
+ *  sim_replay.c - Replay a recorded workload through SLURM and report
+ *	scheduling performance
+ *
+ *  Build with:
+ *    gcc -o sim_replay sim_replay.c -lslurm
+ *  (add -I<prefix>/include -L<prefix>/lib as needed) and see the README file
+ *  in this directory for how to run it.
+ *****************************************************************************
+ *  The workload trace is read from a file with one job per line, in the
+ *  format produced by:
+ *    sacct -a -X -P -n -o Submit,Timelimit,NNodes,Elapsed
+ *  The submit time may also be given as seconds since the epoch. Each job is
+ *  submitted at its original offset from the first job in the trace as a
+ *  batch job that sleeps for its original elapsed time, with its original
+ *  time limit and node count. When run with the sim_clock library, all of
+ *  these times are compressed by the configured speedup.
+ *
+ *  Once every job has completed, the job wait times, makespan and node
+ *  utilization are reported. If slurmctld's log file is given, backfill
+ *  cycle depth and time (requires DebugFlags=Backfill) plus RPC processing
+ *  times, which are the times locks are held for these RPCs (requires
+ *  SlurmctldDebug=debug2), are also reported. Times from the log file are
+ *  converted back to real (not virtual) time.
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://www.schedmd.com/slurmdocs/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <slurm/slurm.h>
+#include <slurm/slurm_errno.h>
+
+#define POLL_INTERVAL	30	/* seconds between job state polls */
+#define MAX_RPC_TYPES	128	/* maximum distinct RPC names in log */
+
+#ifndef MAX
+#  define MAX(a,b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+typedef struct sim_job {
+	time_t trace_submit;	/* submit time from trace */
+	uint32_t time_limit;	/* minutes or NO_VAL */
+	uint32_t node_cnt;
+	uint32_t run_secs;	/* elapsed time from trace */
+	uint32_t job_id;	/* zero if submit failed */
+	uint32_t alloc_nodes;
+	time_t submit_time;	/* times reported by slurmctld */
+	time_t start_time;
+	time_t end_time;
+	int done;
+	int poll_cnt;		/* last poll which found the job */
+} sim_job_t;
+
+typedef struct rpc_stat {
+	char name[64];
+	uint32_t cnt;
+	double usec_total;
+	double usec_max;
+} rpc_stat_t;
+
+static sim_job_t *job_array = NULL;
+static int job_cnt = 0;
+static int done_cnt = 0;
+static sim_job_t **id_array = NULL;	/* submitted jobs by job ID */
+static int id_cnt = 0;
+static int id_sorted = 1;
+static double speedup = 1.0;
+static char *partition = NULL;
+
+static int    _cmp_id_ptr(const void *a, const void *b);
+static int    _cmp_job_id(const void *a, const void *b);
+static int    _cmp_submit(const void *a, const void *b);
+static int    _cmp_wait(const void *a, const void *b);
+static int    _parse_duration(char *str, uint32_t *secs);
+static int    _parse_line(char *line, sim_job_t *job_ptr);
+static void   _poll_jobs(void);
+static int    _read_trace(char *file_name);
+static void   _report_jobs(time_t replay_start);
+static void   _report_log(char *file_name, time_t replay_start);
+static int    _submit_job(sim_job_t *job_ptr);
+static void   _usage(char *prog_name);
+
+static void _usage(char *prog_name)
+{
+	fprintf(stderr, "Usage: %s -f <trace> [-l <slurmctld_log>] "
+		"[-p <partition>]\n", prog_name);
+}
+
+int main(int argc, char *argv[])
+{
+	char *trace_file = NULL, *log_file = NULL, *speedup_str;
+	time_t replay_start, target, now, next_poll;
+	int i, opt;
+
+	while ((opt = getopt(argc, argv, "f:l:p:h")) != -1) {
+		switch (opt) {
+		case 'f':
+			trace_file = optarg;
+			break;
+		case 'l':
+			log_file = optarg;
+			break;
+		case 'p':
+			partition = optarg;
+			break;
+		default:
+			_usage(argv[0]);
+			exit(1);
+		}
+	}
+	if (!trace_file) {
+		_usage(argv[0]);
+		exit(1);
+	}
+	speedup_str = getenv("SIM_CLOCK_SPEEDUP");
+	if (speedup_str && (atof(speedup_str) > 0.0))
+		speedup = atof(speedup_str);
+
+	if (_read_trace(trace_file) || (job_cnt == 0)) {
+		fprintf(stderr, "No jobs read from %s\n", trace_file);
+		exit(1);
+	}
+	qsort(job_array, job_cnt, sizeof(sim_job_t), _cmp_submit);
+	id_array = malloc(sizeof(sim_job_t *) * job_cnt);
+	if (id_array == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	printf("Replaying %d jobs at speedup %.1f\n", job_cnt, speedup);
+
+	replay_start = time(NULL);
+	next_poll = replay_start + POLL_INTERVAL;
+	for (i = 0; i < job_cnt; i++) {
+		target = replay_start + (job_array[i].trace_submit -
+					 job_array[0].trace_submit);
+		while ((now = time(NULL)) < target) {
+			if (now >= next_poll) {
+				_poll_jobs();
+				next_poll = now + POLL_INTERVAL;
+			}
+			sleep(MIN(target, next_poll) - now);
+		}
+		if (_submit_job(&job_array[i]) != SLURM_SUCCESS) {
+			/* Failed submissions have no job to wait for */
+			job_array[i].done = 1;
+			done_cnt++;
+			continue;
+		}
+		if (id_cnt && (id_array[id_cnt - 1]->job_id >
+			       job_array[i].job_id))
+			id_sorted = 0;
+		id_array[id_cnt++] = &job_array[i];
+	}
+
+	while (done_cnt < job_cnt) {
+		sleep(POLL_INTERVAL);
+		_poll_jobs();
+	}
+
+	_report_jobs(replay_start);
+	if (log_file)
+		_report_log(log_file, replay_start);
+	free(id_array);
+	free(job_array);
+	exit(0);
+}
+
+/* Parse "[days-]hours:minutes:seconds", "minutes:seconds" or "UNLIMITED" */
+static int _parse_duration(char *str, uint32_t *secs)
+{
+	int days = 0, hours = 0, mins = 0, sec = 0;
+
+	if (!strncasecmp(str, "UNLIMITED", 9) ||
+	    !strncasecmp(str, "Partition_Limit", 15)) {
+		*secs = NO_VAL;
+		return 0;
+	}
+	if (strchr(str, '-')) {
+		if (sscanf(str, "%d-%d:%d:%d",
+			   &days, &hours, &mins, &sec) != 4)
+			return -1;
+	} else if (sscanf(str, "%d:%d:%d", &hours, &mins, &sec) != 3) {
+		hours = 0;
+		if (sscanf(str, "%d:%d", &mins, &sec) != 2)
+			return -1;
+	}
+	*secs = (((days * 24 + hours) * 60) + mins) * 60 + sec;
+	return 0;
+}
+
+/* Parse a "Submit|Timelimit|NNodes|Elapsed" line from the trace */
+static int _parse_line(char *line, sim_job_t *job_ptr)
+{
+	char *fields[4], *save_ptr = NULL, *tok;
+	struct tm tm;
+	uint32_t secs;
+	int i = 0;
+
+	tok = strtok_r(line, "|\n", &save_ptr);
+	while (tok && (i < 4)) {
+		fields[i++] = tok;
+		tok = strtok_r(NULL, "|\n", &save_ptr);
+	}
+	if (i < 4)
+		return -1;
+
+	memset(job_ptr, 0, sizeof(sim_job_t));
+	memset(&tm, 0, sizeof(struct tm));
+	if (strptime(fields[0], "%Y-%m-%dT%H:%M:%S", &tm)) {
+		tm.tm_isdst = -1;
+		job_ptr->trace_submit = mktime(&tm);
+	} else if (strspn(fields[0], "0123456789") == strlen(fields[0])) {
+		job_ptr->trace_submit = (time_t) strtol(fields[0], NULL, 10);
+	} else
+		return -1;
+
+	if (_parse_duration(fields[1], &secs))
+		return -1;
+	if (secs == NO_VAL)
+		job_ptr->time_limit = NO_VAL;
+	else
+		job_ptr->time_limit = MAX(1, (secs + 59) / 60);
+
+	job_ptr->node_cnt = strtol(fields[2], NULL, 10);
+	if (job_ptr->node_cnt == 0)
+		return -1;
+
+	if (_parse_duration(fields[3], &job_ptr->run_secs) ||
+	    (job_ptr->run_secs == NO_VAL))
+		return -1;
+
+	return 0;
+}
+
+static int _read_trace(char *file_name)
+{
+	char line[1024];
+	int job_size = 0, line_num = 0;
+	FILE *fp;
+
+	if ((fp = fopen(file_name, "r")) == NULL) {
+		perror(file_name);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		line_num++;
+		if (job_cnt >= job_size) {
+			job_size += 1024;
+			job_array = realloc(job_array,
+					    sizeof(sim_job_t) * job_size);
+			if (job_array == NULL) {
+				perror("realloc");
+				exit(1);
+			}
+		}
+		if (_parse_line(line, &job_array[job_cnt]) == 0)
+			job_cnt++;
+		else if (line[0] && (line[0] != '\n') && (line[0] != '#'))
+			fprintf(stderr, "%s:%d: ignoring bad line\n",
+				file_name, line_num);
+	}
+	fclose(fp);
+	return 0;
+}
+
+static int _submit_job(sim_job_t *job_ptr)
+{
+	static char *env[] = { "PATH=/bin:/usr/bin", NULL };
+	job_desc_msg_t job_desc;
+	submit_response_msg_t *resp = NULL;
+	char script[128];
+	int rc;
+
+	/* The job itself runs in real time, so compress its run time */
+	snprintf(script, sizeof(script), "#!/bin/sh\nsleep %.3f\n",
+		 (double) job_ptr->run_secs / speedup);
+
+	slurm_init_job_desc_msg(&job_desc);
+	job_desc.name = "sim_replay";
+	job_desc.script = script;
+	job_desc.environment = env;
+	job_desc.env_size = 1;
+	job_desc.work_dir = "/tmp";
+	job_desc.std_out = "/dev/null";
+	job_desc.partition = partition;
+	job_desc.min_nodes = job_ptr->node_cnt;
+	job_desc.time_limit = job_ptr->time_limit;
+	job_desc.user_id = getuid();
+	job_desc.group_id = getgid();
+
+	while ((rc = slurm_submit_batch_job(&job_desc, &resp)) !=
+	       SLURM_SUCCESS) {
+		if (errno != EAGAIN)
+			break;
+		sleep(1);
+	}
+	if (rc != SLURM_SUCCESS) {
+		slurm_perror("slurm_submit_batch_job");
+		return rc;
+	}
+	job_ptr->job_id = resp->job_id;
+	slurm_free_submit_response_response_msg(resp);
+	return SLURM_SUCCESS;
+}
+
+static int _cmp_submit(const void *a, const void *b)
+{
+	const sim_job_t *job_a = a, *job_b = b;
+
+	if (job_a->trace_submit < job_b->trace_submit)
+		return -1;
+	if (job_a->trace_submit > job_b->trace_submit)
+		return 1;
+	return 0;
+}
+
+static int _cmp_id_ptr(const void *a, const void *b)
+{
+	const sim_job_t *job_a = *(sim_job_t * const *) a;
+	const sim_job_t *job_b = *(sim_job_t * const *) b;
+
+	if (job_a->job_id < job_b->job_id)
+		return -1;
+	if (job_a->job_id > job_b->job_id)
+		return 1;
+	return 0;
+}
+
+static int _cmp_job_id(const void *a, const void *b)
+{
+	uint32_t job_id = *(const uint32_t *) a;
+	const sim_job_t *job_ptr = *(sim_job_t * const *) b;
+
+	if (job_id < job_ptr->job_id)
+		return -1;
+	if (job_id > job_ptr->job_id)
+		return 1;
+	return 0;
+}
+
+static int _cmp_wait(const void *a, const void *b)
+{
+	long wait_a = *(const long *) a, wait_b = *(const long *) b;
+
+	if (wait_a < wait_b)
+		return -1;
+	if (wait_a > wait_b)
+		return 1;
+	return 0;
+}
+
+/* Record the state of every replayed job which slurmctld still knows about.
+ * Jobs should be polled at intervals shorter than MinJobAge, a job which
+ * slurmctld no longer knows about is counted as done with the times last
+ * seen for it. */
+static void _poll_jobs(void)
+{
+	static int poll_cnt = 0;
+	job_info_msg_t *job_info_msg = NULL;
+	job_info_t *job_info;
+	sim_job_t *job_ptr, **id_ptr;
+	int i;
+
+	if (slurm_load_jobs((time_t) 0, &job_info_msg, SHOW_ALL)) {
+		slurm_perror("slurm_load_jobs");
+		return;
+	}
+	poll_cnt++;
+
+	/* Only submitted jobs are indexed, failed submissions have job_id
+	 * zero and are already done */
+	if (!id_sorted) {
+		qsort(id_array, id_cnt, sizeof(sim_job_t *), _cmp_id_ptr);
+		id_sorted = 1;
+	}
+	for (i = 0; i < job_info_msg->record_count; i++) {
+		job_info = &job_info_msg->job_array[i];
+		id_ptr = bsearch(&job_info->job_id, id_array, id_cnt,
+				 sizeof(sim_job_t *), _cmp_job_id);
+		if (!id_ptr || (*id_ptr)->done)
+			continue;
+		job_ptr = *id_ptr;
+		job_ptr->poll_cnt = poll_cnt;
+		job_ptr->submit_time = job_info->submit_time;
+		if ((job_info->job_state & JOB_STATE_BASE) > JOB_PENDING) {
+			job_ptr->start_time  = job_info->start_time;
+			job_ptr->alloc_nodes = job_info->num_nodes;
+		}
+		if (((job_info->job_state & JOB_STATE_BASE) > JOB_SUSPENDED) &&
+		    ((job_info->job_state & JOB_COMPLETING) == 0)) {
+			job_ptr->end_time = job_info->end_time;
+			job_ptr->done = 1;
+			done_cnt++;
+		}
+	}
+	slurm_free_job_info_msg(job_info_msg);
+
+	for (i = 0; i < id_cnt; i++) {
+		job_ptr = id_array[i];
+		if (job_ptr->done || (job_ptr->poll_cnt == poll_cnt))
+			continue;
+		fprintf(stderr, "Job %u not found, polled too slowly for "
+			"MinJobAge?\n", job_ptr->job_id);
+		if (job_ptr->start_time && !job_ptr->end_time)
+			job_ptr->end_time = time(NULL);
+		job_ptr->done = 1;
+		done_cnt++;
+	}
+}
+
+static void _report_jobs(time_t replay_start)
+{
+	node_info_msg_t *node_info_msg = NULL;
+	long *wait_array, wait_total = 0;
+	double node_secs = 0.0, makespan;
+	time_t last_end = replay_start;
+	int i, node_cnt = 0, run_cnt = 0, fail_cnt = 0;
+
+	if (slurm_load_node((time_t) 0, &node_info_msg, SHOW_ALL) == 0) {
+		node_cnt = node_info_msg->record_count;
+		slurm_free_node_info_msg(node_info_msg);
+	} else
+		slurm_perror("slurm_load_node");
+
+	wait_array = malloc(sizeof(long) * job_cnt);
+	if (wait_array == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0; i < job_cnt; i++) {
+		sim_job_t *job_ptr = &job_array[i];
+		if ((job_ptr->job_id == 0) || (job_ptr->start_time == 0)) {
+			fail_cnt++;
+			continue;
+		}
+		wait_array[run_cnt] = job_ptr->start_time -
+				      job_ptr->submit_time;
+		wait_total += wait_array[run_cnt];
+		run_cnt++;
+		node_secs += (double) job_ptr->alloc_nodes *
+			     difftime(job_ptr->end_time, job_ptr->start_time);
+		if (job_ptr->end_time > last_end)
+			last_end = job_ptr->end_time;
+	}
+	makespan = difftime(last_end, replay_start);
+
+	printf("\nJobs:          %d run, %d failed or never started\n",
+	       run_cnt, fail_cnt);
+	printf("Makespan:      %.0f secs\n", makespan);
+	if (run_cnt) {
+		qsort(wait_array, run_cnt, sizeof(long), _cmp_wait);
+		printf("Wait time:     mean %.1f, median %ld, max %ld secs\n",
+		       (double) wait_total / run_cnt,
+		       wait_array[run_cnt / 2], wait_array[run_cnt - 1]);
+	}
+	if (node_cnt && (makespan > 0.0)) {
+		printf("Utilization:   %.1f%% of %d nodes\n",
+		       (node_secs * 100.0) / (node_cnt * makespan), node_cnt);
+	}
+	free(wait_array);
+}
+
+/* Extract backfill and RPC timing records logged by slurmctld after
+ * replay_start */
+static void _report_log(char *file_name, time_t replay_start)
+{
+	rpc_stat_t *rpc_stats;
+	char line[1024], *ptr, *usec_ptr;
+	int bf_cycles = 0, bf_depth, bf_depth_max = 0, rpc_cnt = 0, i, len;
+	double bf_depth_total = 0, bf_usec_total = 0, bf_usec_max = 0, usec;
+	struct tm tm;
+	time_t line_time;
+	FILE *fp;
+
+	if ((fp = fopen(file_name, "r")) == NULL) {
+		perror(file_name);
+		return;
+	}
+	rpc_stats = calloc(MAX_RPC_TYPES, sizeof(rpc_stat_t));
+	if (rpc_stats == NULL) {
+		perror("calloc");
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		memset(&tm, 0, sizeof(struct tm));
+		if ((line[0] != '[') ||
+		    !strptime(line + 1, "%Y-%m-%dT%H:%M:%S", &tm))
+			continue;
+		tm.tm_isdst = -1;
+		line_time = mktime(&tm);
+		if ((line_time < replay_start) ||
+		    ((usec_ptr = strstr(line, "usec=")) == NULL))
+			continue;
+		/* Timers use the virtual clock, convert to real time */
+		usec = strtod(usec_ptr + 5, NULL) / speedup;
+
+		if ((ptr = strstr(line, "backfill: completed testing ")) &&
+		    (sscanf(ptr + 28, "%d", &bf_depth) == 1)) {
+			bf_cycles++;
+			bf_depth_total += bf_depth;
+			bf_depth_max = MAX(bf_depth_max, bf_depth);
+			bf_usec_total += usec;
+			bf_usec_max = MAX(bf_usec_max, usec);
+			continue;
+		}
+
+		if ((ptr = strstr(line, "_slurm_rpc_")) == NULL)
+			continue;
+		len = strcspn(ptr, " :,");
+		if (len >= sizeof(rpc_stats[0].name))
+			len = sizeof(rpc_stats[0].name) - 1;
+		for (i = 0; i < rpc_cnt; i++) {
+			if (!strncmp(rpc_stats[i].name, ptr, len) &&
+			    (rpc_stats[i].name[len] == '\0'))
+				break;
+		}
+		if (i == rpc_cnt) {
+			if (rpc_cnt == MAX_RPC_TYPES)
+				continue;
+			strncpy(rpc_stats[i].name, ptr, len);
+			rpc_cnt++;
+		}
+		rpc_stats[i].cnt++;
+		rpc_stats[i].usec_total += usec;
+		rpc_stats[i].usec_max = MAX(rpc_stats[i].usec_max, usec);
+	}
+	fclose(fp);
+
+	if (bf_cycles) {
+		printf("Backfill:      %d cycles, depth mean %.1f max %d jobs, "
+		       "time mean %.0f max %.0f usec\n", bf_cycles,
+		       bf_depth_total / bf_cycles, bf_depth_max,
+		       bf_usec_total / bf_cycles, bf_usec_max);
+	}
+	if (rpc_cnt) {
+		printf("\n%-40s %8s %12s %12s\n", "RPC (locks held)", "Count",
+		       "Mean usec", "Max usec");
+		for (i = 0; i < rpc_cnt; i++) {
+			printf("%-40s %8u %12.0f %12.0f\n", rpc_stats[i].name,
+			       rpc_stats[i].cnt,
+			       rpc_stats[i].usec_total / rpc_stats[i].cnt,
+			       rpc_stats[i].usec_max);
+		}
+	}
+	free(rpc_stats);
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************\
+ *  squeue_bench.c - Time squeue's filtering, sorting and formatting of a
+ *	large job queue without a running slurmctld
+ *
+ *  Build with (from a configured build directory, after "make"):
+ *    gcc -DHAVE_CONFIG_H -I<top_srcdir> -I. -o squeue_bench \
+ *        <top_srcdir>/contribs/sim/squeue_bench.c src/squeue/opts.o \
+ *        src/squeue/print.o src/squeue/sort.o src/api/libslurm.o \
+ *        -ldl -lpthread
+ *  and see the README file in this directory.
+ *
+ *  Usage: squeue_bench [job_count [iterations [sort_keys]]]
+ *****************************************************************************
+ *  A job_info_msg_t of job_count records (default 200000) is built in
+ *  memory: one third running on up to 64 nodes each, the rest pending, over
+ *  16 partitions and a mix of local user IDs, with random priorities and
+ *  times. It is then printed to /dev/null with squeue's default format and
+ *  sort order (or the given --sort keys), the way "squeue" would after
+ *  slurm_load_jobs() returns. The wall clock time of each pass is reported.
+ *  slurm.conf is read to load the SelectType plugin used to print node
+ *  counts, no daemon is contacted.
+ *****************************************************************************
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <http://www.schedmd.com/slurmdocs/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "src/common/xstring.h"
+#include "src/squeue/squeue.h"
+
+#define PART_CNT	16	/* partitions jobs are spread over */
+#define UID_CNT		8	/* distinct user IDs */
+
+/* Globals otherwise defined in squeue.c */
+struct squeue_parameters params;
+int max_line_size;
+
+static char *part_names[PART_CNT];
+
+/* Fill in a job record the way slurmctld would report it */
+static void _build_job(job_info_t *job_ptr, uint32_t job_id, time_t now)
+{
+	int node_cnt, first_node;
+	char tmp[64];
+
+	memset(job_ptr, 0, sizeof(job_info_t));
+	job_ptr->job_id = job_id;
+	job_ptr->user_id = getuid() + (random() % UID_CNT);
+	job_ptr->group_id = getgid();
+	job_ptr->partition = part_names[random() % PART_CNT];
+	snprintf(tmp, sizeof(tmp), "job%u", job_id % 1000);
+	job_ptr->name = strdup(tmp);
+	job_ptr->priority = random() % 100000;
+	job_ptr->submit_time = now - (random() % 86400);
+	job_ptr->time_limit = 60 + (random() % 1440);
+	node_cnt = 1 + (random() % 64);
+	job_ptr->num_nodes = node_cnt;
+	job_ptr->num_cpus = node_cnt * 16;
+	if ((job_id % 3) == 0) {
+		job_ptr->job_state = JOB_RUNNING;
+		job_ptr->start_time = job_ptr->submit_time +
+				      (random() % 3600);
+		if (job_ptr->start_time > now)
+			job_ptr->start_time = now;
+		job_ptr->end_time = job_ptr->start_time +
+				    (job_ptr->time_limit * 60);
+		first_node = random() % 10000;
+		snprintf(tmp, sizeof(tmp), "tux[%d-%d]", first_node,
+			 first_node + node_cnt - 1);
+		job_ptr->nodes = strdup(tmp);
+	} else {
+		job_ptr->job_state = JOB_PENDING;
+		job_ptr->state_reason = (random() % 2) ? WAIT_PRIORITY :
+							 WAIT_RESOURCES;
+		job_ptr->start_time = now + (random() % 86400);
+	}
+}
+
+static double _elapsed(struct timeval *tv1, struct timeval *tv2)
+{
+	return (tv2->tv_sec - tv1->tv_sec) +
+	       ((tv2->tv_usec - tv1->tv_usec) / 1000000.0);
+}
+
+int main(int argc, char *argv[])
+{
+	log_options_t opts = LOG_OPTS_STDERR_ONLY;
+	job_info_t *jobs;
+	struct timeval tv1, tv2;
+	time_t now = time(NULL);
+	int i, job_cnt = 200000, iterations = 3;
+	char tmp[16];
+
+	log_init(argv[0], opts, SYSLOG_FACILITY_USER, NULL);
+	if (argc > 1)
+		job_cnt = atoi(argv[1]);
+	if (argc > 2)
+		iterations = atoi(argv[2]);
+	if (argc > 3)
+		params.sort = xstrdup(argv[3]);
+	if ((job_cnt < 1) || (iterations < 1)) {
+		fprintf(stderr,
+			"Usage: %s [job_count [iterations [sort_keys]]]\n",
+			argv[0]);
+		exit(1);
+	}
+
+	for (i = 0; i < PART_CNT; i++) {
+		snprintf(tmp, sizeof(tmp), "part%d", i);
+		part_names[i] = strdup(tmp);
+	}
+	srandom(1);
+	jobs = malloc(sizeof(job_info_t) * job_cnt);
+	if (jobs == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0; i < job_cnt; i++)
+		_build_job(&jobs[i], i + 1, now);
+
+	params.all_flag = true;
+	params.max_cpus = 16;
+	params.format = "%.7i %.9P %.8j %.8u  %.2t %.10M %.6D %R";
+	parse_format(params.format);
+	max_line_size = 80;
+
+	if (freopen("/dev/null", "w", stdout) == NULL) {
+		perror("freopen");
+		exit(1);
+	}
+	for (i = 0; i < iterations; i++) {
+		gettimeofday(&tv1, NULL);
+		print_jobs_array(jobs, job_cnt, params.format_list);
+		fflush(stdout);
+		gettimeofday(&tv2, NULL);
+		fprintf(stderr, "%d jobs: pass %d took %.3f seconds\n",
+			job_cnt, i + 1, _elapsed(&tv1, &tv2));
+	}
+	exit(0);
+}
@@ -255,6 +255,9 @@ typedef struct {
 	List groupid_list;	/* list of char * */
 	uint32_t nodes_max;     /* number of nodes high range */
 	uint32_t nodes_min;     /* number of nodes low range */
+	char *page_cluster;     /* resume paged query in this cluster */
+	uint32_t page_job_id;   /* resume paged query after this job id */
+	uint32_t page_size;     /* max jobs to return per query, 0 for all */
 	List partition_list;	/* list of char * */
 	List qos_list;  	/* list of char * */
 	List resv_list;		/* list of char * */
@@ -843,6 +843,16 @@ extern void *slurm_ctl_conf_2_key_pairs (slurm_ctl_conf_t* slurm_ctl_conf_ptr)
 	key_pair->value = xstrdup(slurm_ctl_conf_ptr->slurmctld_logfile);
 	list_append(ret_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("SlurmctldLogQueue");
+	if (slurm_ctl_conf_ptr->slurmctld_log_queue == LOG_QUEUE_BLOCK)
+		key_pair->value = xstrdup("block");
+	else if (slurm_ctl_conf_ptr->slurmctld_log_queue == LOG_QUEUE_DROP)
+		key_pair->value = xstrdup("drop");
+	else
+		key_pair->value = xstrdup("none");
+	list_append(ret_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("SlurmSchedLogFile");
 	key_pair->value = xstrdup(slurm_ctl_conf_ptr->sched_logfile);
@@ -45,6 +45,8 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sys/types.h>
 
 #include "slurm/slurm.h"
@@ -62,6 +64,11 @@
 
 #define MAX_RETRIES 3
 
+/* How long (in seconds) a node which failed to respond is kept at the
+ * leaves of the forwarding trees, and how many such nodes to remember */
+#define FWD_SUSPECT_TIME	600
+#define FWD_SUSPECT_MAX		4096
+
 typedef struct {
 	pthread_cond_t *notify;
 	slurm_msg_t *orig_msg;
@@ -71,6 +78,236 @@ typedef struct {
 	pthread_mutex_t *tree_mutex;
 } fwd_tree_t;
 
+typedef struct {
+	char *name;
+	int switch_inx;
+} fwd_switch_t;
+
+typedef struct {
+	char *name;
+	time_t when;
+} fwd_suspect_t;
+
+typedef struct {
+	char *name;		/* from hostlist_shift(), release with free() */
+	int pos;		/* position in the original hostlist */
+	int switch_inx;		/* leaf switch, fwd_switch_inx_cnt if unknown */
+	bool suspect;		/* failed to respond recently */
+} fwd_host_t;
+
+/* Leaf switch of each node (sorted by node name, set by slurmctld through
+ * forward_set_switches) and nodes which recently failed to respond (also
+ * sorted by node name) */
+static pthread_mutex_t fwd_mutex = PTHREAD_MUTEX_INITIALIZER;
+static fwd_switch_t *fwd_switch = NULL;
+static int fwd_switch_cnt = 0, fwd_switch_inx_cnt = 0;
+static fwd_suspect_t *fwd_suspect = NULL;
+static int fwd_suspect_cnt = 0;
+
+static int _fwd_host_cmp(const void *a, const void *b)
+{
+	const fwd_host_t *h1 = a, *h2 = b;
+
+	if (h1->switch_inx != h2->switch_inx)
+		return (h1->switch_inx - h2->switch_inx);
+	return (h1->pos - h2->pos);
+}
+
+static int _fwd_switch_cmp(const void *a, const void *b)
+{
+	return strcmp(((const fwd_switch_t *) a)->name,
+		      ((const fwd_switch_t *) b)->name);
+}
+
+/* Return the leaf switch of a node, fwd_switch_inx_cnt if not known.
+ * Call with fwd_mutex locked. */
+static int _fwd_switch_inx(char *name)
+{
+	fwd_switch_t key, *found;
+
+	if (!fwd_switch_cnt)
+		return 0;
+	key.name = name;
+	found = bsearch(&key, fwd_switch, fwd_switch_cnt,
+			sizeof(fwd_switch_t), _fwd_switch_cmp);
+	if (found)
+		return found->switch_inx;
+	return fwd_switch_inx_cnt;
+}
+
+/* Return the index of a node in fwd_suspect, -1 if not there. If pos is
+ * set, it gets the index the node should be inserted at.
+ * Call with fwd_mutex locked. */
+static int _fwd_suspect_inx(char *name, int *pos)
+{
+	int lo = 0, hi = fwd_suspect_cnt, mid, rc;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		rc = strcmp(fwd_suspect[mid].name, name);
+		if (rc == 0)
+			return mid;
+		if (rc < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (pos)
+		*pos = lo;
+	return -1;
+}
+
+/* Call with fwd_mutex locked */
+static void _fwd_suspect_del(int inx)
+{
+	xfree(fwd_suspect[inx].name);
+	fwd_suspect_cnt--;
+	memmove(&fwd_suspect[inx], &fwd_suspect[inx + 1],
+		sizeof(fwd_suspect_t) * (fwd_suspect_cnt - inx));
+}
+
+/*
+ * Remember which nodes of a completed tree failed to respond, so the next
+ * trees only use them as leaves, and forget the ones which did respond.
+ */
+static void _fwd_note_responses(List ret_list)
+{
+	ListIterator itr;
+	ret_data_info_t *ret_data_info = NULL;
+	time_t now = time(NULL);
+	int i, j, pos = 0, oldest;
+
+	if (!ret_list)
+		return;
+
+	slurm_mutex_lock(&fwd_mutex);
+	for (i = 0, j = 0; i < fwd_suspect_cnt; i++) {
+		if (difftime(now, fwd_suspect[i].when) >= FWD_SUSPECT_TIME)
+			xfree(fwd_suspect[i].name);
+		else
+			fwd_suspect[j++] = fwd_suspect[i];
+	}
+	fwd_suspect_cnt = j;
+	itr = list_iterator_create(ret_list);
+	while ((ret_data_info = list_next(itr))) {
+		if (!ret_data_info->node_name)
+			continue;
+		i = _fwd_suspect_inx(ret_data_info->node_name, &pos);
+		if (ret_data_info->type != RESPONSE_FORWARD_FAILED) {
+			if (i >= 0)
+				_fwd_suspect_del(i);
+			continue;
+		}
+		if (i < 0) {
+			if (fwd_suspect_cnt >= FWD_SUSPECT_MAX) {
+				for (i = 1, oldest = 0; i < fwd_suspect_cnt;
+				     i++) {
+					if (fwd_suspect[i].when <
+					    fwd_suspect[oldest].when)
+						oldest = i;
+				}
+				_fwd_suspect_del(oldest);
+				if (oldest < pos)
+					pos--;
+			}
+			if (!fwd_suspect) {
+				fwd_suspect = xmalloc(sizeof(fwd_suspect_t) *
+						      FWD_SUSPECT_MAX);
+			}
+			memmove(&fwd_suspect[pos + 1], &fwd_suspect[pos],
+				sizeof(fwd_suspect_t) *
+				(fwd_suspect_cnt - pos));
+			fwd_suspect_cnt++;
+			i = pos;
+			fwd_suspect[i].name =
+				xstrdup(ret_data_info->node_name);
+			debug2("forward: %s failed to respond, keeping it at "
+			       "the leaves of the tree", fwd_suspect[i].name);
+		}
+		fwd_suspect[i].when = now;
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&fwd_mutex);
+}
+
+/*
+ * Split the nodes of hl (emptied here) into the subtrees of the forwarding
+ * tree. The first node of each subtree is sent the message, the others are
+ * the ones it forwards the message to. Subtree sizes are those given by
+ * set_span(), but when the leaf switches are known the nodes are grouped by
+ * switch and a subtree may end early at a switch boundary, so subtrees stay
+ * within a switch where possible. Nodes which recently failed to respond are
+ * moved to the end of their subtree: they are never used to forward to
+ * responsive nodes, here or further down the tree since forwarding nodes
+ * keep the order of the nodes they are sent.
+ * OUT tree_cnt - number of subtrees
+ * RET xmalloc'd array of tree_cnt hostlists
+ */
+static hostlist_t *_fwd_split_hosts(hostlist_t hl, int *tree_cnt)
+{
+	int host_cnt = hostlist_count(hl);
+	int *span = set_span(host_cnt, 0);
+	int width = slurm_get_tree_width();
+	fwd_host_t *hosts;
+	hostlist_t *trees;
+	time_t now = time(NULL);
+	int i, j, k, size, target, carry = 0, inx = 0;
+	bool by_switch;
+
+	hosts = xmalloc(sizeof(fwd_host_t) * (host_cnt + 1));
+	slurm_mutex_lock(&fwd_mutex);
+	by_switch = (fwd_switch_cnt != 0);
+	for (i = 0; i < host_cnt; i++) {
+		hosts[i].name = hostlist_shift(hl);
+		hosts[i].pos = i;
+		hosts[i].switch_inx = _fwd_switch_inx(hosts[i].name);
+		j = _fwd_suspect_inx(hosts[i].name, NULL);
+		hosts[i].suspect = ((j >= 0) &&
+				    (difftime(now, fwd_suspect[j].when) <
+				     FWD_SUSPECT_TIME));
+	}
+	slurm_mutex_unlock(&fwd_mutex);
+	if (by_switch)
+		qsort(hosts, host_cnt, sizeof(fwd_host_t), _fwd_host_cmp);
+
+	trees = xmalloc(sizeof(hostlist_t) * (host_cnt + 1));
+	*tree_cnt = 0;
+	while (inx < host_cnt) {
+		/* never more than TreeWidth subtrees */
+		if (*tree_cnt >= (width - 1))
+			target = host_cnt - inx;
+		else
+			target = span[*tree_cnt] + 1 + carry;
+		for (size = 1; (size < target) && (inx + size < host_cnt);
+		     size++) {
+			if (by_switch && ((size * 2) >= target) &&
+			    (hosts[inx + size].switch_inx !=
+			     hosts[inx + size - 1].switch_inx))
+				break;
+		}
+		carry = target - size;
+
+		/* responsive nodes first, keeping their order */
+		trees[*tree_cnt] = hostlist_create(NULL);
+		for (k = 0; k < 2; k++) {
+			for (j = inx; j < inx + size; j++) {
+				if (hosts[j].suspect == (k == 1)) {
+					hostlist_push_host(trees[*tree_cnt],
+							   hosts[j].name);
+				}
+			}
+		}
+		for (j = inx; j < inx + size; j++)
+			free(hosts[j].name);
+		inx += size;
+		(*tree_cnt)++;
+	}
+	xfree(hosts);
+	xfree(span);
+
+	return trees;
+}
+
 void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 {
 	if(fwd_tree) {
@@ -83,7 +320,7 @@ void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 void *_forward_thread(void *arg)
 {
 	forward_msg_t *fwd_msg = (forward_msg_t *)arg;
-	Buf buffer = init_buf(fwd_msg->buf_len);
+	Buf buffer = init_buf(BUF_SIZE);
 	int i=0;
 	List ret_list = NULL;
 	slurm_fd_t fd = -1;
@@ -138,26 +375,20 @@ void *_forward_thread(void *arg)
 		} else
 			debug3("forward: send to %s ", name);
 
+		/* Only the header is packed here, the forwarded data
+		 * (auth credential and body) is sent straight from the
+		 * buffer shared by all the forwarding threads */
+		set_buf_offset(buffer, 0);
 		pack_header(&fwd_msg->header, buffer);
 
-		/* add forward data to buffer */
-		if (remaining_buf(buffer) < fwd_msg->buf_len) {
-			buffer->size += (fwd_msg->buf_len + BUF_SIZE);
-			xrealloc(buffer->head, buffer->size);
-		}
-		if (fwd_msg->buf_len) {
-			memcpy(&buffer->head[buffer->processed],
-			       fwd_msg->buf, fwd_msg->buf_len);
-			buffer->processed += fwd_msg->buf_len;
-		}
-
 		/*
 		 * forward message
 		 */
-		if(_slurm_msg_sendto(fd,
-				     get_buf_data(buffer),
-				     get_buf_offset(buffer),
-				     SLURM_PROTOCOL_NO_SEND_RECV_FLAGS ) < 0) {
+		if(_slurm_msg_sendto_parts(fd,
+					   get_buf_data(buffer),
+					   get_buf_offset(buffer),
+					   fwd_msg->buf, fwd_msg->buf_len,
+					   SLURM_PROTOCOL_NO_SEND_RECV_FLAGS) < 0) {
 			error("forward_thread: slurm_msg_sendto: %m");
 
 			slurm_mutex_lock(fwd_msg->forward_mutex);
@@ -165,8 +396,6 @@ void *_forward_thread(void *arg)
 					       errno);
 			free(name);
 			if(hostlist_count(hl) > 0) {
-				free_buf(buffer);
-				buffer = init_buf(fwd_msg->buf_len);
 				slurm_mutex_unlock(fwd_msg->forward_mutex);
 				slurm_close_accepted_conn(fd);
 				fd = -1;
@@ -207,7 +436,10 @@ void *_forward_thread(void *arg)
 /* 			info("now  + %d*%d = %d", start_timeout, steps, fwd_msg->timeout); */
 		}
 
-		ret_list = slurm_receive_msgs(fd, steps, fwd_msg->timeout);
+		/* The responses are only passed back up the tree, so
+		 * leave their data packed */
+		ret_list = slurm_receive_relay_msgs(fd, steps,
+						    fwd_msg->timeout);
 		/* info("sent %d forwards got %d back", */
 /* 		     fwd_msg->header.forward.cnt, list_count(ret_list)); */
 
@@ -220,8 +452,6 @@ void *_forward_thread(void *arg)
 			if(ret_list)
 				list_destroy(ret_list);
 			if (hostlist_count(hl) > 0) {
-				free_buf(buffer);
-				buffer = init_buf(fwd_msg->buf_len);
 				slurm_mutex_unlock(fwd_msg->forward_mutex);
 				slurm_close_accepted_conn(fd);
 				fd = -1;
@@ -424,24 +654,29 @@ extern void forward_init(forward_t *forward, forward_t *from)
 extern int forward_msg(forward_struct_t *forward_struct,
 		       header_t *header)
 {
-	int j = 0;
 	int retries = 0;
 	forward_msg_t *forward_msg = NULL;
 	int thr_count = 0;
-	int *span = set_span(header->forward.cnt, 0);
 	hostlist_t hl = NULL;
-	hostlist_t forward_hl = NULL;
-	char *name = NULL;
+	hostlist_t *trees = NULL;
+	int tree_cnt = 0;
 
 	if(!forward_struct->ret_list) {
 		error("didn't get a ret_list from forward_struct");
-		xfree(span);
 		return SLURM_ERROR;
 	}
+	/* The sender already removed duplicates, keep its order of the
+	 * nodes as it puts unresponsive nodes last */
 	hl = hostlist_create(header->forward.nodelist);
-	hostlist_uniq(hl);
+	trees = _fwd_split_hosts(hl, &tree_cnt);
+	hostlist_destroy(hl);
+	if (tree_cnt > header->forward.cnt) {
+		error("forward_msg: got %d nodes to forward to, expected %u",
+		      tree_cnt, header->forward.cnt);
+		tree_cnt = header->forward.cnt;
+	}
 
-	while((name = hostlist_shift(hl))) {
+	for (thr_count = 0; thr_count < tree_cnt; thr_count++) {
 		pthread_attr_t attr_agent;
 		pthread_t thread_agent;
 		char *buf = NULL;
@@ -477,18 +712,8 @@ extern int forward_msg(forward_struct_t *forward_struct,
 		forward_msg->header.ret_list = NULL;
 		forward_msg->header.ret_cnt = 0;
 
-		forward_hl = hostlist_create(name);
-		free(name);
-		for(j = 0; j < span[thr_count]; j++) {
-			name = hostlist_shift(hl);
-			if(!name)
-				break;
-			hostlist_push(forward_hl, name);
-			free(name);
-		}
-
-		buf = hostlist_ranged_string_xmalloc(forward_hl);
-		hostlist_destroy(forward_hl);
+		buf = hostlist_ranged_string_xmalloc(trees[thr_count]);
+		hostlist_destroy(trees[thr_count]);
 		forward_init(&forward_msg->header.forward, NULL);
 		forward_msg->header.forward.nodelist = buf;
 		while(pthread_create(&thread_agent, &attr_agent,
@@ -500,10 +725,10 @@ extern int forward_msg(forward_struct_t *forward_struct,
 			sleep(1);	/* sleep and try again */
 		}
 		slurm_attr_destroy(&attr_agent);
-		thr_count++;
 	}
-	hostlist_destroy(hl);
-	xfree(span);
+	for ( ; thr_count < tree_cnt; thr_count++)
+		hostlist_destroy(trees[thr_count]);
+	xfree(trees);
 	return SLURM_SUCCESS;
 }
 
@@ -521,15 +746,15 @@ extern int forward_msg(forward_struct_t *forward_struct,
  */
 extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 {
-	int *span = NULL;
 	fwd_tree_t *fwd_tree = NULL;
 	pthread_mutex_t tree_mutex;
 	pthread_cond_t notify;
-	int j = 0, count = 0;
+	int count = 0;
 	List ret_list = NULL;
-	char *name = NULL;
 	int thr_count = 0;
 	int host_count = 0;
+	hostlist_t *trees = NULL;
+	int tree_cnt = 0;
 
 	xassert(hl);
 	xassert(msg);
@@ -537,14 +762,14 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	hostlist_uniq(hl);
 	host_count = hostlist_count(hl);
 
-	span = set_span(host_count, 0);
+	trees = _fwd_split_hosts(hl, &tree_cnt);
 
 	slurm_mutex_init(&tree_mutex);
 	pthread_cond_init(&notify, NULL);
 
 	ret_list = list_create(destroy_data_info);
 
-	while((name = hostlist_shift(hl))) {
+	for (thr_count = 0; thr_count < tree_cnt; thr_count++) {
 		pthread_attr_t attr_agent;
 		pthread_t thread_agent;
 		int retries = 0;
@@ -566,15 +791,7 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 			fwd_tree->timeout  = slurm_get_msg_timeout() * 1000;
 		}
 
-		fwd_tree->tree_hl = hostlist_create(name);
-		free(name);
-		for(j = 0; j < span[thr_count]; j++) {
-			name = hostlist_shift(hl);
-			if(!name)
-				break;
-			hostlist_push(fwd_tree->tree_hl, name);
-			free(name);
-		}
+		fwd_tree->tree_hl = trees[thr_count];
 
 		while(pthread_create(&thread_agent, &attr_agent,
 				     _fwd_tree_thread, (void *)fwd_tree)) {
@@ -584,9 +801,8 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 			sleep(1);	/* sleep and try again */
 		}
 		slurm_attr_destroy(&attr_agent);
-		thr_count++;
 	}
-	xfree(span);
+	xfree(trees);
 
 	slurm_mutex_lock(&tree_mutex);
 
@@ -599,6 +815,7 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	}
 	debug2("Tree head got them all");
 	slurm_mutex_unlock(&tree_mutex);
+	_fwd_note_responses(ret_list);
 
 	slurm_mutex_destroy(&tree_mutex);
 	pthread_cond_destroy(&notify);
@@ -606,6 +823,48 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 	return ret_list;
 }
 
+/*
+ * forward_set_switches - set the nodes connected to each leaf switch
+ *
+ * IN: switch_nodes   - char **  - node list of each leaf switch
+ * IN: switch_cnt     - int      - number of leaf switches, 0 to clear
+ */
+extern void forward_set_switches(char **switch_nodes, int switch_cnt)
+{
+	hostlist_t hl;
+	char *name;
+	int i, cnt = 0, size = 0;
+
+	slurm_mutex_lock(&fwd_mutex);
+	for (i = 0; i < fwd_switch_cnt; i++)
+		xfree(fwd_switch[i].name);
+	xfree(fwd_switch);
+	fwd_switch_cnt = 0;
+	fwd_switch_inx_cnt = 0;
+
+	for (i = 0; i < switch_cnt; i++) {
+		if (!switch_nodes[i])
+			continue;
+		hl = hostlist_create(switch_nodes[i]);
+		while ((name = hostlist_shift(hl))) {
+			if (cnt >= size) {
+				size += 1024;
+				xrealloc(fwd_switch, sizeof(fwd_switch_t) * size);
+			}
+			fwd_switch[cnt].name = xstrdup(name);
+			fwd_switch[cnt].switch_inx = i;
+			cnt++;
+			free(name);
+		}
+		hostlist_destroy(hl);
+	}
+	if (cnt)
+		qsort(fwd_switch, cnt, sizeof(fwd_switch_t), _fwd_switch_cmp);
+	fwd_switch_cnt = cnt;
+	fwd_switch_inx_cnt = switch_cnt;
+	slurm_mutex_unlock(&fwd_mutex);
+}
+
 /*
  * mark_as_failed_forward- mark a node as failed and add it to "ret_list"
  *
@@ -656,6 +915,7 @@ extern void forward_wait(slurm_msg_t * msg)
 		}
 		debug2("Got them all");
 		slurm_mutex_unlock(&msg->forward_struct->forward_mutex);
+		_fwd_note_responses(msg->ret_list);
 		destroy_forward_struct(msg->forward_struct);
 	}
 	return;
@@ -667,6 +927,7 @@ void destroy_data_info(void *object)
 	if(ret_data_info) {
 		slurm_free_msg_data(ret_data_info->type,
 				    ret_data_info->data);
+		xfree(ret_data_info->buf);
 		xfree(ret_data_info->node_name);
 		xfree(ret_data_info);
 	}
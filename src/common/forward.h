@@ -103,6 +103,16 @@ extern int forward_msg(forward_struct_t *forward_struct,
  */
 extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout);
 
+/*
+ * forward_set_switches - set the nodes connected to each leaf switch, used
+ *                        to keep the subtrees of the forwarding trees built
+ *                        by start_msg_tree within a switch where possible
+ *
+ * IN: switch_nodes   - char **  - node list of each leaf switch
+ * IN: switch_cnt     - int      - number of leaf switches, 0 to clear
+ */
+extern void forward_set_switches(char **switch_nodes, int switch_cnt);
+
 /*
  * mark_as_failed_forward- mark a node as failed and add it to "ret_list"
  *
@@ -60,6 +60,15 @@
 
 #include <stdarg.h>
 #include <errno.h>
+#include <time.h>
+
+#if HAVE_INTTYPES_H
+#  include <inttypes.h>
+#else
+#  if HAVE_STDINT_H
+#    include <stdint.h>
+#  endif
+#endif
 
 #ifdef WITH_PTHREADS
 #  include <pthread.h>
@@ -90,6 +99,9 @@
 #  define LINEBUFSIZE 256
 #endif
 
+#define LOG_RING_SIZE	4096	/* log queue entries, must be power of 2 */
+#define LOG_RING_BATCH	256	/* entries written per log_lock hold */
+
 /*
 ** Define slurm-specific aliases for use by plugins, see slurm_xlator.h
 ** for details.
@@ -141,6 +153,44 @@ typedef struct {
 static log_t            *log = NULL;
 static log_t            *sched_log = NULL;
 
+/*
+ * Copies of the log options, read without log_lock by log_msg() to discard
+ * or queue messages without serializing on log_lock. They are only changed
+ * with log_lock held, when the logs are (re)configured.
+ */
+static volatile log_level_t log_level_max  = LOG_LEVEL_INFO;
+static volatile log_level_t log_sync_level = LOG_LEVEL_INFO;
+static volatile bool        log_prefix = true;
+static volatile bool        sched_log_enabled = false;
+
+/*
+ * Log queue: a bounded ring of messages for the logfile and scheduler
+ * logfile. Any thread adds entries without locks, a single writer thread
+ * removes them and writes them in batches while holding log_lock.
+ * Each entry's seq is equal to its position when free, and to its
+ * position + 1 once filled (see _log_ring_put).
+ */
+typedef struct {
+	volatile uint32_t seq;
+	bool   sched;		/* write to sched_log rather than log */
+	time_t time;		/* time message was logged */
+	char  *pfx;		/* static level prefix string */
+	char  *msg;		/* xmalloc'ed message, freed by writer */
+} log_ring_ent_t;
+
+static log_ring_ent_t    *log_ring = NULL;
+static volatile uint32_t  log_ring_head = 0;
+static volatile uint32_t  log_ring_tail = 0;
+static volatile uint32_t  log_ring_dropped = 0;
+static volatile bool      log_queue_active = false;
+static uint16_t           log_queue_mode = LOG_QUEUE_NONE;
+static pthread_mutex_t    log_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t     log_ring_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t          log_writer_tid;
+static volatile bool      log_writer_running = false;
+static volatile bool      log_writer_idle = false;
+static volatile bool      log_writer_shutdown = false;
+
 #define LOG_INITIALIZED ((log != NULL) && (log->initialized))
 #define SCHED_LOG_INITIALIZED ((sched_log != NULL) && (sched_log->initialized))
 /* define a default argv0 */
@@ -156,11 +206,23 @@ extern char * program_invocation_name;
 
 /*
  * pthread_atfork handlers:
+ * The child has no writer thread, it drops its copy of the log queue
+ * (the parent's writer still writes the messages queued before the fork)
+ * and logs synchronously until the queue is restarted.
  */
 #ifdef WITH_PTHREADS
 static void _atfork_prep()   { slurm_mutex_lock(&log_lock);   }
 static void _atfork_parent() { slurm_mutex_unlock(&log_lock); }
-static void _atfork_child()  { slurm_mutex_unlock(&log_lock); }
+static void _atfork_child()
+{
+	log_queue_active   = false;
+	log_writer_running = false;
+	log_writer_idle    = false;
+	xfree(log_ring);
+	pthread_mutex_init(&log_ring_lock, NULL);
+	pthread_cond_init(&log_ring_cond, NULL);
+	slurm_mutex_unlock(&log_lock);
+}
 static bool at_forked = false;
 #  define atfork_install_handlers()                                           \
           while (!at_forked) {                                                \
@@ -171,6 +233,9 @@ static bool at_forked = false;
 #  define atfork_install_handlers() (NULL)
 #endif
 static void _log_flush(log_t *log);
+static void _log_queue_drain(void);
+static void _log_queue_start(void);
+static void _log_queue_stop(void);
 
 /* check to see if a file is writeable,
  * RET 1 if file can be written now,
@@ -270,6 +335,10 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 	if (log->opt.syslog_level > LOG_LEVEL_QUIET)
 		log->facility = fac;
 
+	log_sync_level = MAX(opt.stderr_level, opt.syslog_level);
+	log_level_max  = MAX(log_sync_level, opt.logfile_level);
+	log_prefix     = opt.prefix_level;
+
 	if (logfile && (log->opt.logfile_level > LOG_LEVEL_QUIET)) {
 		FILE *fp;
 
@@ -300,6 +369,12 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 			fd_set_close_on_exec(fd);
 	}
 
+	log_queue_mode = opt.queue;
+	if (log->logfp && (log_queue_mode != LOG_QUEUE_NONE))
+		_log_queue_start();
+	else
+		log_queue_active = false;
+
 	log->initialized = 1;
  out:
 	return rc;
@@ -379,6 +454,7 @@ _sched_log_init(char *prog, log_options_t opt, log_facility_t fac,
 	}
 
 	sched_log->initialized = 1;
+	sched_log_enabled = (sched_log->opt.logfile_level > LOG_LEVEL_QUIET);
  out:
 	return rc;
 }
@@ -414,6 +490,7 @@ void log_fini()
 	if (!log)
 		return;
 
+	_log_queue_stop();
 	slurm_mutex_lock(&log_lock);
 	_log_flush(log);
 	xfree(log->argv0);
@@ -433,7 +510,9 @@ void sched_log_fini(void)
 	if (!sched_log)
 		return;
 
+	_log_queue_drain();
 	slurm_mutex_lock(&log_lock);
+	sched_log_enabled = false;
 	_log_flush(sched_log);
 	xfree(sched_log->argv0);
 	xfree(sched_log->fpfx);
@@ -756,6 +835,250 @@ _log_printf(log_t *log, cbuf_t cb, FILE *stream, const char *fmt, ...)
 
 }
 
+/* Return the prefix for messages at the given level and set the syslog
+ * priority for them */
+static char *_log_level_pfx(log_level_t level, int *priority)
+{
+	switch (level) {
+	case LOG_LEVEL_FATAL:
+		*priority = LOG_CRIT;
+		return "fatal: ";
+	case LOG_LEVEL_ERROR:
+		*priority = LOG_ERR;
+		return "error: ";
+	case LOG_LEVEL_SCHED:
+	case LOG_LEVEL_INFO:
+	case LOG_LEVEL_VERBOSE:
+		*priority = LOG_INFO;
+		return "";
+	case LOG_LEVEL_DEBUG:
+		*priority = LOG_DEBUG;
+		return "debug:  ";
+	case LOG_LEVEL_DEBUG2:
+		*priority = LOG_DEBUG;
+		return "debug2: ";
+	case LOG_LEVEL_DEBUG3:
+		*priority = LOG_DEBUG;
+		return "debug3: ";
+	case LOG_LEVEL_DEBUG4:
+		*priority = LOG_DEBUG;
+		return "debug4: ";
+	case LOG_LEVEL_DEBUG5:
+		*priority = LOG_DEBUG;
+		return "debug5: ";
+	default:
+		*priority = LOG_ERR;
+		return "internal error: ";
+	}
+}
+
+/* Add a message to the log queue, RET false if the queue is full */
+static bool _log_ring_put(bool sched, char *pfx, char *msg)
+{
+	log_ring_ent_t *ent;
+	uint32_t pos = log_ring_head;
+	int32_t diff;
+
+	while (1) {
+		ent = &log_ring[pos & (LOG_RING_SIZE - 1)];
+		diff = (int32_t) (ent->seq - pos);
+		if (diff == 0) {
+			if (__sync_bool_compare_and_swap(&log_ring_head,
+							 pos, pos + 1))
+				break;
+		} else if (diff < 0)
+			return false;
+		pos = log_ring_head;
+	}
+	ent->sched = sched;
+	ent->time  = time(NULL);
+	ent->pfx   = pfx;
+	ent->msg   = msg;
+	__sync_synchronize();
+	ent->seq   = pos + 1;
+	return true;
+}
+
+/* Remove the oldest message from the log queue, writer thread only.
+ * RET false if the queue is empty */
+static bool _log_ring_get(log_ring_ent_t *out)
+{
+	log_ring_ent_t *ent;
+	uint32_t pos = log_ring_tail;
+
+	ent = &log_ring[pos & (LOG_RING_SIZE - 1)];
+	if (ent->seq != (pos + 1))
+		return false;
+	__sync_synchronize();
+	out->sched = ent->sched;
+	out->time  = ent->time;
+	out->pfx   = ent->pfx;
+	out->msg   = ent->msg;
+	__sync_synchronize();
+	ent->seq = pos + LOG_RING_SIZE;
+	log_ring_tail = pos + 1;
+	return true;
+}
+
+static bool _log_ring_empty(void)
+{
+	uint32_t pos = log_ring_tail;
+
+	return (log_ring[pos & (LOG_RING_SIZE - 1)].seq != (pos + 1));
+}
+
+static void _log_writer_wake(void)
+{
+	slurm_mutex_lock(&log_ring_lock);
+	pthread_cond_signal(&log_ring_cond);
+	slurm_mutex_unlock(&log_ring_lock);
+}
+
+/* Hand a message off to the writer thread. The message is freed by the
+ * writer, or here if it is discarded. */
+static void _log_queue_put(bool sched, char *pfx, char *msg)
+{
+	while (!_log_ring_put(sched, pfx, msg)) {
+		if (log_queue_mode == LOG_QUEUE_DROP) {
+			__sync_fetch_and_add(&log_ring_dropped, 1);
+			xfree(msg);
+			return;
+		}
+		_log_writer_wake();
+		usleep(1000);
+	}
+	__sync_synchronize();
+	if (log_writer_idle)
+		_log_writer_wake();
+}
+
+/* Format a log file time stamp, like "%M" in vxstrfmt() */
+static void _log_time_str(time_t t, char *buf, int buf_size)
+{
+	struct tm time_tm;
+
+	localtime_r(&t, &time_tm);
+#ifdef USE_ISO_8601
+	strftime(buf, buf_size, "%Y-%m-%dT%T", &time_tm);
+#else
+	strftime(buf, buf_size, "%b %d %T", &time_tm);
+#endif
+}
+
+static void *_log_writer(void *arg)
+{
+	log_ring_ent_t ent;
+	log_t *lp;
+	char time_str[32];
+	struct timespec ts;
+	uint32_t dropped;
+	int cnt;
+
+	while (1) {
+		slurm_mutex_lock(&log_lock);
+		for (cnt = 0; cnt < LOG_RING_BATCH; cnt++) {
+			if (!_log_ring_get(&ent))
+				break;
+			lp = ent.sched ? sched_log : log;
+			if (lp && lp->logfp) {
+				_log_time_str(ent.time, time_str,
+					      sizeof(time_str));
+				fprintf(lp->logfp, "[%s] %s%s%s\n", time_str,
+					lp->fpfx, ent.pfx, ent.msg);
+			}
+			xfree(ent.msg);
+		}
+		dropped = __sync_fetch_and_and(&log_ring_dropped, 0);
+		if (dropped && log && log->logfp) {
+			_log_time_str(time(NULL), time_str, sizeof(time_str));
+			fprintf(log->logfp, "[%s] %serror: log queue full, "
+				"%u messages discarded\n",
+				time_str, log->fpfx, dropped);
+		}
+		if (cnt || dropped) {
+			if (log && log->logfp)
+				fflush(log->logfp);
+			if (sched_log && sched_log->logfp)
+				fflush(sched_log->logfp);
+		}
+		slurm_mutex_unlock(&log_lock);
+		if (cnt == LOG_RING_BATCH)
+			continue;
+
+		slurm_mutex_lock(&log_ring_lock);
+		log_writer_idle = true;
+		__sync_synchronize();
+		if (_log_ring_empty() && !log_writer_shutdown) {
+			ts.tv_sec  = time(NULL) + 1;
+			ts.tv_nsec = 0;
+			pthread_cond_timedwait(&log_ring_cond, &log_ring_lock,
+					       &ts);
+		}
+		log_writer_idle = false;
+		slurm_mutex_unlock(&log_ring_lock);
+		if (log_writer_shutdown && _log_ring_empty())
+			break;
+	}
+	return NULL;
+}
+
+/* Start the log queue's writer thread, log_lock must be held.
+ * Errors can not be logged here, so are reported to stderr. */
+static void _log_queue_start(void)
+{
+	pthread_attr_t attr;
+	int i;
+
+	if (log_writer_running) {
+		log_queue_active = true;
+		return;
+	}
+	if (!log_ring) {
+		log_ring = xmalloc(sizeof(log_ring_ent_t) * LOG_RING_SIZE);
+		for (i = 0; i < LOG_RING_SIZE; i++)
+			log_ring[i].seq = i;
+		log_ring_head = 0;
+		log_ring_tail = 0;
+	}
+	log_writer_shutdown = false;
+	pthread_attr_init(&attr);
+	if (pthread_create(&log_writer_tid, &attr, _log_writer, NULL)) {
+		fprintf(stderr, "log: unable to start log writer thread, "
+			"logging synchronously\n");
+		log_queue_active = false;
+	} else {
+		log_writer_running = true;
+		log_queue_active = true;
+	}
+	pthread_attr_destroy(&attr);
+}
+
+/* Write out the log queue and terminate the writer thread */
+static void _log_queue_stop(void)
+{
+	if (!log_writer_running)
+		return;
+
+	log_queue_active = false;
+	log_writer_shutdown = true;
+	_log_writer_wake();
+	pthread_join(log_writer_tid, NULL);
+	log_writer_running = false;
+}
+
+/* Wait (up to 5 seconds) for the writer thread to empty the log queue */
+static void _log_queue_drain(void)
+{
+	int i;
+
+	if (!log_writer_running)
+		return;
+	for (i = 0; (i < 5000) && !_log_ring_empty(); i++) {
+		_log_writer_wake();
+		usleep(1000);
+	}
+}
+
 /*
  * log a message at the specified level to facilities that have been
  * configured to receive messages at that level
@@ -765,7 +1088,28 @@ static void log_msg(log_level_t level, const char *fmt, va_list args)
 	char *pfx = "";
 	char *buf = NULL;
 	char *msgbuf = NULL;
+	char *sched_buf = NULL, *file_buf = NULL;
 	int priority = LOG_INFO;
+	bool sched_msg;
+
+	/* Discard and format messages before taking log_lock */
+	sched_msg = sched_log_enabled && (strncmp(fmt, "sched: ", 7) == 0);
+	if ((level > log_level_max) && !sched_msg)
+		return;
+	buf = vxstrfmt(fmt, args);
+
+	/* Messages only for the log files go straight to the log queue */
+	if (log_queue_active && (level > log_sync_level)) {
+		if (sched_msg)
+			_log_queue_put(true, "", xstrdup(buf));
+		if (level <= log_level_max) {
+			if (log_prefix)
+				pfx = _log_level_pfx(level, &priority);
+			_log_queue_put(false, pfx, buf);
+		} else
+			xfree(buf);
+		return;
+	}
 
 	slurm_mutex_lock(&log_lock);
 	if (!LOG_INITIALIZED) {
@@ -773,94 +1117,44 @@ static void log_msg(log_level_t level, const char *fmt, va_list args)
 		_log_init(NULL, opts, 0, NULL);
 	}
 
-	if (SCHED_LOG_INITIALIZED &&
-	    (sched_log->opt.logfile_level > LOG_LEVEL_QUIET) &&
-	    (strncmp(fmt, "sched: ", 7) == 0)) {
-		buf = vxstrfmt(fmt, args);
-		xlogfmtcat(&msgbuf, "[%M] %s%s%s", sched_log->fpfx, pfx, buf);
-		_log_printf(sched_log, sched_log->fbuf, sched_log->logfp, 
-			    "%s\n", msgbuf);
-		fflush(sched_log->logfp);
-		xfree(msgbuf);
+	if (sched_msg && SCHED_LOG_INITIALIZED) {
+		if (log_queue_active)
+			sched_buf = xstrdup(buf);
+		else {
+			xlogfmtcat(&msgbuf, "[%M] %s%s%s", sched_log->fpfx,
+				   pfx, buf);
+			_log_printf(sched_log, sched_log->fbuf,
+				    sched_log->logfp, "%s\n", msgbuf);
+			fflush(sched_log->logfp);
+			xfree(msgbuf);
+		}
 	}
 	if ((level > log->opt.syslog_level)  &&
 	    (level > log->opt.logfile_level) &&
-	    (level > log->opt.stderr_level)) {
-		slurm_mutex_unlock(&log_lock);
-		xfree(buf);
-		return;
-	}
-
-	if (log->opt.prefix_level || (log->opt.syslog_level > level)) {
-		switch (level) {
-		case LOG_LEVEL_FATAL:
-			priority = LOG_CRIT;
-			pfx = "fatal: ";
-			break;
-
-		case LOG_LEVEL_ERROR:
-			priority = LOG_ERR;
-			pfx = "error: ";
-			break;
-
-		case LOG_LEVEL_SCHED:
-		case LOG_LEVEL_INFO:
-		case LOG_LEVEL_VERBOSE:
-			priority = LOG_INFO;
-			break;
-
-		case LOG_LEVEL_DEBUG:
-			priority = LOG_DEBUG;
-			pfx = "debug:  ";
-			break;
-
-		case LOG_LEVEL_DEBUG2:
-			priority = LOG_DEBUG;
-			pfx = "debug2: ";
-			break;
-
-		case LOG_LEVEL_DEBUG3:
-			priority = LOG_DEBUG;
-			pfx = "debug3: ";
-			break;
+	    (level > log->opt.stderr_level))
+		goto fini;
 
-		case LOG_LEVEL_DEBUG4:
-			priority = LOG_DEBUG;
-			pfx = "debug4: ";
-			break;
-
-		case LOG_LEVEL_DEBUG5:
-			priority = LOG_DEBUG;
-			pfx = "debug5: ";
-			break;
-
-		default:
-			priority = LOG_ERR;
-			pfx = "internal error: ";
-			break;
-		}
-
-	}
-
-	if (!buf) {
-		/* format the basic message,
-		 * if not already done for scheduling log */
-		buf = vxstrfmt(fmt, args);
-	}
+	if (log->opt.prefix_level || (log->opt.syslog_level > level))
+		pfx = _log_level_pfx(level, &priority);
 
 	if (level <= log->opt.stderr_level) {
 		fflush(stdout);
-		_log_printf(log, log->buf, stderr, "%s: %s%s\n", 
+		_log_printf(log, log->buf, stderr, "%s: %s%s\n",
 			    log->argv0, pfx, buf);
 		fflush(stderr);
 	}
 
 	if ((level <= log->opt.logfile_level) && (log->logfp != NULL)) {
-		xlogfmtcat(&msgbuf, "[%M] %s%s%s", log->fpfx, pfx, buf);
-		_log_printf(log, log->fbuf, log->logfp, "%s\n", msgbuf);
-		fflush(log->logfp);
-
-		xfree(msgbuf);
+		if (log_queue_active)
+			file_buf = xstrdup(buf);
+		else {
+			xlogfmtcat(&msgbuf, "[%M] %s%s%s", log->fpfx, pfx,
+				   buf);
+			_log_printf(log, log->fbuf, log->logfp, "%s\n",
+				    msgbuf);
+			fflush(log->logfp);
+			xfree(msgbuf);
+		}
 	}
 
 	if (level <=  log->opt.syslog_level) {
@@ -873,8 +1167,13 @@ static void log_msg(log_level_t level, const char *fmt, va_list args)
 		xfree(msgbuf);
 	}
 
-	slurm_mutex_unlock(&log_lock);
+fini:	slurm_mutex_unlock(&log_lock);
 
+	/* Queue only after releasing log_lock, which the writer needs */
+	if (sched_buf)
+		_log_queue_put(true, "", sched_buf);
+	if (file_buf)
+		_log_queue_put(false, pfx, file_buf);
 	xfree(buf);
 }
 
@@ -904,6 +1203,7 @@ _log_flush(log_t *log)
 void
 log_flush()
 {
+	_log_queue_drain();
 	slurm_mutex_lock(&log_lock);
 	_log_flush(log);
 	slurm_mutex_unlock(&log_lock);
@@ -98,6 +98,14 @@ typedef enum {
 }	log_level_t;
 
 
+/*
+ * log queue modes: logfile (and scheduler logfile) messages may be handed
+ * to a writer thread rather than written by the thread which logs them
+ */
+#define LOG_QUEUE_NONE	0	/* write from the logging thread          */
+#define LOG_QUEUE_BLOCK	1	/* queue, wait for space if queue full    */
+#define LOG_QUEUE_DROP	2	/* queue, discard message if queue full   */
+
 /*
  * log options: Each of stderr, syslog, and logfile can have a different level
  */
@@ -107,6 +115,8 @@ typedef struct {
 	log_level_t logfile_level;  /* max level to log to logfile        */
 	unsigned    prefix_level:1; /* prefix level (e.g. "debug: ") if 1 */
 	unsigned    buffered:1;     /* Use internal buffer to never block */
+	unsigned    queue:2;        /* LOG_QUEUE_* for logfile, set only  *
+				     * for the main log, not sched log    */
 } 	log_options_t;
 
 /* some useful initializers for log_options_t
@@ -228,7 +238,7 @@ bool log_has_data(void);
 
 /*
  * log_flush() attempts to flush all data in the internal
- * log buffer to the appropriate output stream.
+ * log buffer and log queue to the appropriate output stream.
  */
 void log_flush(void);
 
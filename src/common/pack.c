@@ -49,6 +49,8 @@
 #include <string.h>
 #include <time.h>
 #include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "slurm/slurm_errno.h"
 
@@ -68,6 +70,8 @@
  * for details.
  */
 strong_alias(create_buf,	slurm_create_buf);
+strong_alias(create_mmap_buf,	slurm_create_mmap_buf);
+strong_alias(buf_intern_strings, slurm_buf_intern_strings);
 strong_alias(free_buf,		slurm_free_buf);
 strong_alias(grow_buf,		slurm_grow_buf);
 strong_alias(init_buf,		slurm_init_buf);
@@ -98,6 +102,21 @@ strong_alias(unpackstr_array,	slurm_unpackstr_array);
 strong_alias(packmem_array,	slurm_packmem_array);
 strong_alias(unpackmem_array,	slurm_unpackmem_array);
 
+#define PACK_INTERN_MAX	256		/* longest data packed as a reference */
+#define PACK_INTERN_REF	0x80000000	/* size flag of a reference, the rest
+					 * is the offset of the first copy */
+
+/* Data packed so far, by the offset of its size in the buffer plus one,
+ * hashed on its contents. Only used when packing. */
+struct pack_intern {
+	uint32_t *offset;
+	uint32_t size;		/* slots in offset, a power of 2 */
+	uint32_t cnt;		/* slots in use */
+};
+
+static int _unpackmem_data(char **data, uint32_t *size_valp,
+			   uint32_t max_len, Buf buffer);
+
 /* Basic buffer management routines */
 /* create_buf - create a buffer with the supplied contents, contents must
  * be xalloc'ed */
@@ -120,11 +139,133 @@ Buf create_buf(char *data, int size)
 	return my_buf;
 }
 
+/*
+ * create_mmap_buf - create a read only buffer with the contents of an
+ *	open file, mapped into memory rather than read in piece by piece.
+ *	fd may be closed once this returns.  Used for loading state files.
+ * RET the buffer or NULL on error with errno set
+ */
+Buf create_mmap_buf(int fd)
+{
+	struct stat f_stat;
+	void *data;
+	Buf my_buf;
+
+	if (fstat(fd, &f_stat) < 0)
+		return NULL;
+	if (f_stat.st_size > MAX_BUF_SIZE) {
+		error("create_mmap_buf: buffer size too large (%"PRIu64" > %u)",
+		      (uint64_t) f_stat.st_size, MAX_BUF_SIZE);
+		errno = EFBIG;
+		return NULL;
+	}
+	if (f_stat.st_size == 0)
+		return create_buf(NULL, 0);
+
+	data = mmap(NULL, f_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		return NULL;
+
+	my_buf = create_buf(data, f_stat.st_size);
+	my_buf->mmaped = true;
+
+	return my_buf;
+}
+
+/*
+ * buf_intern_strings - from the buffer's current offset on, pack memory
+ *	(strings) of up to PACK_INTERN_MAX bytes that was already packed as a
+ *	reference to its first copy, and accept such references when
+ *	unpacking.  The packing and unpacking sides must both call this at
+ *	the same point of the data.  Used for state files, which repeat the
+ *	same user, partition and node names many times.
+ */
+void buf_intern_strings(Buf my_buf)
+{
+	assert(my_buf->magic == BUF_MAGIC);
+	if (my_buf->intern == NULL)
+		my_buf->intern = xmalloc(sizeof(struct pack_intern));
+}
+
+static uint32_t _intern_hash(char *valp, uint32_t size_val)
+{
+	uint32_t hash = 2166136261U, i;
+
+	for (i = 0; i < size_val; i++)
+		hash = (hash ^ (unsigned char) valp[i]) * 16777619;
+	return hash;
+}
+
+/* Double the size of a buffer's hash of packed data */
+static void _intern_grow(Buf buffer)
+{
+	struct pack_intern *intern = buffer->intern;
+	uint32_t *old_offset = intern->offset, old_size = intern->size;
+	uint32_t i, j, ns, off;
+
+	intern->size = old_size ? (old_size * 2) : 1024;
+	intern->offset = xmalloc(sizeof(uint32_t) * intern->size);
+	for (i = 0; i < old_size; i++) {
+		if (((off = old_offset[i]) == 0) ||
+		    ((off - 1 + sizeof(ns)) > buffer->processed))
+			continue;
+		memcpy(&ns, &buffer->head[off - 1], sizeof(ns));
+		j = _intern_hash(&buffer->head[off - 1 + sizeof(ns)],
+				 ntohl(ns)) & (intern->size - 1);
+		while (intern->offset[j])
+			j = (j + 1) & (intern->size - 1);
+		intern->offset[j] = off;
+	}
+	xfree(old_offset);
+}
+
+/*
+ * Return the offset of an earlier copy of the given data in the buffer, or
+ * note that it is about to be packed at the buffer's current offset and
+ * return PACK_INTERN_REF
+ */
+static uint32_t _intern_find(char *valp, uint32_t size_val, Buf buffer)
+{
+	struct pack_intern *intern = buffer->intern;
+	uint32_t i, ns, off;
+
+	if ((intern->cnt * 2) >= intern->size)
+		_intern_grow(buffer);
+
+	i = _intern_hash(valp, size_val) & (intern->size - 1);
+	for ( ; intern->offset[i]; i = (i + 1) & (intern->size - 1)) {
+		off = intern->offset[i] - 1;
+		if ((off + sizeof(ns) + size_val) > buffer->processed)
+			continue;
+		memcpy(&ns, &buffer->head[off], sizeof(ns));
+		if ((ntohl(ns) == size_val) &&
+		    !memcmp(&buffer->head[off + sizeof(ns)], valp, size_val))
+			return off;
+	}
+	if (buffer->processed < PACK_INTERN_REF) {
+		intern->offset[i] = buffer->processed + 1;
+		intern->cnt++;
+	}
+	return PACK_INTERN_REF;
+}
+
+static void _intern_free(Buf my_buf)
+{
+	if (my_buf->intern) {
+		xfree(my_buf->intern->offset);
+		xfree(my_buf->intern);
+	}
+}
+
 /* free_buf - release memory associated with a given buffer */
 void free_buf(Buf my_buf)
 {
 	assert(my_buf->magic == BUF_MAGIC);
-	xfree(my_buf->head);
+	_intern_free(my_buf);
+	if (my_buf->mmaped)
+		munmap(my_buf->head, my_buf->size);
+	else
+		xfree(my_buf->head);
 	xfree(my_buf);
 }
 
@@ -166,7 +307,14 @@ void *xfer_buf_data(Buf my_buf)
 	void *data_ptr;
 
 	assert(my_buf->magic == BUF_MAGIC);
-	data_ptr = (void *) my_buf->head;
+	_intern_free(my_buf);
+	if (my_buf->mmaped) {
+		/* the caller will xfree this */
+		data_ptr = xmalloc(my_buf->size);
+		memcpy(data_ptr, my_buf->head, my_buf->size);
+		munmap(my_buf->head, my_buf->size);
+	} else
+		data_ptr = (void *) my_buf->head;
 	xfree(my_buf);
 	return data_ptr;
 }
@@ -471,7 +619,13 @@ int unpack8(uint8_t * valp, Buf buffer)
  */
 void packmem(char *valp, uint32_t size_val, Buf buffer)
 {
-	uint32_t ns = htonl(size_val);
+	uint32_t ns = htonl(size_val), off;
+
+	if (buffer->intern && size_val && (size_val <= PACK_INTERN_MAX) &&
+	    ((off = _intern_find(valp, size_val, buffer)) != PACK_INTERN_REF)) {
+		pack32(PACK_INTERN_REF | off, buffer);
+		return;
+	}
 
 	if (remaining_buf(buffer) < (sizeof(ns) + size_val)) {
 		if (buffer->size > (MAX_BUF_SIZE -  size_val - BUF_SIZE)) {
@@ -493,16 +647,16 @@ void packmem(char *valp, uint32_t size_val, Buf buffer)
 
 
 /*
- * Given a buffer containing a network byte order 16-bit integer,
- * and an arbitrary data string, return a pointer to the
- * data string in 'valp'.  Also return the sizes of 'valp' in bytes.
- * Adjust buffer counters.
- * NOTE: valp is set to point into the buffer bufp, a copy of
- *	the data is not made
+ * Unpack the size and data packed by packmem(), following a reference made
+ * under buf_intern_strings() to the first copy of the data.
+ * OUT data - set to point into the buffer, NULL for zero size
+ * OUT size_valp - size of the data
+ * IN max_len - largest size accepted
  */
-int unpackmem_ptr(char **valp, uint32_t * size_valp, Buf buffer)
+static int _unpackmem_data(char **data, uint32_t *size_valp,
+			   uint32_t max_len, Buf buffer)
 {
-	uint32_t ns;
+	uint32_t ns, ref, ref_end;
 
 	if (remaining_buf(buffer) < sizeof(ns))
 		return SLURM_ERROR;
@@ -511,18 +665,47 @@ int unpackmem_ptr(char **valp, uint32_t * size_valp, Buf buffer)
 	*size_valp = ntohl(ns);
 	buffer->processed += sizeof(ns);
 
-	if (*size_valp > MAX_PACK_MEM_LEN)
+	if (buffer->intern && (*size_valp & PACK_INTERN_REF)) {
+		/* the first copy must come before the reference */
+		ref = *size_valp & ~PACK_INTERN_REF;
+		ref_end = buffer->processed - sizeof(ns);
+		if ((ref + sizeof(ns)) > ref_end)
+			return SLURM_ERROR;
+		memcpy(&ns, &buffer->head[ref], sizeof(ns));
+		*size_valp = ntohl(ns);
+		if ((*size_valp == 0) || (*size_valp > PACK_INTERN_MAX) ||
+		    (*size_valp > max_len) ||
+		    ((ref + sizeof(ns) + *size_valp) > ref_end))
+			return SLURM_ERROR;
+		*data = &buffer->head[ref + sizeof(ns)];
+		return SLURM_SUCCESS;
+	}
+
+	if (*size_valp > max_len)
 		return SLURM_ERROR;
 	else if (*size_valp > 0) {
 		if (remaining_buf(buffer) < *size_valp)
 			return SLURM_ERROR;
-		*valp = &buffer->head[buffer->processed];
+		*data = &buffer->head[buffer->processed];
 		buffer->processed += *size_valp;
 	} else
-		*valp = NULL;
+		*data = NULL;
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Given a buffer containing a network byte order 16-bit integer,
+ * and an arbitrary data string, return a pointer to the
+ * data string in 'valp'.  Also return the sizes of 'valp' in bytes.
+ * Adjust buffer counters.
+ * NOTE: valp is set to point into the buffer bufp, a copy of
+ *	the data is not made
+ */
+int unpackmem_ptr(char **valp, uint32_t * size_valp, Buf buffer)
+{
+	return _unpackmem_data(valp, size_valp, MAX_PACK_MEM_LEN, buffer);
+}
+
 
 /*
  * Given a buffer containing a network byte order 16-bit integer,
@@ -534,23 +717,13 @@ int unpackmem_ptr(char **valp, uint32_t * size_valp, Buf buffer)
  */
 int unpackmem(char *valp, uint32_t * size_valp, Buf buffer)
 {
-	uint32_t ns;
-
-	if (remaining_buf(buffer) < sizeof(ns))
-		return SLURM_ERROR;
+	char *data;
 
-	memcpy(&ns, &buffer->head[buffer->processed], sizeof(ns));
-	*size_valp = ntohl(ns);
-	buffer->processed += sizeof(ns);
-
-	if (*size_valp > MAX_PACK_MEM_LEN)
+	if (_unpackmem_data(&data, size_valp, MAX_PACK_MEM_LEN, buffer))
 		return SLURM_ERROR;
-	else if (*size_valp > 0) {
-		if (remaining_buf(buffer) < *size_valp)
-			return SLURM_ERROR;
-		memcpy(valp, &buffer->head[buffer->processed], *size_valp);
-		buffer->processed += *size_valp;
-	} else
+	if (*size_valp > 0)
+		memcpy(valp, data, *size_valp);
+	else
 		*valp = 0;
 	return SLURM_SUCCESS;
 }
@@ -566,24 +739,13 @@ int unpackmem(char *valp, uint32_t * size_valp, Buf buffer)
  */
 int unpackmem_xmalloc(char **valp, uint32_t * size_valp, Buf buffer)
 {
-	uint32_t ns;
-
-	if (remaining_buf(buffer) < sizeof(ns))
-		return SLURM_ERROR;
+	char *data;
 
-	memcpy(&ns, &buffer->head[buffer->processed], sizeof(ns));
-	*size_valp = ntohl(ns);
-	buffer->processed += sizeof(ns);
-
-	if (*size_valp > MAX_PACK_STR_LEN)
+	if (_unpackmem_data(&data, size_valp, MAX_PACK_STR_LEN, buffer))
 		return SLURM_ERROR;
-	else if (*size_valp > 0) {
-		if (remaining_buf(buffer) < *size_valp)
-			return SLURM_ERROR;
+	if (*size_valp > 0) {
 		*valp = xmalloc(*size_valp);
-		memcpy(*valp, &buffer->head[buffer->processed],
-		       *size_valp);
-		buffer->processed += *size_valp;
+		memcpy(*valp, data, *size_valp);
 	} else
 		*valp = NULL;
 	return SLURM_SUCCESS;
@@ -600,23 +762,13 @@ int unpackmem_xmalloc(char **valp, uint32_t * size_valp, Buf buffer)
  */
 int unpackmem_malloc(char **valp, uint32_t * size_valp, Buf buffer)
 {
-	uint32_t ns;
+	char *data;
 
-	if (remaining_buf(buffer) < sizeof(ns))
+	if (_unpackmem_data(&data, size_valp, MAX_PACK_STR_LEN, buffer))
 		return SLURM_ERROR;
-
-	memcpy(&ns, &buffer->head[buffer->processed], sizeof(ns));
-	*size_valp = ntohl(ns);
-	buffer->processed += sizeof(ns);
-	if (*size_valp > MAX_PACK_STR_LEN)
-		return SLURM_ERROR;
-	else if (*size_valp > 0) {
-		if (remaining_buf(buffer) < *size_valp)
-			return SLURM_ERROR;
+	if (*size_valp > 0) {
 		*valp = malloc(*size_valp);
-		memcpy(*valp, &buffer->head[buffer->processed],
-		       *size_valp);
-		buffer->processed += *size_valp;
+		memcpy(*valp, data, *size_valp);
 	} else
 		*valp = NULL;
 	return SLURM_SUCCESS;
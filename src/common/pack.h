@@ -58,6 +58,8 @@
 #include <time.h>
 #include <string.h>
 
+#include "src/common/macros.h"
+
 #define BUF_MAGIC 0x42554545
 #define BUF_SIZE (16 * 1024)
 #define MAX_BUF_SIZE ((uint32_t) 0xffff0000)	/* avoid going over 32-bits */
@@ -68,6 +70,8 @@ struct slurm_buf {
 	char *head;
 	uint32_t size;
 	uint32_t processed;
+	bool mmaped;		/* head is mmap()ed, see create_mmap_buf() */
+	struct pack_intern *intern; /* see buf_intern_strings() */
 };
 
 typedef struct slurm_buf * Buf;
@@ -79,6 +83,8 @@ typedef struct slurm_buf * Buf;
 #define size_buf(__buf)			(__buf->size)
 
 Buf	create_buf (char *data, int size);
+Buf	create_mmap_buf(int fd);
+void	buf_intern_strings(Buf my_buf);
 void	free_buf(Buf my_buf);
 Buf	init_buf(int size);
 void    grow_buf (Buf my_buf, int size);
@@ -256,6 +256,7 @@ s_p_options_t slurm_conf_options[] = {
 	{"SlurmdUser", S_P_STRING},
 	{"SlurmctldDebug", S_P_UINT16},
 	{"SlurmctldLogFile", S_P_STRING},
+	{"SlurmctldLogQueue", S_P_STRING},
 	{"SlurmctldPidFile", S_P_STRING},
 	{"SlurmctldPort", S_P_STRING},
 	{"SlurmctldTimeout", S_P_UINT16},
@@ -1944,6 +1945,7 @@ init_slurm_conf (slurm_ctl_conf_t *ctl_conf_ptr)
 	xfree (ctl_conf_ptr->slurmd_user_name);
 	ctl_conf_ptr->slurmctld_debug		= (uint16_t) NO_VAL;
 	xfree (ctl_conf_ptr->slurmctld_logfile);
+	ctl_conf_ptr->slurmctld_log_queue	= (uint16_t) NO_VAL;
 	xfree (ctl_conf_ptr->sched_logfile);
 	ctl_conf_ptr->sched_log_level		= (uint16_t) NO_VAL;
 	xfree (ctl_conf_ptr->slurmctld_pidfile);
@@ -2958,6 +2960,19 @@ _validate_and_set_defaults(slurm_ctl_conf_t *conf, s_p_hashtbl_t *hashtbl)
 
 	s_p_get_string(&conf->slurmctld_logfile, "SlurmctldLogFile", hashtbl);
 
+	if (s_p_get_string(&temp_str, "SlurmctldLogQueue", hashtbl)) {
+		if (strcasecmp(temp_str, "none") == 0)
+			conf->slurmctld_log_queue = LOG_QUEUE_NONE;
+		else if (strcasecmp(temp_str, "block") == 0)
+			conf->slurmctld_log_queue = LOG_QUEUE_BLOCK;
+		else if (strcasecmp(temp_str, "drop") == 0)
+			conf->slurmctld_log_queue = LOG_QUEUE_DROP;
+		else
+			fatal("SlurmctldLogQueue=%s invalid", temp_str);
+		xfree(temp_str);
+	} else
+		conf->slurmctld_log_queue = LOG_QUEUE_NONE;
+
 	if (s_p_get_string(&temp_str, "SlurmctldPort", hashtbl)) {
 		char *end_ptr = NULL;
 		long port_long;
@@ -176,6 +176,10 @@ typedef struct slurm_acct_storage_ops {
 				    struct step_record *step_ptr);
 	int  (*step_complete)      (void *db_conn,
 				    struct step_record *step_ptr);
+	int  (*step_start_mult)    (void *db_conn, List step_list);
+	int  (*step_complete_mult) (void *db_conn, List step_list);
+	int  (*job_start_mult)     (void *db_conn, List job_list);
+	int  (*job_complete_mult)  (void *db_conn, List job_list);
 	int  (*job_suspend)        (void *db_conn,
 				    struct job_record *job_ptr);
 	List (*get_jobs_cond)      (void *db_conn, uint32_t uid,
@@ -272,6 +276,10 @@ static slurm_acct_storage_ops_t * _acct_storage_get_ops(
 		"jobacct_storage_p_job_complete",
 		"jobacct_storage_p_step_start",
 		"jobacct_storage_p_step_complete",
+		"jobacct_storage_p_step_start_mult",
+		"jobacct_storage_p_step_complete_mult",
+		"jobacct_storage_p_job_start_mult",
+		"jobacct_storage_p_job_complete_mult",
 		"jobacct_storage_p_suspend",
 		"jobacct_storage_p_get_jobs_cond",
 		"jobacct_storage_p_archive",
@@ -953,6 +961,51 @@ extern int jobacct_storage_g_step_complete(void *db_conn,
 							      step_ptr);
 }
 
+/*
+ * load into the storage the start of a list of job steps
+ */
+extern int jobacct_storage_g_step_start_mult(void *db_conn, List step_list)
+{
+	if (slurm_acct_storage_init(NULL) < 0)
+		return SLURM_ERROR;
+	return (*(g_acct_storage_context->ops.step_start_mult))(db_conn,
+								step_list);
+}
+
+/*
+ * load into the storage the end of a list of job steps
+ */
+extern int jobacct_storage_g_step_complete_mult(void *db_conn,
+						List step_list)
+{
+	if (slurm_acct_storage_init(NULL) < 0)
+		return SLURM_ERROR;
+	return (*(g_acct_storage_context->ops.step_complete_mult))(db_conn,
+								   step_list);
+}
+
+/*
+ * load into the storage the start of a list of jobs
+ */
+extern int jobacct_storage_g_job_start_mult(void *db_conn, List job_list)
+{
+	if (slurm_acct_storage_init(NULL) < 0)
+		return SLURM_ERROR;
+	return (*(g_acct_storage_context->ops.job_start_mult))(db_conn,
+							       job_list);
+}
+
+/*
+ * load into the storage the end of a list of jobs
+ */
+extern int jobacct_storage_g_job_complete_mult(void *db_conn, List job_list)
+{
+	if (slurm_acct_storage_init(NULL) < 0)
+		return SLURM_ERROR;
+	return (*(g_acct_storage_context->ops.job_complete_mult))(db_conn,
+								  job_list);
+}
+
 /*
  * load into the storage a suspention of a job
  */
@@ -480,6 +480,40 @@ extern int jobacct_storage_g_step_start(void *db_conn,
 extern int jobacct_storage_g_step_complete(void *db_conn,
 					   struct step_record *step_ptr);
 
+/*
+ * load into the storage the start of a list of job steps
+ * IN/OUT step_list - list of struct step_record *, on failure only the
+ *	steps which were not stored are left in it
+ * RET SLURM_SUCCESS if every step was stored
+ */
+extern int jobacct_storage_g_step_start_mult(void *db_conn, List step_list);
+
+/*
+ * load into the storage the end of a list of job steps
+ * IN/OUT step_list - list of struct step_record *, on failure only the
+ *	steps which were not stored are left in it
+ * RET SLURM_SUCCESS if every step was stored
+ */
+extern int jobacct_storage_g_step_complete_mult(void *db_conn,
+						List step_list);
+
+/*
+ * load into the storage the start of a list of jobs
+ * IN/OUT job_list - list of struct job_record *, db_index is set for
+ *	each job stored, on failure only the jobs which were not stored
+ *	are left in it
+ * RET SLURM_SUCCESS if every job was stored
+ */
+extern int jobacct_storage_g_job_start_mult(void *db_conn, List job_list);
+
+/*
+ * load into the storage the end of a list of jobs
+ * IN/OUT job_list - list of struct job_record *, on failure only the
+ *	jobs which were not stored are left in it
+ * RET SLURM_SUCCESS if every job was stored
+ */
+extern int jobacct_storage_g_job_complete_mult(void *db_conn, List job_list);
+
 /*
  * load into the storage a suspention of a job
  */
@@ -92,6 +92,8 @@ static int message_timeout = -1;
 static char *_global_auth_key(void);
 static void  _remap_slurmctld_errno(void);
 static int   _unpack_msg_uid(Buf buffer);
+static List  _receive_msgs(slurm_fd_t fd, int steps, int timeout,
+			   bool relay);
 
 #if _DEBUG
 static void _print_data(char *data, int len);
@@ -2232,6 +2234,21 @@ total_return:
  *		  (ret_data_info_t).
  */
 List slurm_receive_msgs(slurm_fd_t fd, int steps, int timeout)
+{
+	return _receive_msgs(fd, steps, timeout, false);
+}
+
+/*
+ * Same as slurm_receive_msgs, but for a node in the middle of a forwarding
+ * tree. The responses are authenticated, but their bodies are kept packed
+ * in the ret_data_info_t buf and relayed up the tree as received.
+ */
+List slurm_receive_relay_msgs(slurm_fd_t fd, int steps, int timeout)
+{
+	return _receive_msgs(fd, steps, timeout, true);
+}
+
+static List _receive_msgs(slurm_fd_t fd, int steps, int timeout, bool relay)
 {
 	char *buf = NULL;
 	size_t buflen = 0;
@@ -2243,6 +2260,8 @@ List slurm_receive_msgs(slurm_fd_t fd, int steps, int timeout)
 	ret_data_info_t *ret_data_info = NULL;
 	List ret_list = NULL;
 	int orig_timeout = timeout;
+	char *body = NULL;
+	uint32_t body_len = 0;
 
 	xassert(fd >= 0);
 
@@ -2297,7 +2316,8 @@ List slurm_receive_msgs(slurm_fd_t fd, int steps, int timeout)
 #endif
 	buffer = create_buf(buf, buflen);
 
-	if (unpack_header(&header, buffer) == SLURM_ERROR) {
+	if ((relay ? unpack_header_relay(&header, buffer) :
+		     unpack_header(&header, buffer)) == SLURM_ERROR) {
 		free_buf(buffer);
 		rc = SLURM_COMMUNICATIONS_RECEIVE_ERROR;
 		goto total_return;
@@ -2359,8 +2379,21 @@ List slurm_receive_msgs(slurm_fd_t fd, int steps, int timeout)
 	msg.msg_type = header.msg_type;
 	msg.flags = header.flags;
 
-	if ((header.body_length > remaining_buf(buffer)) ||
-	    (unpack_msg(&msg, buffer) != SLURM_SUCCESS)) {
+	if (header.body_length > remaining_buf(buffer)) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+		goto total_return;
+	}
+	if (relay && (header.version >= SLURM_2_4_PROTOCOL_VERSION)) {
+		/* Keep the body packed, it is relayed up the tree as is */
+		body_len = header.body_length;
+		if (body_len) {
+			body = xmalloc(body_len);
+			memcpy(body, &buffer->head[buffer->processed],
+			       body_len);
+		}
+	} else if (unpack_msg(&msg, buffer) != SLURM_SUCCESS) {
 		(void) g_slurm_auth_destroy(auth_cred);
 		free_buf(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
@@ -2391,6 +2424,8 @@ total_return:
 		ret_data_info->node_name = NULL;
 		ret_data_info->type = msg.msg_type;
 		ret_data_info->data = msg.data;
+		ret_data_info->buf = body;
+		ret_data_info->buf_len = body_len;
 		list_push(ret_list, ret_data_info);
 	}
 
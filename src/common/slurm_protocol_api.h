@@ -690,6 +690,20 @@ int slurm_receive_msg(slurm_fd_t fd, slurm_msg_t *msg, int timeout);
  */
 List slurm_receive_msgs(slurm_fd_t fd, int steps, int timeout);
 
+/*
+ *  Same as slurm_receive_msgs, but used by nodes forwarding a message down
+ *    the tree: the responses are authenticated, but their data is kept
+ *    packed (ret_data_info_t buf) rather than unpacked, so it can be
+ *    passed back up the tree without being decoded and packed again.
+ *
+ * IN open_fd	- file descriptor to receive msg on
+ * IN steps	- how many steps down the tree we have to wait for
+ * IN timeout	- how long to wait in milliseconds
+ * RET List	- List containing the responses (ret_data_info_t), as for
+ *                slurm_receive_msgs
+ */
+List slurm_receive_relay_msgs(slurm_fd_t fd, int steps, int timeout);
+
 /*
  *  Receive a slurm message on the open slurm descriptor "fd" waiting
  *    at most "timeout" seconds for the message data. This will also
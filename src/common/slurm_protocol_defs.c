@@ -359,6 +359,7 @@ extern void slurm_free_job_desc_msg(job_desc_msg_t * msg)
 	if (msg) {
 		xfree(msg->account);
 		xfree(msg->alloc_node);
+		xfree(msg->array_inx);
 		for (i = 0; i < msg->argc; i++)
 			xfree(msg->argv[i]);
 		xfree(msg->argv);
@@ -453,6 +454,7 @@ extern void slurm_free_job_info_members(job_info_t * job)
 	if (job) {
 		xfree(job->account);
 		xfree(job->alloc_node);
+		xfree(job->array_task_str);
 		xfree(job->batch_host);
 		xfree(job->batch_script);
 		xfree(job->command);
@@ -841,6 +843,15 @@ extern void slurm_free_suspend_msg(suspend_msg_t *msg)
 	xfree(msg);
 }
 
+extern void slurm_free_suspend_batch_msg(suspend_batch_msg_t *msg)
+{
+	if (msg) {
+		xfree(msg->job_id);
+		xfree(msg->op);
+		xfree(msg);
+	}
+}
+
 extern void slurm_free_spank_env_request_msg(spank_env_request_msg_t *msg)
 {
 	xfree(msg);
@@ -2372,6 +2383,9 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case SRUN_REQUEST_SUSPEND:
 		slurm_free_suspend_msg(data);
 		break;
+	case REQUEST_SUSPEND_BATCH:
+		slurm_free_suspend_batch_msg(data);
+		break;
 	case REQUEST_JOB_READY:
 	case REQUEST_JOB_REQUEUE:
 	case REQUEST_JOB_INFO_SINGLE:
@@ -2505,6 +2519,9 @@ extern uint32_t slurm_get_return_code(slurm_msg_type_t type, void *data)
 	case RESPONSE_SLURM_RC:
 		rc = ((return_code_msg_t *)data)->return_code;
 		break;
+	case MESSAGE_NODE_REGISTRATION_STATUS:
+		rc = ((slurm_node_registration_status_msg_t *)data)->status;
+		break;
 	case RESPONSE_FORWARD_FAILED:
 		/* There may be other reasons for the failure, but
 		 * this may be a slurm_msg_t data type lacking the
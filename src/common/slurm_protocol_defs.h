@@ -294,6 +294,7 @@ typedef enum {
 	REQUEST_FILE_BCAST,
 	TASK_USER_MANAGED_IO_STREAM,
 	REQUEST_KILL_PREEMPTED,
+	REQUEST_SUSPEND_BATCH,
 
 	SRUN_PING = 7001,
 	SRUN_TIMEOUT,
@@ -399,6 +400,9 @@ typedef struct ret_data_info {
 	char *node_name;
 	void *data; /* used to hold the return message data (i.e.
 		       return_code_msg_t */
+	char *buf;  /* or the message data still packed, when a forwarding
+		     * node relays it without unpacking it */
+	uint32_t buf_len;
 } ret_data_info_t;
 
 /*****************************************************************************\
@@ -726,6 +730,14 @@ typedef struct signal_job_msg {
 	uint32_t signal;
 } signal_job_msg_t;
 
+/* Suspend and resume requests for many jobs, sent to the union of their
+ * nodes. Each slurmd performs the operations for its own jobs in order. */
+typedef struct suspend_batch_msg {
+	uint32_t job_cnt;	/* entries in job_id and op */
+	uint32_t *job_id;
+	uint16_t *op;		/* SUSPEND_JOB or RESUME_JOB */
+} suspend_batch_msg_t;
+
 typedef struct job_time_msg {
 	uint32_t job_id;
 	time_t expiration_time;
@@ -898,6 +910,8 @@ typedef struct slurm_node_registration_status_msg {
 	uint32_t *job_id;	/* IDs of running job (if any) */
 	char *node_name;
 	char *os;
+	uint16_t protocol_version; /* DON'T PACK!  Set when unpacked to
+				    * the sender's protocol version */
 	uint32_t real_memory;
 	time_t slurmd_start_time;
 	uint32_t status;	/* node status code, same as return codes */
@@ -1049,6 +1063,7 @@ extern void slurm_free_checkpoint_comp_msg(checkpoint_comp_msg_t *msg);
 extern void slurm_free_checkpoint_task_comp_msg(checkpoint_task_comp_msg_t *msg);
 extern void slurm_free_checkpoint_resp_msg(checkpoint_resp_msg_t *msg);
 extern void slurm_free_suspend_msg(suspend_msg_t *msg);
+extern void slurm_free_suspend_batch_msg(suspend_batch_msg_t *msg);
 extern void slurm_free_update_step_msg(step_update_request_msg_t * msg);
 extern void slurm_free_resource_allocation_response_msg (
 		resource_allocation_response_msg_t * msg);
@@ -165,6 +165,18 @@ ssize_t _slurm_msg_sendto ( slurm_fd_t open_fd, char *buffer ,
  * IN timeout - maximum time to wait for a message in milliseconds */
 ssize_t _slurm_msg_sendto_timeout ( slurm_fd_t open_fd, char *buffer,
 				    size_t size, uint32_t flags, int timeout );
+/* _slurm_msg_sendto_parts is identical to _slurm_msg_sendto except that the
+ * message is sent from two separate buffers, so that a header can be put in
+ * front of a payload without copying the payload
+ * IN head - first part of the message
+ * IN head_size - size of head in bytes
+ * IN body - second part of the message
+ * IN body_size - size of body in bytes
+ * RET number of bytes written */
+ssize_t _slurm_msg_sendto_parts ( slurm_fd_t open_fd,
+				  char *head, size_t head_size,
+				  char *body, size_t body_size,
+				  uint32_t flags );
 
 /* _slurm_accept_msg_conn
  * In the bsd implmentation maps directly to a accept call
@@ -249,6 +249,10 @@ static void _pack_launch_tasks_request_msg(launch_tasks_request_msg_t *msg,
 static int _unpack_launch_tasks_request_msg(
 	launch_tasks_request_msg_t **msg_ptr, Buf buffer,
 	uint16_t protocol_version);
+static void _pack_launch_node_groups(launch_tasks_request_msg_t *msg,
+				     Buf buffer);
+static int _unpack_launch_node_groups(launch_tasks_request_msg_t *msg,
+				      Buf buffer);
 
 
 static void _pack_task_user_managed_io_stream_msg(task_user_managed_io_msg_t *
@@ -413,7 +417,8 @@ static int _unpack_slurm_addr_array(slurm_addr_t ** slurm_address,
 static void _pack_ret_list(List ret_list, uint16_t size_val, Buf buffer,
 			   uint16_t protocol_version);
 static int _unpack_ret_list(List *ret_list, uint16_t size_val, Buf buffer,
-			    uint16_t protocol_version);
+			    uint16_t protocol_version, bool relay);
+static int _unpack_header(header_t *header, Buf buffer, bool relay);
 
 static void _pack_job_id_request_msg(job_id_request_msg_t * msg, Buf buffer,
 				     uint16_t protocol_version);
@@ -495,6 +500,10 @@ static void _pack_suspend_msg(suspend_msg_t *msg, Buf buffer,
 			      uint16_t protocol_version);
 static int  _unpack_suspend_msg(suspend_msg_t **msg_ptr, Buf buffer,
 				uint16_t protocol_version);
+static void _pack_suspend_batch_msg(suspend_batch_msg_t *msg, Buf buffer,
+				    uint16_t protocol_version);
+static int  _unpack_suspend_batch_msg(suspend_batch_msg_t **msg_ptr,
+				      Buf buffer, uint16_t protocol_version);
 
 static void _pack_buffer_msg(slurm_msg_t * msg, Buf buffer);
 
@@ -634,6 +643,23 @@ pack_header(header_t * header, Buf buffer)
  */
 int
 unpack_header(header_t * header, Buf buffer)
+{
+	return _unpack_header(header, buffer, false);
+}
+
+/* unpack_header_relay
+ * same as unpack_header, but the bodies of the responses in the header's
+ * ret_list are left packed (see ret_data_info_t buf) so that a node in the
+ * middle of the forwarding tree can pass them on without decoding them.
+ */
+int
+unpack_header_relay(header_t * header, Buf buffer)
+{
+	return _unpack_header(header, buffer, true);
+}
+
+static int
+_unpack_header(header_t *header, Buf buffer, bool relay)
 {
 	uint32_t uint32_tmp = 0;
 
@@ -654,7 +680,8 @@ unpack_header(header_t * header, Buf buffer)
 	safe_unpack16(&header->ret_cnt, buffer);
 	if (header->ret_cnt > 0) {
 		if (_unpack_ret_list(&(header->ret_list),
-				     header->ret_cnt, buffer, header->version))
+				     header->ret_cnt, buffer, header->version,
+				     relay))
 			goto unpack_error;
 	} else {
 		header->ret_list = NULL;
@@ -1043,6 +1070,10 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 		_pack_suspend_msg((suspend_msg_t *)msg->data, buffer,
 				  msg->protocol_version);
 		break;
+	case REQUEST_SUSPEND_BATCH:
+		_pack_suspend_batch_msg((suspend_batch_msg_t *)msg->data,
+					buffer, msg->protocol_version);
+		break;
 
 	case REQUEST_JOB_READY:
 	case REQUEST_JOB_REQUEUE:
@@ -1575,6 +1606,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					 buffer,
 					 msg->protocol_version);
 		break;
+	case REQUEST_SUSPEND_BATCH:
+		rc = _unpack_suspend_batch_msg(
+			(suspend_batch_msg_t **) &msg->data, buffer,
+			msg->protocol_version);
+		break;
 
 	case REQUEST_JOB_READY:
 	case REQUEST_JOB_REQUEUE:
@@ -2303,6 +2339,7 @@ _unpack_node_registration_status_msg(slurm_node_registration_status_msg_t
 	xassert(msg != NULL);
 	node_reg_ptr = xmalloc(sizeof(slurm_node_registration_status_msg_t));
 	*msg = node_reg_ptr;
+	node_reg_ptr->protocol_version = protocol_version;
 
 	if(protocol_version >= SLURM_2_2_PROTOCOL_VERSION) {
 		/* unpack timestamp of snapshot */
@@ -3949,6 +3986,12 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 	if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
 		safe_unpack32(&job->assoc_id, buffer);
 		safe_unpack32(&job->job_id, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			safe_unpack32(&job->array_job_id, buffer);
+			safe_unpack32(&job->array_task_id, buffer);
+			safe_unpackstr_xmalloc(&job->array_task_str,
+					       &uint32_tmp, buffer);
+		}
 		safe_unpack32(&job->user_id, buffer);
 		safe_unpack32(&job->group_id, buffer);
 
@@ -4439,6 +4482,8 @@ _pack_slurm_ctl_conf_msg(slurm_ctl_conf_info_msg_t * build_ptr, Buf buffer,
 
 		pack16(build_ptr->slurmctld_debug, buffer);
 		packstr(build_ptr->slurmctld_logfile, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION)
+			pack16(build_ptr->slurmctld_log_queue, buffer);
 		packstr(build_ptr->slurmctld_pidfile, buffer);
 		pack32(build_ptr->slurmctld_port, buffer);
 		pack16(build_ptr->slurmctld_port_count, buffer);
@@ -5096,6 +5141,10 @@ _unpack_slurm_ctl_conf_msg(slurm_ctl_conf_info_msg_t **build_buffer_ptr,
 		safe_unpack16(&build_ptr->slurmctld_debug, buffer);
 		safe_unpackstr_xmalloc(&build_ptr->slurmctld_logfile,
 				       &uint32_tmp, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			safe_unpack16(&build_ptr->slurmctld_log_queue,
+				      buffer);
+		}
 		safe_unpackstr_xmalloc(&build_ptr->slurmctld_pidfile,
 				       &uint32_tmp, buffer);
 		safe_unpack32(&build_ptr->slurmctld_port, buffer);
@@ -5725,6 +5774,8 @@ _pack_job_desc_msg(job_desc_msg_t * job_desc_ptr, Buf buffer,
 		packstr(job_desc_ptr->features, buffer);
 		packstr(job_desc_ptr->gres, buffer);
 		pack32(job_desc_ptr->job_id, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION)
+			packstr(job_desc_ptr->array_inx, buffer);
 		packstr(job_desc_ptr->name, buffer);
 
 		packstr(job_desc_ptr->alloc_node, buffer);
@@ -6169,6 +6220,10 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, Buf buffer,
 				       &uint32_tmp, buffer);
 		safe_unpackstr_xmalloc(&job_desc_ptr->gres, &uint32_tmp,buffer);
 		safe_unpack32(&job_desc_ptr->job_id, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			safe_unpackstr_xmalloc(&job_desc_ptr->array_inx,
+					       &uint32_tmp, buffer);
+		}
 		safe_unpackstr_xmalloc(&job_desc_ptr->name,
 				       &uint32_tmp, buffer);
 
@@ -6856,12 +6911,17 @@ _pack_launch_tasks_request_msg(launch_tasks_request_msg_t * msg, Buf buffer,
 		pack16(msg->task_dist, buffer);
 
 		slurm_cred_pack(msg->cred, buffer);
-		for(i=0; i<msg->nnodes; i++) {
-			pack16(msg->tasks_to_launch[i], buffer);
-			pack16(msg->cpus_allocated[i], buffer);
-			pack32_array(msg->global_task_ids[i],
-				     (uint32_t) msg->tasks_to_launch[i],
-				     buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			_pack_launch_node_groups(msg, buffer);
+		} else {
+			for(i=0; i<msg->nnodes; i++) {
+				pack16(msg->tasks_to_launch[i], buffer);
+				pack16(msg->cpus_allocated[i], buffer);
+				pack32_array(msg->global_task_ids[i],
+					     (uint32_t)
+					     msg->tasks_to_launch[i],
+					     buffer);
+			}
 		}
 		pack16(msg->num_resp_port, buffer);
 		for(i = 0; i < msg->num_resp_port; i++)
@@ -7033,6 +7093,136 @@ _pack_launch_tasks_request_msg(launch_tasks_request_msg_t * msg, Buf buffer,
 	}
 }
 
+/*
+ * Test if a node's task ids form a single arithmetic progression, which
+ * is always the case with block and cyclic distributions
+ */
+static bool _launch_node_progression(uint32_t *tids, uint16_t cnt,
+				     uint32_t *start, uint32_t *stride)
+{
+	uint16_t i;
+
+	*start  = (cnt > 0) ? tids[0] : 0;
+	*stride = (cnt > 1) ? (tids[1] - tids[0]) : 1;
+	for (i = 2; i < cnt; i++) {
+		if ((tids[i] - tids[i-1]) != *stride)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Pack the per-node task counts, allocated cpus and task ids of a launch
+ * request as groups of consecutive nodes with the same task and cpu
+ * counts whose task ids are progressions shifted by a constant from one
+ * node to the next. A regular step over thousands of nodes packs into a
+ * few groups. A node not matching this pattern is packed as a group of
+ * count zero followed by its plain task ids.
+ */
+static void _pack_launch_node_groups(launch_tasks_request_msg_t *msg,
+				     Buf buffer)
+{
+	uint32_t i = 0, j, start, stride, next_start, next_stride, delta;
+	uint32_t group_cnt = 0;
+	uint32_t cnt_offset, end_offset;
+	uint16_t tasks;
+
+	cnt_offset = get_buf_offset(buffer);
+	pack32(group_cnt, buffer);	/* filled in below */
+
+	while (i < msg->nnodes) {
+		tasks = msg->tasks_to_launch[i];
+		group_cnt++;
+		if (!_launch_node_progression(msg->global_task_ids[i], tasks,
+					      &start, &stride)) {
+			pack32((uint32_t) 0, buffer);
+			pack16(tasks, buffer);
+			pack16(msg->cpus_allocated[i], buffer);
+			pack32_array(msg->global_task_ids[i], (uint32_t) tasks,
+				     buffer);
+			i++;
+			continue;
+		}
+
+		delta = 0;
+		for (j = i + 1; j < msg->nnodes; j++) {
+			if ((msg->tasks_to_launch[j] != tasks) ||
+			    (msg->cpus_allocated[j] != msg->cpus_allocated[i]))
+				break;
+			if (!_launch_node_progression(msg->global_task_ids[j],
+						      tasks, &next_start,
+						      &next_stride) ||
+			    (next_stride != stride))
+				break;
+			if (j == (i + 1))
+				delta = next_start - start;
+			else if ((next_start - start) != (delta * (j - i)))
+				break;
+		}
+
+		pack32(j - i, buffer);
+		pack16(tasks, buffer);
+		pack16(msg->cpus_allocated[i], buffer);
+		pack32(start, buffer);
+		pack32(stride, buffer);
+		pack32(delta, buffer);
+		i = j;
+	}
+
+	end_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, cnt_offset);
+	pack32(group_cnt, buffer);
+	set_buf_offset(buffer, end_offset);
+}
+
+static int _unpack_launch_node_groups(launch_tasks_request_msg_t *msg,
+				      Buf buffer)
+{
+	uint32_t group_cnt, node_cnt, start, stride, delta, uint32_tmp;
+	uint32_t g, i = 0, k;
+	uint16_t tasks, cpus, t;
+
+	safe_unpack32(&group_cnt, buffer);
+	for (g = 0; g < group_cnt; g++) {
+		safe_unpack32(&node_cnt, buffer);
+		safe_unpack16(&tasks, buffer);
+		safe_unpack16(&cpus, buffer);
+		if (node_cnt == 0) {
+			if (i >= msg->nnodes)
+				goto unpack_error;
+			msg->tasks_to_launch[i] = tasks;
+			msg->cpus_allocated[i] = cpus;
+			safe_unpack32_array(&msg->global_task_ids[i],
+					    &uint32_tmp, buffer);
+			i++;
+			if (tasks != (uint16_t) uint32_tmp)
+				goto unpack_error;
+			continue;
+		}
+
+		safe_unpack32(&start, buffer);
+		safe_unpack32(&stride, buffer);
+		safe_unpack32(&delta, buffer);
+		if (node_cnt > (msg->nnodes - i))
+			goto unpack_error;
+		for (k = 0; k < node_cnt; k++, i++, start += delta) {
+			msg->tasks_to_launch[i] = tasks;
+			msg->cpus_allocated[i] = cpus;
+			msg->global_task_ids[i] =
+				xmalloc(sizeof(uint32_t) * tasks);
+			for (t = 0; t < tasks; t++)
+				msg->global_task_ids[i][t] = start +
+							     (t * stride);
+		}
+	}
+	if (i != msg->nnodes)
+		goto unpack_error;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
 static int
 _unpack_launch_tasks_request_msg(launch_tasks_request_msg_t **
 				 msg_ptr, Buf buffer,
@@ -7066,14 +7256,21 @@ _unpack_launch_tasks_request_msg(launch_tasks_request_msg_t **
 		msg->cpus_allocated = xmalloc(sizeof(uint16_t) * msg->nnodes);
 		msg->global_task_ids = xmalloc(sizeof(uint32_t *) *
 					       msg->nnodes);
-		for(i=0; i<msg->nnodes; i++) {
-			safe_unpack16(&msg->tasks_to_launch[i], buffer);
-			safe_unpack16(&msg->cpus_allocated[i], buffer);
-			safe_unpack32_array(&msg->global_task_ids[i],
-					    &uint32_tmp,
-					    buffer);
-			if (msg->tasks_to_launch[i] != (uint16_t) uint32_tmp)
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			if (_unpack_launch_node_groups(msg, buffer))
 				goto unpack_error;
+		} else {
+			for(i=0; i<msg->nnodes; i++) {
+				safe_unpack16(&msg->tasks_to_launch[i],
+					      buffer);
+				safe_unpack16(&msg->cpus_allocated[i], buffer);
+				safe_unpack32_array(&msg->global_task_ids[i],
+						    &uint32_tmp,
+						    buffer);
+				if (msg->tasks_to_launch[i] !=
+				    (uint16_t) uint32_tmp)
+					goto unpack_error;
+			}
 		}
 		safe_unpack16(&msg->num_resp_port, buffer);
 		if (msg->num_resp_port > 0) {
@@ -8514,29 +8711,71 @@ _pack_ret_list(List ret_list,
 	ListIterator itr;
 	ret_data_info_t *ret_data_info = NULL;
 	slurm_msg_t msg;
+	uint32_t len_offset, body_offset, end_offset;
 
 	slurm_msg_t_init(&msg);
 	msg.protocol_version = protocol_version;
 	itr = list_iterator_create(ret_list);
 	while((ret_data_info = list_next(itr))) {
-		pack32((uint32_t)ret_data_info->err, buffer);
-		pack16((uint16_t)ret_data_info->type, buffer);
-		packstr(ret_data_info->node_name, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			pack32((uint32_t)ret_data_info->err, buffer);
+			pack16((uint16_t)ret_data_info->type, buffer);
+			packstr(ret_data_info->node_name, buffer);
+
+			/* Each body is preceded by its length so that
+			 * forwarding nodes can relay it untouched */
+			if (ret_data_info->buf) {
+				pack32(ret_data_info->buf_len, buffer);
+				packmem_array(ret_data_info->buf,
+					      ret_data_info->buf_len, buffer);
+				continue;
+			}
+			len_offset = get_buf_offset(buffer);
+			pack32((uint32_t)0, buffer);
+			body_offset = get_buf_offset(buffer);
+			msg.msg_type = ret_data_info->type;
+			msg.data = ret_data_info->data;
+			pack_msg(&msg, buffer);
+			end_offset = get_buf_offset(buffer);
+			set_buf_offset(buffer, len_offset);
+			pack32(end_offset - body_offset, buffer);
+			set_buf_offset(buffer, end_offset);
+		} else {
+			if (ret_data_info->buf) {
+				/* Only relayed at SLURM_2_4_PROTOCOL_VERSION
+				 * or later, so this should never happen */
+				error("_pack_ret_list: can't relay a packed "
+				      "response from %s at protocol version %u",
+				      ret_data_info->node_name,
+				      protocol_version);
+				pack32((uint32_t)SLURM_PROTOCOL_VERSION_ERROR,
+				       buffer);
+				pack16((uint16_t)RESPONSE_FORWARD_FAILED,
+				       buffer);
+				packstr(ret_data_info->node_name, buffer);
+				continue;
+			}
+			pack32((uint32_t)ret_data_info->err, buffer);
+			pack16((uint16_t)ret_data_info->type, buffer);
+			packstr(ret_data_info->node_name, buffer);
 
-		msg.msg_type = ret_data_info->type;
-		msg.data = ret_data_info->data;
-		pack_msg(&msg, buffer);
+			msg.msg_type = ret_data_info->type;
+			msg.data = ret_data_info->data;
+			pack_msg(&msg, buffer);
+		}
 	}
 	list_iterator_destroy(itr);
 }
 
+/* If relay is set, the response bodies are copied out still packed rather
+ * than unpacked (only possible at SLURM_2_4_PROTOCOL_VERSION or later) */
 static int
 _unpack_ret_list(List *ret_list,
 		 uint16_t size_val, Buf buffer,
-		 uint16_t protocol_version)
+		 uint16_t protocol_version, bool relay)
 {
 	int i = 0;
-	uint32_t uint32_tmp;
+	uint32_t uint32_tmp, body_len, body_offset;
 	ret_data_info_t *ret_data_info = NULL;
 	slurm_msg_t msg;
 
@@ -8553,10 +8792,32 @@ _unpack_ret_list(List *ret_list,
 		safe_unpack16(&ret_data_info->type, buffer);
 		safe_unpackstr_xmalloc(&ret_data_info->node_name,
 				       &uint32_tmp, buffer);
-		msg.msg_type = ret_data_info->type;
-		if (unpack_msg(&msg, buffer) != SLURM_SUCCESS)
-			goto unpack_error;
-		ret_data_info->data = msg.data;
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			safe_unpack32(&body_len, buffer);
+			if (body_len > remaining_buf(buffer))
+				goto unpack_error;
+			body_offset = get_buf_offset(buffer);
+			if (relay) {
+				if (body_len) {
+					ret_data_info->buf = xmalloc(body_len);
+					memcpy(ret_data_info->buf,
+					       &buffer->head[body_offset],
+					       body_len);
+				}
+				ret_data_info->buf_len = body_len;
+			} else {
+				msg.msg_type = ret_data_info->type;
+				if (unpack_msg(&msg, buffer) != SLURM_SUCCESS)
+					goto unpack_error;
+				ret_data_info->data = msg.data;
+			}
+			set_buf_offset(buffer, body_offset + body_len);
+		} else {
+			msg.msg_type = ret_data_info->type;
+			if (unpack_msg(&msg, buffer) != SLURM_SUCCESS)
+				goto unpack_error;
+			ret_data_info->data = msg.data;
+		}
 	}
 
 	return SLURM_SUCCESS;
@@ -9015,6 +9276,37 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_suspend_batch_msg(suspend_batch_msg_t *msg, Buf buffer,
+				    uint16_t protocol_version)
+{
+	xassert ( msg != NULL );
+
+	pack32_array(msg->job_id, msg->job_cnt, buffer);
+	pack16_array(msg->op, msg->job_cnt, buffer);
+}
+
+static int  _unpack_suspend_batch_msg(suspend_batch_msg_t **msg_ptr,
+				      Buf buffer, uint16_t protocol_version)
+{
+	suspend_batch_msg_t * msg;
+	uint32_t uint32_tmp;
+	xassert ( msg_ptr != NULL );
+
+	msg = xmalloc ( sizeof (suspend_batch_msg_t) );
+	*msg_ptr = msg ;
+
+	safe_unpack32_array(&msg->job_id, &msg->job_cnt, buffer);
+	safe_unpack16_array(&msg->op, &uint32_tmp, buffer);
+	if (uint32_tmp != msg->job_cnt)
+		goto unpack_error;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*msg_ptr = NULL;
+	slurm_free_suspend_batch_msg(msg);
+	return SLURM_ERROR;
+}
+
 
 static void
 _pack_checkpoint_msg(checkpoint_msg_t *msg, Buf buffer,
@@ -77,6 +77,16 @@ extern void pack_header ( header_t  * header , Buf buffer );
  */
 extern int unpack_header ( header_t * header , Buf buffer );
 
+/* unpack_header_relay
+ * same as unpack_header, but the responses in the header's ret_list are
+ * kept packed (see ret_data_info_t) so they can be forwarded as received
+ * OUT header - the header structure to unpack
+ * IN/OUT buffer - source of the unpack data, contains pointers that are
+ *			automatically updated
+ * RET 0 or error code
+ */
+extern int unpack_header_relay ( header_t * header , Buf buffer );
+
 
 /**************************************************************************/
 /* generic case statement Pack / Unpack methods for slurm protocol bodies */
@@ -52,6 +52,7 @@
 #include <sys/poll.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -94,6 +95,9 @@
  * MIDDLE LAYER MSG FUNCTIONS
  ****************************************************************/
 
+static ssize_t _slurm_sendv_timeout(slurm_fd_t fd, struct iovec *iov,
+				    int iovcnt, int timeout);
+
 /*
  * Return time in msec since "start time"
  */
@@ -238,6 +242,140 @@ ssize_t _slurm_msg_sendto_timeout(slurm_fd_t fd, char *buffer, size_t size,
 	return len;
 }
 
+ssize_t _slurm_msg_sendto_parts(slurm_fd_t fd, char *head, size_t head_size,
+				char *body, size_t body_size, uint32_t flags)
+{
+	ssize_t len;
+	uint32_t usize;
+	struct iovec iov[3];
+	SigFunc *ohandler;
+
+	ohandler = xsignal(SIGPIPE, SIG_IGN);
+
+	/* One writev() for the length and both parts, so that the small
+	 * length and header writes are not held back by Nagle */
+	usize = htonl(head_size + body_size);
+	iov[0].iov_base = &usize;
+	iov[0].iov_len  = sizeof(usize);
+	iov[1].iov_base = head;
+	iov[1].iov_len  = head_size;
+	iov[2].iov_base = body;
+	iov[2].iov_len  = body_size;
+
+	len = _slurm_sendv_timeout(fd, iov, 3,
+				   (slurm_get_msg_timeout() * 1000));
+	if (len >= 0)
+		len = head_size + body_size;
+
+	xsignal(SIGPIPE, ohandler);
+	return len;
+}
+
+/* Send the contents of an iovec array with timeout, the array is modified
+ * RET bytes sent or SLURM_ERROR on error */
+static ssize_t _slurm_sendv_timeout(slurm_fd_t fd, struct iovec *iov,
+				    int iovcnt, int timeout)
+{
+	ssize_t rc, sent = 0;
+	size_t size = 0;
+	int fd_flags, i;
+	struct pollfd ufds;
+	struct timeval tstart;
+	int timeleft = timeout;
+	char temp[2];
+
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+
+	ufds.fd     = fd;
+	ufds.events = POLLOUT;
+
+	fd_flags = _slurm_fcntl(fd, F_GETFL);
+	fd_set_nonblocking(fd);
+
+	gettimeofday(&tstart, NULL);
+
+	while (sent < size) {
+		timeleft = timeout - _tot_wait(&tstart);
+		if (timeleft <= 0) {
+			debug("_slurm_sendv_timeout at %zd of %zd, timeout",
+			      sent, size);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		if ((rc = poll(&ufds, 1, timeleft)) <= 0) {
+			if ((rc == 0) || (errno == EINTR) || (errno == EAGAIN))
+ 				continue;
+			debug("_slurm_sendv_timeout at %zd of %zd, "
+			      "poll error: %s", sent, size, strerror(errno));
+			slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		/* See _slurm_send_timeout() */
+		if (ufds.revents & POLLERR) {
+			debug("_slurm_sendv_timeout: Socket POLLERR");
+			slurm_seterrno(ENOTCONN);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+		if ((ufds.revents & POLLHUP) || (ufds.revents & POLLNVAL) ||
+		    (_slurm_recv(fd, &temp, 1, 0) == 0)) {
+			debug2("_slurm_sendv_timeout: Socket no longer there");
+			slurm_seterrno(ENOTCONN);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		rc = writev(fd, iov, iovcnt);
+		if (rc < 0) {
+ 			if (errno == EINTR)
+				continue;
+			debug("_slurm_sendv_timeout at %zd of %zd, "
+			      "writev error: %s", sent, size, strerror(errno));
+ 			if (errno == EAGAIN) {	/* poll() lied to us */
+				usleep(10000);
+				continue;
+			}
+ 			slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+		if (rc == 0) {
+			debug("_slurm_sendv_timeout at %zd of %zd, "
+			      "sent zero bytes", sent, size);
+			slurm_seterrno(SLURM_PROTOCOL_SOCKET_ZERO_BYTES_SENT);
+			sent = SLURM_ERROR;
+			goto done;
+		}
+
+		sent += rc;
+		/* skip what was written */
+		while (iovcnt && (rc >= iov->iov_len)) {
+			rc -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt) {
+			iov->iov_base = (char *) iov->iov_base + rc;
+			iov->iov_len -= rc;
+		}
+	}
+
+    done:
+	/* Reset fd flags to prior state, preserve errno */
+	if (fd_flags != SLURM_PROTOCOL_ERROR) {
+		int slurm_err = slurm_get_errno();
+		_slurm_fcntl(fd , F_SETFL , fd_flags);
+		slurm_seterrno(slurm_err);
+	}
+
+	return sent;
+}
+
 /* Send slurm message with timeout
  * RET message size (as specified in argument) or SLURM_ERROR on error */
 int _slurm_send_timeout(slurm_fd_t fd, char *buf, size_t size,
@@ -60,6 +60,8 @@ static int _init_task_layout(slurm_step_layout_t *step_layout,
 			     uint16_t cpus_per_task,
 			     uint16_t task_dist, uint16_t plane_size);
 
+static void _task_layout_count(slurm_step_layout_t *step_layout,
+			       uint16_t *cpus);
 static int _task_layout_block(slurm_step_layout_t *step_layout,
 			      uint16_t *cpus);
 static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
@@ -69,6 +71,12 @@ static int _task_layout_plane(slurm_step_layout_t *step_layout,
 static int _task_layout_hostfile(slurm_step_layout_t *step_layout,
 				 const char *arbitrary_nodes);
 
+static uint32_t _tids_run_end(uint32_t *tids, uint32_t cnt, uint32_t inx,
+			      uint32_t *stride);
+static uint32_t _tids_run_cnt(uint32_t *tids, uint32_t cnt);
+static void _pack_tids(uint32_t *tids, uint32_t cnt, Buf buffer);
+static int  _unpack_tids(uint32_t **tids, uint16_t *cnt, Buf buffer);
+
 /*
  * slurm_step_layout_create - determine how many tasks of a job will be
  *                    run on each node. Distribution is influenced
@@ -285,7 +293,24 @@ extern void pack_slurm_step_layout(slurm_step_layout_t *step_layout,
 {
 	uint16_t i = 0;
 
-	if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+		if (step_layout)
+			i=1;
+
+		pack16(i, buffer);
+		if (!i)
+			return;
+		packstr(step_layout->front_end, buffer);
+		packstr(step_layout->node_list, buffer);
+		pack32(step_layout->node_cnt, buffer);
+		pack32(step_layout->task_cnt, buffer);
+		pack16(step_layout->task_dist, buffer);
+
+		for (i=0; i<step_layout->node_cnt; i++) {
+			_pack_tids(step_layout->tids[i],
+				   step_layout->tasks[i], buffer);
+		}
+	} else if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
 		if (step_layout)
 			i=1;
 
@@ -331,7 +356,32 @@ extern int unpack_slurm_step_layout(slurm_step_layout_t **layout, Buf buffer,
 	slurm_step_layout_t *step_layout = NULL;
 	int i;
 
-	if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+		safe_unpack16(&uint16_tmp, buffer);
+		if (!uint16_tmp)
+			return SLURM_SUCCESS;
+
+		step_layout = xmalloc(sizeof(slurm_step_layout_t));
+		*layout = step_layout;
+
+		safe_unpackstr_xmalloc(&step_layout->front_end,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&step_layout->node_list,
+				       &uint32_tmp, buffer);
+		safe_unpack32(&step_layout->node_cnt, buffer);
+		safe_unpack32(&step_layout->task_cnt, buffer);
+		safe_unpack16(&step_layout->task_dist, buffer);
+
+		step_layout->tasks =
+			xmalloc(sizeof(uint16_t) * step_layout->node_cnt);
+		step_layout->tids = xmalloc(sizeof(uint32_t *)
+					    * step_layout->node_cnt);
+		for (i = 0; i < step_layout->node_cnt; i++) {
+			if (_unpack_tids(&(step_layout->tids[i]),
+					 &(step_layout->tasks[i]), buffer))
+				goto unpack_error;
+		}
+	} else if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
 		safe_unpack16(&uint16_tmp, buffer);
 		if (!uint16_tmp)
 			return SLURM_SUCCESS;
@@ -390,6 +440,95 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/*
+ * Find the end of the arithmetic progression of task ids starting at
+ * tids[inx]. Block and cyclic layouts make one progression per node,
+ * plane layouts one per plane.
+ * RET index following the progression, its stride is set in *stride
+ */
+static uint32_t _tids_run_end(uint32_t *tids, uint32_t cnt, uint32_t inx,
+			      uint32_t *stride)
+{
+	uint32_t end = inx + 1;
+
+	*stride = 1;
+	if (end < cnt) {
+		*stride = tids[end] - tids[inx];
+		for (end++; (end < cnt) &&
+			     ((tids[end] - tids[end-1]) == *stride); end++)
+			;
+	}
+	return end;
+}
+
+static uint32_t _tids_run_cnt(uint32_t *tids, uint32_t cnt)
+{
+	uint32_t i = 0, stride, run_cnt = 0;
+
+	while (i < cnt) {
+		i = _tids_run_end(tids, cnt, i, &stride);
+		run_cnt++;
+	}
+	return run_cnt;
+}
+
+/*
+ * Pack a node's task ids as (start, stride, count) progressions when
+ * that is smaller than the plain list. A zero progression count
+ * announces the plain list.
+ */
+static void _pack_tids(uint32_t *tids, uint32_t cnt, Buf buffer)
+{
+	uint32_t i, end, run_cnt, stride;
+
+	pack16((uint16_t) cnt, buffer);
+	run_cnt = _tids_run_cnt(tids, cnt);
+	if ((run_cnt * 3) >= cnt) {
+		pack32((uint32_t) 0, buffer);
+		for (i = 0; i < cnt; i++)
+			pack32(tids[i], buffer);
+		return;
+	}
+
+	pack32(run_cnt, buffer);
+	for (i = 0; i < cnt; i = end) {
+		end = _tids_run_end(tids, cnt, i, &stride);
+		pack32(tids[i], buffer);
+		pack32(stride, buffer);
+		pack32(end - i, buffer);
+	}
+}
+
+static int _unpack_tids(uint32_t **tids, uint16_t *cnt, Buf buffer)
+{
+	uint32_t i, j = 0, k, run_cnt, start, stride, run_len;
+
+	safe_unpack16(cnt, buffer);
+	safe_unpack32(&run_cnt, buffer);
+	*tids = xmalloc(sizeof(uint32_t) * (*cnt));
+	if (run_cnt == 0) {
+		for (i = 0; i < *cnt; i++)
+			safe_unpack32(&(*tids)[i], buffer);
+		return SLURM_SUCCESS;
+	}
+
+	for (i = 0; i < run_cnt; i++) {
+		safe_unpack32(&start, buffer);
+		safe_unpack32(&stride, buffer);
+		safe_unpack32(&run_len, buffer);
+		if (run_len > (*cnt - j))
+			goto unpack_error;
+		for (k = 0; k < run_len; k++, start += stride)
+			(*tids)[j++] = start;
+	}
+	if (j != *cnt)
+		goto unpack_error;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
 /* destroys structure for step layout */
 extern int slurm_step_layout_destroy(slurm_step_layout_t *step_layout)
 {
@@ -594,32 +733,74 @@ static int _task_layout_hostfile(slurm_step_layout_t *step_layout,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Figure out how many tasks go to each node when distributing them in a
+ * cyclic fashion over the available processors, then over-subscribing
+ * every node once all processors are used (see _task_layout_cyclic).
+ * Rather than going through the cycles one task at a time, find the
+ * number of complete cycles by bisection over the processor counts.
+ */
+static void _task_layout_count(slurm_step_layout_t *step_layout,
+			       uint16_t *cpus)
+{
+	uint32_t node_cnt = step_layout->node_cnt;
+	uint32_t task_cnt = step_layout->task_cnt;
+	uint32_t i, cpu_sum = 0, max_cpus = 0, lo, hi, mid, used, rem;
+
+	for (i = 0; i < node_cnt; i++) {
+		cpu_sum += cpus[i];
+		max_cpus = MAX(max_cpus, cpus[i]);
+	}
+
+	if (task_cnt >= cpu_sum) {
+		/* all processors used, the remaining tasks are spread
+		 * evenly starting over from the first node */
+		rem = task_cnt - cpu_sum;
+		for (i = 0; i < node_cnt; i++) {
+			step_layout->tasks[i] = cpus[i] + (rem / node_cnt);
+			if (i < (rem % node_cnt))
+				step_layout->tasks[i]++;
+		}
+		return;
+	}
+
+	/* largest number of complete cycles fitting in task_cnt */
+	lo = 0;
+	hi = max_cpus;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		for (i = 0, used = 0; i < node_cnt; i++)
+			used += MIN(cpus[i], mid);
+		if (used <= task_cnt)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	/* then a partial cycle over the nodes having processors left */
+	for (i = 0, used = 0; i < node_cnt; i++) {
+		step_layout->tasks[i] = MIN(cpus[i], lo);
+		used += step_layout->tasks[i];
+	}
+	for (i = 0; (i < node_cnt) && (used < task_cnt); i++) {
+		if (cpus[i] > lo) {
+			step_layout->tasks[i]++;
+			used++;
+		}
+	}
+}
+
 /* to effectively deal with heterogeneous nodes, we fake a cyclic
  * distribution to figure out how many tasks go on each node and
  * then make those assignments in a block fashion */
 static int _task_layout_block(slurm_step_layout_t *step_layout, uint16_t *cpus)
 {
 	int i, j, taskid = 0;
-	bool over_subscribe = false;
 
 	/* figure out how many tasks go to each node */
-	for (j=0; (taskid<step_layout->task_cnt); j++) {   /* cycle counter */
-		bool space_remaining = false;
-		for (i=0; ((i<step_layout->node_cnt)
-			   && (taskid<step_layout->task_cnt)); i++) {
-			if ((j<cpus[i]) || over_subscribe) {
-				taskid++;
-				step_layout->tasks[i]++;
-				if ((j+1) < cpus[i])
-					space_remaining = true;
-			}
-		}
-		if (!space_remaining)
-			over_subscribe = true;
-	}
+	_task_layout_count(step_layout, cpus);
 
 	/* now distribute the tasks */
-	taskid = 0;
 	for (i=0; i < step_layout->node_cnt; i++) {
 		step_layout->tids[i] = xmalloc(sizeof(uint32_t)
 					       * step_layout->tasks[i]);
@@ -648,27 +829,29 @@ static int _task_layout_cyclic(slurm_step_layout_t *step_layout,
 			       uint16_t *cpus)
 {
 	int i, j, taskid = 0;
-	bool over_subscribe = false;
+	uint16_t max_cpus = 0;
+	uint32_t cur_task[step_layout->node_cnt];
 
+	/* size each node's task ids exactly before filling them */
+	_task_layout_count(step_layout, cpus);
 	for (i=0; i<step_layout->node_cnt; i++) {
 		step_layout->tids[i] = xmalloc(sizeof(uint32_t)
-					       * step_layout->task_cnt);
+					       * step_layout->tasks[i]);
+		cur_task[i] = 0;
+		max_cpus = MAX(max_cpus, cpus[i]);
 	}
+
+	/* a node gets a task in each cycle until its processors are all
+	 * used, then in every cycle once all processors are used */
 	for (j=0; taskid<step_layout->task_cnt; j++) {   /* cycle counter */
-		bool space_remaining = false;
 		for (i=0; ((i<step_layout->node_cnt)
 			   && (taskid<step_layout->task_cnt)); i++) {
-			if ((j<cpus[i]) || over_subscribe) {
-				step_layout->tids[i][step_layout->tasks[i]] =
-					taskid;
+			if (((j<cpus[i]) || (j>=max_cpus)) &&
+			    (cur_task[i] < step_layout->tasks[i])) {
+				step_layout->tids[i][cur_task[i]++] = taskid;
 				taskid++;
-				step_layout->tasks[i]++;
-				if ((j+1) < cpus[i])
-					space_remaining = true;
 			}
 		}
-		if (!space_remaining)
-			over_subscribe = true;
 	}
 	return SLURM_SUCCESS;
 }
@@ -695,7 +878,6 @@ static int _task_layout_plane(slurm_step_layout_t *step_layout,
 			      uint16_t *cpus)
 {
 	int i, j, k, taskid = 0;
-	bool over_subscribe = false;
 	uint32_t cur_task[step_layout->node_cnt];
 
 	debug3("_task_layout_plane plane_size %u node_cnt %u task_cnt %u",
@@ -709,23 +891,9 @@ static int _task_layout_plane(slurm_step_layout_t *step_layout,
 		return SLURM_ERROR;
 
 	/* figure out how many tasks go to each node */
-	for (j=0; taskid<step_layout->task_cnt; j++) {   /* cycle counter */
-		bool space_remaining = false;
-		for (i=0; ((i<step_layout->node_cnt)
-			   && (taskid<step_layout->task_cnt)); i++) {
-			if ((j<cpus[i]) || over_subscribe) {
-				taskid++;
-				step_layout->tasks[i]++;
-				if ((j+1) < cpus[i])
-					space_remaining = true;
-			}
-		}
-		if (!space_remaining)
-			over_subscribe = true;
-	}
+	_task_layout_count(step_layout, cpus);
 
 	/* now distribute the tasks */
-	taskid = 0;
 	for (i=0; i < step_layout->node_cnt; i++) {
 	    step_layout->tids[i] = xmalloc(sizeof(uint32_t)
 				           * step_layout->tasks[i]);
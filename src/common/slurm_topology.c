@@ -37,6 +37,7 @@
 \*****************************************************************************/
 
 #include <pthread.h>
+#include <string.h>
 
 #include "src/common/log.h"
 #include "src/common/plugrack.h"
@@ -49,6 +50,10 @@
 /* defined here but is really tree plugin related */
 struct switch_record *switch_record_table = NULL;
 int switch_record_cnt = 0;
+int *node_switch_offset = NULL;
+int *node_switch_inx = NULL;
+int *leaf_switch_inx = NULL;
+int  leaf_switch_cnt = 0;
 
 /* ************************************************************************ */
 /*  TAG(                        slurm_topo_ops_t                         )  */
@@ -234,6 +239,59 @@ done:
 	return retval;
 }
 
+static void _free_switch_index(void)
+{
+	xfree(node_switch_offset);
+	xfree(node_switch_inx);
+	xfree(leaf_switch_inx);
+	leaf_switch_cnt = 0;
+}
+
+/* (re)build node_switch_offset, node_switch_inx and leaf_switch_inx from
+ * switch_record_table, every node_bitmap of which is node_record_count
+ * bits long */
+static void _build_switch_index(void)
+{
+	int i, j, first, last, *next;
+
+	_free_switch_index();
+	if (!switch_record_cnt || !switch_record_table)
+		return;
+
+	node_switch_offset = xmalloc((node_record_count+1) * sizeof(int));
+	leaf_switch_inx = xmalloc(switch_record_cnt * sizeof(int));
+	for (j = 0; j < switch_record_cnt; j++) {
+		if (switch_record_table[j].level == 0)
+			leaf_switch_inx[leaf_switch_cnt++] = j;
+		if (!switch_record_table[j].node_bitmap)
+			continue;
+		first = bit_ffs(switch_record_table[j].node_bitmap);
+		last  = bit_fls(switch_record_table[j].node_bitmap);
+		for (i = first; ((i <= last) && (first >= 0)); i++) {
+			if (bit_test(switch_record_table[j].node_bitmap, i))
+				node_switch_offset[i+1]++;
+		}
+	}
+	for (i = 0; i < node_record_count; i++)
+		node_switch_offset[i+1] += node_switch_offset[i];
+
+	node_switch_inx = xmalloc((node_switch_offset[node_record_count] + 1) *
+				  sizeof(int));
+	next = xmalloc((node_record_count+1) * sizeof(int));
+	memcpy(next, node_switch_offset, node_record_count * sizeof(int));
+	for (j = 0; j < switch_record_cnt; j++) {
+		if (!switch_record_table[j].node_bitmap)
+			continue;
+		first = bit_ffs(switch_record_table[j].node_bitmap);
+		last  = bit_fls(switch_record_table[j].node_bitmap);
+		for (i = first; ((i <= last) && (first >= 0)); i++) {
+			if (bit_test(switch_record_table[j].node_bitmap, i))
+				node_switch_inx[next[i]++] = j;
+		}
+	}
+	xfree(next);
+}
+
 /* *********************************************************************** */
 /*  TAG(                        slurm_topo_fini                         )  */
 /* *********************************************************************** */
@@ -242,6 +300,7 @@ slurm_topo_fini( void )
 {
 	int rc;
 
+	_free_switch_index();
 	if (!g_topo_context)
 		return SLURM_SUCCESS;
 
@@ -265,6 +324,7 @@ slurm_topo_build_config( void )
 
 	START_TIMER;
 	rc = (*(g_topo_context->ops.build_config))();
+	_build_switch_index();
 	END_TIMER3("slurm_topo_build_config", 20000);
 
 	return rc;
@@ -59,6 +59,15 @@ struct switch_record {
 extern struct switch_record *switch_record_table;  /* ptr to switch records */
 extern int switch_record_cnt;		/* size of switch_record_table */
 
+/* Switches holding each node, built from switch_record_table by
+ * slurm_topo_build_config(): the switch_record_table indexes of node n are
+ * node_switch_inx[node_switch_offset[n]] up to, but excluding,
+ * node_switch_inx[node_switch_offset[n+1]] */
+extern int *node_switch_offset;
+extern int *node_switch_inx;
+extern int *leaf_switch_inx;		/* indexes of leaf switches */
+extern int  leaf_switch_cnt;		/* size of leaf_switch_inx */
+
 /*****************************************************************************\
  *  Slurm topology functions
 \*****************************************************************************/
@@ -228,6 +228,8 @@
 
 /* pack.[ch] functions */
 #define	create_buf		slurm_create_buf
+#define	create_mmap_buf		slurm_create_mmap_buf
+#define	buf_intern_strings	slurm_buf_intern_strings
 #define	free_buf		slurm_free_buf
 #define grow_buf		slurm_grow_buf
 #define	init_buf		slurm_init_buf
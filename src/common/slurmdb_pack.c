@@ -3873,6 +3873,11 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t rpc_version, Buf buffer)
 			pack32(NO_VAL, buffer);
 			pack16(0, buffer);
 			pack16(0, buffer);
+			if(rpc_version >= 10) {
+				packnull(buffer);
+				pack32(0, buffer);
+				pack32(0, buffer);
+			}
 			return;
 		}
 
@@ -4044,6 +4049,12 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t rpc_version, Buf buffer)
 
 		pack16(object->without_steps, buffer);
 		pack16(object->without_usage_truncation, buffer);
+
+		if(rpc_version >= 10) {
+			packstr(object->page_cluster, buffer);
+			pack32(object->page_job_id, buffer);
+			pack32(object->page_size, buffer);
+		}
 	} else if(rpc_version >= 6) {
 		if(!object) {
 			pack32(NO_VAL, buffer);
@@ -4391,6 +4402,13 @@ extern int slurmdb_unpack_job_cond(void **object, uint16_t rpc_version,
 
 		safe_unpack16(&object_ptr->without_steps, buffer);
 		safe_unpack16(&object_ptr->without_usage_truncation, buffer);
+
+		if(rpc_version >= 10) {
+			safe_unpackstr_xmalloc(&object_ptr->page_cluster,
+					       &uint32_tmp, buffer);
+			safe_unpack32(&object_ptr->page_job_id, buffer);
+			safe_unpack32(&object_ptr->page_size, buffer);
+		}
 	} else if(rpc_version >= 6) {
 		safe_unpack32(&count, buffer);
 		if(count != NO_VAL) {
@@ -76,6 +76,8 @@ int _file_read_uint64s(char* file_path, uint64_t** pvalues, int* pnb);
 int _file_write_uint64s(char* file_path, uint64_t* values, int nb);
 int _file_read_content(char* file_path, char** content, size_t *csize);
 int _file_write_content(char* file_path, char* content, size_t csize);
+int _file_write_content_at(int dfd, char* dir_path, char* file_name,
+			   char* content, size_t csize);
 
 
 /*
@@ -363,6 +365,7 @@ int xcgroup_create(xcgroup_ns_t* cgns, xcgroup_t* cg,
 	cg->path = xstrdup(file_path);
 	cg->uid = uid;
 	cg->gid = gid;
+	cg->created = 0;
 
 	return XCGROUP_SUCCESS;
 }
@@ -448,7 +451,9 @@ int xcgroup_instanciate(xcgroup_t* cg)
 			umask(omask);
 			return fstatus;
 		}
-	}
+		cg->created = 0;
+	} else
+		cg->created = 1;
 	umask(omask);
 
 	/* change cgroup ownership as requested */
@@ -462,6 +467,11 @@ int xcgroup_instanciate(xcgroup_t* cg)
 	 * failure so set output status to success */
 	fstatus = XCGROUP_SUCCESS;
 
+	/* an already existing cgroup got its notify on release flag
+	 * when it was created by a previous step of the job */
+	if (!cg->created)
+		return fstatus;
+
 	/* set notify on release flag */
 	if (notify && cgns->notify_prog)
 		xcgroup_set_params(cg, "notify_on_release=1");
@@ -497,6 +507,7 @@ int xcgroup_load(xcgroup_ns_t* cgns, xcgroup_t* cg, char* uri)
 	cg->path = xstrdup(file_path);
 	cg->uid = buf.st_uid;
 	cg->gid = buf.st_gid;
+	cg->created = 0;
 
 	return XCGROUP_SUCCESS;
 }
@@ -549,6 +560,58 @@ xcgroup_get_pids(xcgroup_t* cg, pid_t **pids, int *npids)
 	return fstatus;
 }
 
+int xcgroup_is_empty(xcgroup_t* cg)
+{
+	char* cpath = cg->path;
+	char file_path[PATH_MAX];
+	char c;
+	int fd, rc;
+
+	if (snprintf(file_path, PATH_MAX, "%s/tasks",
+		      cpath) >= PATH_MAX) {
+		debug2("unable to build tasks file path of '%s' : %m", cpath);
+		return -1;
+	}
+
+	/* a removed cgroup is empty */
+	if ((fd = open(file_path, O_RDONLY)) < 0)
+		return (errno == ENOENT) ? 1 : -1;
+
+	/* no need to read the whole list, a single byte tells */
+	do {
+		rc = read(fd, &c, 1);
+	} while (rc < 0 && errno == EINTR);
+	close(fd);
+
+	if (rc < 0) {
+		debug2("unable to read '%s' : %m", file_path);
+		return -1;
+	}
+	return (rc == 0) ? 1 : 0;
+}
+
+int xcgroup_wait_empty(xcgroup_t* cg, int timeout)
+{
+	int delay = 10, waited = 0;
+	int rc;
+
+	/* cgroup only notifies the release agent when it becomes empty, so
+	 * poll the tasks file, starting with a delay short enough to not
+	 * slow down the common case of tasks exiting right after a kill */
+	while ((rc = xcgroup_is_empty(cg)) == 0) {
+		if (waited >= timeout)
+			return XCGROUP_ERROR;
+		if (delay > timeout - waited)
+			delay = timeout - waited;
+		usleep(delay * 1000);
+		waited += delay;
+		if (delay < 1000)
+			delay *= 2;
+	}
+
+	return (rc == 1) ? XCGROUP_SUCCESS : XCGROUP_ERROR;
+}
+
 int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 {
 	int fstatus = XCGROUP_ERROR;
@@ -558,9 +621,13 @@ int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 	char* value;
 	char* p;
 	char* next;
+	int dfd;
 
 	params = (char*) xstrdup(parameters);
 
+	/* resolve the cgroup directory once for all the parameters */
+	dfd = open(cpath, O_RDONLY | O_DIRECTORY);
+
 	p = params;
 	while (p != NULL && *p != '\0') {
 		next = index(p, ' ');
@@ -574,14 +641,19 @@ int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 		if (value != NULL) {
 			*value='\0';
 			value++;
-			if (snprintf(file_path, PATH_MAX, "%s/%s", cpath, p)
-			     >= PATH_MAX) {
+			if (dfd >= 0) {
+				fstatus = _file_write_content_at(dfd, cpath, p,
+								 value,
+								 strlen(value));
+			} else if (snprintf(file_path, PATH_MAX, "%s/%s",
+					    cpath, p) >= PATH_MAX) {
 				debug2("unable to build filepath for '%s' and"
 				       " parameter '%s' : %m", cpath, p);
 				goto next_loop;
+			} else {
+				fstatus = _file_write_content(file_path, value,
+							      strlen(value));
 			}
-			fstatus = _file_write_content(file_path, value,
-						      strlen(value));
 			if (fstatus != XCGROUP_SUCCESS)
 				debug2("unable to set parameter '%s' to "
 				       "'%s' for '%s'", p, value, cpath);
@@ -595,6 +667,8 @@ int xcgroup_set_params(xcgroup_t* cg, char* parameters)
 		p = next;
 	}
 
+	if (dfd >= 0)
+		close(dfd);
 	xfree(params);
 	return fstatus;
 }
@@ -1060,6 +1134,42 @@ int _file_write_content(char* file_path, char* content, size_t csize)
 	return fstatus;
 }
 
+int _file_write_content_at(int dfd, char* dir_path, char* file_name,
+			   char* content, size_t csize)
+{
+	int fstatus;
+	int rc;
+	int fd;
+
+	/* open file for writing relative to the cgroup directory */
+	fd = openat(dfd, file_name, O_WRONLY, 0700);
+	if (fd < 0) {
+		debug2("unable to open '%s/%s' for writing : %m",
+		       dir_path, file_name);
+		return XCGROUP_ERROR;
+	}
+
+	/* write content */
+	do {
+		rc = write(fd, content, csize);
+	}
+	while (rc < 0 && errno == EINTR);
+
+	/* check written size */
+	if (rc < (int) csize) {
+		debug2("unable to write %lu bytes to file '%s/%s' : %m",
+		       (long unsigned int) csize, dir_path, file_name);
+		fstatus = XCGROUP_ERROR;
+	}
+	else
+		fstatus = XCGROUP_SUCCESS;
+
+	/* close file */
+	close(fd);
+
+	return fstatus;
+}
+
 int _file_read_content(char* file_path, char** content, size_t *csize)
 {
 	int fstatus;
@@ -70,6 +70,8 @@ typedef struct xcgroup {
 	uid_t uid;        /* uid of the owner */
 	gid_t gid;        /* gid of the owner */
 	int   fd;         /* used for locking */
+	int   created;    /* set if instanciate made the directory, not
+			   * set if it already existed */
 
 } xcgroup_t;
 
@@ -170,6 +172,10 @@ int xcgroup_unlock(xcgroup_t* cg);
 /*
  * instanciate a cgroup in a cgroup namespace (mkdir)
  *
+ * cg->created tells whether the cgroup was made by this call or
+ * already existed (previous step of the same job), in which case
+ * its parameters do not need to be set again
+ *
  * returned values:
  *  - XCGROUP_ERROR
  *  - XCGROUP_SUCCESS
@@ -215,6 +221,25 @@ int xcgroup_add_pids(xcgroup_t* cg,pid_t* pids,int npids);
  */
 int xcgroup_get_pids(xcgroup_t* cg, pid_t **pids, int *npids);
 
+/*
+ * test if a cgroup has no more tasks (a removed cgroup is empty)
+ *
+ * returned values:
+ *  - -1 on error
+ *  - 0 if not empty
+ *  - 1 if empty
+ */
+int xcgroup_is_empty(xcgroup_t* cg);
+
+/*
+ * wait up to timeout milliseconds for a cgroup to have no more tasks
+ *
+ * returned values:
+ *  - XCGROUP_ERROR
+ *  - XCGROUP_SUCCESS
+ */
+int xcgroup_wait_empty(xcgroup_t* cg, int timeout);
+
 /*
  * set cgroup parameters using string of the form :
  * parameteres="param=value[ param=value]*"
@@ -224,6 +249,9 @@ int xcgroup_get_pids(xcgroup_t* cg, pid_t **pids, int *npids);
  *
  * i.e. xcgroup_set_params(&cg,"memory.swappiness=10");
  *
+ * the cgroup directory is only looked up once for all the parameters,
+ * which are written in the given order
+ *
  * returned values:
  *  - XCGROUP_ERROR
  *  - XCGROUP_SUCCESS
@@ -48,7 +48,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <ctype.h>
+#include <dirent.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
@@ -63,6 +65,7 @@
 #include "xcpuinfo.h"
 
 static char* _cpuinfo_path = "/proc/cpuinfo";
+static char* _numa_node_path = "/sys/devices/system/node";
 
 static int _compute_block_map(uint16_t numproc,
 			      uint16_t **block_map, uint16_t **block_map_inv);
@@ -79,6 +82,12 @@ uint16_t procs, sockets, cores, threads=1;
 uint16_t block_map_size;
 uint16_t *block_map, *block_map_inv;
 
+/* topology handed over by the caller, see xcpuinfo_preload() */
+static bool     preloaded = false;
+static uint16_t pre_procs, pre_sockets, pre_cores, pre_threads;
+static uint16_t pre_block_map_size;
+static uint16_t *pre_block_map = NULL, *pre_block_map_inv = NULL;
+
 /*
  * get_procs - Return the count of procs on this system
  * Input: procs - buffer for the CPU count
@@ -459,6 +468,63 @@ get_cpuinfo(uint16_t numproc,
 	return retval;
 }
 
+/*
+ * get_numa_map - Return the NUMA node of each CPU on this system, as
+ *	listed by the kernel under /sys/devices/system/node
+ * Input:  numproc - number of processors on the system
+ * Output: numa_map - machine CPU ID->NUMA node ID map, NULL if the
+ *		      system does not report its NUMA nodes
+ *         return code - 0 if no error, otherwise errno
+ * NOTE: User must xfree numa_map
+ */
+extern int
+get_numa_map(uint16_t numproc, uint16_t **numa_map)
+{
+	DIR *dir;
+	struct dirent *ent;
+	FILE *fp;
+	char path[PATH_MAX], buffer[4096];
+	uint16_t *cpus_map, i;
+	int node, nodes = 0;
+
+	*numa_map = NULL;
+	if (!numproc || !(dir = opendir(_numa_node_path)))
+		return 0;
+
+	*numa_map = xmalloc(numproc * sizeof(uint16_t));
+	cpus_map = xmalloc(numproc * sizeof(uint16_t));
+	while ((ent = readdir(dir))) {
+		if (strncmp(ent->d_name, "node", 4) ||
+		    !isdigit((int) ent->d_name[4]))
+			continue;
+		node = atoi(ent->d_name + 4);
+		snprintf(path, sizeof(path), "%s/%s/cpulist",
+			 _numa_node_path, ent->d_name);
+		if (!(fp = fopen(path, "r")))
+			continue;
+		if (fgets(buffer, sizeof(buffer), fp)) {
+			buffer[strcspn(buffer, "\n")] = '\0';
+			memset(cpus_map, 0, numproc * sizeof(uint16_t));
+			if (_range_to_map(buffer, cpus_map, numproc, 0)
+			    == XCPUINFO_SUCCESS) {
+				for (i = 0; i < numproc; i++) {
+					if (cpus_map[i])
+						(*numa_map)[i] = node;
+				}
+				nodes++;
+			} else
+				error("get_numa_map: bad cpulist in %s", path);
+		}
+		fclose(fp);
+	}
+	closedir(dir);
+	xfree(cpus_map);
+
+	if (nodes == 0)
+		xfree(*numa_map);
+	return 0;
+}
+
 /* _chk_cpuinfo_str
  *	check a line of cpuinfo data (buffer) for a keyword.  If it
  *	exists, return the string value for that keyword in *valptr.
@@ -676,6 +742,22 @@ xcpuinfo_init()
 	if ( initialized )
 		return XCPUINFO_SUCCESS;
 
+	if ( preloaded ) {
+		procs = pre_procs;
+		sockets = pre_sockets;
+		cores = pre_cores;
+		threads = pre_threads;
+		block_map_size = pre_block_map_size;
+		block_map = xmalloc(block_map_size * sizeof(uint16_t));
+		memcpy(block_map, pre_block_map,
+		       block_map_size * sizeof(uint16_t));
+		block_map_inv = xmalloc(block_map_size * sizeof(uint16_t));
+		memcpy(block_map_inv, pre_block_map_inv,
+		       block_map_size * sizeof(uint16_t));
+		initialized = true ;
+		return XCPUINFO_SUCCESS;
+	}
+
 	if ( get_procs(&procs) )
 		return XCPUINFO_ERROR;
 
@@ -703,6 +785,31 @@ xcpuinfo_fini()
 	return XCPUINFO_SUCCESS;
 }
 
+int
+xcpuinfo_preload(uint16_t nprocs, uint16_t nsockets, uint16_t ncores,
+		 uint16_t nthreads, uint16_t map_size,
+		 uint16_t *map, uint16_t *map_inv)
+{
+	if ( map_size == 0 || map == NULL || map_inv == NULL )
+		return XCPUINFO_ERROR;
+
+	xfree(pre_block_map);
+	xfree(pre_block_map_inv);
+
+	pre_procs = nprocs;
+	pre_sockets = nsockets;
+	pre_cores = ncores;
+	pre_threads = nthreads;
+	pre_block_map_size = map_size;
+	pre_block_map = xmalloc(map_size * sizeof(uint16_t));
+	memcpy(pre_block_map, map, map_size * sizeof(uint16_t));
+	pre_block_map_inv = xmalloc(map_size * sizeof(uint16_t));
+	memcpy(pre_block_map_inv, map_inv, map_size * sizeof(uint16_t));
+	preloaded = true ;
+
+	return XCPUINFO_SUCCESS;
+}
+
 int
 xcpuinfo_abs_to_mac(char* lrange,char** prange)
 {
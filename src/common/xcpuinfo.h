@@ -49,6 +49,7 @@ extern int get_cpuinfo(uint16_t numproc,
 		       uint16_t *sockets, uint16_t *cores, uint16_t *threads,
 		       uint16_t *block_map_size,
 		       uint16_t **block_map, uint16_t **block_map_inv);
+extern int get_numa_map(uint16_t numproc, uint16_t **numa_map);
 
 /*
  * Initialize xcpuinfo internal data
@@ -68,6 +69,21 @@ int xcpuinfo_init();
  */
 int xcpuinfo_fini();
 
+/*
+ * Provide xcpuinfo with a topology already discovered by the caller
+ * (slurmstepd gets the one slurmd computed at startup), so that later
+ * xcpuinfo_init() calls use it instead of probing the node again
+ *
+ * the given maps are copied
+ *
+ * returned values:
+ *  - XCPUINFO_ERROR
+ *  - XCPUINFO_SUCCESS
+ */
+int xcpuinfo_preload(uint16_t nprocs, uint16_t nsockets, uint16_t ncores,
+		     uint16_t nthreads, uint16_t map_size,
+		     uint16_t *map, uint16_t *map_inv);
+
 /*
  * Use xcpuinfo internal data to convert an abstract range
  * of cores (slurm internal format) into the machine one
@@ -2703,6 +2703,42 @@ extern int jobacct_storage_p_step_complete(mysql_conn_t *mysql_conn,
 	return as_mysql_step_complete(mysql_conn, step_ptr);
 }
 
+/*
+ * load into the storage the start of a list of job steps
+ */
+extern int jobacct_storage_p_step_start_mult(mysql_conn_t *mysql_conn,
+					     List step_list)
+{
+	return as_mysql_step_start_mult(mysql_conn, step_list);
+}
+
+/*
+ * load into the storage the end of a list of job steps
+ */
+extern int jobacct_storage_p_step_complete_mult(mysql_conn_t *mysql_conn,
+						List step_list)
+{
+	return as_mysql_step_complete_mult(mysql_conn, step_list);
+}
+
+/*
+ * load into the storage the start of a list of jobs
+ */
+extern int jobacct_storage_p_job_start_mult(mysql_conn_t *mysql_conn,
+					    List job_list)
+{
+	return as_mysql_job_start_mult(mysql_conn, job_list);
+}
+
+/*
+ * load into the storage the end of a list of jobs
+ */
+extern int jobacct_storage_p_job_complete_mult(mysql_conn_t *mysql_conn,
+					       List job_list)
+{
+	return as_mysql_job_complete_mult(mysql_conn, job_list);
+}
+
 /*
  * load into the storage a suspention of a job
  */
@@ -44,6 +44,22 @@
 #include "src/common/parse_time.h"
 #include "src/common/jobacct_common.h"
 
+/* Once the rows of a multiple row statement get this long send them off
+ * and start a new statement so we stay well under max_allowed_packet */
+#define MULT_QUERY_MAX	(512 * 1024)
+
+/* Fields of the job table row written for a job start */
+typedef struct {
+	char *block_id;
+	char *jname;
+	int node_cnt;
+	char *node_inx;
+	char *nodes;
+	char temp_bit[BUF_SIZE];
+	int track_steps;
+	uint32_t wckeyid;
+} job_start_fields_t;
+
 /* Used in job functions for getting the database index based off the
  * submit time, job and assoc id.  0 is returned if none is found
  */
@@ -206,6 +222,67 @@ no_wckeyid:
 	return wckeyid;
 }
 
+/* Fill in the fields of the job table row for a job start which don't
+ * depend upon its times. Free with _job_start_fields_free(). */
+static void _job_start_fields(mysql_conn_t *mysql_conn,
+			      struct job_record *job_ptr,
+			      job_start_fields_t *fields)
+{
+	memset(fields, 0, sizeof(job_start_fields_t));
+
+	if (job_ptr->name && job_ptr->name[0])
+		fields->jname = slurm_add_slash_to_quotes(job_ptr->name);
+	else {
+		fields->jname = xstrdup("allocation");
+		fields->track_steps = 1;
+	}
+
+	if (job_ptr->nodes && job_ptr->nodes[0])
+		fields->nodes = job_ptr->nodes;
+	else
+		fields->nodes = "None assigned";
+
+	if (job_ptr->batch_flag)
+		fields->track_steps = 1;
+
+	if (slurmdbd_conf) {
+		fields->block_id = xstrdup(job_ptr->comment);
+		fields->node_cnt = job_ptr->total_nodes;
+		fields->node_inx = job_ptr->network;
+	} else {
+		if (job_ptr->node_bitmap) {
+			fields->node_inx = bit_fmt(fields->temp_bit,
+						   sizeof(fields->temp_bit),
+						   job_ptr->node_bitmap);
+		}
+#ifdef HAVE_BG
+		select_g_select_jobinfo_get(job_ptr->select_jobinfo,
+					    SELECT_JOBDATA_BLOCK_ID,
+					    &fields->block_id);
+		select_g_select_jobinfo_get(job_ptr->select_jobinfo,
+					    SELECT_JOBDATA_NODE_CNT,
+					    &fields->node_cnt);
+#else
+		fields->node_cnt = job_ptr->total_nodes;
+#endif
+	}
+
+	/* If there is a start_time get the wckeyid.  If the job is
+	 * cancelled before the job starts we also want to grab it. */
+	if (job_ptr->assoc_id
+	    && (job_ptr->start_time || IS_JOB_CANCELLED(job_ptr)))
+		fields->wckeyid = _get_wckeyid(mysql_conn, &job_ptr->wckey,
+					       job_ptr->user_id,
+					       mysql_conn->cluster_name,
+					       job_ptr->assoc_id);
+}
+
+static void _job_start_fields_free(job_start_fields_t *fields)
+{
+	xfree(fields->block_id);
+	xfree(fields->jname);
+}
+
 /* extern functions */
 
 extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
@@ -221,6 +298,7 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 	uint32_t wckeyid = 0;
 	int job_state, node_cnt = 0;
 	uint32_t job_db_inx = job_ptr->db_index;
+	job_start_fields_t fields;
 
 	if ((!job_ptr->details || !job_ptr->details->submit_time)
 	    && !job_ptr->resize_time) {
@@ -349,52 +427,14 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 
 no_rollup_change:
 
-	if (job_ptr->name && job_ptr->name[0])
-		jname = slurm_add_slash_to_quotes(job_ptr->name);
-	else {
-		jname = xstrdup("allocation");
-		track_steps = 1;
-	}
-
-	if (job_ptr->nodes && job_ptr->nodes[0])
-		nodes = job_ptr->nodes;
-	else
-		nodes = "None assigned";
-
-	if (job_ptr->batch_flag)
-		track_steps = 1;
-
-	if (slurmdbd_conf) {
-		block_id = xstrdup(job_ptr->comment);
-		node_cnt = job_ptr->total_nodes;
-		node_inx = job_ptr->network;
-	} else {
-		char temp_bit[BUF_SIZE];
-
-		if (job_ptr->node_bitmap) {
-			node_inx = bit_fmt(temp_bit, sizeof(temp_bit),
-					   job_ptr->node_bitmap);
-		}
-#ifdef HAVE_BG
-		select_g_select_jobinfo_get(job_ptr->select_jobinfo,
-					    SELECT_JOBDATA_BLOCK_ID,
-					    &block_id);
-		select_g_select_jobinfo_get(job_ptr->select_jobinfo,
-					    SELECT_JOBDATA_NODE_CNT,
-					    &node_cnt);
-#else
-		node_cnt = job_ptr->total_nodes;
-#endif
-	}
-
-	/* If there is a start_time get the wckeyid.  If the job is
-	 * cancelled before the job starts we also want to grab it. */
-	if (job_ptr->assoc_id
-	    && (job_ptr->start_time || IS_JOB_CANCELLED(job_ptr)))
-		wckeyid = _get_wckeyid(mysql_conn, &job_ptr->wckey,
-				       job_ptr->user_id,
-				       mysql_conn->cluster_name,
-				       job_ptr->assoc_id);
+	_job_start_fields(mysql_conn, job_ptr, &fields);
+	block_id = fields.block_id;
+	jname = fields.jname;
+	node_cnt = fields.node_cnt;
+	node_inx = fields.node_inx;
+	nodes = fields.nodes;
+	track_steps = fields.track_steps;
+	wckeyid = fields.wckeyid;
 
 	if (!job_ptr->db_index) {
 		if (!begin_time)
@@ -518,8 +558,7 @@ no_rollup_change:
 		rc = mysql_db_query(mysql_conn, query);
 	}
 
-	xfree(block_id);
-	xfree(jname);
+	_job_start_fields_free(&fields);
 	xfree(query);
 
 	/* now we will reset all the steps */
@@ -747,15 +786,388 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	return rc;
 }
 
-extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
-			       struct step_record *step_ptr)
+/* Remove the first stored_cnt records from rec_list after a failure, so
+ * only the records which were not stored are left for the caller */
+static void _remove_stored(List rec_list, int stored_cnt)
+{
+	while (stored_cnt--)
+		(void) list_pop(rec_list);
+}
+
+/* qsort/bsearch function: order jobs by the job table's unique key */
+static int _job_key_cmp(const void *x, const void *y)
+{
+	struct job_record *job1 = *(struct job_record **) x;
+	struct job_record *job2 = *(struct job_record **) y;
+
+	if (job1->job_id != job2->job_id)
+		return (job1->job_id < job2->job_id) ? -1 : 1;
+	if (job1->assoc_id != job2->assoc_id)
+		return (job1->assoc_id < job2->assoc_id) ? -1 : 1;
+	if (job1->details->submit_time != job2->details->submit_time)
+		return (job1->details->submit_time <
+			job2->details->submit_time) ? -1 : 1;
+	return 0;
+}
+
+/* Insert the rows in values of the job table for the job starts in
+ * job_array, then read back the job_db_inx given to each of them */
+static int _job_start_insert(mysql_conn_t *mysql_conn, char *values,
+			     char *job_ids, struct job_record **job_array,
+			     int job_cnt)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	struct job_details key_details;
+	struct job_record key_job, *key_ptr = &key_job, **found;
+	char *query;
+	uint32_t db_index;
+	int i, rc;
+
+	query = xstrdup_printf(
+		"insert into \"%s_%s\" "
+		"(id_job, id_assoc, id_qos, id_wckey, id_user, "
+		"id_group, nodelist, id_resv, timelimit, "
+		"time_eligible, time_submit, time_start, "
+		"job_name, track_steps, state, priority, cpus_req, "
+		"cpus_alloc, nodes_alloc, account, partition, id_block, "
+		"wckey, node_inx) values %s "
+		"on duplicate key update "
+		"id_wckey=VALUES(id_wckey), id_user=VALUES(id_user), "
+		"id_group=VALUES(id_group), nodelist=VALUES(nodelist), "
+		"id_resv=VALUES(id_resv), timelimit=VALUES(timelimit), "
+		"time_submit=VALUES(time_submit), "
+		"time_start=VALUES(time_start), job_name=VALUES(job_name), "
+		"track_steps=VALUES(track_steps), id_qos=VALUES(id_qos), "
+		"state=greatest(state, VALUES(state)), "
+		"priority=VALUES(priority), cpus_req=VALUES(cpus_req), "
+		"cpus_alloc=VALUES(cpus_alloc), "
+		"nodes_alloc=VALUES(nodes_alloc), "
+		"account=ifnull(VALUES(account), account), "
+		"partition=if(VALUES(partition)='', partition, "
+		"VALUES(partition)), "
+		"id_block=ifnull(VALUES(id_block), id_block), "
+		"wckey=if(VALUES(wckey)='', wckey, VALUES(wckey)), "
+		"node_inx=ifnull(VALUES(node_inx), node_inx)",
+		mysql_conn->cluster_name, job_table, values);
+	debug3("%d(%s:%d) query\n%s",
+	       mysql_conn->conn, THIS_FILE, __LINE__, query);
+	rc = mysql_db_query(mysql_conn, query);
+	xfree(query);
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
+	/* Rows of earlier jobs with the same id_job are skipped by the
+	 * search on the rest of the unique key */
+	query = xstrdup_printf("select job_db_inx, id_job, id_assoc, "
+			       "time_submit from \"%s_%s\" where id_job in (%s)",
+			       mysql_conn->cluster_name, job_table, job_ids);
+	debug3("%d(%s:%d) query\n%s",
+	       mysql_conn->conn, THIS_FILE, __LINE__, query);
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(query);
+		return SLURM_ERROR;
+	}
+	xfree(query);
+
+	qsort(job_array, job_cnt, sizeof(struct job_record *), _job_key_cmp);
+	memset(&key_job, 0, sizeof(struct job_record));
+	memset(&key_details, 0, sizeof(struct job_details));
+	key_job.details = &key_details;
+	while ((row = mysql_fetch_row(result))) {
+		key_job.job_id = slurm_atoul(row[1]);
+		key_job.assoc_id = slurm_atoul(row[2]);
+		key_details.submit_time = slurm_atoul(row[3]);
+		found = bsearch(&key_ptr, job_array, job_cnt,
+				sizeof(struct job_record *), _job_key_cmp);
+		if (!found)
+			continue;
+		/* A job can have more than one record in the batch, such
+		 * as its eligible and start records, all share the row */
+		while ((found > job_array) && !_job_key_cmp(found - 1, found))
+			found--;
+		db_index = slurm_atoul(row[0]);
+		while ((found < (job_array + job_cnt)) &&
+		       !_job_key_cmp(found, &key_ptr))
+			(*found++)->db_index = db_index;
+	}
+	mysql_free_result(result);
+
+	for (i = 0; i < job_cnt; i++) {
+		if (!job_array[i]->db_index) {
+			error("as_mysql_job_start_mult: no db_index for "
+			      "job %u", job_array[i]->job_id);
+			rc = SLURM_ERROR;
+		}
+	}
+
+	return rc;
+}
+
+extern int as_mysql_job_start_mult(mysql_conn_t *mysql_conn, List job_list)
+{
+	struct job_record *job_ptr, **job_array;
+	job_start_fields_t fields;
+	ListIterator itr;
+	char *values = NULL, *job_ids = NULL;
+	char *account, *block_id, *node_inx;
+	time_t begin_time, check_time, submit_time;
+	int job_cnt = 0, stored_cnt = 0, rc = SLURM_SUCCESS;
+	bool single;
+
+	if (check_connection(mysql_conn) != SLURM_SUCCESS)
+		return ESLURM_DB_CONNECTION;
+
+	job_array = xmalloc(sizeof(struct job_record *) *
+			    (list_count(job_list) + 1));
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
+		/* Jobs already in the table, resized jobs and jobs from
+		 * before the last rollup go through as_mysql_job_start() */
+		single = (job_ptr->db_index || job_ptr->resize_time ||
+			  IS_JOB_RESIZING(job_ptr) || !job_ptr->details ||
+			  !job_ptr->details->submit_time);
+		if (!single) {
+			begin_time  = job_ptr->details->begin_time;
+			submit_time = job_ptr->details->submit_time;
+			if (job_ptr->start_time)
+				check_time = job_ptr->start_time;
+			else if (begin_time)
+				check_time = begin_time;
+			else
+				check_time = submit_time;
+			slurm_mutex_lock(&rollup_lock);
+			single = (check_time < global_last_rollup);
+			slurm_mutex_unlock(&rollup_lock);
+		}
+		if (single) {
+			/* Store the jobs before it first so the jobs stored
+			 * are always at the head of job_list */
+			if (job_cnt) {
+				rc = _job_start_insert(mysql_conn, values,
+						       job_ids, job_array,
+						       job_cnt);
+				xfree(values);
+				xfree(job_ids);
+				if (rc != SLURM_SUCCESS)
+					break;
+				stored_cnt += job_cnt;
+				job_cnt = 0;
+			}
+			if ((rc = as_mysql_job_start(mysql_conn, job_ptr))
+			    != SLURM_SUCCESS)
+				break;
+			stored_cnt++;
+			continue;
+		}
+
+		if (!begin_time)
+			begin_time = submit_time;
+		_job_start_fields(mysql_conn, job_ptr, &fields);
+		if (job_ptr->account)
+			account = xstrdup_printf("'%s'", job_ptr->account);
+		else
+			account = xstrdup("NULL");
+		if (fields.block_id)
+			block_id = xstrdup_printf("'%s'", fields.block_id);
+		else
+			block_id = xstrdup("NULL");
+		if (fields.node_inx)
+			node_inx = xstrdup_printf("'%s'", fields.node_inx);
+		else
+			node_inx = xstrdup("NULL");
+		xstrfmtcat(values,
+			   "%s(%u, %u, %u, %u, %u, %u, '%s', %u, %u, "
+			   "%ld, %ld, %ld, '%s', %u, %u, %u, %u, %u, %u, "
+			   "%s, '%s', %s, '%s', %s)",
+			   values ? ", " : "",
+			   job_ptr->job_id, job_ptr->assoc_id,
+			   job_ptr->qos_id, fields.wckeyid,
+			   job_ptr->user_id, job_ptr->group_id, fields.nodes,
+			   job_ptr->resv_id, job_ptr->time_limit,
+			   begin_time, submit_time, job_ptr->start_time,
+			   fields.jname, fields.track_steps,
+			   job_ptr->job_state & JOB_STATE_BASE,
+			   job_ptr->priority, job_ptr->details->min_cpus,
+			   job_ptr->total_cpus, fields.node_cnt, account,
+			   job_ptr->partition ? job_ptr->partition : "",
+			   block_id, job_ptr->wckey ? job_ptr->wckey : "",
+			   node_inx);
+		xstrfmtcat(job_ids, "%s%u", job_ids ? ", " : "",
+			   job_ptr->job_id);
+		xfree(account);
+		xfree(block_id);
+		xfree(node_inx);
+		_job_start_fields_free(&fields);
+		job_array[job_cnt++] = job_ptr;
+
+		if (strlen(values) >= MULT_QUERY_MAX) {
+			rc = _job_start_insert(mysql_conn, values, job_ids,
+					       job_array, job_cnt);
+			xfree(values);
+			xfree(job_ids);
+			if (rc != SLURM_SUCCESS)
+				break;
+			stored_cnt += job_cnt;
+			job_cnt = 0;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	if ((rc == SLURM_SUCCESS) && job_cnt)
+		rc = _job_start_insert(mysql_conn, values, job_ids,
+				       job_array, job_cnt);
+	xfree(values);
+	xfree(job_ids);
+	xfree(job_array);
+	if (rc != SLURM_SUCCESS)
+		_remove_stored(job_list, stored_cnt);
+
+	return rc;
+}
+
+/* Update the rows of the job table for job completions with the selects
+ * in values, end_time is the earliest end time among them */
+static int _job_complete_update(mysql_conn_t *mysql_conn, char *values,
+				time_t end_time)
+{
+	char *query;
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&rollup_lock);
+	if (end_time < global_last_rollup) {
+		global_last_rollup = end_time;
+		slurm_mutex_unlock(&rollup_lock);
+
+		query = xstrdup_printf("update \"%s_%s\" set "
+				       "hourly_rollup=%ld, "
+				       "daily_rollup=%ld, monthly_rollup=%ld",
+				       mysql_conn->cluster_name,
+				       last_ran_table, end_time,
+				       end_time, end_time);
+		debug3("%d(%s:%d) query\n%s",
+		       mysql_conn->conn, THIS_FILE, __LINE__, query);
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		if (rc != SLURM_SUCCESS)
+			return rc;
+	} else
+		slurm_mutex_unlock(&rollup_lock);
+
+	query = xstrdup_printf(
+		"update \"%s_%s\" as t inner join (%s) as v "
+		"on t.job_db_inx=v.job_db_inx "
+		"set t.time_end=v.time_end, t.state=v.state, "
+		"t.nodelist=v.nodelist, "
+		"t.derived_ec=ifnull(v.derived_ec, t.derived_ec), "
+		"t.derived_es=ifnull(v.derived_es, t.derived_es), "
+		"t.exit_code=v.exit_code, t.kill_requid=v.kill_requid",
+		mysql_conn->cluster_name, job_table, values);
+	debug3("%d(%s:%d) query\n%s",
+	       mysql_conn->conn, THIS_FILE, __LINE__, query);
+	rc = mysql_db_query(mysql_conn, query);
+	xfree(query);
+
+	return rc;
+}
+
+extern int as_mysql_job_complete_mult(mysql_conn_t *mysql_conn,
+				      List job_list)
+{
+	struct job_record *job_ptr;
+	ListIterator itr;
+	char *values = NULL, *derived_ec, *derived_es, *comment;
+	time_t end_time = 0;
+	int job_cnt = 0, stored_cnt = 0, rc = SLURM_SUCCESS;
+
+	if (check_connection(mysql_conn) != SLURM_SUCCESS)
+		return ESLURM_DB_CONNECTION;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
+		/* Jobs not yet in the table, resized jobs and jobs which
+		 * never started go through as_mysql_job_complete() */
+		if (!job_ptr->db_index || IS_JOB_RESIZING(job_ptr) ||
+		    !job_ptr->end_time) {
+			/* Store the jobs before it first so the jobs stored
+			 * are always at the head of job_list */
+			if (job_cnt) {
+				rc = _job_complete_update(mysql_conn, values,
+							  end_time);
+				xfree(values);
+				end_time = 0;
+				if (rc != SLURM_SUCCESS)
+					break;
+				stored_cnt += job_cnt;
+				job_cnt = 0;
+			}
+			if ((rc = as_mysql_job_complete(mysql_conn, job_ptr))
+			    != SLURM_SUCCESS)
+				break;
+			stored_cnt++;
+			continue;
+		}
+
+		if (job_ptr->derived_ec != NO_VAL)
+			derived_ec = xstrdup_printf("%u", job_ptr->derived_ec);
+		else
+			derived_ec = xstrdup("NULL");
+		if (job_ptr->comment) {
+			comment = slurm_add_slash_to_quotes(job_ptr->comment);
+			derived_es = xstrdup_printf("'%s'", comment);
+			xfree(comment);
+		} else
+			derived_es = xstrdup("NULL");
+		xstrfmtcat(values,
+			   "%sselect %d as job_db_inx, %ld as time_end, "
+			   "%d as state, '%s' as nodelist, "
+			   "%s as derived_ec, %s as derived_es, "
+			   "%d as exit_code, %d as kill_requid",
+			   values ? " union all " : "",
+			   job_ptr->db_index, job_ptr->end_time,
+			   job_ptr->job_state & JOB_STATE_BASE,
+			   (job_ptr->nodes && job_ptr->nodes[0]) ?
+			   job_ptr->nodes : "None assigned",
+			   derived_ec, derived_es,
+			   job_ptr->exit_code, job_ptr->requid);
+		xfree(derived_ec);
+		xfree(derived_es);
+		if (!end_time || (job_ptr->end_time < end_time))
+			end_time = job_ptr->end_time;
+		job_cnt++;
+
+		if (strlen(values) >= MULT_QUERY_MAX) {
+			rc = _job_complete_update(mysql_conn, values,
+						  end_time);
+			xfree(values);
+			end_time = 0;
+			if (rc != SLURM_SUCCESS)
+				break;
+			stored_cnt += job_cnt;
+			job_cnt = 0;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	if ((rc == SLURM_SUCCESS) && values)
+		rc = _job_complete_update(mysql_conn, values, end_time);
+	xfree(values);
+	if (rc != SLURM_SUCCESS)
+		_remove_stored(job_list, stored_cnt);
+
+	return rc;
+}
+
+/* Fill in the row of the step table for a step start, *values is
+ * left NULL if there is nothing to insert */
+static int _step_start_values(mysql_conn_t *mysql_conn,
+			      struct step_record *step_ptr, char **values)
 {
 	int cpus = 0, tasks = 0, nodes = 0, task_dist = 0;
 	int rc=SLURM_SUCCESS;
 	char node_list[BUFFER_SIZE];
 	char *node_inx = NULL, *step_name = NULL;
 	time_t start_time, submit_time;
-	char *query = NULL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -866,37 +1278,101 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 
 	step_name = slurm_add_slash_to_quotes(step_ptr->name);
 
-	/* we want to print a -1 for the requid so leave it a
-	   %d */
 	/* The stepid could be -2 so use %d not %u */
+	*values = xstrdup_printf(
+		"(%d, %d, %d, '%s', %d, %d, %d, %d, '%s', '%s', %d)",
+		step_ptr->job_ptr->db_index,
+		step_ptr->step_id,
+		(int)start_time, step_name,
+		JOB_RUNNING, cpus, nodes, tasks, node_list, node_inx, task_dist);
+	xfree(step_name);
+
+	return rc;
+}
+
+/* Insert the rows in values of the step table for a step start */
+static int _step_start_insert(mysql_conn_t *mysql_conn, char *values)
+{
+	char *query;
+	int rc;
+
 	query = xstrdup_printf(
 		"insert into \"%s_%s\" (job_db_inx, id_step, time_start, "
 		"step_name, state, "
 		"cpus_alloc, nodes_alloc, task_cnt, nodelist, "
-		"node_inx, task_dist) "
-		"values (%d, %d, %d, '%s', %d, %d, %d, %d, "
-		"'%s', '%s', %d) "
-		"on duplicate key update cpus_alloc=%d, nodes_alloc=%d, "
-		"task_cnt=%d, time_end=0, state=%d, "
-		"nodelist='%s', node_inx='%s', task_dist=%d",
-		mysql_conn->cluster_name, step_table,
-		step_ptr->job_ptr->db_index,
-		step_ptr->step_id,
-		(int)start_time, step_name,
-		JOB_RUNNING, cpus, nodes, tasks, node_list, node_inx, task_dist,
-		cpus, nodes, tasks, JOB_RUNNING,
-		node_list, node_inx, task_dist);
+		"node_inx, task_dist) values %s "
+		"on duplicate key update cpus_alloc=VALUES(cpus_alloc), "
+		"nodes_alloc=VALUES(nodes_alloc), task_cnt=VALUES(task_cnt), "
+		"time_end=0, state=VALUES(state), "
+		"nodelist=VALUES(nodelist), node_inx=VALUES(node_inx), "
+		"task_dist=VALUES(task_dist)",
+		mysql_conn->cluster_name, step_table, values);
 	debug3("%d(%s:%d) query\n%s",
 	       mysql_conn->conn, THIS_FILE, __LINE__, query);
 	rc = mysql_db_query(mysql_conn, query);
 	xfree(query);
-	xfree(step_name);
 
 	return rc;
 }
 
-extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
-				  struct step_record *step_ptr)
+extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
+			       struct step_record *step_ptr)
+{
+	char *values = NULL;
+	int rc;
+
+	rc = _step_start_values(mysql_conn, step_ptr, &values);
+	if ((rc == SLURM_SUCCESS) && values)
+		rc = _step_start_insert(mysql_conn, values);
+	xfree(values);
+
+	return rc;
+}
+
+extern int as_mysql_step_start_mult(mysql_conn_t *mysql_conn,
+				    List step_list)
+{
+	struct step_record *step_ptr;
+	ListIterator itr;
+	char *values = NULL, *row = NULL;
+	int step_cnt = 0, stored_cnt = 0, rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(step_list);
+	while ((step_ptr = list_next(itr))) {
+		if ((rc = _step_start_values(mysql_conn, step_ptr, &row))
+		    != SLURM_SUCCESS)
+			break;
+		step_cnt++;
+		if (!row)
+			continue;
+		if (values)
+			xstrcat(values, ", ");
+		xstrcat(values, row);
+		xfree(row);
+		if (strlen(values) >= MULT_QUERY_MAX) {
+			rc = _step_start_insert(mysql_conn, values);
+			xfree(values);
+			if (rc != SLURM_SUCCESS)
+				break;
+			stored_cnt += step_cnt;
+			step_cnt = 0;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	if ((rc == SLURM_SUCCESS) && values)
+		rc = _step_start_insert(mysql_conn, values);
+	xfree(values);
+	if (rc != SLURM_SUCCESS)
+		_remove_stored(step_list, stored_cnt);
+
+	return rc;
+}
+
+/* Fill in the row of the step table for a step completion as a select
+ * of the new values, *values is left NULL if there is nothing to update */
+static int _step_complete_values(mysql_conn_t *mysql_conn,
+				 struct step_record *step_ptr, char **values)
 {
 	time_t now;
 	int elapsed;
@@ -906,7 +1382,6 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	struct jobacctinfo dummy_jobacct;
 	double ave_vsize = 0, ave_rss = 0, ave_pages = 0;
 	double ave_cpu = 0, ave_cpu2 = 0;
-	char *query = NULL;
 	int rc =SLURM_SUCCESS;
 	uint32_t exit_code = 0;
 	time_t start_time, submit_time;
@@ -1009,22 +1484,21 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	}
 
 	/* The stepid could be -2 so use %d not %u */
-	query = xstrdup_printf(
-		"update \"%s_%s\" set time_end=%d, state=%d, "
-		"kill_requid=%d, exit_code=%d, "
-		"user_sec=%u, user_usec=%u, "
-		"sys_sec=%u, sys_usec=%u, "
-		"max_vsize=%u, max_vsize_task=%u, "
-		"max_vsize_node=%u, ave_vsize=%f, "
-		"max_rss=%u, max_rss_task=%u, "
-		"max_rss_node=%u, ave_rss=%f, "
-		"max_pages=%u, max_pages_task=%u, "
-		"max_pages_node=%u, ave_pages=%f, "
-		"min_cpu=%f, min_cpu_task=%u, "
-		"min_cpu_node=%u, ave_cpu=%f "
-		"where job_db_inx=%d and id_step=%d",
-		mysql_conn->cluster_name, step_table, (int)now,
-		comp_status,
+	*values = xstrdup_printf(
+		"select %d as job_db_inx, %d as id_step, %d as time_end, "
+		"%d as state, %d as kill_requid, %d as exit_code, "
+		"%u as user_sec, %u as user_usec, "
+		"%u as sys_sec, %u as sys_usec, "
+		"%u as max_vsize, %u as max_vsize_task, "
+		"%u as max_vsize_node, %f as ave_vsize, "
+		"%u as max_rss, %u as max_rss_task, "
+		"%u as max_rss_node, %f as ave_rss, "
+		"%u as max_pages, %u as max_pages_task, "
+		"%u as max_pages_node, %f as ave_pages, "
+		"%f as min_cpu, %u as min_cpu_task, "
+		"%u as min_cpu_node, %f as ave_cpu",
+		step_ptr->job_ptr->db_index, step_ptr->step_id,
+		(int)now, comp_status,
 		step_ptr->requid,
 		exit_code,
 		/* user seconds */
@@ -1050,8 +1524,35 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		ave_cpu2,	/* min cpu */
 		jobacct->min_cpu_id.taskid,	/* min cpu task */
 		jobacct->min_cpu_id.nodeid,	/* min cpu node */
-		ave_cpu,	/* ave cpu */
-		step_ptr->job_ptr->db_index, step_ptr->step_id);
+		ave_cpu);	/* ave cpu */
+
+	return rc;
+}
+
+/* Update the rows of the step table for a step completion with the
+ * selects in values. Only existing rows are changed, as with a single
+ * update, so a completion whose step start was lost adds no row. */
+static int _step_complete_update(mysql_conn_t *mysql_conn, char *values)
+{
+	char *query;
+	int rc;
+
+	query = xstrdup_printf(
+		"update \"%s_%s\" as t inner join (%s) as v "
+		"on t.job_db_inx=v.job_db_inx and t.id_step=v.id_step "
+		"set t.time_end=v.time_end, t.state=v.state, "
+		"t.kill_requid=v.kill_requid, t.exit_code=v.exit_code, "
+		"t.user_sec=v.user_sec, t.user_usec=v.user_usec, "
+		"t.sys_sec=v.sys_sec, t.sys_usec=v.sys_usec, "
+		"t.max_vsize=v.max_vsize, t.max_vsize_task=v.max_vsize_task, "
+		"t.max_vsize_node=v.max_vsize_node, t.ave_vsize=v.ave_vsize, "
+		"t.max_rss=v.max_rss, t.max_rss_task=v.max_rss_task, "
+		"t.max_rss_node=v.max_rss_node, t.ave_rss=v.ave_rss, "
+		"t.max_pages=v.max_pages, t.max_pages_task=v.max_pages_task, "
+		"t.max_pages_node=v.max_pages_node, t.ave_pages=v.ave_pages, "
+		"t.min_cpu=v.min_cpu, t.min_cpu_task=v.min_cpu_task, "
+		"t.min_cpu_node=v.min_cpu_node, t.ave_cpu=v.ave_cpu",
+		mysql_conn->cluster_name, step_table, values);
 	debug3("%d(%s:%d) query\n%s",
 	       mysql_conn->conn, THIS_FILE, __LINE__, query);
 	rc = mysql_db_query(mysql_conn, query);
@@ -1060,6 +1561,60 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	return rc;
 }
 
+extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
+				  struct step_record *step_ptr)
+{
+	char *values = NULL;
+	int rc;
+
+	rc = _step_complete_values(mysql_conn, step_ptr, &values);
+	if ((rc == SLURM_SUCCESS) && values)
+		rc = _step_complete_update(mysql_conn, values);
+	xfree(values);
+
+	return rc;
+}
+
+extern int as_mysql_step_complete_mult(mysql_conn_t *mysql_conn,
+				       List step_list)
+{
+	struct step_record *step_ptr;
+	ListIterator itr;
+	char *values = NULL, *row = NULL;
+	int step_cnt = 0, stored_cnt = 0, rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(step_list);
+	while ((step_ptr = list_next(itr))) {
+		if ((rc = _step_complete_values(mysql_conn, step_ptr, &row))
+		    != SLURM_SUCCESS)
+			break;
+		step_cnt++;
+		if (!row)
+			continue;
+		if (values)
+			xstrcat(values, " union all ");
+		xstrcat(values, row);
+		xfree(row);
+		if (strlen(values) >= MULT_QUERY_MAX) {
+			rc = _step_complete_update(mysql_conn, values);
+			xfree(values);
+			if (rc != SLURM_SUCCESS)
+				break;
+			stored_cnt += step_cnt;
+			step_cnt = 0;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	if ((rc == SLURM_SUCCESS) && values)
+		rc = _step_complete_update(mysql_conn, values);
+	xfree(values);
+	if (rc != SLURM_SUCCESS)
+		_remove_stored(step_list, stored_cnt);
+
+	return rc;
+}
+
 extern int as_mysql_suspend(mysql_conn_t *mysql_conn,
 			    uint32_t old_db_inx,
 			    struct job_record *job_ptr)
@@ -58,6 +58,22 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 			       struct step_record *step_ptr);
 
+/* Store the start or end of every step in step_list with a single
+ * insert (or a few for very long lists) instead of one per step */
+extern int as_mysql_step_start_mult(mysql_conn_t *mysql_conn,
+				    List step_list);
+
+extern int as_mysql_step_complete_mult(mysql_conn_t *mysql_conn,
+				       List step_list);
+
+/* Store the start or end of every job in job_list with a few statements
+ * instead of one or more per job */
+extern int as_mysql_job_start_mult(mysql_conn_t *mysql_conn,
+				   List job_list);
+
+extern int as_mysql_job_complete_mult(mysql_conn_t *mysql_conn,
+				      List job_list);
+
 extern int as_mysql_suspend(mysql_conn_t *mysql_conn, uint32_t old_db_inx,
 			    struct job_record *job_ptr);
 
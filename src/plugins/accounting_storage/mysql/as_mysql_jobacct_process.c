@@ -311,7 +311,9 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     char *cluster_name,
 			     char *job_fields, char *step_fields,
 			     char *sent_extra,
-			     bool is_admin, int only_pending, List sent_list)
+			     bool is_admin, int only_pending,
+			     uint32_t page_size, uint32_t *page_job_id,
+			     List sent_list)
 {
 	char *query = NULL;
 	char *extra = xstrdup(sent_extra);
@@ -329,6 +331,8 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	char *prefix="t2";
 	int rc = SLURM_SUCCESS;
 	int last_id = -1, curr_id = -1, last_state = -1;
+	uint32_t page_last_id = 0;
+	bool page_full = false;
 	local_cluster_t *curr_cluster = NULL;
 
 	/* This is here to make sure we are looking at only this user
@@ -388,6 +392,58 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	setup_job_cluster_cond_limits(mysql_conn, job_cond,
 				      cluster_name, &extra);
 
+	/* When paging, resume after the last job id already returned */
+	if (page_size && *page_job_id) {
+		if (extra)
+			xstrfmtcat(extra, " && (t1.id_job > %u)",
+				   *page_job_id);
+		else
+			xstrfmtcat(extra, " where (t1.id_job > %u)",
+				   *page_job_id);
+	}
+
+	/* Pages hold whole jobs: find the last of the next page_size
+	   job ids and take every record of the jobs up to it */
+	if (page_size) {
+		query = xstrdup_printf("select count(*), max(id_job) from "
+				       "(select distinct t1.id_job "
+				       "from \"%s_%s\" as t1 "
+				       "left join \"%s_%s\" as t2 "
+				       "on t1.id_assoc=t2.id_assoc%s "
+				       "order by t1.id_job limit %u) as t3",
+				       cluster_name, job_table,
+				       cluster_name, assoc_table,
+				       extra ? extra : "", page_size);
+		debug3("%d(%s:%d) query\n%s",
+		       mysql_conn->conn, THIS_FILE, __LINE__, query);
+		if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+			xfree(extra);
+			xfree(query);
+			rc = SLURM_ERROR;
+			goto end_it;
+		}
+		xfree(query);
+		row = mysql_fetch_row(result);
+		if (!row || !row[1]) {
+			/* no jobs left in this cluster */
+			mysql_free_result(result);
+			result = NULL;
+			xfree(extra);
+			goto end_it;
+		}
+		page_full = (slurm_atoul(row[0]) >= page_size);
+		page_last_id = slurm_atoul(row[1]);
+		mysql_free_result(result);
+		result = NULL;
+
+		if (extra)
+			xstrfmtcat(extra, " && (t1.id_job <= %u)",
+				   page_last_id);
+		else
+			xstrfmtcat(extra, " where (t1.id_job <= %u)",
+				   page_last_id);
+	}
+
 	query = xstrdup_printf("select %s from \"%s_%s\" as t1 "
 			       "left join \"%s_%s\" as t2 "
 			       "on t1.id_assoc=t2.id_assoc",
@@ -400,9 +456,10 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 
 	/* Here we want to order them this way in such a way so it is
 	   easy to look for duplicates, it is also easy to sort the
-	   resized jobs.
+	   resized jobs.  The order by is what paging relies on.
 	*/
-	xstrcat(query, " group by id_job, time_submit desc");
+	xstrcat(query, " group by id_job, time_submit desc "
+		"order by id_job, time_submit desc");
 
 	debug3("%d(%s:%d) query\n%s",
 	       mysql_conn->conn, THIS_FILE, __LINE__, query);
@@ -813,6 +870,13 @@ end_it:
 	if (local_cluster_list)
 		list_destroy(local_cluster_list);
 
+	/* Tell the caller where the next page starts, 0 if this
+	   cluster has no more jobs to give */
+	if ((rc == SLURM_SUCCESS) && page_full)
+		*page_job_id = page_last_id;
+	else
+		*page_job_id = 0;
+
 	if (rc == SLURM_SUCCESS)
 		list_transfer(sent_list, job_list);
 
@@ -1315,7 +1379,8 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	slurmdb_user_rec_t user;
 	int only_pending = 0;
 	List use_cluster_list = as_mysql_cluster_list;
-	char *cluster_name;
+	char *cluster_name, *page_cluster = NULL;
+	uint32_t page_size = 0;
 
 	memset(&user, 0, sizeof(slurmdb_user_rec_t));
 	user.uid = uid;
@@ -1357,16 +1422,44 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	else
 		slurm_mutex_lock(&as_mysql_cluster_list_lock);
 
+	if (job_cond && job_cond->page_size) {
+		page_size = job_cond->page_size;
+		if (job_cond->page_cluster)
+			page_cluster = job_cond->page_cluster;
+	}
+
 	job_list = list_create(slurmdb_destroy_job_rec);
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
-		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
-					    cluster_name, tmp, tmp2, extra,
-					    is_admin, only_pending, job_list))
-		    != SLURM_SUCCESS)
-			error("Problem getting jobs for cluster %s",
-			      cluster_name);
+		uint32_t page_job_id = 0, page_left = 0;
+
+		/* A paged query resumes in the cluster it stopped in */
+		if (page_cluster) {
+			if (strcmp(cluster_name, page_cluster))
+				continue;
+			page_cluster = NULL;
+			page_job_id = job_cond->page_job_id;
+		}
+
+		/* Keep going past jobs filtered out after the query so
+		   an empty page is only ever returned at the end */
+		do {
+			if (page_size)
+				page_left = page_size - list_count(job_list);
+			if ((rc = _cluster_get_jobs(
+				     mysql_conn, &user, job_cond,
+				     cluster_name, tmp, tmp2, extra,
+				     is_admin, only_pending,
+				     page_left, &page_job_id, job_list))
+			    != SLURM_SUCCESS)
+				error("Problem getting jobs for cluster %s",
+				      cluster_name);
+		} while (page_job_id && !list_count(job_list));
+
+		if (page_size && (page_job_id
+				  || (list_count(job_list) >= page_size)))
+			break;
 	}
 	list_iterator_destroy(itr);
 
@@ -42,9 +42,14 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 
-typedef struct {
+/* Size of the hash tables used to find the usage of an association or
+ * wckey while rolling up an hour, must be a power of 2 */
+#define ID_USAGE_HASH_SIZE 1024
+
+typedef struct local_id_usage {
 	int id;
 	uint64_t a_cpu;
+	struct local_id_usage *next;	/* next entry with same hash index */
 } local_id_usage_t;
 
 typedef struct {
@@ -97,6 +102,29 @@ static void _destroy_local_resv_usage(void *object)
 	}
 }
 
+/* Find the usage record for an id, creating it and adding it to
+ * usage_list if this is the first time the id has been seen */
+static local_id_usage_t *_get_id_usage(local_id_usage_t **usage_hash,
+				       List usage_list, int id)
+{
+	int inx = id & (ID_USAGE_HASH_SIZE - 1);
+	local_id_usage_t *id_usage = usage_hash[inx];
+
+	while (id_usage) {
+		if (id_usage->id == id)
+			return id_usage;
+		id_usage = id_usage->next;
+	}
+
+	id_usage = xmalloc(sizeof(local_id_usage_t));
+	id_usage->id = id;
+	id_usage->next = usage_hash[inx];
+	usage_hash[inx] = id_usage;
+	list_append(usage_list, id_usage);
+
+	return id_usage;
+}
+
 static int _process_purge(mysql_conn_t *mysql_conn,
 			  char *cluster_name,
 			  uint16_t archive_data,
@@ -449,7 +477,8 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				  char *cluster_name,
 				  time_t start, time_t end,
-				  uint16_t archive_data)
+				  uint16_t archive_data,
+				  bool save_progress)
 {
 	int rc = SLURM_SUCCESS;
 	int add_sec = 3600;
@@ -468,6 +497,10 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	List cluster_down_list = list_create(_destroy_local_cluster_usage);
 	List wckey_usage_list = list_create(_destroy_local_id_usage);
 	List resv_usage_list = list_create(_destroy_local_resv_usage);
+	local_id_usage_t **assoc_usage_hash =
+		xmalloc(sizeof(local_id_usage_t *) * ID_USAGE_HASH_SIZE);
+	local_id_usage_t **wckey_usage_hash =
+		xmalloc(sizeof(local_id_usage_t *) * ID_USAGE_HASH_SIZE);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	/* char start_char[20], end_char[20]; */
 
@@ -769,9 +802,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 
 			if (last_id != assoc_id) {
-				a_usage = xmalloc(sizeof(local_id_usage_t));
-				a_usage->id = assoc_id;
-				list_append(assoc_usage_list, a_usage);
+				a_usage = _get_id_usage(assoc_usage_hash,
+							assoc_usage_list,
+							assoc_id);
 				last_id = assoc_id;
 			}
 
@@ -782,19 +815,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
-
-				if (!w_usage) {
-					w_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					w_usage->id = wckey_id;
-					list_append(wckey_usage_list,
-						    w_usage);
-				}
-
+				w_usage = _get_id_usage(wckey_usage_hash,
+							wckey_usage_list,
+							wckey_id);
 				last_wckeyid = wckey_id;
 			}
 			w_usage->a_cpu += seconds * row_acpu;
@@ -945,21 +968,10 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			tmp_itr = list_iterator_create(r_usage->local_assocs);
 			while ((assoc = list_next(tmp_itr))) {
 				uint32_t associd = slurm_atoul(assoc);
-				if (last_id != associd) {
-					list_iterator_reset(a_itr);
-					while ((a_usage = list_next(a_itr))) {
-						if (!a_usage->id == associd) {
-							last_id = a_usage->id;
-							break;
-						}
-					}
-				}
-
-				if (!a_usage) {
-					a_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					a_usage->id = associd;
-					list_append(assoc_usage_list, a_usage);
+				if ((last_id != associd) || !a_usage) {
+					a_usage = _get_id_usage(
+						assoc_usage_hash,
+						assoc_usage_list, associd);
 					last_id = associd;
 				}
 
@@ -1073,6 +1085,32 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		list_flush(cluster_down_list);
 		list_flush(wckey_usage_list);
 		list_flush(resv_usage_list);
+		memset(assoc_usage_hash, 0,
+		       sizeof(local_id_usage_t *) * ID_USAGE_HASH_SIZE);
+		memset(wckey_usage_hash, 0,
+		       sizeof(local_id_usage_t *) * ID_USAGE_HASH_SIZE);
+
+		/* Commit each hour as it is done so an interrupted
+		   rollup picks up where it left off instead of
+		   starting over from the beginning. */
+		if (save_progress) {
+			query = xstrdup_printf(
+				"update \"%s_%s\" set hourly_rollup=%ld",
+				cluster_name, last_ran_table, curr_end);
+			debug3("%d(%s:%d) query\n%s",
+			       mysql_conn->conn, THIS_FILE, __LINE__, query);
+			rc = mysql_db_query(mysql_conn, query);
+			xfree(query);
+			if ((rc == SLURM_SUCCESS)
+			    && mysql_db_commit(mysql_conn))
+				rc = SLURM_ERROR;
+			if (rc != SLURM_SUCCESS) {
+				error("Couldn't save hour rollup progress "
+				      "for cluster %s", cluster_name);
+				goto end_it;
+			}
+		}
+
 		curr_start = curr_end;
 		curr_end = curr_start + add_sec;
 	}
@@ -1089,6 +1127,8 @@ end_it:
 	list_destroy(cluster_down_list);
 	list_destroy(wckey_usage_list);
 	list_destroy(resv_usage_list);
+	xfree(assoc_usage_hash);
+	xfree(wckey_usage_hash);
 
 /* 	info("stop start %s", ctime(&curr_start)); */
 /* 	info("stop end %s", ctime(&curr_end)); */
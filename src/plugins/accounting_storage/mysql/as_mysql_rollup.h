@@ -44,11 +44,16 @@
 
 #include "accounting_storage_mysql.h"
 
+/* as_mysql_hourly_rollup - roll up usage for each hour from start to end
+ * IN save_progress - commit after each hour and record it in the
+ *	last_ran_table so an interrupted rollup resumes where it stopped
+ */
 extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				  char *cluster_name, 
 				  time_t start,
 				  time_t end,
-				  uint16_t archive_data);
+				  uint16_t archive_data,
+				  bool save_progress);
 extern int as_mysql_daily_rollup(mysql_conn_t *mysql_conn,
 			      char *cluster_name,
 				 time_t start, 
@@ -45,6 +45,14 @@ pthread_mutex_t rollup_lock = PTHREAD_MUTEX_INITIALIZER;
 
 static pthread_mutex_t usage_rollup_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/* Hourly catch-up longer than this is split into windows that are
+ * rolled up in parallel, each with its own database connection. */
+#define ROLLUP_WINDOW_SECS	(24 * 60 * 60)
+/* Most windows of one cluster rolled up at the same time */
+#define ROLLUP_WINDOW_THREADS	4
+/* Most clusters rolled up at the same time */
+#define ROLLUP_CLUSTER_THREADS	4
+
 typedef struct {
 	uint16_t archive_data;
 	char *cluster_name;
@@ -57,6 +65,128 @@ typedef struct {
 	time_t sent_start;
 } local_rollup_t;
 
+typedef struct {
+	uint16_t archive_data;
+	char *cluster_name;
+	mysql_conn_t *mysql_conn;
+	int rc;
+	time_t start;
+	time_t end;
+} local_window_t;
+
+/* Roll up the hours of one window with its own connection and commit
+ * them on success. */
+static void *_hourly_window_rollup(void *arg)
+{
+	local_window_t *window = (local_window_t *)arg;
+	mysql_conn_t mysql_conn;
+
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = window->mysql_conn->conn;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	/* Each thread needs it's own connection we can't use the one
+	 * sent from the parent thread. */
+	window->rc = check_connection(&mysql_conn);
+	if (window->rc == SLURM_SUCCESS)
+		window->rc = as_mysql_hourly_rollup(&mysql_conn,
+						    window->cluster_name,
+						    window->start, window->end,
+						    window->archive_data,
+						    false);
+
+	if (window->rc == SLURM_SUCCESS) {
+		if (mysql_db_commit(&mysql_conn)) {
+			error("Couldn't commit hourly rollup of cluster %s",
+			      window->cluster_name);
+			window->rc = SLURM_ERROR;
+		}
+	} else if (mysql_db_rollback(&mysql_conn))
+		error("rollback failed");
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	return NULL;
+}
+
+/* Roll up the hours between hour_start and hour_end.  Each hour only
+ * depends on the raw data in that hour, so a long catch-up is split
+ * into windows rolled up in parallel.  The windows are run in rounds
+ * and the hourly_rollup mark is moved past each round once it is
+ * committed, so an interrupted catch-up resumes from there.  A short
+ * span is rolled up on mysql_conn, committing hour by hour.
+ */
+static int _hourly_rollup_windows(mysql_conn_t *mysql_conn,
+				  local_rollup_t *local_rollup,
+				  time_t hour_start, time_t hour_end)
+{
+	local_window_t windows[ROLLUP_WINDOW_THREADS];
+	pthread_t window_tids[ROLLUP_WINDOW_THREADS];
+	pthread_attr_t window_attr;
+	bool save_progress = !local_rollup->sent_end;
+	time_t curr_start = hour_start;
+	char *query = NULL;
+	int i, window_cnt, rc = SLURM_SUCCESS;
+
+	if ((hour_end - hour_start) <= ROLLUP_WINDOW_SECS)
+		return as_mysql_hourly_rollup(mysql_conn,
+					      local_rollup->cluster_name,
+					      hour_start, hour_end,
+					      local_rollup->archive_data,
+					      save_progress);
+
+	while ((rc == SLURM_SUCCESS) && (curr_start < hour_end)) {
+		memset(windows, 0, sizeof(windows));
+		for (window_cnt = 0; (window_cnt < ROLLUP_WINDOW_THREADS)
+			     && (curr_start < hour_end); window_cnt++) {
+			windows[window_cnt].cluster_name =
+				local_rollup->cluster_name;
+			windows[window_cnt].mysql_conn = mysql_conn;
+			windows[window_cnt].start = curr_start;
+			curr_start += ROLLUP_WINDOW_SECS;
+			if (curr_start > hour_end)
+				curr_start = hour_end;
+			windows[window_cnt].end = curr_start;
+		}
+		/* Only purge once, after the last window */
+		if (curr_start == hour_end)
+			windows[window_cnt - 1].archive_data =
+				local_rollup->archive_data;
+
+		for (i = 0; i < window_cnt; i++) {
+			slurm_attr_init(&window_attr);
+			if (pthread_create(&window_tids[i], &window_attr,
+					   _hourly_window_rollup,
+					   (void *)&windows[i]))
+				fatal("pthread_create: %m");
+			slurm_attr_destroy(&window_attr);
+		}
+		for (i = 0; i < window_cnt; i++) {
+			pthread_join(window_tids[i], NULL);
+			if (windows[i].rc != SLURM_SUCCESS)
+				rc = windows[i].rc;
+		}
+
+		if ((rc != SLURM_SUCCESS) || !save_progress)
+			continue;
+
+		query = xstrdup_printf(
+			"update \"%s_%s\" set hourly_rollup=%ld",
+			local_rollup->cluster_name, last_ran_table,
+			curr_start);
+		debug3("%d(%s:%d) query\n%s",
+		       mysql_conn->conn, THIS_FILE, __LINE__, query);
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		if ((rc == SLURM_SUCCESS) && mysql_db_commit(mysql_conn))
+			rc = SLURM_ERROR;
+	}
+
+	return rc;
+}
+
 static void *_cluster_rollup_usage(void *arg)
 {
 	local_rollup_t *local_rollup = (local_rollup_t *)arg;
@@ -296,11 +426,8 @@ static void *_cluster_rollup_usage(void *arg)
 
 	if ((hour_end - hour_start) > 0) {
 		START_TIMER;
-		rc = as_mysql_hourly_rollup(&mysql_conn,
-					    local_rollup->cluster_name,
-					    hour_start,
-					    hour_end,
-					    local_rollup->archive_data);
+		rc = _hourly_rollup_windows(&mysql_conn, local_rollup,
+					    hour_start, hour_end);
 		snprintf(timer_str, sizeof(timer_str),
 			 "hourly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -914,8 +1041,9 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn,
 			       uint16_t archive_data)
 {
 	int rc = SLURM_SUCCESS;
-	int rolledup = 0;
+	int rolledup = 0, started = 0, cluster_cnt;
 	char *cluster_name = NULL;
+	List cluster_list = NULL;
 	ListIterator itr;
 	pthread_mutex_t rolledup_lock = PTHREAD_MUTEX_INITIALIZER;
 	pthread_cond_t rolledup_cond;
@@ -929,12 +1057,23 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn,
 	slurm_mutex_init(&rolledup_lock);
 	pthread_cond_init(&rolledup_cond, NULL);
 
-	//START_TIMER;
+	/* Work off a copy of the cluster names so the cluster list
+	 * isn't locked for the whole rollup. */
 	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	cluster_list = list_create(slurm_destroy_char);
 	itr = list_iterator_create(as_mysql_cluster_list);
+	while ((cluster_name = list_next(itr)))
+		list_append(cluster_list, xstrdup(cluster_name));
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	cluster_cnt = list_count(cluster_list);
+
+	//START_TIMER;
+	slurm_mutex_lock(&rolledup_lock);
+	itr = list_iterator_create(cluster_list);
 	while ((cluster_name = list_next(itr))) {
-		/* pthread_t rollup_tid; */
-		/* pthread_attr_t rollup_attr; */
+		pthread_t rollup_tid;
+		pthread_attr_t rollup_attr;
 		local_rollup_t *local_rollup = xmalloc(sizeof(local_rollup_t));
 
 		local_rollup->archive_data = archive_data;
@@ -949,27 +1088,28 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn,
 		local_rollup->sent_end = sent_end;
 		local_rollup->sent_start = sent_start;
 
+		/* Don't have more than ROLLUP_CLUSTER_THREADS
+		   clusters going at once, each one can have its own
+		   window threads and database connections. */
+		while ((started - rolledup) >= ROLLUP_CLUSTER_THREADS)
+			pthread_cond_wait(&rolledup_cond, &rolledup_lock);
+
 		/* _cluster_rollup_usage is responsible for freeing
 		   this local_rollup */
-		_cluster_rollup_usage(local_rollup);
-		/* It turns out doing this with threads only buys a
-		   very small victory, and can skew the timings.  So
-		   just doing them one after the other isn't too bad.
-		   If you really want to do this in threads you can
-		   just uncomment this, and comment the call above.
-		*/
-		/* slurm_attr_init(&rollup_attr); */
-		/* if (pthread_create(&rollup_tid, &rollup_attr, */
-		/* 		   _cluster_rollup_usage, */
-		/* 		   (void *)local_rollup)) */
-		/* 	fatal("pthread_create: %m"); */
-		/* slurm_attr_destroy(&rollup_attr); */
+		slurm_attr_init(&rollup_attr);
+		if (pthread_attr_setdetachstate(&rollup_attr,
+						PTHREAD_CREATE_DETACHED))
+			error("pthread_attr_setdetachstate error %m");
+		if (pthread_create(&rollup_tid, &rollup_attr,
+				   _cluster_rollup_usage,
+				   (void *)local_rollup))
+			fatal("pthread_create: %m");
+		slurm_attr_destroy(&rollup_attr);
+		started++;
 	}
-	slurm_mutex_lock(&rolledup_lock);
 	list_iterator_destroy(itr);
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
 
-	while (rolledup < list_count(as_mysql_cluster_list)) {
+	while (rolledup < cluster_cnt) {
 		pthread_cond_wait(&rolledup_cond, &rolledup_lock);
 		debug2("Got %d rolled up", rolledup);
 	}
@@ -977,6 +1117,7 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn,
 	debug2("Everything rolled up");
 	slurm_mutex_destroy(&rolledup_lock);
 	pthread_cond_destroy(&rolledup_cond);
+	list_destroy(cluster_list);
 	/* END_TIMER; */
 	/* info("total time was %s", TIME_STR); */
 
@@ -416,6 +416,39 @@ extern int jobacct_storage_p_step_complete(void *db_conn,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * load into the storage the start of a list of job steps
+ */
+extern int jobacct_storage_p_step_start_mult(void *db_conn, List step_list)
+{
+	return SLURM_SUCCESS;
+}
+
+/*
+ * load into the storage the end of a list of job steps
+ */
+extern int jobacct_storage_p_step_complete_mult(void *db_conn,
+						List step_list)
+{
+	return SLURM_SUCCESS;
+}
+
+/*
+ * load into the storage the start of a list of jobs
+ */
+extern int jobacct_storage_p_job_start_mult(void *db_conn, List job_list)
+{
+	return SLURM_SUCCESS;
+}
+
+/*
+ * load into the storage the end of a list of jobs
+ */
+extern int jobacct_storage_p_job_complete_mult(void *db_conn, List job_list)
+{
+	return SLURM_SUCCESS;
+}
+
 /*
  * load into the storage a suspention of a job
  */
@@ -678,6 +678,94 @@ extern int jobacct_storage_p_step_complete(pgsql_conn_t *pg_conn,
 	return js_pg_step_complete(pg_conn, step_ptr);
 }
 
+/*
+ * load into the storage the start of a list of job steps
+ */
+extern int jobacct_storage_p_step_start_mult(pgsql_conn_t *pg_conn,
+					     List step_list)
+{
+	struct step_record *step_ptr;
+	ListIterator itr;
+	int rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(step_list);
+	while ((step_ptr = list_next(itr))) {
+		rc = jobacct_storage_p_step_start(pg_conn, step_ptr);
+		if (rc != SLURM_SUCCESS)
+			break;
+		list_remove(itr);
+	}
+	list_iterator_destroy(itr);
+
+	return rc;
+}
+
+/*
+ * load into the storage the end of a list of job steps
+ */
+extern int jobacct_storage_p_step_complete_mult(pgsql_conn_t *pg_conn,
+						List step_list)
+{
+	struct step_record *step_ptr;
+	ListIterator itr;
+	int rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(step_list);
+	while ((step_ptr = list_next(itr))) {
+		rc = jobacct_storage_p_step_complete(pg_conn, step_ptr);
+		if (rc != SLURM_SUCCESS)
+			break;
+		list_remove(itr);
+	}
+	list_iterator_destroy(itr);
+
+	return rc;
+}
+
+/*
+ * load into the storage the start of a list of jobs
+ */
+extern int jobacct_storage_p_job_start_mult(pgsql_conn_t *pg_conn,
+					    List job_list)
+{
+	struct job_record *job_ptr;
+	ListIterator itr;
+	int rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
+		rc = jobacct_storage_p_job_start(pg_conn, job_ptr);
+		if (rc != SLURM_SUCCESS)
+			break;
+		list_remove(itr);
+	}
+	list_iterator_destroy(itr);
+
+	return rc;
+}
+
+/*
+ * load into the storage the end of a list of jobs
+ */
+extern int jobacct_storage_p_job_complete_mult(pgsql_conn_t *pg_conn,
+					       List job_list)
+{
+	struct job_record *job_ptr;
+	ListIterator itr;
+	int rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
+		rc = jobacct_storage_p_job_complete(pg_conn, job_ptr);
+		if (rc != SLURM_SUCCESS)
+			break;
+		list_remove(itr);
+	}
+	list_iterator_destroy(itr);
+
+	return rc;
+}
+
 /*
  * load into the storage a suspention of a job
  */
@@ -48,6 +48,7 @@
 #include "slurm/slurm.h"
 #include "slurm/slurm_errno.h"
 #include "src/common/log.h"
+#include "src/common/timers.h"
 #include "src/slurmd/slurmd/slurmd.h"
 
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
@@ -245,19 +246,30 @@ int _slurm_cgroup_create(slurmd_job_t *job, uint64_t id, uid_t uid, gid_t gid)
 
 int _slurm_cgroup_destroy(void)
 {
+	/* the step cgroup can only be removed once all its tasks are gone,
+	 * a failure here tells the caller that some are still running */
 	if (jobstep_cgroup_path[0] != '\0') {
-		xcgroup_delete(&step_freezer_cg);
+		if (xcgroup_delete(&step_freezer_cg) != XCGROUP_SUCCESS &&
+		    errno != ENOENT) {
+			debug2("unable to remove step freezer cg '%s' : %m",
+			       step_freezer_cg.path);
+			return SLURM_ERROR;
+		}
 		xcgroup_destroy(&step_freezer_cg);
+		jobstep_cgroup_path[0] = '\0';
 	}
 
+	/* job and user cgroups can still be used by other steps */
 	if (job_cgroup_path[0] != '\0') {
 		xcgroup_delete(&job_freezer_cg);
 		xcgroup_destroy(&job_freezer_cg);
+		job_cgroup_path[0] = '\0';
 	}
 
 	if (user_cgroup_path[0] != '\0') {
 		xcgroup_delete(&user_freezer_cg);
 		xcgroup_destroy(&user_freezer_cg);
+		user_cgroup_path[0] = '\0';
 	}
 
 	return SLURM_SUCCESS;
@@ -410,8 +422,10 @@ extern int fini (void)
 extern int slurm_container_plugin_create (slurmd_job_t *job)
 {
 	int fstatus;
+	DEF_TIMERS;
 
 	/* create a new cgroup for that container */
+	START_TIMER;
 	fstatus = _slurm_cgroup_create(job, (uint64_t)job->jmgr_pid,
 				       job->uid, job->gid);
 	if (fstatus)
@@ -434,6 +448,9 @@ extern int slurm_container_plugin_create (slurmd_job_t *job)
 	 * the corresponding cgroup could be found using
 	 * _slurm_cgroup_find_by_pid */
 	job->cont_id = (uint64_t)job->jmgr_pid;
+	END_TIMER;
+	debug2("proctrack/cgroup: step %u.%u container created in %s",
+	       job->jobid, job->stepid, TIME_STR);
 
 	return SLURM_SUCCESS;
 }
@@ -500,8 +517,7 @@ extern int slurm_container_plugin_signal (uint64_t id, int signal)
 
 extern int slurm_container_plugin_destroy (uint64_t id)
 {
-	_slurm_cgroup_destroy();
-	return SLURM_SUCCESS;
+	return _slurm_cgroup_destroy();
 }
 
 extern uint64_t slurm_container_plugin_find(pid_t pid)
@@ -522,16 +538,26 @@ extern bool slurm_container_plugin_has_pid(uint64_t cont_id, pid_t pid)
 extern int slurm_container_plugin_wait(uint64_t cont_id)
 {
 	int delay = 1;
+	bool empty = false;
+	DEF_TIMERS;
 
 	if (cont_id == 0 || cont_id == 1) {
 		errno = EINVAL;
 		return SLURM_ERROR;
 	}
 
-	/* Spin until the container is successfully destroyed */
+	/* Spin until the container is successfully destroyed, the wait
+	 * for the step cgroup to be empty returns as soon as the killed
+	 * tasks are gone rather than after a full delay. If the container
+	 * still can not be destroyed once empty, sleep out the delay so
+	 * that the retries back off all the same. */
+	START_TIMER;
 	while (slurm_container_plugin_destroy(cont_id) != SLURM_SUCCESS) {
 		slurm_container_plugin_signal(cont_id, SIGKILL);
-		sleep(delay);
+		if (empty)
+			sleep(delay);
+		empty = (xcgroup_wait_empty(&step_freezer_cg, delay * 1000) ==
+			 XCGROUP_SUCCESS);
 		if (delay < 120) {
 			delay *= 2;
 		} else {
@@ -539,6 +565,9 @@ extern int slurm_container_plugin_wait(uint64_t cont_id)
 			      cont_id);
 		}
 	}
+	END_TIMER;
+	debug2("proctrack/cgroup: container %"PRIu64" destroyed in %s",
+	       cont_id, TIME_STR);
 
 	return SLURM_SUCCESS;
 }
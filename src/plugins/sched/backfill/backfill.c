@@ -96,6 +96,8 @@ typedef struct node_space_map {
 	time_t begin_time;
 	time_t end_time;
 	bitstr_t *avail_bitmap;
+	uint32_t *lic_avail;	/* licenses available by license ID,
+				 * NULL if no licenses configured */
 	int next;	/* next record, by time, zero termination */
 } node_space_map_t;
 int backfilled_jobs = 0;
@@ -110,13 +112,18 @@ static uint32_t debug_flags = 0;
 static int backfill_interval = BACKFILL_INTERVAL;
 static int backfill_window = BACKFILL_WINDOW;
 static int max_backfill_job_cnt = 50;
+static uint32_t lic_id_cnt = 0;
+static int job_test_count = 0;
 
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
-			     bitstr_t *res_bitmap,
+			     bitstr_t *res_bitmap, struct job_record *job_ptr,
 			     node_space_map_t *node_space,
 			     int *node_space_recs);
 static int  _attempt_backfill(void);
+static uint32_t *_copy_lic_avail(uint32_t *lic_avail);
+static void _deduct_licenses(struct job_record *job_ptr, time_t start_time,
+			     time_t end_time, node_space_map_t *node_space);
 static bool _job_is_completing(void);
 static void _load_config(void);
 static bool _many_pending_rpcs(void);
@@ -402,13 +409,15 @@ extern void *backfill_agent(void *args)
 			continue;
 
 		START_TIMER;
+		job_test_count = 0;
 		lock_slurmctld(all_locks);
 		while (_attempt_backfill()) ;
 		last_backfill_time = time(NULL);
 		unlock_slurmctld(all_locks);
 		END_TIMER;
 		if (debug_flags & DEBUG_FLAG_BACKFILL)
-			info("backfill: completed, %s", TIME_STR);
+			info("backfill: completed testing %d jobs, %s",
+			     job_test_count, TIME_STR);
 	}
 	return NULL;
 }
@@ -451,6 +460,7 @@ static int _attempt_backfill(void)
 	uint32_t time_limit, comp_time_limit, orig_time_limit;
 	uint32_t min_nodes, max_nodes, req_nodes;
 	bitstr_t *avail_bitmap = NULL, *resv_bitmap = NULL;
+	bool lic_avail;
 	time_t now = time(NULL), sched_start, later_start, start_res;
 	node_space_map_t *node_space;
 	static int sched_timeout = 0;
@@ -491,6 +501,12 @@ static int _attempt_backfill(void)
 	node_space[0].begin_time = sched_start;
 	node_space[0].end_time = sched_start + backfill_window;
 	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
+	lic_id_cnt = license_id_cnt();
+	if (lic_id_cnt) {
+		node_space[0].lic_avail = xmalloc(sizeof(uint32_t) *
+						  lic_id_cnt);
+		license_avail_get(node_space[0].lic_avail, lic_id_cnt);
+	}
 	node_space[0].next = 0;
 	node_space_recs = 1;
 	if (debug_flags & DEBUG_FLAG_BACKFILL)
@@ -504,6 +520,7 @@ static int _attempt_backfill(void)
 		if (!IS_JOB_PENDING(job_ptr))
 			continue;	/* started in other partition */
 		job_ptr->part_ptr = part_ptr;
+		job_test_count++;
 
 		if (debug_flags & DEBUG_FLAG_BACKFILL)
 			info("backfill test for job %u", job_ptr->job_id);
@@ -590,6 +607,7 @@ static int _attempt_backfill(void)
 		/* Identify usable nodes for this job */
 		bit_and(avail_bitmap, part_ptr->node_bitmap);
 		bit_and(avail_bitmap, up_node_bitmap);
+		lic_avail = true;
 		for (j=0; ; ) {
 			if ((node_space[j].end_time > start_res) &&
 			     node_space[j].next && (later_start == 0))
@@ -599,12 +617,27 @@ static int _attempt_backfill(void)
 			else if (node_space[j].begin_time <= end_time) {
 				bit_and(avail_bitmap,
 					node_space[j].avail_bitmap);
+				if (lic_avail &&
+				    !license_job_avail_test(job_ptr,
+						node_space[j].lic_avail,
+						lic_id_cnt))
+					lic_avail = false;
 			} else
 				break;
 			if ((j = node_space[j].next) == 0)
 				break;
 		}
 
+		/* Licenses held for jobs to be backfill scheduled */
+		if (!lic_avail) {
+			if (later_start) {
+				job_ptr->start_time = 0;
+				goto TRY_LATER;
+			}
+			job_ptr->time_limit = orig_time_limit;
+			continue;
+		}
+
 		if (job_ptr->details->exc_node_bitmap) {
 			bit_not(job_ptr->details->exc_node_bitmap);
 			bit_and(avail_bitmap,
@@ -688,6 +721,10 @@ static int _attempt_backfill(void)
 				break;
 			} else {
 				/* Started this job, move to next one */
+				_deduct_licenses(job_ptr, job_ptr->start_time,
+						 job_ptr->end_time,
+						 node_space);
+				job_queue_add_array(job_queue, job_ptr);
 				continue;
 			}
 		} else
@@ -729,7 +766,8 @@ static int _attempt_backfill(void)
 			continue;
 		bit_not(avail_bitmap);
 		_add_reservation(job_ptr->start_time, end_reserve,
-				 avail_bitmap, node_space, &node_space_recs);
+				 avail_bitmap, job_ptr, node_space,
+				 &node_space_recs);
 		if (debug_flags & DEBUG_FLAG_BACKFILL)
 			_dump_node_space_table(node_space);
 	}
@@ -738,6 +776,7 @@ static int _attempt_backfill(void)
 
 	for (i=0; ; ) {
 		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+		xfree(node_space[i].lic_avail);
 		if ((i = node_space[i].next) == 0)
 			break;
 	}
@@ -849,9 +888,20 @@ static bool _more_work (time_t last_backfill_time)
 	return rc;
 }
 
+static uint32_t *_copy_lic_avail(uint32_t *lic_avail)
+{
+	uint32_t *lic_copy;
+
+	if (lic_avail == NULL)
+		return NULL;
+	lic_copy = xmalloc(sizeof(uint32_t) * lic_id_cnt);
+	memcpy(lic_copy, lic_avail, sizeof(uint32_t) * lic_id_cnt);
+	return lic_copy;
+}
+
 /* Create a reservation for a job in the future */
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
-			     bitstr_t *res_bitmap,
+			     bitstr_t *res_bitmap, struct job_record *job_ptr,
 			     node_space_map_t *node_space,
 			     int *node_space_recs)
 {
@@ -867,6 +917,8 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			node_space[j].end_time = start_time;
 			node_space[i].avail_bitmap =
 				bit_copy(node_space[j].avail_bitmap);
+			node_space[i].lic_avail =
+				_copy_lic_avail(node_space[j].lic_avail);
 			node_space[i].next = node_space[j].next;
 			node_space[j].next = i;
 			(*node_space_recs)++;
@@ -887,6 +939,9 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 				node_space[j].end_time = end_reserve;
 				node_space[i].avail_bitmap =
 					bit_copy(node_space[j].avail_bitmap);
+				node_space[i].lic_avail =
+					_copy_lic_avail(node_space[j].
+							lic_avail);
 				node_space[i].next = node_space[j].next;
 				node_space[j].next = i;
 				(*node_space_recs)++;
@@ -905,6 +960,28 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 		    ((j = node_space[j].next) == 0))
 			break;
 	}
+	_deduct_licenses(job_ptr, start_time, end_reserve, node_space);
+}
+
+/* Remove a job's licenses from every time slot it overlaps */
+static void _deduct_licenses(struct job_record *job_ptr, time_t start_time,
+			     time_t end_time, node_space_map_t *node_space)
+{
+	int j;
+
+	if (!job_ptr->license_list || (lic_id_cnt == 0))
+		return;
+	for (j=0; ; ) {
+		if ((node_space[j].end_time > start_time) &&
+		    (node_space[j].begin_time < end_time)) {
+			license_job_avail_deduct(job_ptr,
+						 node_space[j].lic_avail,
+						 lic_id_cnt);
+		}
+		if ((node_space[j].begin_time >= end_time) ||
+		    ((j = node_space[j].next) == 0))
+			break;
+	}
 }
 
 /*
@@ -110,6 +110,7 @@ static int	_job_modify(uint32_t jobid, char *bank_ptr,
 			      "for non-batch job %u", jobid);
 			return ESLURM_DISABLED;
 		}
+		decode_job_launch_details(job_ptr->details);
 		for (i=0; ; i++) {
 			if (env_ptr[i] == '=') {
 				if (have_equal) {
@@ -1319,13 +1319,15 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	int       *switches_node_cnt;		/* total nodes on switch */
 	int       *switches_required;		/* set if has required node */
 	int        leaf_switch_count = 0;   /* Count of leaf node switches used */
+	int       *leaf_inx = NULL;		/* usable leaf switches */
+	int        leaf_cnt = 0;
 
 	bitstr_t  *avail_nodes_bitmap = NULL;	/* nodes on any switch */
 	bitstr_t  *req_nodes_bitmap   = NULL;
 	int rem_cpus, rem_nodes;	/* remaining resources desired */
 	int avail_cpus;
 	int total_cpus = 0;	/* #CPUs allocated to job */
-	int i, j, rc = SLURM_SUCCESS;
+	int i, j, k, rc = SLURM_SUCCESS;
 	int best_fit_inx, first, last;
 	int best_fit_nodes, best_fit_cpus;
 	int best_fit_location = 0, best_fit_sufficient;
@@ -1447,9 +1449,9 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 			max_nodes--;
 			total_cpus += avail_cpus;
 			rem_cpus   -= avail_cpus;
-			for (j=0; j<switch_record_cnt; j++) {
-				if (!bit_test(switches_bitmap[j], i))
-					continue;
+			for (k = node_switch_offset[i];
+			     k < node_switch_offset[i+1]; k++) {
+				j = node_switch_inx[k];
 				bit_clear(switches_bitmap[j], i);
 				switches_node_cnt[j]--;
 				/* keep track of the accumulated resources */
@@ -1466,42 +1468,19 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 		}
 		if ((rem_nodes <= 0) && (rem_cpus <= 0))
 			goto fini;
+	}
 
-		/* Update bitmaps and node counts for higher-level switches */
-		for (j=0; j<switch_record_cnt; j++) {
-			if (switches_node_cnt[j] == 0)
-				continue;
-			first = bit_ffs(switches_bitmap[j]);
-			if (first < 0)
-				continue;
-			last  = bit_fls(switches_bitmap[j]);
-			for (i=first; i<=last; i++) {
-				if (!bit_test(switches_bitmap[j], i))
-					continue;
-				if (!bit_test(avail_nodes_bitmap, i)) {
-					/* cleared from lower level */
-					bit_clear(switches_bitmap[j], i);
-					switches_node_cnt[j]--;
-				} else {
-					switches_cpu_cnt[j] +=
-						_get_cpu_cnt(job_ptr, i,
-							     cpu_cnt);
-				}
-			}
-		}
-	} else {
-		/* No specific required nodes, calculate CPU counts */
-		for (j=0; j<switch_record_cnt; j++) {
-			first = bit_ffs(switches_bitmap[j]);
-			if (first < 0)
-				continue;
-			last  = bit_fls(switches_bitmap[j]);
-			for (i=first; i<=last; i++) {
-				if (!bit_test(switches_bitmap[j], i))
-					continue;
-				switches_cpu_cnt[j] +=
-					_get_cpu_cnt(job_ptr, i, cpu_cnt);
-			}
+	/* Calculate CPU counts, adding each remaining node's CPUs to every
+	 * switch holding it rather than counting each switch's nodes */
+	first = bit_ffs(avail_nodes_bitmap);
+	last  = bit_fls(avail_nodes_bitmap);
+	for (i=first; ((i<=last) && (first>=0)); i++) {
+		if (!bit_test(avail_nodes_bitmap, i))
+			continue;
+		avail_cpus = _get_cpu_cnt(job_ptr, i, cpu_cnt);
+		for (k = node_switch_offset[i];
+		     k < node_switch_offset[i+1]; k++) {
+			switches_cpu_cnt[node_switch_inx[k]] += avail_cpus;
 		}
 	}
 
@@ -1562,12 +1541,13 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	bit_and(avail_nodes_bitmap, switches_bitmap[best_fit_inx]);
 
 	/* Identify usable leafs (within higher switch having best fit) */
-	for (j=0; j<switch_record_cnt; j++) {
-		if ((switch_record_table[j].level != 0) ||
-		    (!bit_super_set(switches_bitmap[j],
-				    switches_bitmap[best_fit_inx]))) {
-			switches_node_cnt[j] = 0;
-		}
+	leaf_inx = xmalloc(sizeof(int) * (leaf_switch_cnt + 1));
+	for (k=0; k<leaf_switch_cnt; k++) {
+		j = leaf_switch_inx[k];
+		if ((switches_node_cnt[j] != 0) &&
+		    bit_super_set(switches_bitmap[j],
+				  switches_bitmap[best_fit_inx]))
+			leaf_inx[leaf_cnt++] = j;
 	}
 
 	/* Select resources from these leafs on a best-fit basis */
@@ -1577,7 +1557,8 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	while ((max_nodes > 0) && ((rem_nodes > 0) || (rem_cpus > 0))) {
 		int *cpus_array = NULL, array_len;
 		best_fit_cpus = best_fit_nodes = best_fit_sufficient = 0;
-		for (j=0; j<switch_record_cnt; j++) {
+		for (k=0; k<leaf_cnt; k++) {
+			j = leaf_inx[k];
 			if (switches_node_cnt[j] == 0)
 				continue;
 			sufficient = (switches_cpu_cnt[j] >= rem_cpus) &&
@@ -1747,6 +1728,7 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	for (i=0; i<switch_record_cnt; i++)
 		FREE_NULL_BITMAP(switches_bitmap[i]);
 	xfree(switches_bitmap);
+	xfree(leaf_inx);
 	xfree(switches_cpu_cnt);
 	xfree(switches_node_cnt);
 	xfree(switches_required);
@@ -122,6 +122,10 @@ int node_record_count __attribute__((weak_import));
 time_t last_node_update __attribute__((weak_import));
 struct switch_record *switch_record_table __attribute__((weak_import));
 int switch_record_cnt __attribute__((weak_import));
+int *node_switch_offset __attribute__((weak_import));
+int *node_switch_inx __attribute__((weak_import));
+int *leaf_switch_inx __attribute__((weak_import));
+int leaf_switch_cnt __attribute__((weak_import));
 bitstr_t *avail_node_bitmap __attribute__((weak_import));
 bitstr_t *idle_node_bitmap __attribute__((weak_import));
 #else
@@ -133,6 +137,10 @@ int node_record_count;
 time_t last_node_update;
 struct switch_record *switch_record_table;
 int switch_record_cnt;
+int *node_switch_offset;
+int *node_switch_inx;
+int *leaf_switch_inx;
+int leaf_switch_cnt;
 bitstr_t *avail_node_bitmap;
 bitstr_t *idle_node_bitmap;
 #endif
@@ -187,6 +195,27 @@ static bool job_preemption_enabled = false;
 static bool job_preemption_killing = false;
 static bool job_preemption_tested  = false;
 
+/* Running and suspended jobs with resources in select_part_record, sorted
+ * by end time as of their last use. The job_ptr is only valid during
+ * _run_job_sort()'s caller, since jobs are found again by ID each time. */
+typedef struct run_job_rec {
+	uint32_t job_id;
+	time_t end_time;
+	struct job_record *job_ptr;
+} run_job_rec_t;
+static run_job_rec_t *run_job_array = NULL;
+static int run_job_cnt = 0, run_job_size = 0;
+
+/* Index of run_job_array by job ID, holding the end time each job is
+ * sorted by so that its record can be found with a binary search */
+#define RUN_JOB_HASH_SIZE 1024
+typedef struct run_job_hash {
+	uint32_t job_id;
+	time_t end_time;
+	struct run_job_hash *next;
+} run_job_hash_t;
+static run_job_hash_t *run_job_hash[RUN_JOB_HASH_SIZE];
+
 struct select_nodeinfo {
 	uint16_t magic;		/* magic number */
 	uint16_t alloc_cpus;
@@ -204,6 +233,10 @@ static int _rm_job_from_one_node(struct job_record *job_ptr,
 static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 			    struct node_use_record *node_usage,
 			    struct job_record *job_ptr, int action);
+static void _run_job_add(struct job_record *job_ptr);
+static void _run_job_clear(void);
+static void _run_job_remove(uint32_t job_id);
+static int  _run_job_sort(void);
 static int _run_now(struct job_record *job_ptr, bitstr_t *bitmap,
 		    uint32_t min_nodes, uint32_t max_nodes,
 		    uint32_t req_nodes, uint16_t job_node_req,
@@ -319,10 +352,10 @@ static void _init_global_core_data(struct node_record *node_ptr, int node_cnt)
 	/* number of cores in the cluster */
 	cr_node_cores_offset[node_cnt] = cr_node_cores_offset[node_cnt-1] +
 					 cr_node_num_cores[node_cnt-1] ;
-
 }
 
 
+
 /* return the coremap index to the first core of the given node */
 extern uint32_t cr_get_coremap_offset(uint32_t node_index)
 {
@@ -360,7 +393,9 @@ static struct part_row_data *_dup_row_data(struct part_row_data *orig_row,
 }
 
 
-/* Create a duplicate part_res_record list */
+/* Create a duplicate part_res_record list. The rows are shared with the
+ * original list until _rm_job_from_res() changes them, so partitions whose
+ * jobs are not removed are never copied. */
 static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
 {
 	struct part_res_record *new_part_ptr, *new_ptr;
@@ -374,8 +409,8 @@ static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
 	while (orig_ptr) {
 		new_ptr->part_ptr = orig_ptr->part_ptr;
 		new_ptr->num_rows = orig_ptr->num_rows;
-		new_ptr->row = _dup_row_data(orig_ptr->row,
-					     orig_ptr->num_rows);
+		new_ptr->row = orig_ptr->row;
+		new_ptr->row_shared = (orig_ptr->row != NULL);
 		if (orig_ptr->next) {
 			new_ptr->next = xmalloc(sizeof(struct part_res_record));
 			new_ptr = new_ptr->next;
@@ -386,15 +421,17 @@ static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
 }
 
 
-/* Create a duplicate part_res_record list */
+/* Create a duplicate node_use_record array from select_node_usage.
+ * A NULL gres_list refers to the node's own gres_list, as in the original,
+ * and is copied by _rm_job_from_res() before any change. */
 static struct node_use_record *_dup_node_usage(struct node_use_record *orig_ptr)
 {
 	struct node_use_record *new_use_ptr, *new_ptr;
-	List gres_list;
 	uint32_t i;
 
 	if (orig_ptr == NULL)
 		return NULL;
+	xassert(orig_ptr == select_node_usage);
 
 	new_use_ptr = xmalloc(select_node_cnt * sizeof(struct node_use_record));
 	new_ptr = new_use_ptr;
@@ -402,11 +439,45 @@ static struct node_use_record *_dup_node_usage(struct node_use_record *orig_ptr)
 	for (i = 0; i < select_node_cnt; i++) {
 		new_ptr[i].node_state   = orig_ptr[i].node_state;
 		new_ptr[i].alloc_memory = orig_ptr[i].alloc_memory;
-		if (orig_ptr[i].gres_list)
-			gres_list = orig_ptr[i].gres_list;
-		else
-			gres_list = node_record_table_ptr[i].gres_list;
-		new_ptr[i].gres_list = gres_plugin_node_state_dup(gres_list);
+	}
+	return new_use_ptr;
+}
+
+/* Copy a part_res_record list made by _dup_part_data(). Rows still shared
+ * with select_part_record stay shared, rows changed since are copied. */
+static struct part_res_record *_copy_future_part(
+					struct part_res_record *orig_ptr)
+{
+	struct part_res_record *new_part_ptr, *new_ptr;
+
+	new_part_ptr = _dup_part_data(orig_ptr);
+	for (new_ptr = new_part_ptr; new_ptr;
+	     new_ptr = new_ptr->next, orig_ptr = orig_ptr->next) {
+		new_ptr->row_shared = orig_ptr->row_shared;
+		if (new_ptr->row && !new_ptr->row_shared) {
+			new_ptr->row = _dup_row_data(orig_ptr->row,
+						     orig_ptr->num_rows);
+		}
+	}
+	return new_part_ptr;
+}
+
+
+/* Copy a node_use_record array made by _dup_node_usage() */
+static struct node_use_record *_copy_future_usage(
+					struct node_use_record *orig_ptr)
+{
+	struct node_use_record *new_use_ptr;
+	uint32_t i;
+
+	new_use_ptr = xmalloc(select_node_cnt * sizeof(struct node_use_record));
+	for (i = 0; i < select_node_cnt; i++) {
+		new_use_ptr[i].node_state   = orig_ptr[i].node_state;
+		new_use_ptr[i].alloc_memory = orig_ptr[i].alloc_memory;
+		if (orig_ptr[i].gres_list) {
+			new_use_ptr[i].gres_list = gres_plugin_node_state_dup(
+						   orig_ptr[i].gres_list);
+		}
 	}
 	return new_use_ptr;
 }
@@ -434,10 +505,9 @@ static void _destroy_part_data(struct part_res_record *this_ptr)
 		this_ptr = this_ptr->next;
 		tmp->part_ptr = NULL;
 
-		if (tmp->row) {
+		if (tmp->row && !tmp->row_shared)
 			_destroy_row_data(tmp->row, tmp->num_rows);
-			tmp->row = NULL;
-		}
+		tmp->row = NULL;
 		xfree(tmp);
 	}
 }
@@ -453,6 +523,7 @@ static void _create_part_data(void)
 
 	_destroy_part_data(select_part_record);
 	select_part_record = NULL;
+	_run_job_clear();
 
 	num_parts = list_count(part_list);
 	if (!num_parts)
@@ -488,15 +559,6 @@ static void _create_part_data(void)
 }
 
 
-/* List sort function: sort by the job's expected end time */
-static int _cr_job_list_sort(void *x, void *y)
-{
-	struct job_record *job1_ptr = (struct job_record *) x;
-	struct job_record *job2_ptr = (struct job_record *) y;
-	return (int) difftime(job1_ptr->end_time, job2_ptr->end_time);
-}
-
-
 /* delete the given select_node_record and select_node_usage arrays */
 static void _destroy_node_data(struct node_use_record *node_usage,
 			       struct node_res_record *node_data)
@@ -579,6 +641,25 @@ extern void cr_sort_part_rows(struct part_res_record *p_ptr)
 	if (!p_ptr->row)
 		return;
 
+	if (p_ptr->row_shared) {
+		/* The rows belong to another record (select_part_record
+		 * in a will-run test), so only sort a private copy */
+		a = 0xffffffff;
+		for (i = 0; i < p_ptr->num_rows; i++) {
+			if (p_ptr->row[i].row_bitmap)
+				b = bit_set_count(p_ptr->row[i].row_bitmap);
+			else
+				b = 0;
+			if (b > a)
+				break;
+			a = b;
+		}
+		if (i >= p_ptr->num_rows)
+			return;		/* already sorted */
+		p_ptr->row = _dup_row_data(p_ptr->row, p_ptr->num_rows);
+		p_ptr->row_shared = false;
+	}
+
 	for (i = 0; i < p_ptr->num_rows; i++) {
 		if (p_ptr->row[i].row_bitmap)
 			a = bit_set_count(p_ptr->row[i].row_bitmap);
@@ -841,6 +922,7 @@ static int _add_job_to_res(struct job_record *job_ptr, int action)
 
 	debug3("cons_res: _add_job_to_res: job %u act %d ", job_ptr->job_id,
 	       action);
+	_run_job_add(job_ptr);
 
 	if (select_debug_flags & DEBUG_FLAG_CPU_BIND)
 		_dump_job_res(job);
@@ -1177,6 +1259,8 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 
 	debug3("cons_res: _rm_job_from_res: job %u action %d", job_ptr->job_id,
 	       action);
+	if ((part_record_ptr == select_part_record) && (action != 2))
+		_run_job_remove(job_ptr->job_id);
 	if (select_debug_flags & DEBUG_FLAG_CPU_BIND)
 		_dump_job_res(job);
 
@@ -1191,10 +1275,15 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 		n++;
 
 		node_ptr = node_record_table_ptr + i;
-		if (action != 2) {
+		if ((action != 2) && job_ptr->gres_list) {
 			if (node_usage[i].gres_list)
 				gres_list = node_usage[i].gres_list;
-			else
+			else if (node_usage != select_node_usage) {
+				/* copy of select_node_usage */
+				gres_list = gres_plugin_node_state_dup(
+						node_ptr->gres_list);
+				node_usage[i].gres_list = gres_list;
+			} else
 				gres_list = node_ptr->gres_list;
 			gres_plugin_job_dealloc(job_ptr->gres_list, gres_list,
 						n, job_ptr->job_id,
@@ -1245,6 +1334,11 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 
 		if (!p_ptr->row)
 			return SLURM_SUCCESS;
+		if (p_ptr->row_shared) {
+			p_ptr->row = _dup_row_data(p_ptr->row,
+						   p_ptr->num_rows);
+			p_ptr->row_shared = false;
+		}
 
 		/* remove the job from the job_list */
 		n = 0;
@@ -1512,6 +1606,167 @@ static int _sort_usable_nodes_dec(struct job_record *job_a,
 	return 0;
 }
 
+/* qsort function: sort by the job's expected end time */
+static int _run_job_end_sort(const void *x, const void *y)
+{
+	const run_job_rec_t *rec1 = (const run_job_rec_t *) x;
+	const run_job_rec_t *rec2 = (const run_job_rec_t *) y;
+
+	if (rec1->end_time < rec2->end_time)
+		return -1;
+	if (rec1->end_time > rec2->end_time)
+		return 1;
+	return 0;
+}
+
+/* Find a job's entry in the run_job_array index */
+static run_job_hash_t **_run_job_hash_find(uint32_t job_id)
+{
+	run_job_hash_t **hash_pptr;
+
+	hash_pptr = &run_job_hash[job_id % RUN_JOB_HASH_SIZE];
+	while (*hash_pptr && ((*hash_pptr)->job_id != job_id))
+		hash_pptr = &(*hash_pptr)->next;
+	return hash_pptr;
+}
+
+/* Return the first run_job_array index whose end time is after end_time,
+ * or at or after it if inclusive is set */
+static int _run_job_bsearch(time_t end_time, bool inclusive)
+{
+	int i, lo = 0, hi = run_job_cnt;
+
+	while (lo < hi) {
+		i = (lo + hi) / 2;
+		if ((run_job_array[i].end_time < end_time) ||
+		    (!inclusive && (run_job_array[i].end_time == end_time)))
+			lo = i + 1;
+		else
+			hi = i;
+	}
+	return lo;
+}
+
+/* Record a job whose resources were added to select_part_record */
+static void _run_job_add(struct job_record *job_ptr)
+{
+	run_job_hash_t **hash_pptr, *hash_ptr;
+	int lo;
+
+	hash_pptr = _run_job_hash_find(job_ptr->job_id);
+	if (*hash_pptr)
+		return;		/* resumed job, already recorded */
+	hash_ptr = xmalloc(sizeof(run_job_hash_t));
+	hash_ptr->job_id   = job_ptr->job_id;
+	hash_ptr->end_time = job_ptr->end_time;
+	*hash_pptr = hash_ptr;
+
+	if (run_job_cnt >= run_job_size) {
+		run_job_size = MAX(run_job_size * 2, 64);
+		xrealloc(run_job_array, sizeof(run_job_rec_t) * run_job_size);
+	}
+
+	/* Insert after equal end times */
+	lo = _run_job_bsearch(job_ptr->end_time, false);
+	if (lo < run_job_cnt) {
+		memmove(run_job_array + lo + 1, run_job_array + lo,
+			sizeof(run_job_rec_t) * (run_job_cnt - lo));
+	}
+	run_job_array[lo].job_id   = job_ptr->job_id;
+	run_job_array[lo].end_time = job_ptr->end_time;
+	run_job_array[lo].job_ptr  = job_ptr;
+	run_job_cnt++;
+}
+
+/* Forget all jobs recorded in run_job_array */
+static void _run_job_clear(void)
+{
+	run_job_hash_t *hash_ptr;
+	int i;
+
+	for (i = 0; i < RUN_JOB_HASH_SIZE; i++) {
+		while ((hash_ptr = run_job_hash[i])) {
+			run_job_hash[i] = hash_ptr->next;
+			xfree(hash_ptr);
+		}
+	}
+	run_job_cnt = 0;
+}
+
+/* Forget a job whose resources were removed from select_part_record */
+static void _run_job_remove(uint32_t job_id)
+{
+	run_job_hash_t **hash_pptr, *hash_ptr;
+	time_t end_time;
+	int i;
+
+	hash_pptr = _run_job_hash_find(job_id);
+	if (!*hash_pptr)
+		return;
+	hash_ptr = *hash_pptr;
+	end_time = hash_ptr->end_time;
+	*hash_pptr = hash_ptr->next;
+	xfree(hash_ptr);
+
+	for (i = _run_job_bsearch(end_time, true); i < run_job_cnt; i++) {
+		if (run_job_array[i].end_time != end_time)
+			break;
+		if (run_job_array[i].job_id != job_id)
+			continue;
+		run_job_cnt--;
+		if (i < run_job_cnt) {
+			memmove(run_job_array + i, run_job_array + i + 1,
+				sizeof(run_job_rec_t) * (run_job_cnt - i));
+		}
+		return;
+	}
+}
+
+/* Validate run_job_array against the job table and sort it by the jobs'
+ * current end times, which change with time limit updates, suspend and
+ * resume. The array is normally still in order, so no sort is needed.
+ * RET count of valid records */
+static int _run_job_sort(void)
+{
+	run_job_hash_t **hash_pptr, *hash_ptr;
+	struct job_record *job_ptr;
+	bool sorted = true;
+	int i, j;
+
+	for (i = 0, j = 0; i < run_job_cnt; i++) {
+		hash_pptr = _run_job_hash_find(run_job_array[i].job_id);
+		job_ptr = find_job_record(run_job_array[i].job_id);
+		if (job_ptr &&
+		    (!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr)))
+			job_ptr = NULL;
+		if (job_ptr && (job_ptr->end_time == 0)) {
+			error("Job %u has zero end_time", job_ptr->job_id);
+			job_ptr = NULL;
+		}
+		if (!job_ptr) {
+			if ((hash_ptr = *hash_pptr)) {
+				*hash_pptr = hash_ptr->next;
+				xfree(hash_ptr);
+			}
+			continue;
+		}
+		if (*hash_pptr)
+			(*hash_pptr)->end_time = job_ptr->end_time;
+		run_job_array[j].job_id   = job_ptr->job_id;
+		run_job_array[j].end_time = job_ptr->end_time;
+		run_job_array[j].job_ptr  = job_ptr;
+		if (j && (run_job_array[j - 1].end_time > job_ptr->end_time))
+			sorted = false;
+		j++;
+	}
+	run_job_cnt = j;
+	if (!sorted) {
+		qsort(run_job_array, run_job_cnt, sizeof(run_job_rec_t),
+		      _run_job_end_sort);
+	}
+	return run_job_cnt;
+}
+
 /* Allocate resources for a job now, if possible */
 static int _run_now(struct job_record *job_ptr, bitstr_t *bitmap,
 		    uint32_t min_nodes, uint32_t max_nodes,
@@ -1647,9 +1902,129 @@ top:	orig_map = bit_copy(save_bitmap);
 	return rc;
 }
 
+/* Remove the jobs of run_job_array[first..last] from future data, skipping
+ * preemptable jobs (already removed) and jobs outside of orig_map */
+static void _will_run_remove(struct part_res_record *future_part,
+			     struct node_use_record *future_usage,
+			     bitstr_t *orig_map, List preemptee_candidates,
+			     int first, int last)
+{
+	struct job_record *tmp_job_ptr;
+	int i, ovrlap;
+
+	for (i = first; i <= last; i++) {
+		tmp_job_ptr = run_job_array[i].job_ptr;
+		if (preemptee_candidates &&
+		    _is_preemptable(tmp_job_ptr, preemptee_candidates))
+			continue;	/* already removed */
+		ovrlap = bit_overlap(orig_map, tmp_job_ptr->node_bitmap);
+		if (ovrlap == 0)
+			continue;
+		debug2("cons_res: _will_run_test, job %u: overlap=%d",
+		       tmp_job_ptr->job_id, ovrlap);
+		_rm_job_from_res(future_part, future_usage, tmp_job_ptr, 0);
+	}
+}
+
+/* _will_run_search - find the first end time at which a pending job can
+ *	start. The job is worth testing once all running jobs sharing an
+ *	end time are gone, if some of them were using nodes in orig_map.
+ *	Since removing jobs only frees resources, the test points are
+ *	probed with exponentially growing steps and then bisected, taking
+ *	O(log n) calls to cr_job_test() rather than one per end time. Each
+ *	probe starts from a copy of the data at the last failed probe.
+ * IN/OUT future_part, future_usage - data with preempted jobs removed,
+ *	replaced with data to be destroyed by the caller
+ * RET SLURM_SUCCESS with bitmap and job_ptr->start_time set if found */
+static int _will_run_search(struct job_record *job_ptr, bitstr_t *bitmap,
+			    bitstr_t *orig_map, uint32_t min_nodes,
+			    uint32_t max_nodes, uint32_t req_nodes,
+			    uint16_t job_node_req, List preemptee_candidates,
+			    int job_cnt, struct part_res_record **future_part,
+			    struct node_use_record **future_usage)
+{
+	struct part_res_record *probe_part;
+	struct node_use_record *probe_usage;
+	struct job_record *tmp_job_ptr;
+	bitstr_t *best_map = NULL;
+	int *test_inx, test_cnt = 0, rm_cnt = 0, base_inx = -1;
+	int i, lo, hi, probe, step = 1, best = -1, rc;
+	time_t end_time, now = time(NULL);
+
+	test_inx = xmalloc(sizeof(int) * (job_cnt + 1));
+	for (i = 0; i < job_cnt; i++) {
+		tmp_job_ptr = run_job_array[i].job_ptr;
+		if ((!preemptee_candidates ||
+		     !_is_preemptable(tmp_job_ptr, preemptee_candidates)) &&
+		    bit_overlap(orig_map, tmp_job_ptr->node_bitmap))
+			rm_cnt++;
+		if ((rm_cnt == 0) ||
+		    ((i + 1 < job_cnt) &&
+		     (run_job_array[i + 1].end_time ==
+		      run_job_array[i].end_time)))
+			continue;
+		rm_cnt = 0;
+		test_inx[test_cnt++] = i;
+	}
+
+	/* The first test point at which the job can start is in [lo, hi) */
+	lo = 0;
+	hi = test_cnt;
+	while (lo < hi) {
+		if (best < 0) {
+			probe = MIN(lo + step - 1, hi - 1);
+			step *= 2;
+		} else
+			probe = (lo + hi - 1) / 2;
+		probe_part  = _copy_future_part(*future_part);
+		probe_usage = _copy_future_usage(*future_usage);
+		_will_run_remove(probe_part, probe_usage, orig_map,
+				 preemptee_candidates, base_inx + 1,
+				 test_inx[probe]);
+		bit_or(bitmap, orig_map);
+		rc = cr_job_test(job_ptr, bitmap, min_nodes,
+				 max_nodes, req_nodes,
+				 SELECT_MODE_WILL_RUN, cr_type,
+				 job_node_req, select_node_cnt,
+				 probe_part, probe_usage);
+		if (rc == SLURM_SUCCESS) {
+			best = probe;
+			hi = probe;
+			FREE_NULL_BITMAP(best_map);
+			best_map = bit_copy(bitmap);
+			if (!best_map)
+				fatal("bit_copy: malloc failure");
+			_destroy_part_data(probe_part);
+			_destroy_node_data(probe_usage, NULL);
+		} else {
+			lo = probe + 1;
+			base_inx = test_inx[probe];
+			_destroy_part_data(*future_part);
+			_destroy_node_data(*future_usage, NULL);
+			*future_part  = probe_part;
+			*future_usage = probe_usage;
+		}
+	}
+
+	rc = SLURM_ERROR;
+	if (best >= 0) {
+		bit_copybits(bitmap, best_map);
+		end_time = run_job_array[test_inx[best]].end_time;
+		if (end_time <= now)
+			job_ptr->start_time = now + 1;
+		else
+			job_ptr->start_time = end_time;
+		rc = SLURM_SUCCESS;
+	}
+	FREE_NULL_BITMAP(best_map);
+	xfree(test_inx);
+	return rc;
+}
+
 /* _will_run_test - determine when and where a pending job can start, removes
  *	jobs from node table at termination time and run _test_job() after
- *	each one. Used by SLURM's sched/backfill plugin and Moab. */
+ *	all jobs ending at the same time are gone. Used by SLURM's
+ *	sched/backfill plugin and Moab. */
 static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 			  uint32_t min_nodes, uint32_t max_nodes,
 			  uint32_t req_nodes, uint16_t job_node_req,
@@ -1658,10 +2033,9 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 	struct part_res_record *future_part;
 	struct node_use_record *future_usage;
 	struct job_record *tmp_job_ptr;
-	List cr_job_list;
-	ListIterator job_iterator, preemptee_iterator;
+	ListIterator preemptee_iterator;
 	bitstr_t *orig_map;
-	int action, rc = SLURM_ERROR;
+	int action, i, job_cnt, rc = SLURM_ERROR;
 	time_t now = time(NULL);
 
 	orig_map = bit_copy(bitmap);
@@ -1693,21 +2067,10 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 		return SLURM_ERROR;
 	}
 
-	/* Build list of running and suspended jobs */
-	cr_job_list = list_create(NULL);
-	if (!cr_job_list)
-		fatal("list_create: memory allocation error");
-	job_iterator = list_iterator_create(job_list);
-	if (job_iterator == NULL)
-		fatal ("memory allocation failure");
-	while ((tmp_job_ptr = (struct job_record *) list_next(job_iterator))) {
-		if (!IS_JOB_RUNNING(tmp_job_ptr) &&
-		    !IS_JOB_SUSPENDED(tmp_job_ptr))
-			continue;
-		if (tmp_job_ptr->end_time == 0) {
-			error("Job %u has zero end_time", tmp_job_ptr->job_id);
-			continue;
-		}
+	/* Running and suspended jobs, sorted by end time */
+	job_cnt = _run_job_sort();
+	for (i = 0; preemptee_candidates && (i < job_cnt); i++) {
+		tmp_job_ptr = run_job_array[i].job_ptr;
 		if (_is_preemptable(tmp_job_ptr, preemptee_candidates)) {
 			uint16_t mode = slurm_job_preempt_mode(tmp_job_ptr);
 			if (mode == PREEMPT_MODE_OFF)
@@ -1719,10 +2082,8 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 			/* Remove preemptable job now */
 			_rm_job_from_res(future_part, future_usage,
 					 tmp_job_ptr, action);
-		} else
-			list_append(cr_job_list, tmp_job_ptr);
+		}
 	}
-	list_iterator_destroy(job_iterator);
 
 	/* Test with all preemptable jobs gone */
 	if (preemptee_candidates) {
@@ -1735,38 +2096,11 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 			job_ptr->start_time = now + 1;
 	}
 
-	/* Remove the running jobs one at a time from exp_node_cr and try
-	 * scheduling the pending job after each one. */
 	if (rc != SLURM_SUCCESS) {
-		list_sort(cr_job_list, _cr_job_list_sort);
-		job_iterator = list_iterator_create(cr_job_list);
-		if (job_iterator == NULL)
-			fatal ("memory allocation failure");
-		while ((tmp_job_ptr = list_next(job_iterator))) {
-		        int ovrlap;
-			bit_or(bitmap, orig_map);
-			ovrlap = bit_overlap(bitmap, tmp_job_ptr->node_bitmap);
-			if (ovrlap == 0)	/* job has no usable nodes */
-				continue;	/* skip it */
-			debug2("cons_res: _will_run_test, job %u: overlap=%d",
-			       tmp_job_ptr->job_id, ovrlap);
-			_rm_job_from_res(future_part, future_usage,
-					 tmp_job_ptr, 0);
-			rc = cr_job_test(job_ptr, bitmap, min_nodes,
-					 max_nodes, req_nodes,
-					 SELECT_MODE_WILL_RUN, cr_type,
-					 job_node_req, select_node_cnt,
-					 future_part, future_usage);
-			if (rc == SLURM_SUCCESS) {
-				if (tmp_job_ptr->end_time <= now)
-					job_ptr->start_time = now + 1;
-				else
-					job_ptr->start_time = tmp_job_ptr->
-						end_time;
-				break;
-			}
-		}
-		list_iterator_destroy(job_iterator);
+		rc = _will_run_search(job_ptr, bitmap, orig_map, min_nodes,
+				      max_nodes, req_nodes, job_node_req,
+				      preemptee_candidates, job_cnt,
+				      &future_part, &future_usage);
 	}
 
 	if ((rc == SLURM_SUCCESS) && preemptee_job_list &&
@@ -1792,7 +2126,6 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 		list_iterator_destroy(preemptee_iterator);
 	}
 
-	list_destroy(cr_job_list);
 	_destroy_part_data(future_part);
 	_destroy_node_data(future_usage, NULL);
 	FREE_NULL_BITMAP(orig_map);
@@ -1820,6 +2153,9 @@ extern int fini(void)
 	select_node_usage = NULL;
 	_destroy_part_data(select_part_record);
 	select_part_record = NULL;
+	_run_job_clear();
+	xfree(run_job_array);
+	run_job_size = 0;
 	xfree(cr_node_num_cores);
 	xfree(cr_node_cores_offset);
 
@@ -98,6 +98,8 @@ struct part_res_record {
 	uint16_t num_rows;		/* Number of row_bitmaps */
 	struct part_record *part_ptr;   /* controller part record pointer */
 	struct part_row_data *row;	/* array of rows containing jobs */
+	bool row_shared;		/* row belongs to another record,
+					 * copy it before any change */
 };
 
 /* per-node resource data */
@@ -78,7 +78,7 @@
 
 #define NO_SHARE_LIMIT	0xfffe
 #define NODEINFO_MAGIC	0x82ad
-#define RUN_JOB_INCR	16
+#define JOB_SET_INIT	16	/* initial size of job ID hash sets */
 #define SELECT_DEBUG	0
 
 /* These are defined here so when we link with something other than
@@ -94,6 +94,10 @@ int node_record_count __attribute__((weak_import));
 time_t last_node_update __attribute__((weak_import));
 struct switch_record *switch_record_table __attribute__((weak_import));
 int switch_record_cnt __attribute__((weak_import));
+int *node_switch_offset __attribute__((weak_import));
+int *node_switch_inx __attribute__((weak_import));
+int *leaf_switch_inx __attribute__((weak_import));
+int leaf_switch_cnt __attribute__((weak_import));
 #else
 slurm_ctl_conf_t slurmctld_conf;
 struct node_record *node_record_table_ptr;
@@ -103,6 +107,10 @@ int node_record_count;
 time_t last_node_update;
 struct switch_record *switch_record_table;
 int switch_record_cnt;
+int *node_switch_offset;
+int *node_switch_inx;
+int *leaf_switch_inx;
+int leaf_switch_cnt;
 #endif
 
 struct select_nodeinfo {
@@ -308,123 +316,130 @@ static int _fini_status_pthread(void)
 }
 #endif
 
-/* Add job id to record of jobs running on this node */
-static void _add_run_job(struct cr_record *cr_ptr, uint32_t job_id)
+/*
+ * Job ID sets are open addressing hash tables with linear probing. A zero
+ * job ID marks an empty slot. Tables are a power of 2 in size and at most
+ * half full, so that lookups and removals touch only a few slots.
+ */
+static inline uint32_t _job_set_hash(uint32_t job_id, uint32_t len)
 {
-	int i;
-
-	if (cr_ptr->run_job_ids == NULL) {	/* create new array */
-		cr_ptr->run_job_len = RUN_JOB_INCR;
-		cr_ptr->run_job_ids = xmalloc(sizeof(uint32_t) *
-					      cr_ptr->run_job_len);
-		cr_ptr->run_job_ids[0] = job_id;
-		return;
-	}
+	return (job_id * 2654435761U) & (len - 1);
+}
 
-	for (i=0; i<cr_ptr->run_job_len; i++) {
-		if (cr_ptr->run_job_ids[i])
-			continue;
-		/* fill in hole */
-		cr_ptr->run_job_ids[i] = job_id;
-		return;
-	}
+/* Return the slot holding job_id or the empty slot where it belongs */
+static uint32_t _job_set_slot(uint32_t *set, uint32_t len, uint32_t job_id)
+{
+	uint32_t i = _job_set_hash(job_id, len);
 
-	/* expand array and add to end */
-	cr_ptr->run_job_len += RUN_JOB_INCR;
-	xrealloc(cr_ptr->run_job_ids, sizeof(uint32_t) * cr_ptr->run_job_len);
-	cr_ptr->run_job_ids[i] = job_id;
+	while (set[i] && (set[i] != job_id))
+		i = (i + 1) & (len - 1);
+	return i;
 }
 
-/* Add job id to record of jobs running or suspended on this node */
-static void _add_tot_job(struct cr_record *cr_ptr, uint32_t job_id)
+static void _job_set_add(uint32_t **set, uint32_t *len, uint32_t *cnt,
+			 uint32_t job_id)
 {
-	int i;
+	uint32_t *old_set, old_len, i;
 
-	if (cr_ptr->tot_job_ids == NULL) {	/* create new array */
-		cr_ptr->tot_job_len = RUN_JOB_INCR;
-		cr_ptr->tot_job_ids = xmalloc(sizeof(uint32_t) *
-					      cr_ptr->tot_job_len);
-		cr_ptr->tot_job_ids[0] = job_id;
-		return;
+	if ((*cnt + 1) * 2 > *len) {		/* create or expand table */
+		old_set = *set;
+		old_len = *len;
+		*len = old_len ? (old_len * 2) : JOB_SET_INIT;
+		*set = xmalloc(sizeof(uint32_t) * *len);
+		for (i = 0; i < old_len; i++) {
+			if (old_set[i])
+				(*set)[_job_set_slot(*set, *len, old_set[i])] =
+					old_set[i];
+		}
+		xfree(old_set);
 	}
 
-	for (i=0; i<cr_ptr->tot_job_len; i++) {
-		if (cr_ptr->tot_job_ids[i])
-			continue;
-		/* fill in hole */
-		cr_ptr->tot_job_ids[i] = job_id;
-		return;
+	i = _job_set_slot(*set, *len, job_id);
+	if ((*set)[i] == 0) {
+		(*set)[i] = job_id;
+		(*cnt)++;
 	}
+}
 
-	/* expand array and add to end */
-	cr_ptr->tot_job_len += RUN_JOB_INCR;
-	xrealloc(cr_ptr->tot_job_ids, sizeof(uint32_t) * cr_ptr->tot_job_len);
-	cr_ptr->tot_job_ids[i] = job_id;
+static bool _job_set_test(uint32_t *set, uint32_t len, uint32_t job_id)
+{
+	if ((set == NULL) || (len == 0))
+		return false;
+	return (set[_job_set_slot(set, len, job_id)] != 0);
 }
 
-static bool _ck_run_job(struct cr_record *cr_ptr, uint32_t job_id,
-			bool clear_it)
+/* Remove job_id, moving back any later entries of its probe sequence into
+ * the hole so that no tombstones are needed */
+static bool _job_set_rem(uint32_t *set, uint32_t len, uint32_t *cnt,
+			 uint32_t job_id)
 {
-	int i;
-	bool rc = false;
+	uint32_t hole, i, home, mask = len - 1;
 
-	if ((cr_ptr->run_job_ids == NULL) || (cr_ptr->run_job_len == 0))
-		return rc;
+	if ((set == NULL) || (len == 0))
+		return false;
+	hole = _job_set_slot(set, len, job_id);
+	if (set[hole] == 0)
+		return false;
 
-	for (i=0; i<cr_ptr->run_job_len; i++) {
-		if (cr_ptr->run_job_ids[i] != job_id)
-			continue;
-		if (clear_it)
-			cr_ptr->run_job_ids[i] = 0;
-		rc = true;
+	i = hole;
+	while (1) {
+		i = (i + 1) & mask;
+		if (set[i] == 0)
+			break;
+		home = _job_set_hash(set[i], len);
+		/* Move the entry if its home slot is not in (hole, i] */
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			set[hole] = set[i];
+			hole = i;
+		}
 	}
-	return rc;
+	set[hole] = 0;
+	(*cnt)--;
+	return true;
+}
+
+/* Add job id to record of jobs running on this node */
+static void _add_run_job(struct cr_record *cr_ptr, uint32_t job_id)
+{
+	_job_set_add(&cr_ptr->run_job_ids, &cr_ptr->run_job_len,
+		     &cr_ptr->run_job_cnt, job_id);
+}
+
+/* Add job id to record of jobs running or suspended on this node */
+static void _add_tot_job(struct cr_record *cr_ptr, uint32_t job_id)
+{
+	_job_set_add(&cr_ptr->tot_job_ids, &cr_ptr->tot_job_len,
+		     &cr_ptr->tot_job_cnt, job_id);
 }
 
 /* Remove job id from record of jobs running,
  * RET true if successful, false if the job was not running */
 static bool _rem_run_job(struct cr_record *cr_ptr, uint32_t job_id)
 {
-	return _ck_run_job(cr_ptr, job_id, true);
+	return _job_set_rem(cr_ptr->run_job_ids, cr_ptr->run_job_len,
+			    &cr_ptr->run_job_cnt, job_id);
 }
 
 /* Test for job id in record of jobs running,
  * RET true if successful, false if the job was not running */
 static bool _test_run_job(struct cr_record *cr_ptr, uint32_t job_id)
 {
-	return _ck_run_job(cr_ptr, job_id, false);
+	return _job_set_test(cr_ptr->run_job_ids, cr_ptr->run_job_len, job_id);
 }
 
-static bool _ck_tot_job(struct cr_record *cr_ptr, uint32_t job_id,
-			bool clear_it)
-{
-	int i;
-	bool rc = false;
-
-	if ((cr_ptr->tot_job_ids == NULL) || (cr_ptr->tot_job_len == 0))
-		return rc;
-
-	for (i=0; i<cr_ptr->tot_job_len; i++) {
-		if (cr_ptr->tot_job_ids[i] != job_id)
-			continue;
-		if (clear_it)
-			cr_ptr->tot_job_ids[i] = 0;
-		rc = true;
-	}
-	return rc;
-}
 /* Remove job id from record of jobs running or suspended,
  * RET true if successful, false if the job was not found */
 static bool _rem_tot_job(struct cr_record *cr_ptr, uint32_t job_id)
 {
-	return _ck_tot_job(cr_ptr, job_id, true);
+	return _job_set_rem(cr_ptr->tot_job_ids, cr_ptr->tot_job_len,
+			    &cr_ptr->tot_job_cnt, job_id);
 }
 
 /* Test for job id in record of jobs running or suspended,
  * RET true if successful, false if the job was not found */
 static bool _test_tot_job(struct cr_record *cr_ptr, uint32_t job_id)
 {
-	return _ck_tot_job(cr_ptr, job_id, false);
+	return _job_set_test(cr_ptr->tot_job_ids, cr_ptr->tot_job_len, job_id);
 }
 
 static bool _enough_nodes(int avail_nodes, int rem_nodes,
@@ -624,8 +639,7 @@ static int _job_count_bitmap(struct cr_record *cr_ptr,
 			     int run_job_cnt, int tot_job_cnt, uint16_t mode)
 {
 	int i, i_first, i_last;
-	int count = 0, total_jobs, total_run_jobs;
-	struct part_cr_record *part_cr_ptr;
+	int count = 0;
 	struct node_record *node_ptr;
 	uint32_t job_memory_cpu = 0, job_memory_node = 0;
 	uint32_t alloc_mem = 0, job_mem = 0, avail_mem = 0;
@@ -712,16 +726,8 @@ static int _job_count_bitmap(struct cr_record *cr_ptr,
 			continue;
 		}
 
-		total_jobs = 0;
-		total_run_jobs = 0;
-		part_cr_ptr = cr_ptr->nodes[i].parts;
-		while (part_cr_ptr) {
-			total_run_jobs += part_cr_ptr->run_job_cnt;
-			total_jobs     += part_cr_ptr->tot_job_cnt;
-			part_cr_ptr = part_cr_ptr->next;
-		}
-		if ((total_run_jobs <= run_job_cnt) &&
-		    (total_jobs     <= tot_job_cnt)) {
+		if ((cr_ptr->nodes[i].run_job_cnt <= run_job_cnt) &&
+		    (cr_ptr->nodes[i].tot_job_cnt <= tot_job_cnt)) {
 			bit_set(jobmap, i);
 			count++;
 		} else {
@@ -741,13 +747,21 @@ static int _find_job_mate(struct job_record *job_ptr, bitstr_t *bitmap,
 			  uint32_t min_nodes, uint32_t max_nodes,
 			  uint32_t req_nodes)
 {
-	ListIterator job_iterator;
-	struct job_record *job_scan_ptr;
+	struct job_record *job_scan_ptr, *mate_ptr = NULL;
+	uint32_t i;
 	int rc = EINVAL;
 
-	job_iterator = list_iterator_create(job_list);
-	while ((job_scan_ptr = (struct job_record *) list_next(job_iterator))) {
-		if ((!IS_JOB_RUNNING(job_scan_ptr))			||
+	/* Only jobs in the running set can be mates, so there is no need
+	 * to scan pending and completed jobs in job_list. The set is in
+	 * hash order, so keep the mate with the lowest job ID, which is
+	 * the first one a scan of job_list (in submission order) finds. */
+	for (i = 0; i < cr_ptr->run_job_len; i++) {
+		if ((cr_ptr->run_job_ids[i] == 0) ||
+		    (mate_ptr && (cr_ptr->run_job_ids[i] > mate_ptr->job_id)))
+			continue;
+		job_scan_ptr = find_job_record(cr_ptr->run_job_ids[i]);
+		if ((job_scan_ptr == NULL)				||
+		    (!IS_JOB_RUNNING(job_scan_ptr))			||
 		    (job_scan_ptr->node_cnt   != req_nodes)		||
 		    (job_scan_ptr->total_cpus <
 		     job_ptr->details->min_cpus)			||
@@ -768,12 +782,13 @@ static int _find_job_mate(struct job_record *job_ptr, bitstr_t *bitmap,
 				 job_scan_ptr->node_bitmap) != 0))
 			continue;	/* Excluded nodes in this job */
 
-		bit_and(bitmap, job_scan_ptr->node_bitmap);
-		job_ptr->total_cpus = job_scan_ptr->total_cpus;
+		mate_ptr = job_scan_ptr;
+	}
+	if (mate_ptr) {
+		bit_and(bitmap, mate_ptr->node_bitmap);
+		job_ptr->total_cpus = mate_ptr->total_cpus;
 		rc = SLURM_SUCCESS;
-		break;
 	}
-	list_iterator_destroy(job_iterator);
 	return rc;
 }
 
@@ -1043,12 +1058,14 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	int       *switches_cpu_cnt;		/* total CPUs on switch */
 	uint32_t  *switches_node_cnt;		/* total nodes on switch */
 	int       *switches_required;		/* set if has required node */
+	int       *leaf_inx = NULL;		/* usable leaf switches */
+	int        leaf_cnt = 0;
 
 	bitstr_t  *req_nodes_bitmap   = NULL;
 	int rem_cpus;			/* remaining resources desired */
 	int avail_cpus, total_cpus = 0;
 	uint32_t want_nodes, alloc_nodes = 0;
-	int i, j, rc = SLURM_SUCCESS;
+	int i, j, k, rc = SLURM_SUCCESS;
 	int best_fit_inx, first, last;
 	int best_fit_nodes, best_fit_cpus;
 	int best_fit_location = 0, best_fit_sufficient;
@@ -1136,12 +1153,15 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	debug5("_job_test_topo: phase 2");
 #endif
 	for (i = 0; i < node_record_count; i++) {
+		/* A node is in the bitmap of all switches holding it,
+		 * or in none of them */
+		k = node_switch_offset[i];
+		if ((k == node_switch_offset[i+1]) ||
+		    !bit_test(switches_bitmap[node_switch_inx[k]], i))
+			continue;
 		avail_cpus = _get_avail_cpus(job_ptr, i);
-		for (j=0; j<switch_record_cnt; j++) {
-			if (bit_test(switches_bitmap[j], i)) {
-				switches_cpu_cnt[j] += avail_cpus;
-			}
-		}
+		for ( ; k < node_switch_offset[i+1]; k++)
+			switches_cpu_cnt[node_switch_inx[k]] += avail_cpus;
 	}
 
 	/* phase 3 */
@@ -1177,21 +1197,25 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 #if SELECT_DEBUG
 	debug5("_job_test_topo: phase 4");
 #endif
-	/* Identify usable leafs (within higher switch having best fit) */
-	for (j=0; j<switch_record_cnt; j++) {
-		if ((switch_record_table[j].level > 0) ||
-		    (!bit_super_set(switches_bitmap[j],
-				    switches_bitmap[best_fit_inx]))) {
-			switches_node_cnt[j] = 0;
-		} else if (req_nodes_bitmap) {
+	/* Identify usable leafs (within higher switch having best fit).
+	 * Only these are considered from here on. */
+	leaf_inx = xmalloc(sizeof(int) * (leaf_switch_cnt + 1));
+	for (k=0; k<leaf_switch_cnt; k++) {
+		j = leaf_switch_inx[k];
+		if (!bit_super_set(switches_bitmap[j],
+				   switches_bitmap[best_fit_inx]))
+			continue;
+		if (req_nodes_bitmap) {
 			/* we have subnodes count zeroed yet so count them */
 			switches_node_cnt[j] = bit_set_count(switches_bitmap[j]);
 		}
+		leaf_inx[leaf_cnt++] = j;
 	}
 	/* set already allocated nodes and gather additional resources */
 	if (req_nodes_bitmap) {
 		/* Accumulate specific required resources, if any */
-		for (j=0; j<switch_record_cnt; j++) {
+		for (k=0; k<leaf_cnt; k++) {
+			j = leaf_inx[k];
 			if (alloc_nodes > max_nodes)
 				break;
 			if (switches_node_cnt[j] == 0 ||
@@ -1234,7 +1258,8 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 		}
 		/* Accumulate additional resources from leafs that
 		 * contain required nodes */
-		for (j=0; j<switch_record_cnt; j++) {
+		for (k=0; k<leaf_cnt; k++) {
+			j = leaf_inx[k];
 			if ((alloc_nodes > max_nodes) ||
 			    ((alloc_nodes >= want_nodes) && (rem_cpus <= 0)))
 				break;
@@ -1284,7 +1309,8 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 	       ((alloc_nodes < want_nodes) || (rem_cpus > 0))) {
 		best_fit_cpus = best_fit_nodes = best_fit_sufficient = 0;
 		i = min_nodes - alloc_nodes; /* use it as a temp. int */
-		for (j=0; j<switch_record_cnt; j++) {
+		for (k=0; k<leaf_cnt; k++) {
+			j = leaf_inx[k];
 			if (switches_node_cnt[j] == 0)
 				continue;
 			sufficient = (switches_cpu_cnt[j] >= rem_cpus) &&
@@ -1381,6 +1407,7 @@ fini:	if (rc == SLURM_SUCCESS) {
 	xfree(switches_cpu_cnt);
 	xfree(switches_node_cnt);
 	xfree(switches_required);
+	xfree(leaf_inx);
 
 	return rc;
 }
@@ -1500,22 +1527,26 @@ static int _rm_job_from_nodes(struct cr_record *cr_ptr,
 			}
 			if (!is_job_running)
 				/* cancelled job already suspended */;
-			else if (part_cr_ptr->run_job_cnt > 0)
+			else if (part_cr_ptr->run_job_cnt > 0) {
 				part_cr_ptr->run_job_cnt--;
-			else {
+				cr_ptr->nodes[i].run_job_cnt--;
+			} else {
 				error("%s: run_job_cnt underflow for node %s",
 				      pre_err, node_ptr->name);
 			}
 			if (remove_all) {
-				if (part_cr_ptr->tot_job_cnt > 0)
+				if (part_cr_ptr->tot_job_cnt > 0) {
 					part_cr_ptr->tot_job_cnt--;
-				else {
+					cr_ptr->nodes[i].tot_job_cnt--;
+				} else {
 					error("%s: tot_job_cnt underflow "
 					      "for node %s",
 					      pre_err, node_ptr->name);
 				}
 				if ((part_cr_ptr->tot_job_cnt == 0) &&
 				    (part_cr_ptr->run_job_cnt)) {
+					cr_ptr->nodes[i].run_job_cnt -=
+						part_cr_ptr->run_job_cnt;
 					part_cr_ptr->run_job_cnt = 0;
 					error("%s: run_job_cnt out of sync "
 					      "for node %s",
@@ -1772,20 +1803,24 @@ static int _decr_node_job_cnt(int node_inx, struct job_record *job_ptr,
 		}
 		if (!is_job_running)
 			/* cancelled job already suspended */;
-		else if (part_cr_ptr->run_job_cnt > 0)
+		else if (part_cr_ptr->run_job_cnt > 0) {
 			part_cr_ptr->run_job_cnt--;
-		else {
+			cr_ptr->nodes[node_inx].run_job_cnt--;
+		} else {
 			error("%s: run_job_cnt underflow for node %s",
 			      pre_err, node_ptr->name);
 		}
-		if (part_cr_ptr->tot_job_cnt > 0)
+		if (part_cr_ptr->tot_job_cnt > 0) {
 			part_cr_ptr->tot_job_cnt--;
-		else {
+			cr_ptr->nodes[node_inx].tot_job_cnt--;
+		} else {
 			error("%s: tot_job_cnt underflow for node %s",
 			      pre_err, node_ptr->name);
 		}
 		if ((part_cr_ptr->tot_job_cnt == 0) &&
 		    (part_cr_ptr->run_job_cnt)) {
+			cr_ptr->nodes[node_inx].run_job_cnt -=
+				part_cr_ptr->run_job_cnt;
 			part_cr_ptr->run_job_cnt = 0;
 			error("%s: run_job_cnt out of sync for node %s",
 			      pre_err, node_ptr->name);
@@ -1978,9 +2013,12 @@ static int _add_job_to_nodes(struct cr_record *cr_ptr,
 				part_cr_ptr = part_cr_ptr->next;
 				continue;
 			}
-			if (alloc_all)
+			if (alloc_all) {
 				part_cr_ptr->run_job_cnt++;
+				cr_ptr->nodes[i].run_job_cnt++;
+			}
 			part_cr_ptr->tot_job_cnt++;
+			cr_ptr->nodes[i].tot_job_cnt++;
 			break;
 		}
 		if (part_cr_ptr == NULL) {
@@ -2042,9 +2080,11 @@ static void _dump_node_cr(struct cr_record *cr_ptr)
 
 	for (i = 0; i < select_node_cnt; i++) {
 		node_ptr = node_record_table_ptr + i;
-		info("Node:%s exclusive_cnt:%u alloc_mem:%u",
+		info("Node:%s exclusive_cnt:%u alloc_mem:%u run:%u tot:%u",
 		     node_ptr->name, cr_ptr->nodes[i].exclusive_cnt,
-		     cr_ptr->nodes[i].alloc_memory);
+		     cr_ptr->nodes[i].alloc_memory,
+		     cr_ptr->nodes[i].run_job_cnt,
+		     cr_ptr->nodes[i].tot_job_cnt);
 
 		part_cr_ptr = cr_ptr->nodes[i].parts;
 		while (part_cr_ptr) {
@@ -2078,13 +2118,19 @@ static struct cr_record *_dup_cr(struct cr_record *cr_ptr)
 
 	new_cr_ptr = xmalloc(sizeof(struct cr_record));
 	new_cr_ptr->run_job_len = cr_ptr->run_job_len;
+	new_cr_ptr->run_job_cnt = cr_ptr->run_job_cnt;
 	i = sizeof(uint32_t) * cr_ptr->run_job_len;
-	new_cr_ptr->run_job_ids = xmalloc(i);
-	memcpy(new_cr_ptr->run_job_ids, cr_ptr->run_job_ids, i);
+	if (i) {
+		new_cr_ptr->run_job_ids = xmalloc(i);
+		memcpy(new_cr_ptr->run_job_ids, cr_ptr->run_job_ids, i);
+	}
 	new_cr_ptr->tot_job_len = cr_ptr->tot_job_len;
+	new_cr_ptr->tot_job_cnt = cr_ptr->tot_job_cnt;
 	i = sizeof(uint32_t) * cr_ptr->tot_job_len;
-	new_cr_ptr->tot_job_ids = xmalloc(i);
-	memcpy(new_cr_ptr->tot_job_ids, cr_ptr->tot_job_ids, i);
+	if (i) {
+		new_cr_ptr->tot_job_ids = xmalloc(i);
+		memcpy(new_cr_ptr->tot_job_ids, cr_ptr->tot_job_ids, i);
+	}
 
 	new_cr_ptr->nodes = xmalloc(select_node_cnt *
 				    sizeof(struct node_cr_record));
@@ -2094,6 +2140,10 @@ static struct cr_record *_dup_cr(struct cr_record *cr_ptr)
 			alloc_memory;
 		new_cr_ptr->nodes[i].exclusive_cnt = cr_ptr->nodes[i].
 			exclusive_cnt;
+		new_cr_ptr->nodes[i].run_job_cnt = cr_ptr->nodes[i].
+			run_job_cnt;
+		new_cr_ptr->nodes[i].tot_job_cnt = cr_ptr->nodes[i].
+			tot_job_cnt;
 
 		part_cr_ptr = cr_ptr->nodes[i].parts;
 		while (part_cr_ptr) {
@@ -2247,8 +2297,10 @@ static void _init_node_cr(void)
 				     (job_ptr->priority != 0))) {
 					/* Running or being gang scheduled */
 					part_cr_ptr->run_job_cnt++;
+					cr_ptr->nodes[i].run_job_cnt++;
 				}
 				part_cr_ptr->tot_job_cnt++;
+				cr_ptr->nodes[i].tot_job_cnt++;
 				break;
 			}
 			if (part_cr_ptr == NULL) {
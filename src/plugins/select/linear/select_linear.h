@@ -70,17 +70,22 @@ struct node_cr_record {
 	uint16_t exclusive_cnt;		/* count of jobs exclusively allocated
 					 * this node (from different
 					 * partitions) */
+	uint16_t run_job_cnt;		/* sum of run_job_cnt in parts */
+	uint16_t tot_job_cnt;		/* sum of tot_job_cnt in parts */
 	List gres_list;			/* list of gres state info managed by 
 					 * plugins */
 };
 
 struct cr_record {
 	struct node_cr_record *nodes;	/* ptr to array of node records */
-	uint32_t *run_job_ids;		/* job IDs for running jobs */
-	uint16_t run_job_len;		/* length of run_job_ids array */
-	uint32_t *tot_job_ids;		/* job IDs for allocated jobs 
-					 * (RUNNING & SUSPENDED)*/
-	uint16_t tot_job_len;		/* length of tot_job_ids array */
+	uint32_t *run_job_ids;		/* hash set of job IDs for running
+					 * jobs, zero for an empty slot */
+	uint32_t run_job_len;		/* size of run_job_ids, a power of 2 */
+	uint32_t run_job_cnt;		/* count of job IDs in run_job_ids */
+	uint32_t *tot_job_ids;		/* hash set of job IDs for allocated
+					 * jobs (RUNNING & SUSPENDED) */
+	uint32_t tot_job_len;		/* size of tot_job_ids, a power of 2 */
+	uint32_t tot_job_cnt;		/* count of job IDs in tot_job_ids */
 };
 
 #endif /* !_SELECT_LINEAR_H */
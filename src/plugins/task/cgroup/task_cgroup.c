@@ -44,6 +44,7 @@
 
 #include "slurm/slurm_errno.h"
 #include "src/common/slurm_xlator.h"
+#include "src/common/timers.h"
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
 
 #include "src/common/xcgroup_read_config.h"
@@ -211,7 +212,9 @@ extern int task_slurmd_release_resources (uint32_t job_id)
  */
 extern int task_pre_setuid (slurmd_job_t *job)
 {
+	DEF_TIMERS;
 
+	START_TIMER;
 	if (use_cpuset) {
 		/* we create the cpuset container as we are still root */
 		task_cgroup_cpuset_create(job);
@@ -226,6 +229,9 @@ extern int task_pre_setuid (slurmd_job_t *job)
 		task_cgroup_devices_create(job);
 		/* here we should create the devices container as we are root */
 	}
+	END_TIMER;
+	debug2("task/cgroup: step %u.%u cgroups set up in %s",
+	       job->jobid, job->stepid, TIME_STR);
 
 	return SLURM_SUCCESS;
 }
@@ -275,6 +281,12 @@ extern int task_post_term (slurmd_job_t *job)
  */
 extern int task_post_step (slurmd_job_t *job)
 {
+	DEF_TIMERS;
+
+	START_TIMER;
 	fini();
+	END_TIMER;
+	debug2("task/cgroup: step %u.%u cgroups released in %s",
+	       job->jobid, job->stepid, TIME_STR);
 	return SLURM_SUCCESS;
 }
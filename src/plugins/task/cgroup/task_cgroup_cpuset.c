@@ -52,11 +52,6 @@
 #include "src/common/xcgroup.h"
 #include "src/common/xcpuinfo.h"
 
-#ifdef HAVE_HWLOC
-#include <hwloc.h>
-#include <hwloc/glibc-sched.h>
-#endif
-
 #ifndef PATH_MAX
 #define PATH_MAX 256
 #endif
@@ -71,7 +66,19 @@ static xcgroup_t user_cpuset_cg;
 static xcgroup_t job_cpuset_cg;
 static xcgroup_t step_cpuset_cg;
 
-static int _xcgroup_cpuset_init(xcgroup_t* cg);
+/*
+ * Objects used as affinity granularity, from the coarsest to the finest.
+ * They are built from the node topology handed over by slurmd (block map,
+ * NUMA map and socket/core/thread counts) instead of being probed again
+ * for each task.
+ */
+#define CG_OBJ_MACHINE	0
+#define CG_OBJ_LDOM	1
+#define CG_OBJ_SOCKET	2
+#define CG_OBJ_CORE	3
+#define CG_OBJ_PU	4
+
+static int _xcgroup_cpuset_init(xcgroup_t* cg, char* cpus);
 
 extern int task_cgroup_cpuset_init(slurm_cgroup_conf_t *slurm_cgroup_conf)
 {
@@ -268,26 +275,29 @@ extern int task_cgroup_cpuset_create(slurmd_job_t *job)
 	 * check that user's cpuset cgroup is consistant and add the job cores
 	 */
 	rc = xcgroup_get_param(&user_cpuset_cg,"cpuset.cpus",&cpus,&cpus_size);
+	user_alloc_cores = xstrdup(job_alloc_cores);
 	if (rc != XCGROUP_SUCCESS || cpus_size == 1) {
 		/* initialize the cpusets as it was inexistant */
-		if (_xcgroup_cpuset_init(&user_cpuset_cg) !=
+		if (_xcgroup_cpuset_init(&user_cpuset_cg, user_alloc_cores) !=
 		     XCGROUP_SUCCESS) {
 			xcgroup_delete(&user_cpuset_cg);
 			xcgroup_destroy(&user_cpuset_cg);
+			xfree(cpus);
 			goto error;
 		}
-	}
-	user_alloc_cores = xstrdup(job_alloc_cores);
-	if (cpus != NULL && cpus_size > 1) {
+	} else {
 		cpus[cpus_size-1]='\0';
 		xstrcat(user_alloc_cores,",");
 		xstrcat(user_alloc_cores,cpus);
+		xcgroup_set_param(&user_cpuset_cg,"cpuset.cpus",
+				  user_alloc_cores);
 	}
-	xcgroup_set_param(&user_cpuset_cg,"cpuset.cpus",user_alloc_cores);
 	xfree(cpus);
 
 	/*
 	 * create job cgroup in the cpuset ns (it could already exist)
+	 * the job cores are the same for every step of the job on this
+	 * node, so an existing job cgroup is already set up
 	 */
 	if (xcgroup_create(&cpuset_ns,&job_cpuset_cg,
 			    job_cgroup_path,
@@ -300,12 +310,14 @@ extern int task_cgroup_cpuset_create(slurmd_job_t *job)
 		xcgroup_destroy(&job_cpuset_cg);
 		goto error;
 	}
-	if (_xcgroup_cpuset_init(&job_cpuset_cg) != XCGROUP_SUCCESS) {
+	if (job_cpuset_cg.created &&
+	    _xcgroup_cpuset_init(&job_cpuset_cg, job_alloc_cores) !=
+	    XCGROUP_SUCCESS) {
 		xcgroup_destroy(&user_cpuset_cg);
+		xcgroup_delete(&job_cpuset_cg);
 		xcgroup_destroy(&job_cpuset_cg);
 		goto error;
 	}
-	xcgroup_set_param(&job_cpuset_cg,"cpuset.cpus",job_alloc_cores);
 
 	/*
 	 * create step cgroup in the cpuset ns (it should not exists)
@@ -327,14 +339,14 @@ extern int task_cgroup_cpuset_create(slurmd_job_t *job)
 		xcgroup_destroy(&step_cpuset_cg);
 		goto error;
 	}
-	if (_xcgroup_cpuset_init(&step_cpuset_cg) != XCGROUP_SUCCESS) {
+	if (_xcgroup_cpuset_init(&step_cpuset_cg, step_alloc_cores) !=
+	    XCGROUP_SUCCESS) {
 		xcgroup_destroy(&user_cpuset_cg);
 		xcgroup_destroy(&job_cpuset_cg);
 		xcgroup_delete(&step_cpuset_cg);
 		xcgroup_destroy(&step_cpuset_cg);
 		goto error;
 	}
-	xcgroup_set_param(&step_cpuset_cg,"cpuset.cpus",step_alloc_cores);
 
 	/* attach the slurmstepd to the step cpuset cgroup */
 	pid_t pid = getpid();
@@ -367,19 +379,179 @@ extern int task_cgroup_cpuset_attach_task(slurmd_job_t *job)
 	return fstatus;
 }
 
+static uint32_t _cg_pu_cnt(void)
+{
+	return conf->block_map_size ? conf->block_map_size : CPU_SETSIZE;
+}
+
+/* Machine CPU id of an abstract PU */
+static int _cg_abs_to_mac(uint32_t abs)
+{
+	if (conf->block_map_size)
+		return conf->block_map[abs];
+	return abs;
+}
+
+/* Number of abstract PUs in each object of a type, but NUMA nodes which
+ * are taken from the NUMA map */
+static uint32_t _cg_obj_size(int type)
+{
+	uint32_t threads = conf->actual_threads, cores = conf->actual_cores;
+	uint32_t pus = conf->block_map_size;
+
+	if (!pus || (conf->actual_sockets * cores * threads != pus)) {
+		/* no usable topology, each PU is a core of a single socket */
+		threads = 1;
+		cores = pus ? pus : CPU_SETSIZE;
+	}
+	switch (type) {
+	case CG_OBJ_PU:
+		return 1;
+	case CG_OBJ_CORE:
+		return threads;
+	case CG_OBJ_SOCKET:
+		return cores * threads;
+	default:
+		return _cg_pu_cnt();
+	}
+}
+
+/* Index of the object of a type holding the abstract PU abs, -1 if the
+ * node has no object of that type (NUMA nodes it does not report) */
+static int _cg_obj_id(int type, uint32_t abs)
+{
+	if (type == CG_OBJ_LDOM) {
+		if (!conf->numa_map)
+			return -1;
+		return conf->numa_map[_cg_abs_to_mac(abs)];
+	}
+	return abs / _cg_obj_size(type);
+}
+
+/* xmalloc'd array telling which objects of a type have allowed PUs,
+ * *nobj is set to its size */
+static char *_cg_obj_allowed(int type, cpu_set_t *allowed, uint32_t *nobj)
+{
+	uint32_t abs, pus = _cg_pu_cnt();
+	char *seen;
+	int id;
+
+	*nobj = 0;
+	for (abs = 0; abs < pus; abs++) {
+		id = _cg_obj_id(type, abs);
+		if (id >= (int) *nobj)
+			*nobj = id + 1;
+	}
+	seen = xmalloc(*nobj + 1);
+	for (abs = 0; abs < pus; abs++) {
+		id = _cg_obj_id(type, abs);
+		if ((id >= 0) && CPU_ISSET(_cg_abs_to_mac(abs), allowed))
+			seen[id] = 1;
+	}
+	return seen;
+}
+
+/* Number of objects of a type having allowed PUs */
+static uint32_t _cg_obj_count(int type, cpu_set_t *allowed)
+{
+	uint32_t i, nobj, cnt = 0;
+	char *seen = _cg_obj_allowed(type, allowed, &nobj);
+
+	for (i = 0; i < nobj; i++) {
+		if (seen[i])
+			cnt++;
+	}
+	xfree(seen);
+	return cnt;
+}
+
+/* First abstract PU of the inx'th object of a type having allowed PUs,
+ * -1 if there is no such object */
+static int _cg_obj_first(int type, uint32_t inx, cpu_set_t *allowed)
+{
+	uint32_t i, nobj, abs, pus = _cg_pu_cnt();
+	char *seen = _cg_obj_allowed(type, allowed, &nobj);
+	int id = -1;
+
+	for (i = 0; i < nobj; i++) {
+		if (seen[i] && (inx-- == 0)) {
+			id = i;
+			break;
+		}
+	}
+	xfree(seen);
+	if (id < 0)
+		return -1;
+	for (abs = 0; abs < pus; abs++) {
+		if (_cg_obj_id(type, abs) == id)
+			return abs;
+	}
+	return -1;
+}
+
+/* Add to cpuset the allowed PUs of the object of a type holding the
+ * abstract PU abs. Without such an object the whole machine is used, as
+ * for ldom binding on a node which does not report its NUMA nodes. */
+static void _cg_obj_add(int type, uint32_t abs, cpu_set_t *allowed,
+			cpu_set_t *cpuset)
+{
+	uint32_t i, pus = _cg_pu_cnt();
+	int id = _cg_obj_id(type, abs), mac;
+
+	for (i = 0; i < pus; i++) {
+		if ((id >= 0) && (_cg_obj_id(type, i) != id))
+			continue;
+		mac = _cg_abs_to_mac(i);
+		if (CPU_ISSET(mac, allowed))
+			CPU_SET(mac, cpuset);
+	}
+}
+
+static const char *_cg_obj_name(int type)
+{
+	switch (type) {
+	case CG_OBJ_PU:
+		return "PU";
+	case CG_OBJ_CORE:
+		return "Core";
+	case CG_OBJ_SOCKET:
+		return "Socket";
+	case CG_OBJ_LDOM:
+		return "NUMANode";
+	default:
+		return "Machine";
+	}
+}
+
+/* xmalloc'd list of the machine CPU ids of a cpuset, e.g. "0-3,8" */
+static char *_cg_cpu_set_str(cpu_set_t *cpuset)
+{
+	char *str = NULL;
+	int i, start = -1;
+
+	for (i = 0; i <= CPU_SETSIZE; i++) {
+		if ((i < CPU_SETSIZE) && CPU_ISSET(i, cpuset)) {
+			if (start < 0)
+				start = i;
+			continue;
+		}
+		if (start < 0)
+			continue;
+		if (start == i - 1)
+			xstrfmtcat(str, "%s%d", str ? "," : "", start);
+		else
+			xstrfmtcat(str, "%s%d-%d", str ? "," : "", start,
+				   i - 1);
+		start = -1;
+	}
+	return str;
+}
+
 /* affinity should be set using sched_setaffinity to not force */
 /* user to have to play with the cgroup hierarchy to modify it */
 extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 {
 	int fstatus = SLURM_ERROR;
-
-#ifndef HAVE_HWLOC
-
-	error("task/cgroup: plugin not compiled with hwloc support, "
-	      "skipping affinity.");
-	return fstatus;
-
-#else
 	uint32_t i;
 	uint32_t nldoms;
 	uint32_t nsockets;
@@ -394,22 +566,14 @@ extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 	pid_t    pid = job->envtp->task_pid;
 
 	cpu_bind_type_t bind_type;
-	int verbose;
+	int verbose = 0;
 
-	hwloc_topology_t topology;
-#if HWLOC_API_VERSION <= 0x00010000
-	hwloc_cpuset_t cpuset,ct;
-#else
-	hwloc_bitmap_t cpuset,ct;
-#endif
-	hwloc_obj_t obj;
-	struct hwloc_obj *pobj;
-	hwloc_obj_type_t hwtype;
-	hwloc_obj_type_t req_hwtype;
-	int hwdepth;
+	int hwtype, req_hwtype;
+	int first;
+	char *str;
 
 	size_t tssize;
-	cpu_set_t ts;
+	cpu_set_t allowed, ts;
 
 	bind_type = job->cpu_bind_type ;
 	if (conf->task_plugin_param & CPU_BIND_VERBOSE ||
@@ -425,39 +589,32 @@ extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 		if (verbose)
 			info("task/cgroup: task[%u] is requesting "
 			     "thread level binding",taskid);
-		req_hwtype = HWLOC_OBJ_PU;
+		req_hwtype = CG_OBJ_PU;
 	} else if (bind_type & CPU_BIND_TO_CORES) {
 		if (verbose)
 			info("task/cgroup: task[%u] is requesting "
 			     "core level binding",taskid);
-		req_hwtype = HWLOC_OBJ_CORE;
+		req_hwtype = CG_OBJ_CORE;
 	} else if (bind_type & CPU_BIND_TO_SOCKETS) {
 		if (verbose)
 			info("task/cgroup: task[%u] is requesting "
 			     "socket level binding",taskid);
-		req_hwtype = HWLOC_OBJ_SOCKET;
+		req_hwtype = CG_OBJ_SOCKET;
 	} else if (bind_type & CPU_BIND_TO_LDOMS) {
 		if (verbose)
 			info("task/cgroup: task[%u] is requesting "
 			     "ldom level binding",taskid);
-		req_hwtype = HWLOC_OBJ_NODE;
+		req_hwtype = CG_OBJ_LDOM;
 	} else {
 		if (verbose)
 			info("task/cgroup: task[%u] using core level binding"
 			     " by default",taskid);
-		req_hwtype = HWLOC_OBJ_CORE;
+		req_hwtype = CG_OBJ_CORE;
 	}
 
-	/* Allocate and initialize hwloc objects */
-	hwloc_topology_init(&topology);
-#if HWLOC_API_VERSION <= 0x00010000
-	cpuset = hwloc_cpuset_alloc() ;
-#else
-	cpuset = hwloc_bitmap_alloc() ;
-#endif
-
 	/*
-	 * Perform the topology detection. It will only get allowed PUs.
+	 * Only the PUs allowed to the task (those of the step cpuset) are
+	 * taken into account, as its affinity already reflects them.
 	 * Detect in the same time the granularity to use for binding.
 	 * The granularity can be relaxed from threads to cores if enough
 	 * cores are available as with hyperthread support, ntasks-per-core
@@ -472,41 +629,36 @@ extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 	 * to dispatch the tasks across the sockets and then provide access
 	 * to each task to the cores of its socket.)
 	 */
-	hwloc_topology_load(topology);
-	npus = (uint32_t) hwloc_get_nbobjs_by_type(topology,
-						   HWLOC_OBJ_PU);
-	ncores = (uint32_t) hwloc_get_nbobjs_by_type(topology,
-						     HWLOC_OBJ_CORE);
-	nsockets = (uint32_t) hwloc_get_nbobjs_by_type(topology,
-						       HWLOC_OBJ_SOCKET);
-	nldoms = (uint32_t) hwloc_get_nbobjs_by_type(topology,
-						     HWLOC_OBJ_NODE);
-	hwtype = HWLOC_OBJ_MACHINE;
+	tssize = sizeof(cpu_set_t);
+	if (sched_getaffinity(pid, tssize, &allowed)) {
+		error("task/cgroup: task[%u] unable to get allowed cpus: %m",
+		      taskid);
+		return fstatus;
+	}
+	npus = _cg_obj_count(CG_OBJ_PU, &allowed);
+	ncores = _cg_obj_count(CG_OBJ_CORE, &allowed);
+	nsockets = _cg_obj_count(CG_OBJ_SOCKET, &allowed);
+	nldoms = _cg_obj_count(CG_OBJ_LDOM, &allowed);
+	hwtype = CG_OBJ_MACHINE;
 	nobj = 1;
 	if (npus >= jnpus || bind_type & CPU_BIND_TO_THREADS) {
-		hwtype = HWLOC_OBJ_PU;
+		hwtype = CG_OBJ_PU;
 		nobj = npus;
 	}
 	if (ncores >= jnpus || bind_type & CPU_BIND_TO_CORES) {
-		hwtype = HWLOC_OBJ_CORE;
+		hwtype = CG_OBJ_CORE;
 		nobj = ncores;
 	}
 	if (nsockets >= jntasks &&
 	     bind_type & CPU_BIND_TO_SOCKETS) {
-		hwtype = HWLOC_OBJ_SOCKET;
+		hwtype = CG_OBJ_SOCKET;
 		nobj = nsockets;
 	}
-	/*
-	 * HWLOC returns all the NUMA nodes available regardless of the
-	 * number of underlying sockets available (regardless of the allowed
-	 * resources). So there is no guarantee that each ldom will be populated
-	 * with usable sockets. So add a simple check that at least ensure that
-	 * we have as many sockets as ldoms before moving to ldoms granularity
-	 */
+	/* only the NUMA nodes having allowed PUs are counted, there can be
+	 * more of them than sockets */
 	if (nldoms >= jntasks &&
-	     nsockets >= nldoms &&
 	     bind_type & CPU_BIND_TO_LDOMS) {
-		hwtype = HWLOC_OBJ_NODE;
+		hwtype = CG_OBJ_LDOM;
 		nobj = nldoms;
 	}
 
@@ -515,24 +667,23 @@ extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 	 * granularity.
 	 * If not enough objects to do the job, revert to no affinity mode
 	 */
-	if (hwloc_compare_types(hwtype,HWLOC_OBJ_MACHINE) == 0) {
+	if (hwtype == CG_OBJ_MACHINE) {
 
 		info("task/cgroup: task[%u] disabling affinity because of %s "
-		     "granularity",taskid,hwloc_obj_type_string(hwtype));
+		     "granularity",taskid,_cg_obj_name(hwtype));
 
-	} else if (hwloc_compare_types(hwtype,HWLOC_OBJ_CORE) >= 0 &&
-		    jnpus > nobj) {
+	} else if (hwtype >= CG_OBJ_CORE && jnpus > nobj) {
 
 		info("task/cgroup: task[%u] not enough %s objects, disabling "
-		     "affinity",taskid,hwloc_obj_type_string(hwtype));
+		     "affinity",taskid,_cg_obj_name(hwtype));
 
 	} else {
 
 		if (verbose) {
 			info("task/cgroup: task[%u] using %s granularity",
-			     taskid,hwloc_obj_type_string(hwtype));
+			     taskid,_cg_obj_name(hwtype));
 		}
-		if (hwloc_compare_types(hwtype,HWLOC_OBJ_CORE) >= 0) {
+		if (hwtype >= CG_OBJ_CORE) {
 			/* cores or threads granularity */
 			pfirst = taskid *  job->cpus_per_task ;
 			plast = pfirst + job->cpus_per_task - 1;
@@ -542,128 +693,55 @@ extern int task_cgroup_cpuset_set_task_affinity(slurmd_job_t *job)
 			plast = pfirst;
 		}
 
-		hwdepth = hwloc_get_type_depth(topology,hwtype);
+		CPU_ZERO(&ts);
 		for (i = pfirst; i <= plast && i < nobj ; i++) {
-			obj = hwloc_get_obj_by_depth(topology,hwdepth,(int)i);
-
+			first = _cg_obj_first(hwtype, i, &allowed);
+			if (first < 0)
+				break;
 			/* if requested binding overlap the granularity */
 			/* use the ancestor cpuset instead of the object one */
-			if (hwloc_compare_types(hwtype,req_hwtype) > 0) {
-
-				/* Get the parent object of req_hwtype or the */
-				/* one just above if not found (meaning of >0)*/
-				/* (useful for ldoms binding with !NUMA nodes)*/
-				pobj = obj->parent;
-				while (pobj != NULL &&
-					hwloc_compare_types(pobj->type,
-							    req_hwtype) > 0)
-					pobj = pobj->parent;
-
-				if (pobj != NULL) {
-					if (verbose)
-						info("task/cgroup: task[%u] "
-						     "higher level %s found",
-						     taskid,
-						     hwloc_obj_type_string(
-							     pobj->type));
-#if HWLOC_API_VERSION <= 0x00010000
-					ct = hwloc_cpuset_dup(pobj->
-							      allowed_cpuset);
-					hwloc_cpuset_or(cpuset,cpuset,ct);
-					hwloc_cpuset_free(ct);
-#else
-					ct = hwloc_bitmap_dup(pobj->
-							      allowed_cpuset);
-					hwloc_bitmap_or(cpuset,cpuset,ct);
-					hwloc_bitmap_free(ct);
-#endif
-				} else {
-					/* should not be executed */
-					if (verbose)
-						info("task/cgroup: task[%u] "
-						     "no higher level found",
-						     taskid);
-#if HWLOC_API_VERSION <= 0x00010000
-					ct = hwloc_cpuset_dup(obj->
-							      allowed_cpuset);
-					hwloc_cpuset_or(cpuset,cpuset,ct);
-					hwloc_cpuset_free(ct);
-#else
-					ct = hwloc_bitmap_dup(obj->
-							      allowed_cpuset);
-					hwloc_bitmap_or(cpuset,cpuset,ct);
-					hwloc_bitmap_free(ct);
-#endif
-				}
-
-			} else {
-#if HWLOC_API_VERSION <= 0x00010000
-				ct = hwloc_cpuset_dup(obj->allowed_cpuset);
-				hwloc_cpuset_or(cpuset,cpuset,ct);
-				hwloc_cpuset_free(ct);
-#else
-				ct = hwloc_bitmap_dup(obj->allowed_cpuset);
-				hwloc_bitmap_or(cpuset,cpuset,ct);
-				hwloc_bitmap_free(ct);
-#endif
-			}
+			if (hwtype > req_hwtype) {
+				if (verbose)
+					info("task/cgroup: task[%u] "
+					     "higher level %s found",
+					     taskid,
+					     _cg_obj_name(req_hwtype));
+				_cg_obj_add(req_hwtype, first, &allowed, &ts);
+			} else
+				_cg_obj_add(hwtype, first, &allowed, &ts);
 		}
 
-		char *str;
-#if HWLOC_API_VERSION <= 0x00010000
-		hwloc_cpuset_asprintf(&str,cpuset);
-#else
-		hwloc_bitmap_asprintf(&str,cpuset);
-#endif
-		tssize = sizeof(cpu_set_t);
-		if (hwloc_cpuset_to_glibc_sched_affinity(topology,cpuset,
-							  &ts,tssize) == 0) {
-			fstatus = SLURM_SUCCESS;
-			if (sched_setaffinity(pid,tssize,&ts)) {
-				error("task/cgroup: task[%u] unable to set "
-				      "taskset '%s'",taskid,str);
-				fstatus = SLURM_ERROR;
-			} else if (verbose) {
-				info("task/cgroup: task[%u] taskset '%s' is set"
-				     ,taskid,str);
-			}
-		} else {
-			error("task/cgroup: task[%u] unable to build "
+		str = _cg_cpu_set_str(&ts);
+		fstatus = SLURM_SUCCESS;
+		if (sched_setaffinity(pid,tssize,&ts)) {
+			error("task/cgroup: task[%u] unable to set "
 			      "taskset '%s'",taskid,str);
 			fstatus = SLURM_ERROR;
+		} else if (verbose) {
+			info("task/cgroup: task[%u] taskset '%s' is set"
+			     ,taskid,str);
 		}
-		free(str);
+		xfree(str);
 
 	}
 
-	/* Destroy hwloc objects */
-#if HWLOC_API_VERSION <= 0x00010000
-	hwloc_cpuset_free(cpuset);
-#else
-	hwloc_bitmap_free(cpuset);
-#endif
-	hwloc_topology_destroy(topology);
-
 	return fstatus;
-#endif
-
 }
 
-
 /* when cgroups are configured with cpuset, at least
  * cpuset.cpus and cpuset.mems must be set or the cgroup
  * will not be available at all.
  * we duplicate the ancestor configuration in the init step */
-static int _xcgroup_cpuset_init(xcgroup_t* cg)
+/*
+ * set the cpus of a new cpuset cg and make it inherit the mems of
+ * its ancestor, both being written at once
+ */
+static int _xcgroup_cpuset_init(xcgroup_t* cg, char* cpus)
 {
-	int fstatus,i;
+	int fstatus;
 
-	char* cpuset_metafiles[] = {
-		"cpuset.cpus",
-		"cpuset.mems"
-	};
-	char* cpuset_meta;
 	char* cpuset_conf;
+	char* params = NULL;
 	size_t csize;
 
 	xcgroup_t acg;
@@ -678,40 +756,39 @@ static int _xcgroup_cpuset_init(xcgroup_t* cg)
 	if (p == NULL) {
 		debug2("task/cgroup: unable to get ancestor path for "
 		       "cpuset cg '%s' : %m",cg->path);
+		xfree(acg_name);
 		return fstatus;
 	} else
 		*p = '\0';
 	if (xcgroup_load(cg->ns,&acg,acg_name) != XCGROUP_SUCCESS) {
 		debug2("task/cgroup: unable to load ancestor for "
 		       "cpuset cg '%s' : %m",cg->path);
+		xfree(acg_name);
 		return fstatus;
 	}
-
-	/* inherits ancestor params */
-	for (i = 0 ; i < 2 ; i++) {
-		cpuset_meta = cpuset_metafiles[i];
-		if (xcgroup_get_param(&acg,cpuset_meta,
-				       &cpuset_conf,&csize)
-		     != XCGROUP_SUCCESS) {
-			debug2("task/cgroup: assuming no cpuset cg "
-			       "support for '%s'",acg.path);
-			xcgroup_destroy(&acg);
-			return fstatus;
-		}
-		if (csize > 0)
-			cpuset_conf[csize-1]='\0';
-		if (xcgroup_set_param(cg,cpuset_meta,cpuset_conf)
-		     != XCGROUP_SUCCESS) {
-			debug2("task/cgroup: unable to write %s configuration "
-			       "(%s) for cpuset cg '%s'",cpuset_meta,
-			       cpuset_conf,cg->path);
-			xcgroup_destroy(&acg);
-			xfree(cpuset_conf);
-			return fstatus;
-		}
-		xfree(cpuset_conf);
+	xfree(acg_name);
+
+	/* inherits ancestor mems */
+	if (xcgroup_get_param(&acg,"cpuset.mems",&cpuset_conf,&csize)
+	     != XCGROUP_SUCCESS) {
+		debug2("task/cgroup: assuming no cpuset cg "
+		       "support for '%s'",acg.path);
+		xcgroup_destroy(&acg);
+		return fstatus;
 	}
-
+	if (csize > 0)
+		cpuset_conf[csize-1]='\0';
 	xcgroup_destroy(&acg);
-	return XCGROUP_SUCCESS;
+
+	/* cpus are written first, the returned status is the mems one */
+	xstrfmtcat(params, "cpuset.cpus=%s cpuset.mems=%s", cpus,
+		   cpuset_conf);
+	fstatus = xcgroup_set_params(cg, params);
+	if (fstatus != XCGROUP_SUCCESS)
+		debug2("task/cgroup: unable to write cpuset configuration "
+		       "(%s) for cpuset cg '%s'", params, cg->path);
+	xfree(params);
+	xfree(cpuset_conf);
+
+	return fstatus;
 }
@@ -145,8 +145,8 @@ extern int task_cgroup_memory_fini(slurm_cgroup_conf_t *slurm_cgroup_conf)
 	/*
 	 * Move the slurmstepd back to the root memory cg and force empty
 	 * the step cgroup to move its allocated pages to its parent.
-	 * The release_agent will asynchroneously be called for the step
-	 * cgroup. It will do the necessary cleanup.
+	 * The step cgroup is then removed directly, the release_agent
+	 * will asynchroneously do it if it is still busy.
 	 * It should be good if this force_empty mech could be done directly
 	 * by the memcg implementation at the end of the last task managed
 	 * by a cgroup. It is too difficult and near impossible to handle
@@ -156,6 +156,9 @@ extern int task_cgroup_memory_fini(slurm_cgroup_conf_t *slurm_cgroup_conf)
 		xcgroup_set_uint32_param(&memory_cg,"tasks",getpid());
 		xcgroup_destroy(&memory_cg);
 		xcgroup_set_param(&step_memory_cg,"memory.force_empty","1");
+		if (xcgroup_delete(&step_memory_cg) != XCGROUP_SUCCESS)
+			debug2("task/cgroup: unable to remove step memory "
+			       "cg '%s' : %m", step_memory_cg.path);
 	}
 
 	xcgroup_destroy(&user_memory_cg);
@@ -184,6 +187,7 @@ extern int task_cgroup_memory_create(slurmd_job_t *job)
 	uid_t gid = job->gid;
 	pid_t pid;
 	uint64_t ml,mlb,mls;
+	char params[128];
 
 	/* build user cgroup relative path if not set (should not be) */
 	if (*user_cgroup_path == '\0') {
@@ -256,7 +260,8 @@ extern int task_cgroup_memory_create(slurmd_job_t *job)
 		xcgroup_destroy(&user_memory_cg);
 		goto error;
 	}
-	xcgroup_set_param(&user_memory_cg,"memory.use_hierarchy","1");
+	if (user_memory_cg.created)
+		xcgroup_set_param(&user_memory_cg,"memory.use_hierarchy","1");
 
 	/*
 	 * Create job cgroup in the memory ns (it could already exist)
@@ -264,6 +269,8 @@ extern int task_cgroup_memory_create(slurmd_job_t *job)
 	 * Ask for hierarchical memory accounting starting from the job
 	 * container in order to guarantee that a job will stay on track
 	 * regardless of the consumption of each step.
+	 * The limits are the same for every step of the job on this node,
+	 * so they are only set when the job cgroup is created.
 	 */
 	ml = (uint64_t) job->job_mem;
 	ml = ml * 1024 * 1024 ;
@@ -280,11 +287,12 @@ extern int task_cgroup_memory_create(slurmd_job_t *job)
 		xcgroup_destroy(&job_memory_cg);
 		goto error;
 	}
-	xcgroup_set_param(&job_memory_cg,"memory.use_hierarchy","1");
-	xcgroup_set_uint64_param(&job_memory_cg,
-				 "memory.limit_in_bytes",mlb);
-	xcgroup_set_uint64_param(&job_memory_cg,
-				 "memory.memsw.limit_in_bytes",mls);
+	if (job_memory_cg.created) {
+		snprintf(params, sizeof(params), "memory.use_hierarchy=1 "
+			 "memory.limit_in_bytes=%"PRIu64" "
+			 "memory.memsw.limit_in_bytes=%"PRIu64, mlb, mls);
+		xcgroup_set_params(&job_memory_cg, params);
+	}
 	debug("task/cgroup: job mem.limit=%"PRIu64"MB memsw.limit=%"PRIu64"MB",
 	      mlb/(1024*1024),mls/(1024*1024));
 
@@ -311,10 +319,9 @@ extern int task_cgroup_memory_create(slurmd_job_t *job)
 		xcgroup_destroy(&step_memory_cg);
 		goto error;
 	}
-	xcgroup_set_uint64_param(&step_memory_cg,
-				 "memory.limit_in_bytes",mlb);
-	xcgroup_set_uint64_param(&step_memory_cg,
-				 "memory.memsw.limit_in_bytes",mls);
+	snprintf(params, sizeof(params), "memory.limit_in_bytes=%"PRIu64" "
+		 "memory.memsw.limit_in_bytes=%"PRIu64, mlb, mls);
+	xcgroup_set_params(&step_memory_cg, params);
 	debug("task/cgroup: step mem.limit=%"PRIu64"MB memsw.limit=%"PRIu64"MB",
 	      mlb/(1024*1024),mls/(1024*1024));
 
@@ -97,6 +97,38 @@ static char *_convert_to_id(char *name, bool gid)
 }
 
 /* returns number of objects added to list */
+/* _paging_supported() -- Check the storage behind acct_type honours
+ *	page_size in job queries.  A slurmdbd which doesn't would send
+ *	back the same jobs for every page.
+ */
+static bool _paging_supported(char *acct_type)
+{
+	List config_list = NULL;
+	ListIterator itr = NULL;
+	config_key_pair_t *key_pair = NULL;
+	bool supported = false;
+
+	if(!strcmp(acct_type, "accounting_storage/mysql"))
+		return true;
+	if(strcmp(acct_type, "accounting_storage/slurmdbd"))
+		return false;
+
+	if(!(config_list = slurmdb_config_get(acct_db_conn)))
+		return false;
+	itr = list_iterator_create(config_list);
+	while((key_pair = list_next(itr))) {
+		if(key_pair->name && key_pair->value
+		   && !strcmp(key_pair->name, "SLURMDBD_JOB_PAGING")) {
+			supported = !strcasecmp(key_pair->value, "yes");
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+	list_destroy(config_list);
+
+	return supported;
+}
+
 static int _addto_id_char_list(List char_list, char *names, bool gid)
 {
 	int i=0, start=0;
@@ -535,6 +567,12 @@ int get_data(void)
 	ListIterator itr_step = NULL;
 	slurmdb_job_cond_t *job_cond = params.job_cond;
 
+	if(jobs) {
+		/* release the previous page */
+		list_destroy(jobs);
+		jobs = NULL;
+	}
+
 	if(params.opt_completion) {
 		jobs = g_slurm_jobcomp_get_jobs(job_cond);
 		return SLURM_SUCCESS;
@@ -586,6 +624,68 @@ int get_data(void)
 	return SLURM_SUCCESS;
 }
 
+/* get_next_page() -- Set up the job condition for the next page of a
+ *	paged query.
+ *
+ * RET true if another page should be requested with get_data().
+ */
+bool get_next_page(void)
+{
+	slurmdb_job_cond_t *job_cond = params.job_cond;
+	slurmdb_job_rec_t *job = NULL, *last_job = NULL;
+	ListIterator itr = NULL;
+	uint32_t last_id = 0;
+
+	if(!params.page_size || !jobs || !list_count(jobs))
+		return false;
+	if(list_count(jobs) > params.page_size)
+		return false;	/* the server ignored the page size */
+
+	/* Jobs come back grouped by cluster in job id order, so the
+	 * next page starts after the highest job id seen in the last
+	 * cluster of this page. */
+	itr = list_iterator_create(jobs);
+	while((job = list_next(itr)))
+		last_job = job;
+	list_iterator_reset(itr);
+	while((job = list_next(itr))) {
+		if(!job->cluster || strcmp(job->cluster, last_job->cluster))
+			continue;
+		if(job->jobid > last_id)
+			last_id = job->jobid;
+	}
+	list_iterator_destroy(itr);
+
+	if(!last_job->cluster)
+		return false;	/* storage plugin does not support paging */
+	if(job_cond->page_cluster
+	   && !strcmp(job_cond->page_cluster, last_job->cluster)
+	   && (job_cond->page_job_id >= last_id))
+		return false;	/* no progress, avoid looping forever */
+	if(job_cond->page_cluster) {
+		/* A page must only hold jobs past the last one, anything
+		 * else means the cursor was not honoured */
+		itr = list_iterator_create(jobs);
+		while((job = list_next(itr))) {
+			if(job->cluster
+			   && !strcmp(job->cluster, job_cond->page_cluster)
+			   && (job->jobid <= job_cond->page_job_id))
+				break;
+		}
+		list_iterator_destroy(itr);
+		if(job) {
+			error("Job query paging did not advance, "
+			      "stopping after this page");
+			return false;
+		}
+	}
+
+	xfree(job_cond->page_cluster);
+	job_cond->page_cluster = xstrdup(last_job->cluster);
+	job_cond->page_job_id = last_id;
+	return true;
+}
+
 void parse_command_line(int argc, char **argv)
 {
 	extern int optind;
@@ -971,12 +1071,16 @@ void parse_command_line(int argc, char **argv)
 				"SLURM accounting storage is disabled\n");
 			exit(1);
 		}
-		xfree(acct_type);
 		acct_db_conn = slurmdb_connection_get();
 		if(errno != SLURM_SUCCESS) {
 			error("Problem talking to the database: %m");
 			exit(1);
 		}
+		/* The formatted dump needs everything in one pass */
+		if (!params.opt_fdump && _paging_supported(acct_type))
+			params.page_size = SACCT_PAGE_SIZE;
+		job_cond->page_size = params.page_size;
+		xfree(acct_type);
 	}
 
 	/* specific clusters requested? */
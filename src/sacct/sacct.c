@@ -136,12 +136,14 @@ int main(int argc, char **argv)
 
 	switch (op) {
 	case SACCT_DUMP:
-		if(get_data() == SLURM_ERROR)
-			exit(errno);
-		if(params.opt_completion)
-			do_dump_completion();
-		else
-			do_dump();
+		do {
+			if(get_data() == SLURM_ERROR)
+				exit(errno);
+			if(params.opt_completion)
+				do_dump_completion();
+			else
+				do_dump();
+		} while(get_next_page());
 		break;
 	case SACCT_FDUMP:
 		if(get_data() == SLURM_ERROR)
@@ -149,12 +151,16 @@ int main(int argc, char **argv)
 		break;
 	case SACCT_LIST:
 		print_fields_header(print_fields_list);
-		if(get_data() == SLURM_ERROR)
-			exit(errno);
-		if(params.opt_completion)
-			do_list_completion();
-		else
-			do_list();
+		/* Print each page as it arrives so memory use stays
+		 * bounded no matter how many jobs match */
+		do {
+			if(get_data() == SLURM_ERROR)
+				exit(errno);
+			if(params.opt_completion)
+				do_list_completion();
+			else
+				do_list();
+		} while(get_next_page());
 		break;
 	case SACCT_HELP:
 		do_help();
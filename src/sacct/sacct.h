@@ -75,6 +75,10 @@
 
 #define STATE_COUNT 10
 
+/* Number of jobs requested from the database at a time when the storage
+ * plugin supports paged queries */
+#define SACCT_PAGE_SIZE 10000
+
 #define MAX_PRINTFIELDS 100
 #define FORMAT_STRING_SIZE 34
 
@@ -164,6 +168,7 @@ typedef struct {
 	int opt_noheader;	/* can only be cleared */
 	int opt_allocs;		/* --total */
 	int opt_uid;		/* running persons uid */
+	uint32_t page_size;	/* jobs per database query, 0 for all */
 } sacct_parameters_t;
 
 extern print_field_t fields[];
@@ -185,6 +190,7 @@ void print_fields(type_t type, void *object);
 
 /* options.c */
 int get_data(void);
+bool get_next_page(void);
 void parse_command_line(int argc, char **argv);
 void do_dump(void);
 void do_dump_completion(void);
@@ -371,6 +371,7 @@ static void _opt_default()
 	opt.reservation       = NULL;
 	opt.wckey             = NULL;
 	opt.req_switch        = -1;
+	opt.array_inx         = NULL;
 	opt.wait4switch       = -1;
 
 	opt.ckpt_interval = 0;
@@ -442,6 +443,7 @@ struct env_vars {
 env_vars_t env_vars[] = {
   {"SBATCH_ACCOUNT",       OPT_STRING,     &opt.account,       NULL          },
   {"SBATCH_ACCTG_FREQ",    OPT_INT,        &opt.acctg_freq,    NULL          },
+  {"SBATCH_ARRAY_INX",     OPT_STRING,     &opt.array_inx,     NULL          },
   {"SBATCH_BLRTS_IMAGE",   OPT_STRING,     &opt.blrtsimage,    NULL          },
   {"SBATCH_CHECKPOINT",    OPT_STRING,     &opt.ckpt_interval_str, NULL      },
   {"SBATCH_CHECKPOINT_DIR",OPT_STRING,     &opt.ckpt_dir,      NULL          },
@@ -657,6 +659,7 @@ _process_env_var(env_vars_t *e, const char *val)
 
 static struct option long_options[] = {
 	{"account",       required_argument, 0, 'A'},
+	{"array",         required_argument, 0, 'a'},
 	{"batch",         no_argument,       0, 'b'}, /* batch option
 							 is only here for
 							 moab tansition
@@ -752,7 +755,7 @@ static struct option long_options[] = {
 };
 
 static char *opt_string =
-	"+bA:B:c:C:d:D:e:F:g:hHi:IJ:kL:m:M:n:N:o:Op:P:QRst:uU:vVw:x:";
+	"+ba:A:B:c:C:d:D:e:F:g:hHi:IJ:kL:m:M:n:N:o:Op:P:QRst:uU:vVw:x:";
 char *pos_delimit;
 
 
@@ -1135,6 +1138,10 @@ static void _set_options(int argc, char **argv)
 			error("Try \"sbatch --help\" for more information");
 			exit(error_exit);
 			break;
+		case 'a':
+			xfree(opt.array_inx);
+			opt.array_inx = xstrdup(optarg);
+			break;
 		case 'A':
 		case 'U':	/* backwards compatibility */
 			xfree(opt.account);
@@ -2680,6 +2687,8 @@ static void _opt_list(void)
 	info("job name          : `%s'", opt.job_name);
 	info("reservation       : `%s'", opt.reservation);
 	info("wckey             : `%s'", opt.wckey);
+	if (opt.array_inx)
+		info("array             : %s", opt.array_inx);
 	info("distribution      : %s",
 	     format_task_dist_states(opt.distribution));
 	if(opt.distribution == SLURM_DIST_PLANE)
@@ -2776,6 +2785,7 @@ static void _usage(void)
 "              [--jobid=id] [--verbose] [--gid=group] [--uid=user] [-W sec] \n"
 "              [--contiguous] [--mincpus=n] [--mem=MB] [--tmp=MB] [-C list]\n"
 "              [--account=name] [--dependency=type:jobid] [--comment=name]\n"
+"              [--array=indexes]\n"
 #ifdef HAVE_BG		/* Blue gene specific options */
 "              [--geometry=XxYxZ] [--conn-type=type] [--no-rotate] [ --reboot]\n"
 #ifdef HAVE_BGL
@@ -2803,6 +2813,7 @@ static void _help(void)
 "Usage: sbatch [OPTIONS...] executable [args...]\n"
 "\n"
 "Parallel run options:\n"
+"  -a, --array=indexes         job array index values\n"
 "  -A, --account=name          charge job to specified account\n"
 "      --begin=time            defer job until HH:MM MM/DD/YY\n"
 "  -c, --cpus-per-task=ncpus   number of cpus required per task\n"
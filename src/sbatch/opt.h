@@ -108,6 +108,7 @@ typedef struct sbatch_options {
 	char *dependency;	/* --dependency, -P type:jobid	*/
 	int nice;		/* --nice			*/
 	char *account;		/* --account, -U acct_name	*/
+	char *array_inx;	/* --array, -a			*/
 	char *comment;		/* --comment			*/
 	char *propagate;	/* --propagate[=RLIMIT_CORE,...]*/
 	char *qos;		/* --qos			*/
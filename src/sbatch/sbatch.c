@@ -267,6 +267,7 @@ static int _fill_job_desc_from_opts(job_desc_msg_t *desc)
 		desc->name = xstrdup("sbatch");
 	desc->reservation  = xstrdup(opt.reservation);
 	desc->wckey  = xstrdup(opt.wckey);
+	desc->array_inx = xstrdup(opt.array_inx);
 
 	desc->req_nodes = opt.nodelist;
 	desc->exc_nodes = opt.exc_nodes;
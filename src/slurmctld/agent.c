@@ -85,6 +85,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/uid.h"
+#include "src/common/timers.h"
 #include "src/common/xsignal.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
@@ -648,7 +649,9 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 	slurmctld_lock_t node_write_lock =
 	    { READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK };
 	thd_t *thread_ptr = agent_ptr->thread_struct;
-	int i;
+	int i, reg_cnt = 0, reg_size = 0;
+	slurm_node_registration_status_msg_t **reg_msgs = NULL;
+	DEF_TIMERS;
 
 	/* Notify slurmctld of non-responding nodes */
 	if (no_resp_cnt) {
@@ -667,6 +670,7 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 		_queue_agent_retry(agent_ptr, retry_cnt);
 
 	/* Update last_response on responding nodes */
+	START_TIMER;
 	lock_slurmctld(node_write_lock);
 	for (i = 0; i < agent_ptr->thread_count; i++) {
 		char *down_msg, *node_names;
@@ -710,7 +714,21 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 			case DSH_DONE:
 				if (!is_ret_list)
 					node_did_resp(thread_ptr[i].nodelist);
-				else
+				else if (ret_data_info->type ==
+					 MESSAGE_NODE_REGISTRATION_STATUS) {
+					/* Registration gathered through the
+					 * forwarding tree, applied as one
+					 * batch below */
+					if (reg_cnt >= reg_size) {
+						reg_size = MAX(64,
+							       reg_size * 2);
+						xrealloc(reg_msgs,
+							 sizeof(void *) *
+							 reg_size);
+					}
+					reg_msgs[reg_cnt++] =
+						ret_data_info->data;
+				} else
 					node_did_resp(ret_data_info->node_name);
 				break;
 			default:
@@ -729,7 +747,15 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 		list_iterator_destroy(itr);
 finished:	;
 	}
+	if (reg_cnt)
+		validate_node_registrations(reg_msgs, reg_cnt);
 	unlock_slurmctld(node_write_lock);
+	xfree(reg_msgs);
+	END_TIMER2("_notify_slurmctld_nodes");
+	if (reg_cnt) {
+		debug2("agent processed %d node registrations %s",
+		       reg_cnt, TIME_STR);
+	}
 	if (run_scheduler) {
 		run_scheduler = false;
 		/* below functions all have their own locking */
@@ -1385,6 +1411,8 @@ static void _purge_agent_args(agent_arg_t *agent_arg_ptr)
 				agent_arg_ptr->msg_args);
 		else if (agent_arg_ptr->msg_type == REQUEST_JOB_NOTIFY)
 			slurm_free_job_notify_msg(agent_arg_ptr->msg_args);
+		else if (agent_arg_ptr->msg_type == REQUEST_SUSPEND_BATCH)
+			slurm_free_suspend_batch_msg(agent_arg_ptr->msg_args);
 		else
 			xfree(agent_arg_ptr->msg_args);
 	}
@@ -64,6 +64,7 @@
 #include "src/common/checkpoint.h"
 #include "src/common/daemonize.h"
 #include "src/common/fd.h"
+#include "src/common/forward.h"
 #include "src/common/gres.h"
 #include "src/common/hostlist.h"
 #include "src/common/log.h"
@@ -664,12 +665,13 @@ int main(int argc, char *argv[])
 	slurm_jobacct_gather_fini();
 	slurm_select_fini();
 	slurm_topo_fini();
+	forward_set_switches(NULL, 0);
 	checkpoint_fini();
 	slurm_auth_fini();
 	switch_fini();
 
 	/* purge remaining data structures */
-	license_free();
+	license_fini();
 	slurm_cred_ctx_destroy(slurmctld_config.cred_ctx);
 	slurm_crypto_fini();	/* must be after ctx_destroy */
 	slurm_conf_destroy();
@@ -1842,6 +1844,8 @@ void update_logging(void)
 		xfree(slurmctld_conf.slurmctld_logfile);
 		slurmctld_conf.slurmctld_logfile = xstrdup(debug_logfile);
 	}
+	if (slurmctld_conf.slurmctld_log_queue != (uint16_t) NO_VAL)
+		log_opts.queue = slurmctld_conf.slurmctld_log_queue;
 
 	if (daemonize) {
 		log_opts.stderr_level = LOG_LEVEL_QUIET;
@@ -87,6 +87,7 @@ struct gs_job {
 	struct job_record *job_ptr;
 	uint16_t sig_state;
 	uint16_t row_state;
+	bool shadowing;		/* in shadow array of lower priority parts */
 };
 
 struct gs_part {
@@ -102,6 +103,9 @@ struct gs_part {
 	bitstr_t *active_resmap;
 	uint16_t *active_cpus;
 	uint16_t array_size;
+	bitstr_t *shadow_resmap;	/* active_resmap with only shadows */
+	uint16_t *shadow_cpus;		/* active_cpus with only shadows */
+	bool shadow_valid;		/* shadow_resmap/cpus are current */
 	struct gs_part *next;
 };
 
@@ -135,7 +139,9 @@ struct gs_part {
  * are "caught" in these shadows are preempted (suspended)
  * indefinitely until the "shadow" disappears. When constructing
  * the active row of a partition, any jobs in the 'shadow' array
- * are applied first.
+ * are applied first. The resulting resmap and cpus are saved in
+ * shadow_resmap and shadow_cpus, so rows are rebuilt from a copy of
+ * them until the partition's shadows change.
  *
  ******************************************
  */
@@ -307,6 +313,8 @@ static void _destroy_parts(void *x)
 	xfree(gs_part_ptr->shadow);
 	FREE_NULL_BITMAP(gs_part_ptr->active_resmap);
 	xfree(gs_part_ptr->active_cpus);
+	FREE_NULL_BITMAP(gs_part_ptr->shadow_resmap);
+	xfree(gs_part_ptr->shadow_cpus);
 	xfree(gs_part_ptr->job_list);
 	xfree(gs_part_ptr);
 }
@@ -401,8 +409,6 @@ static int _job_fits_in_active_row(struct job_record *job_ptr,
 				   struct gs_part *p_ptr)
 {
 	job_resources_t *job_res = job_ptr->job_resrcs;
-	int count;
-	bitstr_t *job_map;
 
 	if ((p_ptr->active_resmap == NULL) || (p_ptr->jobs_active == 0))
 		return 1;
@@ -414,17 +420,11 @@ static int _job_fits_in_active_row(struct job_record *job_ptr,
 	}
 
 	/* gr_type == GS_NODE || gr_type == GS_CPU */
-	job_map = bit_copy(job_res->node_bitmap);
-	if (!job_map)
-		fatal("gang: memory allocation error");
-	bit_and(job_map, p_ptr->active_resmap);
-	/* any set bits indicate contention for the same resource */
-	count = bit_set_count(job_map);
-	if (gs_debug_flags & DEBUG_FLAG_GANG)
-		info("gang: _job_fits_in_active_row: %d bits conflict", count);
-	FREE_NULL_BITMAP(job_map);
-	if (count == 0)
+	/* any overlap indicates contention for the same resource */
+	if (!bit_overlap(job_res->node_bitmap, p_ptr->active_resmap))
 		return 1;
+	if (gs_debug_flags & DEBUG_FLAG_GANG)
+		info("gang: _job_fits_in_active_row: bits conflict");
 	if (gr_type == GS_CPU) {
 		/* For GS_CPU we check the CPU arrays */
 		return _can_cpus_fit(job_ptr, p_ptr);
@@ -696,7 +696,12 @@ static void _cast_shadow(struct gs_job *j_ptr, uint16_t priority)
 {
 	ListIterator part_iterator;
 	struct gs_part *p_ptr;
-	int i;
+
+	/* A job always casts its shadow on the same set of partitions,
+	 * so there is nothing to do if it already has */
+	if (j_ptr->shadowing)
+		return;
+	j_ptr->shadowing = true;
 
 	part_iterator = list_iterator_create(gs_part_list);
 	if (part_iterator == NULL)
@@ -712,14 +717,6 @@ static void _cast_shadow(struct gs_job *j_ptr, uint16_t priority)
 			p_ptr->shadow = xmalloc(p_ptr->shadow_size *
 						sizeof(struct gs_job *));
 			/* 'shadow' is initialized to be NULL filled */
-		} else {
-			/* does this shadow already exist? */
-			for (i = 0; i < p_ptr->num_shadows; i++) {
-				if (p_ptr->shadow[i] == j_ptr)
-					break;
-			}
-			if (i < p_ptr->num_shadows)
-				continue;
 		}
 
 		if (p_ptr->num_shadows+1 >= p_ptr->shadow_size) {
@@ -728,6 +725,7 @@ static void _cast_shadow(struct gs_job *j_ptr, uint16_t priority)
 						sizeof(struct gs_job *));
 		}
 		p_ptr->shadow[p_ptr->num_shadows++] = j_ptr;
+		p_ptr->shadow_valid = false;
 	}
 	list_iterator_destroy(part_iterator);
 }
@@ -740,6 +738,10 @@ static void _clear_shadow(struct gs_job *j_ptr)
 	struct gs_part *p_ptr;
 	int i;
 
+	if (!j_ptr->shadowing)
+		return;
+	j_ptr->shadowing = false;
+
 	part_iterator = list_iterator_create(gs_part_list);
 	if (part_iterator == NULL)
 		fatal("memory allocation failure");
@@ -756,6 +758,7 @@ static void _clear_shadow(struct gs_job *j_ptr)
 			continue;
 
 		p_ptr->num_shadows--;
+		p_ptr->shadow_valid = false;
 
 		/* shift all other jobs down */
 		for (; i < p_ptr->num_shadows; i++)
@@ -766,6 +769,65 @@ static void _clear_shadow(struct gs_job *j_ptr)
 }
 
 
+/* Reset the active row to hold only the partition's shadows. The row
+ * built from the shadows is saved and copied back in on later calls
+ * until a shadow is added or removed. */
+static void _apply_shadows(struct gs_part *p_ptr)
+{
+	int i, size;
+
+	p_ptr->jobs_active = 0;
+	if (p_ptr->num_shadows == 0)
+		return;
+
+	if (!p_ptr->shadow_valid || !p_ptr->shadow_resmap) {
+		for (i = 0; i < p_ptr->num_shadows; i++)
+			_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
+		FREE_NULL_BITMAP(p_ptr->shadow_resmap);
+		p_ptr->shadow_resmap = bit_copy(p_ptr->active_resmap);
+		if (!p_ptr->shadow_resmap)
+			fatal("gang: memory allocation error");
+		xfree(p_ptr->shadow_cpus);
+		if (p_ptr->active_cpus) {
+			size = bit_size(p_ptr->active_resmap);
+			p_ptr->shadow_cpus = xmalloc(size * sizeof(uint16_t));
+			memcpy(p_ptr->shadow_cpus, p_ptr->active_cpus,
+			       size * sizeof(uint16_t));
+		}
+		p_ptr->shadow_valid = true;
+		return;
+	}
+
+	if (p_ptr->active_resmap &&
+	    (bit_size(p_ptr->active_resmap) ==
+	     bit_size(p_ptr->shadow_resmap))) {
+		bit_copybits(p_ptr->active_resmap, p_ptr->shadow_resmap);
+	} else {
+		FREE_NULL_BITMAP(p_ptr->active_resmap);
+		p_ptr->active_resmap = bit_copy(p_ptr->shadow_resmap);
+		if (!p_ptr->active_resmap)
+			fatal("gang: memory allocation error");
+		xfree(p_ptr->active_cpus);
+	}
+	if (p_ptr->shadow_cpus) {
+		size = bit_size(p_ptr->shadow_resmap);
+		if (!p_ptr->active_cpus)
+			p_ptr->active_cpus = xmalloc(size * sizeof(uint16_t));
+		memcpy(p_ptr->active_cpus, p_ptr->shadow_cpus,
+		       size * sizeof(uint16_t));
+	}
+	p_ptr->jobs_active = p_ptr->num_shadows;
+}
+
+/* list_for_each() helper, discard the saved shadow row of a partition */
+static int _invalidate_shadow(void *x, void *arg)
+{
+	struct gs_part *p_ptr = (struct gs_part *) x;
+
+	p_ptr->shadow_valid = false;
+	return SLURM_SUCCESS;
+}
+
 /* Rebuild the active row BUT preserve the order of existing jobs.
  * This is called after one or more jobs have been removed from
  * the partition or if a higher priority "shadow" has been added
@@ -781,10 +843,7 @@ static void _update_active_row(struct gs_part *p_ptr, int add_new_jobs)
 		     p_ptr->part_name);
 	}
 	/* rebuild the active row, starting with any shadows */
-	p_ptr->jobs_active = 0;
-	for (i = 0; p_ptr->shadow && p_ptr->shadow[i]; i++) {
-		_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
-	}
+	_apply_shadows(p_ptr);
 
 	/* attempt to add the existing 'active' jobs */
 	for (i = 0; i < p_ptr->num_jobs; i++) {
@@ -1100,6 +1159,10 @@ static void _scan_slurm_job_list(void)
 	}
 	list_iterator_destroy(job_iterator);
 
+	/* resynchronize the saved shadow rows with the jobs' current
+	 * resource allocations as well */
+	list_for_each(gs_part_list, _invalidate_shadow, NULL);
+
 	/* now that all of the old jobs have been flushed out,
 	 * update the active row of all partitions */
 	_update_all_active_rows();
@@ -1454,9 +1517,7 @@ static void _build_active_row(struct gs_part *p_ptr)
 		return;
 
 	/* apply all shadow jobs first */
-	for (i = 0; i < p_ptr->num_shadows; i++) {
-		_add_job_to_active(p_ptr->shadow[i]->job_ptr, p_ptr);
-	}
+	_apply_shadows(p_ptr);
 
 	/* attempt to add jobs from the job_list in the current order */
 	for (i = 0; i < p_ptr->num_jobs; i++) {
@@ -1486,26 +1547,26 @@ static void _build_active_row(struct gs_part *p_ptr)
  */
 static void _cycle_job_list(struct gs_part *p_ptr)
 {
-	int i, j;
-	struct gs_job *j_ptr;
+	int i, j, k;
+	struct gs_job *j_ptr, **active_jobs;
 
 	if (gs_debug_flags & DEBUG_FLAG_GANG)
 		info("gang: entering _cycle_job_list");
-	/* re-prioritize the job_list and set all row_states to GS_NO_ACTIVE */
-	for (i = 0; i < p_ptr->num_jobs; i++) {
-		while (p_ptr->job_list[i]->row_state == GS_ACTIVE) {
-			/* move this job to the back row and "deactivate" it */
-			j_ptr = p_ptr->job_list[i];
-			j_ptr->row_state = GS_NO_ACTIVE;
-			for (j = i; j+1 < p_ptr->num_jobs; j++) {
-				p_ptr->job_list[j] = p_ptr->job_list[j+1];
-			}
-			p_ptr->job_list[j] = j_ptr;
-		}
-		if (p_ptr->job_list[i]->row_state == GS_FILLER)
-			p_ptr->job_list[i]->row_state = GS_NO_ACTIVE;
-
+	/* re-prioritize the job_list and set all row_states to GS_NO_ACTIVE:
+	 * the active jobs move to the back of the list, both groups keeping
+	 * their relative order */
+	active_jobs = xmalloc(p_ptr->num_jobs * sizeof(struct gs_job *));
+	for (i = 0, j = 0, k = 0; i < p_ptr->num_jobs; i++) {
+		j_ptr = p_ptr->job_list[i];
+		if (j_ptr->row_state == GS_ACTIVE)
+			active_jobs[k++] = j_ptr;
+		else
+			p_ptr->job_list[j++] = j_ptr;
+		j_ptr->row_state = GS_NO_ACTIVE;
 	}
+	for (i = 0; i < k; i++)
+		p_ptr->job_list[j++] = active_jobs[i];
+	xfree(active_jobs);
 	if (gs_debug_flags & DEBUG_FLAG_GANG)
 		info("gang: _cycle_job_list reordered job list:");
 	/* Rebuild the active row. */
@@ -1580,6 +1641,8 @@ static void *_timeslicer_thread(void *arg)
 			break;
 
 		lock_slurmctld(job_write_lock);
+		/* send all of this slice's suspend/resume RPCs at once */
+		job_suspend_batch_begin();
 		pthread_mutex_lock(&data_mutex);
 		list_sort(gs_part_list, _sort_partitions);
 
@@ -1605,6 +1668,7 @@ static void *_timeslicer_thread(void *arg)
 
 		/* Preempt jobs that were formerly only suspended */
 		_preempt_job_dequeue();	/* MUST BE OUTSIDE data_mutex lock */
+		job_suspend_batch_end();
 		unlock_slurmctld(job_write_lock);
 	}
 
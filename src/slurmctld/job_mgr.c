@@ -101,7 +101,8 @@
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
 
 /* Change JOB_STATE_VERSION value when changing the state save format */
-#define JOB_STATE_VERSION      "VER011"
+#define JOB_STATE_VERSION      "VER013"
+#define JOB_FLAT_STATE_VERSION "VER012"		/* No job record index */
 #define JOB_2_3_STATE_VERSION  "VER011"		/* SLURM version 2.3 */
 #define JOB_2_2_STATE_VERSION  "VER010"		/* SLURM version 2.2 */
 #define JOB_2_1_STATE_VERSION  "VER009"		/* SLURM version 2.1 */
@@ -110,6 +111,8 @@
 #define JOB_2_2_CKPT_VERSION  "JOB_CKPT_002"	/* SLURM version 2.2 */
 #define JOB_2_1_CKPT_VERSION  "JOB_CKPT_001"	/* SLURM version 2.1 */
 
+#define MAX_ARRAY_TASK_ID 65535	/* largest task_id in a job array */
+
 /* Global variables */
 List   job_list = NULL;		/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
@@ -121,12 +124,38 @@ static int      hash_table_size = 0;
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
+static struct   job_record **job_array_hash = NULL;
+static struct   job_record **job_name_hash = NULL;
+static uint32_t *job_name_singleton_cnt = NULL;	/* singleton dependencies
+						 * per job_name_hash entry */
+static Buf      job_state_buf = NULL;	/* job state file being loaded or
+					 * holding undecoded launch details */
+static uint32_t job_state_buf_ref = 0;	/* users of job_state_buf */
 static bool     wiki_sched = false;
 static bool     wiki2_sched = false;
 static bool     wiki_sched_test = false;
 
+/* Suspend/resume requests being gathered, see job_suspend_batch_begin() */
+static suspend_batch_msg_t *sus_batch = NULL;
+/* Indexes into sus_batch of the jobs of each node (front end node if
+ * HAVE_FRONT_END), only set in job_suspend_batch_end() */
+static uint32_t **sus_tgt_jobs = NULL;
+static uint32_t *sus_tgt_job_cnt = NULL;
+
+/* Active jobs indexed by node for a batch of node registrations, see
+ * validate_jobs_batch_begin() */
+static bitstr_t *reg_node_bitmap = NULL;
+static struct job_record ***reg_node_jobs = NULL;
+static int      *reg_node_job_cnt = NULL;
+
 /* Local functions */
+static void _add_job_array_hash(struct job_record *job_ptr);
 static void _add_job_hash(struct job_record *job_ptr);
+static void _add_job_name_hash(struct job_record *job_ptr);
+static int  _job_singleton_depend_cnt(struct job_record *job_ptr);
+static void _add_job_env_sup(struct job_details *detail_ptr, char *name,
+			     uint32_t value);
+static bitstr_t *_build_array_bitmap(char *array_inx);
 static int  _checkpoint_job_record (struct job_record *job_ptr,
 				    char *image_dir);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
@@ -138,6 +167,7 @@ static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 static job_desc_msg_t * _copy_job_record_to_job_desc(
 				struct job_record *job_ptr);
 static char *_copy_nodelist_no_dup(char *node_list);
+static struct job_record *_create_job_record(void);
 static void _del_batch_list_rec(void *x);
 static void _delete_job_desc_files(uint32_t job_id);
 static slurmdb_qos_rec_t *_determine_and_validate_qos(
@@ -148,20 +178,26 @@ static void _dump_job_details(struct job_details *detail_ptr,
 static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer);
 static int  _find_batch_dir(void *x, void *key);
 static void _get_batch_job_dir_ids(List batch_dirs);
+static struct job_record *_job_array_copy(struct job_record *job_ptr);
 static void _job_timed_out(struct job_record *job_ptr);
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid);
+static uint32_t _job_dir_id(struct job_record *job_ptr);
+static bool _job_files_shared(struct job_record *job_ptr);
 static void _list_delete_job(void *job_entry);
 static int  _list_find_job_id(void *job_entry, void *key);
 static int  _list_find_job_old(void *job_entry, void *key);
 static int  _load_job_details(struct job_record *job_ptr, Buf buffer,
-			      uint16_t protocol_version);
-static int  _load_job_state(Buf buffer,	uint16_t protocol_version);
+			      uint16_t protocol_version, bool indexed);
+static int  _load_job_state(Buf buffer,	uint16_t protocol_version,
+			    bool indexed);
 static uint32_t _max_switch_wait(uint32_t input_wait);
 static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
 				      time_t now, time_t node_boot_time);
 static int  _open_job_state_file(char **state_file);
 static void _pack_job_for_ckpt (struct job_record *job_ptr, Buf buffer);
+static bool _pack_job_permitted(struct job_record *job_ptr, uid_t uid);
+static void _pack_launch_details(struct job_details *detail_ptr, Buf buffer);
 static void _pack_default_job_details(struct job_record *job_ptr,
 				      Buf buffer,
 				      uint16_t protocol_version);
@@ -175,7 +211,12 @@ static void _read_data_array_from_file(char *file_name, char ***data,
  				       struct job_record *job_ptr);
 static void _read_data_from_file(char *file_name, char **data);
 static char *_read_job_ckpt_file(char *ckpt_file, int *size_ptr);
+static void _release_job_launch_details(struct job_details *detail_ptr);
+static void _release_job_state_buf(void);
 static void _remove_defunct_batch_dirs(List batch_dirs);
+static void _remove_job_array_hash(struct job_record *job_ptr);
+static void _remove_job_hash(struct job_record *job_ptr);
+static void _remove_job_name_hash(struct job_record *job_ptr);
 static int  _reset_detail_bitmaps(struct job_record *job_ptr);
 static void _reset_step_bitmaps(struct job_record *job_ptr);
 static int  _resume_job_nodes(struct job_record *job_ptr, bool indf_susp);
@@ -186,7 +227,12 @@ static void _signal_batch_job(struct job_record *job_ptr, uint16_t signal);
 static void _signal_job(struct job_record *job_ptr, int signal);
 static void _suspend_job(struct job_record *job_ptr, uint16_t op);
 static int  _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp);
+static void _swap_job_id(struct job_record *job1_ptr,
+			 struct job_record *job2_ptr);
 static bool _top_priority(struct job_record *job_ptr);
+static int  _unpack_launch_details(Buf buffer, uint32_t offset, uint32_t size,
+				   char **err, char **in, char **out,
+				   char ***env_sup, uint32_t *env_cnt);
 static int  _validate_job_create_req(job_desc_msg_t * job_desc);
 static int  _validate_job_desc(job_desc_msg_t * job_desc_msg, int allocate,
 			       uid_t submit_uid, struct part_record *part_ptr);
@@ -209,17 +255,24 @@ static void _xmit_new_end_time(struct job_record *job_ptr);
  */
 struct job_record *create_job_record(int *error_code)
 {
-	struct job_record  *job_ptr;
-	struct job_details *detail_ptr;
-
 	if (job_count >= slurmctld_conf.max_job_cnt) {
 		error("create_job_record: job_count exceeds limit");
 		*error_code = EAGAIN;
 		return NULL;
 	}
 
-	job_count++;
 	*error_code = 0;
+	return _create_job_record();
+}
+
+/* _create_job_record - create an empty job_record without regard to the
+ *	MaxJobCount limit, see create_job_record() */
+static struct job_record *_create_job_record(void)
+{
+	struct job_record  *job_ptr;
+	struct job_details *detail_ptr;
+
+	job_count++;
 	last_job_update = time(NULL);
 
 	job_ptr    = (struct job_record *) xmalloc(sizeof(struct job_record));
@@ -257,8 +310,8 @@ void delete_job_details(struct job_record *job_entry)
 		return;
 
 	xassert (job_entry->details->magic == DETAILS_MAGIC);
-	if (IS_JOB_FINISHED(job_entry))
-		_delete_job_desc_files(job_entry->job_id);
+	if (IS_JOB_FINISHED(job_entry) && !_job_files_shared(job_entry))
+		_delete_job_desc_files(_job_dir_id(job_entry));
 
 	for (i=0; i<job_entry->details->argc; i++)
 		xfree(job_entry->details->argv[i]);
@@ -273,11 +326,13 @@ void delete_job_details(struct job_record *job_entry)
 		xfree(job_entry->details->env_sup[i]);
 	xfree(job_entry->details->env_sup);
 	xfree(job_entry->details->std_err);
+	_release_job_launch_details(job_entry->details);
 	FREE_NULL_BITMAP(job_entry->details->exc_node_bitmap);
 	xfree(job_entry->details->exc_nodes);
 	if (job_entry->details->feature_list)
 		list_destroy(job_entry->details->feature_list);
 	xfree(job_entry->details->features);
+	node_set_cache_free(job_entry->details);
 	xfree(job_entry->details->std_in);
 	xfree(job_entry->details->mc_ptr);
 	xfree(job_entry->details->mem_bind);
@@ -417,6 +472,8 @@ int dump_all_job_state(void)
 	struct job_record *job_ptr;
 	Buf buffer = init_buf(high_buffer_size);
 	time_t min_age = 0, now = time(NULL);
+	uint32_t index_pos, index_offset, end_offset;
+	uint32_t *rec_offset = NULL, rec_cnt = 0;
 	DEF_TIMERS;
 
 	START_TIMER;
@@ -437,6 +494,14 @@ int dump_all_job_state(void)
 	debug3("Writing job id %u to header record of job_state file",
 	       job_id_sequence);
 
+	/* write header: offset of the job record index, set below */
+	index_pos = get_buf_offset(buffer);
+	pack32((uint32_t) 0, buffer);
+
+	/* Names, paths and such repeat across jobs, pack all but the first
+	 * copy of each as a reference to it */
+	buf_intern_strings(buffer);
+
 	/* write individual job records */
 	lock_slurmctld(job_read_lock);
 	job_iterator = list_iterator_create(job_list);
@@ -446,10 +511,24 @@ int dump_all_job_state(void)
 		    (! IS_JOB_COMPLETING(job_ptr)) && IS_JOB_FINISHED(job_ptr))
 			continue;	/* job ready for purging, don't dump */
 
+		if ((rec_cnt % 1024) == 0) {
+			xrealloc(rec_offset,
+				 sizeof(uint32_t) * (rec_cnt + 1024));
+		}
+		rec_offset[rec_cnt++] = get_buf_offset(buffer);
 		_dump_job_state(job_ptr, buffer);
 	}
 	list_iterator_destroy(job_iterator);
 
+	/* write the job record index and its offset in the header */
+	index_offset = get_buf_offset(buffer);
+	pack32_array(rec_offset, rec_cnt, buffer);
+	end_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, index_pos);
+	pack32(index_offset, buffer);
+	set_buf_offset(buffer, end_offset);
+	xfree(rec_offset);
+
 	/* write the buffer to file */
 	old_file = xstrdup(slurmctld_conf.state_save_location);
 	xstrcat(old_file, "/job_state.old");
@@ -559,16 +638,30 @@ static int _open_job_state_file(char **state_file)
  */
 extern int load_all_job_state(void)
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
-	uint32_t data_size = 0;
-	int state_fd, job_cnt = 0;
-	char *data = NULL, *state_file;
-	Buf buffer;
+	int error_code = SLURM_SUCCESS;
+	int state_fd, job_cnt = 0, fail_cnt = 0;
+	char *state_file;
+	Buf buffer = NULL;
 	time_t buf_time;
-	uint32_t saved_job_id;
+	uint32_t saved_job_id, index_offset, index_pos, rec_offset;
+	uint32_t rec_cnt, header_end, i;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
+	bool indexed = false;
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	DEF_TIMERS;
+
+	START_TIMER;
+	/* Launch details not yet decoded refer to the old file */
+	if (job_state_buf) {
+		job_iterator = list_iterator_create(job_list);
+		while ((job_ptr = (struct job_record *)
+				  list_next(job_iterator)))
+			decode_job_launch_details(job_ptr->details);
+		list_iterator_destroy(job_iterator);
+	}
 
 	/* read the file */
 	lock_state_files();
@@ -577,25 +670,8 @@ extern int load_all_job_state(void)
 		info("No job state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		if (!(buffer = create_mmap_buf(state_fd)))
+			error("Read error on %s: %m", state_file);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -605,12 +681,18 @@ extern int load_all_job_state(void)
 	if (error_code)
 		return error_code;
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)
+		buffer = create_buf(NULL, 0);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
 	if (ver_str) {
 		if (!strcmp(ver_str, JOB_STATE_VERSION)) {
 			protocol_version = SLURM_PROTOCOL_VERSION;
+			indexed = true;
+		} else if (!strcmp(ver_str, JOB_FLAT_STATE_VERSION)) {
+			protocol_version = SLURM_PROTOCOL_VERSION;
+		} else if (!strcmp(ver_str, JOB_2_3_STATE_VERSION)) {
+			protocol_version = SLURM_2_3_PROTOCOL_VERSION;
 		} else if (!strcmp(ver_str, JOB_2_2_STATE_VERSION)) {
 			protocol_version = SLURM_2_2_PROTOCOL_VERSION;
 		} else if (!strcmp(ver_str, JOB_2_1_STATE_VERSION)) {
@@ -633,16 +715,69 @@ extern int load_all_job_state(void)
 	job_id_sequence = MAX(saved_job_id, job_id_sequence);
 	debug3("Job id in job_state header is %u", saved_job_id);
 
-	while (remaining_buf(buffer) > 0) {
-		error_code = _load_job_state(buffer, protocol_version);
-		if (error_code != SLURM_SUCCESS)
-			goto unpack_error;
+	if (!indexed) {
+		while (remaining_buf(buffer) > 0) {
+			error_code = _load_job_state(buffer, protocol_version,
+						     false);
+			if (error_code != SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+		}
+		debug3("Set job_id_sequence to %u", job_id_sequence);
+
+		free_buf(buffer);
+		END_TIMER2("load_all_job_state");
+		info("Recovered information about %d jobs %s", job_cnt,
+		     TIME_STR);
+		return error_code;
+	}
+
+	/* Each job record is found through the index at the end of the
+	 * file, so a bad record only loses that job */
+	safe_unpack32(&index_offset, buffer);
+	header_end = get_buf_offset(buffer);
+	if ((index_offset < header_end) || (index_offset > size_buf(buffer)))
+		goto unpack_error;
+	buf_intern_strings(buffer);
+	set_buf_offset(buffer, index_offset);
+	safe_unpack32(&rec_cnt, buffer);
+	if (rec_cnt > (remaining_buf(buffer) / sizeof(uint32_t)))
+		goto unpack_error;
+	index_pos = get_buf_offset(buffer);
+
+	/* Launch details of the jobs are left in the file until needed,
+	 * the file is kept until the last of them is decoded */
+	job_state_buf = buffer;
+	job_state_buf_ref = 1;
+	for (i = 0; i < rec_cnt; i++) {
+		set_buf_offset(buffer, index_pos + (i * sizeof(uint32_t)));
+		(void) unpack32(&rec_offset, buffer);
+		if ((rec_offset < header_end) ||
+		    (rec_offset >= index_offset)) {
+			error("Invalid offset %u of job record %u",
+			      rec_offset, i);
+			fail_cnt++;
+			continue;
+		}
+		set_buf_offset(buffer, rec_offset);
+		if (_load_job_state(buffer, protocol_version, true)) {
+			error("Invalid job record %u at offset %u",
+			      i, rec_offset);
+			fail_cnt++;
+			continue;
+		}
 		job_cnt++;
 	}
+	_release_job_state_buf();
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
-	free_buf(buffer);
-	info("Recovered information about %d jobs", job_cnt);
+	END_TIMER2("load_all_job_state");
+	info("Recovered information about %d jobs %s", job_cnt, TIME_STR);
+	if (fail_cnt) {
+		error("Could not recover %d jobs from job state file",
+		      fail_cnt);
+		return SLURM_FAILURE;
+	}
 	return error_code;
 
 unpack_error:
@@ -659,11 +794,10 @@ unpack_error:
  */
 extern int load_last_job_id( void )
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
-	uint32_t data_size = 0;
+	int error_code = SLURM_SUCCESS;
 	int state_fd;
-	char *data = NULL, *state_file;
-	Buf buffer;
+	char *state_file;
+	Buf buffer = NULL;
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
@@ -677,25 +811,8 @@ extern int load_last_job_id( void )
 		debug("No job state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		if (!(buffer = create_mmap_buf(state_fd)))
+			error("Read error on %s: %m", state_file);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -704,10 +821,12 @@ extern int load_last_job_id( void )
 	if (error_code)
 		return error_code;
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)
+		buffer = create_buf(NULL, 0);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
-	if ((!ver_str) || (strcmp(ver_str, JOB_STATE_VERSION) != 0)) {
+	if ((!ver_str) || (strcmp(ver_str, JOB_STATE_VERSION) &&
+			   strcmp(ver_str, JOB_FLAT_STATE_VERSION))) {
 		debug("*************************************************");
 		debug("Can not recover last job ID, incompatible version");
 		debug("*************************************************");
@@ -747,6 +866,15 @@ static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer)
 	/* Dump basic job info */
 	pack32(dump_job_ptr->assoc_id, buffer);
 	pack32(dump_job_ptr->job_id, buffer);
+	pack32(dump_job_ptr->array_job_id, buffer);
+	pack32(dump_job_ptr->array_task_id, buffer);
+	if (dump_job_ptr->array_task_bitmap) {
+		char *task_str = bit_fmt_hexmask(dump_job_ptr->array_task_bitmap);
+		pack32(bit_size(dump_job_ptr->array_task_bitmap), buffer);
+		packstr(task_str, buffer);
+		xfree(task_str);
+	} else
+		pack32((uint32_t) 0, buffer);
 	pack32(dump_job_ptr->user_id, buffer);
 	pack32(dump_job_ptr->group_id, buffer);
 	pack32(dump_job_ptr->time_limit, buffer);
@@ -852,14 +980,19 @@ static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer)
 	pack16((uint16_t) 0, buffer);	/* no step flag */
 }
 
-/* Unpack a job's state information from a buffer */
-static int _load_job_state(Buf buffer, uint16_t protocol_version)
+/* Unpack a job's state information from a buffer
+ * IN indexed - job details are packed as by this version of
+ *	_dump_job_details(), rather than the job state file version before
+ *	JOB_STATE_VERSION */
+static int _load_job_state(Buf buffer, uint16_t protocol_version,
+			   bool indexed)
 {
 	uint32_t job_id, user_id, group_id, time_limit, priority, alloc_sid;
 	uint32_t exit_code, assoc_id, db_index, name_len, time_min;
 	uint32_t next_step_id, total_cpus, total_nodes = 0, cpu_cnt;
 	uint32_t resv_id, spank_job_env_size = 0, qos_id, derived_ec = 0;
 	uint32_t req_switch = 0, wait4switch = 0;
+	uint32_t array_job_id = 0, array_task_id = 0, array_task_cnt = 0;
 	time_t start_time, end_time, suspend_time, pre_sus_time, tot_sus_time;
 	time_t preempt_time = 0;
 	time_t resize_time = 0, now = time(NULL);
@@ -876,6 +1009,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	char *comment = NULL, *nodes_completing = NULL, *alloc_node = NULL;
 	char *licenses = NULL, *state_desc = NULL, *wckey = NULL;
 	char *resv_name = NULL, *gres = NULL, *batch_host = NULL;
+	char *array_task_str = NULL;
 	char **spank_job_env = (char **) NULL;
 	List gres_list = NULL, part_ptr_list = NULL;
 	struct job_record *job_ptr = NULL;
@@ -891,6 +1025,15 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
 		safe_unpack32(&assoc_id, buffer);
 		safe_unpack32(&job_id, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			safe_unpack32(&array_job_id, buffer);
+			safe_unpack32(&array_task_id, buffer);
+			safe_unpack32(&array_task_cnt, buffer);
+			if (array_task_cnt) {
+				safe_unpackstr_xmalloc(&array_task_str,
+						       &name_len, buffer);
+			}
+		}
 
 		/* validity test as possible */
 		if (job_id == 0) {
@@ -1018,7 +1161,8 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 
 		safe_unpack16(&details, buffer);
 		if ((details == DETAILS_FLAG) &&
-		    (_load_job_details(job_ptr, buffer, protocol_version))) {
+		    (_load_job_details(job_ptr, buffer, protocol_version,
+				       indexed))) {
 			job_ptr->job_state = JOB_FAILED;
 			job_ptr->exit_code = 1;
 			job_ptr->state_reason = FAIL_SYSTEM;
@@ -1165,7 +1309,8 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 
 		safe_unpack16(&details, buffer);
 		if ((details == DETAILS_FLAG) &&
-		    (_load_job_details(job_ptr, buffer, protocol_version))) {
+		    (_load_job_details(job_ptr, buffer, protocol_version,
+				       indexed))) {
 			job_ptr->job_state = JOB_FAILED;
 			job_ptr->exit_code = 1;
 			job_ptr->state_reason = FAIL_SYSTEM;
@@ -1306,7 +1451,8 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 
 		safe_unpack16(&details, buffer);
 		if ((details == DETAILS_FLAG) &&
-		    (_load_job_details(job_ptr, buffer, protocol_version))) {
+		    (_load_job_details(job_ptr, buffer, protocol_version,
+				       indexed))) {
 			job_ptr->job_state = JOB_FAILED;
 			job_ptr->exit_code = 1;
 			job_ptr->state_reason = FAIL_SYSTEM;
@@ -1360,6 +1506,23 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	alloc_node             = NULL;	/* reused, nothing left to free */
 	job_ptr->alloc_resp_port = alloc_resp_port;
 	job_ptr->alloc_sid    = alloc_sid;
+	if (array_job_id && !job_ptr->array_job_id) {
+		job_ptr->array_job_id = array_job_id;
+		_add_job_array_hash(job_ptr);
+	}
+	job_ptr->array_task_id = array_task_id;
+	FREE_NULL_BITMAP(job_ptr->array_task_bitmap);
+	if (array_task_str) {
+		job_ptr->array_task_bitmap = bit_alloc(array_task_cnt);
+		if (!job_ptr->array_task_bitmap)
+			fatal("bit_alloc: malloc failure");
+		if (bit_unfmt_hexmask(job_ptr->array_task_bitmap,
+				      array_task_str)) {
+			error("Invalid array task_ids (%s) for job %u",
+			      array_task_str, job_id);
+		}
+		xfree(array_task_str);
+	}
 	job_ptr->assoc_id     = assoc_id;
 	job_ptr->batch_flag   = batch_flag;
 	xfree(job_ptr->batch_host);
@@ -1387,6 +1550,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	xfree(job_ptr->mail_user);
 	job_ptr->mail_user    = mail_user;
 	mail_user             = NULL;	/* reused, nothing left to free */
+	_remove_job_name_hash(job_ptr);	/* in case duplicate record */
 	xfree(job_ptr->name);		/* in case duplicate record */
 	job_ptr->name         = name;
 	name                  = NULL;	/* reused, nothing left to free */
@@ -1444,6 +1608,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	job_ptr->tot_sus_time = tot_sus_time;
 	job_ptr->preempt_time = preempt_time;
 	job_ptr->user_id      = user_id;
+	_add_job_name_hash(job_ptr);
 	job_ptr->wait_all_nodes = wait_all_nodes;
 	job_ptr->warn_signal  = warn_signal;
 	job_ptr->warn_time    = warn_time;
@@ -1533,6 +1698,7 @@ unpack_error:
 	error("Incomplete job record");
 	xfree(alloc_node);
 	xfree(account);
+	xfree(array_task_str);
 	xfree(batch_host);
 	xfree(comment);
 	xfree(gres);
@@ -1605,9 +1771,6 @@ void _dump_job_details(struct job_details *detail_ptr, Buf buffer)
 	packstr(detail_ptr->dependency, buffer);
 	packstr(detail_ptr->orig_dependency, buffer);
 
-	packstr(detail_ptr->std_err,       buffer);
-	packstr(detail_ptr->std_in,        buffer);
-	packstr(detail_ptr->std_out,       buffer);
 	packstr(detail_ptr->work_dir,  buffer);
 	packstr(detail_ptr->ckpt_dir,  buffer);
 	packstr(detail_ptr->restart_dir, buffer);
@@ -1615,18 +1778,118 @@ void _dump_job_details(struct job_details *detail_ptr, Buf buffer)
 	pack_multi_core_data(detail_ptr->mc_ptr, buffer,
 			     SLURM_PROTOCOL_VERSION);
 	packstr_array(detail_ptr->argv, detail_ptr->argc, buffer);
+
+	/* Data only used to launch the job goes last as one block, which
+	 * load_all_job_state() can leave undecoded */
+	if (detail_ptr->lazy_size) {
+		packmem(get_buf_data(job_state_buf) + detail_ptr->lazy_offset,
+			detail_ptr->lazy_size, buffer);
+	} else {
+		Buf launch_buf = init_buf(1024);
+		_pack_launch_details(detail_ptr, launch_buf);
+		packmem(get_buf_data(launch_buf), get_buf_offset(launch_buf),
+			buffer);
+		free_buf(launch_buf);
+	}
+}
+
+/* Pack the job details only used to launch the job */
+static void _pack_launch_details(struct job_details *detail_ptr, Buf buffer)
+{
+	packstr(detail_ptr->std_err, buffer);
+	packstr(detail_ptr->std_in,  buffer);
+	packstr(detail_ptr->std_out, buffer);
 	packstr_array(detail_ptr->env_sup, detail_ptr->env_cnt, buffer);
 }
 
-/* _load_job_details - Unpack a job details information from buffer */
+/* Unpack the job details packed by _pack_launch_details() as size bytes
+ * at offset in buffer, the buffer's offset is left unchanged */
+static int _unpack_launch_details(Buf buffer, uint32_t offset, uint32_t size,
+				  char **err, char **in, char **out,
+				  char ***env_sup, uint32_t *env_cnt)
+{
+	uint32_t buf_offset = get_buf_offset(buffer), name_len;
+
+	if (offset > size_buf(buffer))
+		return SLURM_ERROR;
+	set_buf_offset(buffer, offset);
+	safe_unpackstr_xmalloc(err, &name_len, buffer);
+	safe_unpackstr_xmalloc(in,  &name_len, buffer);
+	safe_unpackstr_xmalloc(out, &name_len, buffer);
+	safe_unpackstr_array(env_sup, env_cnt, buffer);
+	if (get_buf_offset(buffer) != (offset + size))
+		goto unpack_error;
+	set_buf_offset(buffer, buf_offset);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(*err);
+	xfree(*in);
+	xfree(*out);
+	xfree(*env_sup);
+	*env_cnt = 0;
+	set_buf_offset(buffer, buf_offset);
+	return SLURM_ERROR;
+}
+
+/*
+ * decode_job_launch_details - unpack a job's std_err, std_in, std_out and
+ *	env_sup, which load_all_job_state() leaves in the job state file
+ *	until used
+ */
+extern void decode_job_launch_details(struct job_details *detail_ptr)
+{
+	char *err = NULL, *in = NULL, *out = NULL, **env_sup = NULL;
+	uint32_t env_cnt = 0;
+
+	if ((detail_ptr == NULL) || (detail_ptr->lazy_size == 0))
+		return;
+
+	xassert(job_state_buf);
+	if (_unpack_launch_details(job_state_buf, detail_ptr->lazy_offset,
+				   detail_ptr->lazy_size, &err, &in, &out,
+				   &env_sup, &env_cnt)) {
+		error("decode_job_launch_details: invalid data at offset %u "
+		      "of job state file", detail_ptr->lazy_offset);
+	}
+	detail_ptr->std_err = err;
+	detail_ptr->std_in  = in;
+	detail_ptr->std_out = out;
+	detail_ptr->env_sup = env_sup;
+	detail_ptr->env_cnt = env_cnt;
+	_release_job_launch_details(detail_ptr);
+}
+
+/* Note that a job's launch details no longer need job_state_buf */
+static void _release_job_launch_details(struct job_details *detail_ptr)
+{
+	if (detail_ptr->lazy_size == 0)
+		return;
+	detail_ptr->lazy_size = 0;
+	_release_job_state_buf();
+}
+
+/* Drop one user of job_state_buf, freeing it with the last one */
+static void _release_job_state_buf(void)
+{
+	if (job_state_buf_ref && (--job_state_buf_ref == 0)) {
+		free_buf(job_state_buf);
+		job_state_buf = NULL;
+	}
+}
+
+/* _load_job_details - Unpack a job details information from buffer
+ * IN indexed - see _load_job_state() */
 static int _load_job_details(struct job_record *job_ptr, Buf buffer,
-			     uint16_t protocol_version)
+			     uint16_t protocol_version, bool indexed)
 {
 	char *req_nodes = NULL, *exc_nodes = NULL, *features = NULL;
 	char *cpu_bind, *dependency = NULL, *orig_dependency = NULL, *mem_bind;
 	char *err = NULL, *in = NULL, *out = NULL, *work_dir = NULL;
 	char *ckpt_dir = NULL, *restart_dir = NULL;
 	char **argv = (char **) NULL, **env_sup = (char **) NULL;
+	char *lazy_data = NULL;
+	uint32_t lazy_size = 0;
 	uint32_t min_nodes, max_nodes;
 	uint32_t min_cpus = 1, max_cpus = NO_VAL;
 	uint32_t pn_min_cpus, pn_min_memory, pn_min_tmp_disk;
@@ -1678,9 +1941,11 @@ static int _load_job_details(struct job_record *job_ptr, Buf buffer,
 		safe_unpackstr_xmalloc(&dependency, &name_len, buffer);
 		safe_unpackstr_xmalloc(&orig_dependency, &name_len, buffer);
 
-		safe_unpackstr_xmalloc(&err, &name_len, buffer);
-		safe_unpackstr_xmalloc(&in,  &name_len, buffer);
-		safe_unpackstr_xmalloc(&out, &name_len, buffer);
+		if (!indexed) {
+			safe_unpackstr_xmalloc(&err, &name_len, buffer);
+			safe_unpackstr_xmalloc(&in,  &name_len, buffer);
+			safe_unpackstr_xmalloc(&out, &name_len, buffer);
+		}
 		safe_unpackstr_xmalloc(&work_dir, &name_len, buffer);
 		safe_unpackstr_xmalloc(&ckpt_dir, &name_len, buffer);
 		safe_unpackstr_xmalloc(&restart_dir, &name_len, buffer);
@@ -1688,7 +1953,24 @@ static int _load_job_details(struct job_record *job_ptr, Buf buffer,
 		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
 			goto unpack_error;
 		safe_unpackstr_array(&argv, &argc, buffer);
-		safe_unpackstr_array(&env_sup, &env_cnt, buffer);
+		if (!indexed) {
+			safe_unpackstr_array(&env_sup, &env_cnt, buffer);
+		} else {
+			safe_unpackmem_ptr(&lazy_data, &lazy_size, buffer);
+			if (lazy_data == NULL)
+				goto unpack_error;
+			/* Leave the launch details of jobs read by
+			 * load_all_job_state() in the file until used,
+			 * see decode_job_launch_details() */
+			if (buffer != job_state_buf) {
+				if (_unpack_launch_details(buffer,
+						lazy_data - get_buf_data(buffer),
+						lazy_size, &err, &in, &out,
+						&env_sup, &env_cnt))
+					goto unpack_error;
+				lazy_size = 0;
+			}
+		}
 	} else if (protocol_version >= SLURM_2_2_PROTOCOL_VERSION) {
 		safe_unpack32(&min_cpus, buffer);
 		safe_unpack32(&max_cpus, buffer);
@@ -1805,6 +2087,7 @@ static int _load_job_details(struct job_record *job_ptr, Buf buffer,
 	}
 
 	/* free any left-over detail data */
+	_release_job_launch_details(job_ptr->details);
 	for (i=0; i<job_ptr->details->argc; i++)
 		xfree(job_ptr->details->argv[i]);
 	xfree(job_ptr->details->argv);
@@ -1868,6 +2151,12 @@ static int _load_job_details(struct job_record *job_ptr, Buf buffer,
 	job_ptr->details->work_dir = work_dir;
 	job_ptr->details->ckpt_dir = ckpt_dir;
 	job_ptr->details->restart_dir = restart_dir;
+	if (lazy_size) {
+		job_ptr->details->lazy_offset = lazy_data -
+						get_buf_data(buffer);
+		job_ptr->details->lazy_size = lazy_size;
+		job_state_buf_ref++;
+	}
 
 	return SLURM_SUCCESS;
 
@@ -1909,6 +2198,128 @@ void _add_job_hash(struct job_record *job_ptr)
 	job_hash[inx] = job_ptr;
 }
 
+/* _add_job_array_hash - add a job array hash entry for given job record,
+ *	array_job_id must already be set
+ * IN job_ptr - pointer to job record
+ * Globals: job array hash table updated
+ */
+static void _add_job_array_hash(struct job_record *job_ptr)
+{
+	int inx;
+
+	inx = JOB_HASH_INX(job_ptr->array_job_id);
+	job_ptr->array_next = job_array_hash[inx];
+	job_array_hash[inx] = job_ptr;
+}
+
+/* _remove_job_hash - remove a job record from the job hash */
+static void _remove_job_hash(struct job_record *job_ptr)
+{
+	struct job_record **job_pptr;
+
+	job_pptr = &job_hash[JOB_HASH_INX(job_ptr->job_id)];
+	while (*job_pptr && (*job_pptr != job_ptr))
+		job_pptr = &(*job_pptr)->job_next;
+	if (*job_pptr == NULL)
+		fatal("job hash error");
+	*job_pptr = job_ptr->job_next;
+	job_ptr->job_next = NULL;
+}
+
+/* _remove_job_array_hash - remove a job record from the job array hash */
+static void _remove_job_array_hash(struct job_record *job_ptr)
+{
+	struct job_record **job_pptr;
+
+	if (job_ptr->array_job_id == 0)
+		return;
+
+	job_pptr = &job_array_hash[JOB_HASH_INX(job_ptr->array_job_id)];
+	while (*job_pptr && (*job_pptr != job_ptr))
+		job_pptr = &(*job_pptr)->array_next;
+	if (*job_pptr == NULL) {
+		error("job array hash error for job %u", job_ptr->job_id);
+		return;
+	}
+	*job_pptr = job_ptr->array_next;
+	job_ptr->array_next = NULL;
+}
+
+/* _job_name_hash_inx - return the job name hash index for a user and name */
+static int _job_name_hash_inx(uint32_t user_id, char *name)
+{
+	uint32_t inx = user_id;
+
+	while (*name)
+		inx = (inx * 31) + (unsigned char) *name++;
+	return (inx % hash_table_size);
+}
+
+/* _add_job_name_hash - add a job name hash entry for given job record,
+ *	user_id and name must already be set
+ * IN job_ptr - pointer to job record
+ * Globals: job name hash table updated
+ */
+static void _add_job_name_hash(struct job_record *job_ptr)
+{
+	int inx;
+
+	if (job_ptr->name == NULL)
+		return;
+
+	inx = _job_name_hash_inx(job_ptr->user_id, job_ptr->name);
+	job_ptr->name_next = job_name_hash[inx];
+	job_name_hash[inx] = job_ptr;
+}
+
+/* _remove_job_name_hash - remove a job record from the job name hash */
+static void _remove_job_name_hash(struct job_record *job_ptr)
+{
+	struct job_record **job_pptr;
+
+	if (job_ptr->name == NULL)
+		return;
+
+	job_pptr = &job_name_hash[_job_name_hash_inx(job_ptr->user_id,
+						     job_ptr->name)];
+	while (*job_pptr && (*job_pptr != job_ptr))
+		job_pptr = &(*job_pptr)->name_next;
+	if (*job_pptr == NULL) {
+		error("job name hash error for job %u", job_ptr->job_id);
+		return;
+	}
+	*job_pptr = job_ptr->name_next;
+	job_ptr->name_next = NULL;
+}
+
+/* _job_files_shared - return true if another record of the same job array
+ *	still references the job's script and environment files */
+static bool _job_files_shared(struct job_record *job_ptr)
+{
+	struct job_record *array_ptr;
+
+	if (job_ptr->array_job_id == 0)
+		return false;
+
+	array_ptr = job_array_hash[JOB_HASH_INX(job_ptr->array_job_id)];
+	while (array_ptr) {
+		if ((array_ptr->array_job_id == job_ptr->array_job_id) &&
+		    (array_ptr != job_ptr))
+			return true;
+		array_ptr = array_ptr->array_next;
+	}
+	return false;
+}
+
+/* _job_dir_id - return the ID of the directory holding a job's script and
+ *	environment, every record of a job array shares the same files */
+static uint32_t _job_dir_id(struct job_record *job_ptr)
+{
+	if (job_ptr->array_job_id)
+		return job_ptr->array_job_id;
+	return job_ptr->job_id;
+}
+
 /*
  * find_job_record - return a pointer to the job record with the given job_id
  * IN job_id - requested job's id
@@ -1930,6 +2341,139 @@ struct job_record *find_job_record(uint32_t job_id)
 	return NULL;
 }
 
+/*
+ * find_job_array_pending - return the record of a job array holding the
+ *	tasks not yet started
+ * IN array_job_id - job ID of the job array
+ * RET pointer to the job array's pending record, NULL if none remains
+ * global: job_array_hash - hash table of job records by array_job_id
+ */
+extern struct job_record *find_job_array_pending(uint32_t array_job_id)
+{
+	struct job_record *job_ptr = NULL;
+
+	/* A new pending record is added at the head of its hash chain */
+	while ((job_ptr = find_next_job_array(array_job_id, job_ptr))) {
+		if (job_ptr->array_task_bitmap)
+			return job_ptr;
+	}
+	return NULL;
+}
+
+/*
+ * find_next_job_array - iterate over the records of a job array
+ * IN array_job_id - job ID of the job array
+ * IN job_ptr - job last returned or NULL to get the first job
+ * RET pointer to the next record of the job array, NULL when none remain
+ * global: job_array_hash - hash table of job records by array_job_id
+ */
+extern struct job_record *find_next_job_array(uint32_t array_job_id,
+					      struct job_record *job_ptr)
+{
+	if (array_job_id == 0)
+		return NULL;
+
+	if (job_ptr)
+		job_ptr = job_ptr->array_next;
+	else
+		job_ptr = job_array_hash[JOB_HASH_INX(array_job_id)];
+	while (job_ptr) {
+		if (job_ptr->array_job_id == array_job_id)
+			return job_ptr;
+		job_ptr = job_ptr->array_next;
+	}
+	return NULL;
+}
+
+/*
+ * find_next_job_user_name - iterate over the jobs of a user with a given name
+ * IN user_id - job owner
+ * IN name - job name
+ * IN job_ptr - job last returned or NULL to get the first job
+ * RET pointer to the next matching job record, NULL when none remain
+ * global: job_name_hash - hash table of job records by user_id and name
+ */
+extern struct job_record *find_next_job_user_name(uint32_t user_id,
+						  char *name,
+						  struct job_record *job_ptr)
+{
+	if (name == NULL)
+		return NULL;
+
+	if (job_ptr)
+		job_ptr = job_ptr->name_next;
+	else
+		job_ptr = job_name_hash[_job_name_hash_inx(user_id, name)];
+	while (job_ptr) {
+		if ((job_ptr->user_id == user_id) &&
+		    !strcmp(job_ptr->name, name))
+			return job_ptr;
+		job_ptr = job_ptr->name_next;
+	}
+	return NULL;
+}
+
+/*
+ * add_job_singleton_depend - change the count of singleton dependencies held
+ *	by the jobs of a user with a given name
+ * IN job_ptr - job whose singleton dependencies were added or removed
+ * IN cnt - number added, negative if removed
+ * global: job_name_singleton_cnt - count per job_name_hash entry
+ */
+extern void add_job_singleton_depend(struct job_record *job_ptr, int cnt)
+{
+	uint32_t *cnt_ptr;
+
+	if ((job_ptr->name == NULL) || (cnt == 0))
+		return;
+
+	cnt_ptr = &job_name_singleton_cnt[_job_name_hash_inx(job_ptr->user_id,
+							     job_ptr->name)];
+	if ((cnt < 0) && (*cnt_ptr < -cnt)) {
+		error("job name singleton count underflow for job %u",
+		      job_ptr->job_id);
+		*cnt_ptr = 0;
+	} else
+		*cnt_ptr += cnt;
+}
+
+/*
+ * test_job_singleton_depend - test if any job of a user with a given name
+ *	may hold a singleton dependency
+ * IN user_id - job owner
+ * IN name - job name
+ * RET false if none does, true may be a false positive since names can
+ *	share a job_name_hash entry
+ */
+extern bool test_job_singleton_depend(uint32_t user_id, char *name)
+{
+	if (name == NULL)
+		return false;
+	return (job_name_singleton_cnt[_job_name_hash_inx(user_id, name)] != 0);
+}
+
+/* Return the number of singleton dependencies held by a job */
+static int _job_singleton_depend_cnt(struct job_record *job_ptr)
+{
+	ListIterator depend_iter;
+	struct depend_spec *dep_ptr;
+	int cnt = 0;
+
+	if ((job_ptr->details == NULL) ||
+	    (job_ptr->details->depend_list == NULL))
+		return 0;
+
+	depend_iter = list_iterator_create(job_ptr->details->depend_list);
+	if (!depend_iter)
+		fatal("list_iterator_create memory allocation failure");
+	while ((dep_ptr = list_next(depend_iter))) {
+		if (dep_ptr->depend_type == SLURM_DEPEND_SINGLETON)
+			cnt++;
+	}
+	list_iterator_destroy(depend_iter);
+	return cnt;
+}
+
 /* rebuild a job's partition name list based upon the contents of its
  *	part_ptr_list */
 static void _rebuild_part_name_list(struct job_record  *job_ptr)
@@ -2715,6 +3259,12 @@ extern void rehash_jobs(void)
 		hash_table_size = slurmctld_conf.max_job_cnt;
 		job_hash = (struct job_record **)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
+		job_array_hash = (struct job_record **)
+			xmalloc(hash_table_size * sizeof(struct job_record *));
+		job_name_hash = (struct job_record **)
+			xmalloc(hash_table_size * sizeof(struct job_record *));
+		job_name_singleton_cnt = (uint32_t *)
+			xmalloc(hash_table_size * sizeof(uint32_t));
 	} else if (hash_table_size < (slurmctld_conf.max_job_cnt / 2)) {
 		/* If the MaxJobCount grows by too much, the hash table will
 		 * be ineffective without rebuilding. We don't presently bother
@@ -3093,6 +3643,239 @@ extern int job_signal(uint32_t job_id, uint16_t signal, uint16_t batch_flag,
 	return ESLURM_TRANSITION_STATE_NO_UPDATE;
 }
 
+/*
+ * job_array_signal - signal every record of a job array, or the specified
+ *	job if job_id does not identify a job array
+ * IN job_id - array_job_id of the job array or job_id of a job
+ * IN signal - signal to send, SIGKILL == cancel the job
+ * IN batch_flag - signal batch shell only if set
+ * IN uid - uid of requesting user
+ * RET 0 on success, otherwise ESLURM error code
+ */
+extern int job_array_signal(uint32_t job_id, uint16_t signal,
+			    uint16_t batch_flag, uid_t uid)
+{
+	struct job_record *job_ptr, *next_ptr;
+	int rc = SLURM_SUCCESS, rc1;
+	bool found = false, success = false;
+
+	job_ptr = find_next_job_array(job_id, NULL);
+	while (job_ptr) {
+		next_ptr = find_next_job_array(job_id, job_ptr);
+		found = true;
+		rc1 = job_signal(job_ptr->job_id, signal, batch_flag, uid,
+				 false);
+		if (rc1 == SLURM_SUCCESS)
+			success = true;
+		else if ((rc1 != ESLURM_ALREADY_DONE) &&
+			 (rc1 != ESLURM_TRANSITION_STATE_NO_UPDATE))
+			rc = rc1;
+		job_ptr = next_ptr;
+	}
+
+	if (!found)
+		return job_signal(job_id, signal, batch_flag, uid, false);
+	if (success)
+		return SLURM_SUCCESS;
+	if (rc == SLURM_SUCCESS)
+		rc = ESLURM_ALREADY_DONE;
+	return rc;
+}
+
+/*
+ * job_array_split - job_ptr is the pending record of a job array and is
+ *	about to be started. Assign it the lowest pending task_id and move
+ *	the remaining task_ids into a new pending record. The new pending
+ *	record takes over job_ptr's job ID and job_ptr gets a new one, so
+ *	the pending tasks keep the job array's ID.
+ * IN job_ptr - pointer to the job array's pending record
+ * NOTE: lock_slurmctld on entry: Read config Write job, Write node, Read part
+ */
+extern void job_array_split(struct job_record *job_ptr)
+{
+	struct job_record *new_job_ptr = NULL;
+	int task_id;
+
+	xassert(job_ptr->array_task_bitmap);
+	task_id = bit_ffs(job_ptr->array_task_bitmap);
+	if (task_id < 0) {
+		error("job_array_split: job %u has no pending tasks",
+		      job_ptr->job_id);
+		FREE_NULL_BITMAP(job_ptr->array_task_bitmap);
+		return;
+	}
+	bit_clear(job_ptr->array_task_bitmap, task_id);
+
+	if (bit_ffs(job_ptr->array_task_bitmap) >= 0)
+		new_job_ptr = _job_array_copy(job_ptr);
+	if (new_job_ptr) {
+		_swap_job_id(job_ptr, new_job_ptr);
+		new_job_ptr->array_task_bitmap = job_ptr->array_task_bitmap;
+		job_ptr->array_task_bitmap = NULL;
+		debug("job_array_split: job %u_%u started as job %u, "
+		      "remaining tasks pending as job %u",
+		      job_ptr->array_job_id, task_id, job_ptr->job_id,
+		      new_job_ptr->job_id);
+	} else
+		FREE_NULL_BITMAP(job_ptr->array_task_bitmap);
+
+	job_ptr->array_task_id = task_id;
+	_add_job_env_sup(job_ptr->details, "SLURM_ARRAY_JOB_ID",
+			 job_ptr->array_job_id);
+	_add_job_env_sup(job_ptr->details, "SLURM_ARRAY_TASK_ID", task_id);
+	last_job_update = time(NULL);
+}
+
+/* _swap_job_id - exchange the job IDs of two job records, along with their
+ *	accounting records, which are identified by job ID */
+static void _swap_job_id(struct job_record *job1_ptr,
+			 struct job_record *job2_ptr)
+{
+	uint32_t tmp;
+
+	_remove_job_hash(job1_ptr);
+	_remove_job_hash(job2_ptr);
+	tmp = job1_ptr->job_id;
+	job1_ptr->job_id = job2_ptr->job_id;
+	job2_ptr->job_id = tmp;
+	tmp = job1_ptr->db_index;
+	job1_ptr->db_index = job2_ptr->db_index;
+	job2_ptr->db_index = tmp;
+	_add_job_hash(job1_ptr);
+	_add_job_hash(job2_ptr);
+	update_job_dependents_id(job1_ptr);
+	update_job_dependents_id(job2_ptr);
+}
+
+/* _add_job_env_sup - add "name=value" to a job's supplemental environment
+ *	variables, these are merged into the batch job's environment */
+static void _add_job_env_sup(struct job_details *detail_ptr, char *name,
+			     uint32_t value)
+{
+	decode_job_launch_details(detail_ptr);
+	xrealloc(detail_ptr->env_sup,
+		 sizeof(char *) * (detail_ptr->env_cnt + 1));
+	detail_ptr->env_sup[detail_ptr->env_cnt++] =
+		xstrdup_printf("%s=%u", name, value);
+}
+
+/*
+ * _job_array_copy - create a new pending record for a job array, copying
+ *	the job's request from the job array's pending record
+ * IN job_ptr - pointer to the job array's pending record
+ * RET pointer to the new job record or NULL on error
+ */
+static struct job_record *_job_array_copy(struct job_record *job_ptr)
+{
+	struct job_record *new_job_ptr;
+	struct job_details *new_detail_ptr;
+	Buf buffer;
+	bool valid;
+	int i;
+
+	/* The job array already holds one record, don't refuse to split it
+	 * because of MaxJobCount */
+	new_job_ptr = _create_job_record();
+	new_detail_ptr = new_job_ptr->details;
+	new_job_ptr->partition = xstrdup(job_ptr->partition);
+	_set_job_id(new_job_ptr);
+	_add_job_hash(new_job_ptr);
+
+	/* Copy the job details by packing and unpacking them */
+	buffer = init_buf(BUF_SIZE);
+	_dump_job_details(job_ptr->details, buffer);
+	set_buf_offset(buffer, 0);
+	if (_load_job_details(new_job_ptr, buffer, SLURM_PROTOCOL_VERSION,
+			      true)) {
+		error("_job_array_copy: unable to copy details of job %u",
+		      job_ptr->job_id);
+		free_buf(buffer);
+		_purge_job_record(new_job_ptr->job_id);
+		return NULL;
+	}
+	free_buf(buffer);
+	new_detail_ptr->expanding_jobid = job_ptr->details->expanding_jobid;
+
+	new_job_ptr->account     = xstrdup(job_ptr->account);
+	new_job_ptr->alloc_node  = xstrdup(job_ptr->alloc_node);
+	new_job_ptr->alloc_sid   = job_ptr->alloc_sid;
+	new_job_ptr->array_job_id  = job_ptr->array_job_id;
+	new_job_ptr->array_task_id = NO_VAL;
+	new_job_ptr->assoc_id    = job_ptr->assoc_id;
+	new_job_ptr->assoc_ptr   = job_ptr->assoc_ptr;
+	new_job_ptr->batch_flag  = job_ptr->batch_flag;
+	new_job_ptr->ckpt_interval = job_ptr->ckpt_interval;
+	new_job_ptr->comment     = xstrdup(job_ptr->comment);
+	new_job_ptr->cr_enabled  = job_ptr->cr_enabled;
+	new_job_ptr->direct_set_prio = job_ptr->direct_set_prio;
+	new_job_ptr->gres        = xstrdup(job_ptr->gres);
+	new_job_ptr->gres_list   = gres_plugin_job_state_dup(job_ptr->
+							    gres_list);
+	new_job_ptr->group_id    = job_ptr->group_id;
+	new_job_ptr->job_state   = JOB_PENDING;
+	new_job_ptr->kill_on_node_fail = job_ptr->kill_on_node_fail;
+	new_job_ptr->licenses    = xstrdup(job_ptr->licenses);
+	new_job_ptr->license_list = license_validate(job_ptr->licenses,
+						     &valid);
+	new_job_ptr->limit_set_max_cpus  = job_ptr->limit_set_max_cpus;
+	new_job_ptr->limit_set_max_nodes = job_ptr->limit_set_max_nodes;
+	new_job_ptr->limit_set_min_cpus  = job_ptr->limit_set_min_cpus;
+	new_job_ptr->limit_set_min_nodes = job_ptr->limit_set_min_nodes;
+	new_job_ptr->limit_set_time      = job_ptr->limit_set_time;
+	new_job_ptr->mail_type   = job_ptr->mail_type;
+	new_job_ptr->mail_user   = xstrdup(job_ptr->mail_user);
+	new_job_ptr->name        = xstrdup(job_ptr->name);
+	new_job_ptr->network     = xstrdup(job_ptr->network);
+	new_job_ptr->part_ptr    = job_ptr->part_ptr;
+	if (job_ptr->part_ptr_list)
+		new_job_ptr->part_ptr_list = get_part_list(job_ptr->partition);
+	new_job_ptr->priority    = job_ptr->priority;
+	new_job_ptr->qos_id      = job_ptr->qos_id;
+	new_job_ptr->qos_ptr     = job_ptr->qos_ptr;
+	new_job_ptr->req_switch  = job_ptr->req_switch;
+	new_job_ptr->resv_flags  = job_ptr->resv_flags;
+	new_job_ptr->resv_id     = job_ptr->resv_id;
+	new_job_ptr->resv_name   = xstrdup(job_ptr->resv_name);
+	new_job_ptr->resv_ptr    = job_ptr->resv_ptr;
+	new_job_ptr->select_jobinfo =
+		select_g_select_jobinfo_copy(job_ptr->select_jobinfo);
+	new_job_ptr->spank_job_env_size = job_ptr->spank_job_env_size;
+	new_job_ptr->spank_job_env = xmalloc(sizeof(char *) *
+					     (job_ptr->spank_job_env_size + 1));
+	for (i = 0; i < job_ptr->spank_job_env_size; i++) {
+		new_job_ptr->spank_job_env[i] =
+			xstrdup(job_ptr->spank_job_env[i]);
+	}
+	new_job_ptr->state_reason = WAIT_NO_REASON;
+	new_job_ptr->time_limit  = job_ptr->time_limit;
+	new_job_ptr->time_min    = job_ptr->time_min;
+	new_job_ptr->user_id     = job_ptr->user_id;
+	_add_job_name_hash(new_job_ptr);
+	new_job_ptr->wait4switch = job_ptr->wait4switch;
+	new_job_ptr->wait_all_nodes = job_ptr->wait_all_nodes;
+	new_job_ptr->warn_signal = job_ptr->warn_signal;
+	new_job_ptr->warn_time   = job_ptr->warn_time;
+	new_job_ptr->wckey       = xstrdup(job_ptr->wckey);
+	new_job_ptr->best_switch = true;
+
+	if (checkpoint_alloc_jobinfo(&new_job_ptr->check_job))
+		error("Failed to allocate checkpoint info for job");
+	if (update_job_dependency(new_job_ptr, new_detail_ptr->dependency))
+		error("Invalid dependency for job array %u",
+		      job_ptr->array_job_id);
+	if (build_feature_list(new_job_ptr))
+		error("Invalid features for job array %u",
+		      job_ptr->array_job_id);
+	(void) _reset_detail_bitmaps(new_job_ptr);
+
+	_add_job_array_hash(new_job_ptr);
+	acct_policy_add_job_submit(new_job_ptr);
+	/* Jobs depending upon the job array also wait for the new record */
+	copy_job_dependents(job_ptr, new_job_ptr);
+
+	return new_job_ptr;
+}
+
 static void
 _signal_batch_job(struct job_record *job_ptr, uint16_t signal)
 {
@@ -3649,6 +4432,7 @@ static int _job_create(job_desc_msg_t * job_desc, int allocate, int will_run,
 	struct job_record *job_ptr = NULL;
 	slurmdb_association_rec_t assoc_rec, *assoc_ptr;
 	List license_list = NULL;
+	bitstr_t *array_bitmap = NULL;
 	bool valid;
 	slurmdb_qos_rec_t qos_rec, *qos_ptr;
 	uint32_t user_submit_priority;
@@ -3927,6 +4711,22 @@ static int _job_create(job_desc_msg_t * job_desc, int allocate, int will_run,
 	if ((error_code =_validate_job_create_req(job_desc)))
 		goto cleanup;
 
+	if (job_desc->array_inx) {
+		if ((job_desc->script == NULL) || allocate) {
+			info("_job_create: job arrays are only supported for "
+			     "batch jobs");
+			error_code = ESLURM_INVALID_ARRAY;
+			goto cleanup_fail;
+		}
+		array_bitmap = _build_array_bitmap(job_desc->array_inx);
+		if (array_bitmap == NULL) {
+			info("_job_create: invalid job array specification "
+			     "(%s)", job_desc->array_inx);
+			error_code = ESLURM_INVALID_ARRAY;
+			goto cleanup_fail;
+		}
+	}
+
 	if ((error_code = _copy_job_desc_to_job_record(job_desc,
 						       job_pptr,
 						       &req_bitmap,
@@ -3939,6 +4739,15 @@ static int _job_create(job_desc_msg_t * job_desc, int allocate, int will_run,
 	job_ptr->part_ptr = part_ptr;
 	job_ptr->part_ptr_list = part_ptr_list;
 	part_ptr_list = NULL;
+	if (array_bitmap) {
+		/* One pending record represents every task of the job array,
+		 * tasks are split off as they are started */
+		job_ptr->array_job_id = job_ptr->job_id;
+		job_ptr->array_task_id = NO_VAL;
+		job_ptr->array_task_bitmap = array_bitmap;
+		array_bitmap = NULL;
+		_add_job_array_hash(job_ptr);
+	}
 	if ((error_code = checkpoint_alloc_jobinfo(&(job_ptr->check_job)))) {
 		error("Failed to allocate checkpoint info for job");
 		goto cleanup_fail;
@@ -4029,6 +4838,7 @@ static int _job_create(job_desc_msg_t * job_desc, int allocate, int will_run,
 
 cleanup:
 	FREE_NULL_LIST(license_list);
+	FREE_NULL_BITMAP(array_bitmap);
 	FREE_NULL_BITMAP(req_bitmap);
 	FREE_NULL_BITMAP(exc_bitmap);
 	return error_code;
@@ -4044,11 +4854,60 @@ cleanup_fail:
 	}
 	FREE_NULL_LIST(license_list);
 	FREE_NULL_LIST(part_ptr_list);
+	FREE_NULL_BITMAP(array_bitmap);
 	FREE_NULL_BITMAP(req_bitmap);
 	FREE_NULL_BITMAP(exc_bitmap);
 	return error_code;
 }
 
+/*
+ * _build_array_bitmap - build a bitmap of the task_ids in a job array
+ *	specification of the form "1-10:2,15"
+ * IN array_inx - job array specification
+ * RET bitmap of task_ids, sized to the highest task_id, or NULL if invalid
+ */
+static bitstr_t *_build_array_bitmap(char *array_inx)
+{
+	char *tmp, *tok, *save_ptr = NULL, *end_ptr;
+	long int first, last, step, i;
+	bitstr_t *array_bitmap;
+	bool valid = true;
+
+	array_bitmap = bit_alloc(MAX_ARRAY_TASK_ID + 1);
+	if (array_bitmap == NULL)
+		fatal("bit_alloc: malloc failure");
+
+	tmp = xstrdup(array_inx);
+	tok = strtok_r(tmp, ",", &save_ptr);
+	while (tok && valid) {
+		first = strtol(tok, &end_ptr, 10);
+		last = first;
+		step = 1;
+		if (end_ptr[0] == '-')
+			last = strtol(end_ptr + 1, &end_ptr, 10);
+		if (end_ptr[0] == ':')
+			step = strtol(end_ptr + 1, &end_ptr, 10);
+		if ((end_ptr[0] != '\0') || (first < 0) || (last < first) ||
+		    (last > MAX_ARRAY_TASK_ID) || (step <= 0)) {
+			valid = false;
+			break;
+		}
+		for (i = first; i <= last; i += step)
+			bit_set(array_bitmap, i);
+		tok = strtok_r(NULL, ",", &save_ptr);
+	}
+	xfree(tmp);
+
+	if (!valid || ((i = bit_fls(array_bitmap)) < 0)) {
+		FREE_NULL_BITMAP(array_bitmap);
+		return NULL;
+	}
+	array_bitmap = bit_realloc(array_bitmap, i + 1);
+	if (array_bitmap == NULL)
+		fatal("bit_realloc: malloc failure");
+	return array_bitmap;
+}
+
 static int _test_strlen(char *test_str, char *str_name, int max_str_len)
 {
 	int i = 0;
@@ -4070,6 +4929,7 @@ static int _validate_job_create_req(job_desc_msg_t * job_desc)
 {
 	if (_test_strlen(job_desc->account, "account", 1024)		||
 	    _test_strlen(job_desc->alloc_node, "alloc_node", 1024)	||
+	    _test_strlen(job_desc->array_inx, "array_inx", 1024 * 4)	||
 	    _test_strlen(job_desc->blrtsimage, "blrtsimage", 1024)	||
 	    _test_strlen(job_desc->ckpt_dir, "ckpt_dir", 1024)		||
 	    _test_strlen(job_desc->comment, "comment", 1024)		||
@@ -4238,8 +5098,9 @@ char **get_job_env(struct job_record *job_ptr, uint32_t * env_size)
 {
 	char job_dir[30], *file_name, **environment = NULL;
 
+	decode_job_launch_details(job_ptr->details);
 	file_name = slurm_get_state_save_location();
-	sprintf(job_dir, "/job.%d/environment", job_ptr->job_id);
+	sprintf(job_dir, "/job.%u/environment", _job_dir_id(job_ptr));
 	xstrcat(file_name, job_dir);
 
 	_read_data_array_from_file(file_name, &environment, env_size, job_ptr);
@@ -4261,7 +5122,7 @@ char *get_job_script(struct job_record *job_ptr)
 		char *file_name = slurm_get_state_save_location();
 		char job_dir[30];
 
-		sprintf(job_dir, "/job.%d/script", job_ptr->job_id);
+		sprintf(job_dir, "/job.%u/script", _job_dir_id(job_ptr));
 		xstrcat(file_name, job_dir);
 
 		_read_data_from_file(file_name, &script);
@@ -4557,6 +5418,7 @@ _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 	_add_job_hash(job_ptr);
 
 	job_ptr->user_id    = (uid_t) job_desc->user_id;
+	_add_job_name_hash(job_ptr);
 	job_ptr->group_id   = (gid_t) job_desc->group_id;
 	job_ptr->job_state  = JOB_PENDING;
 	job_ptr->time_limit = job_desc->time_limit;
@@ -5205,26 +6067,22 @@ static int _validate_job_desc(job_desc_msg_t * job_desc_msg, int allocate,
 static void _list_delete_job(void *job_entry)
 {
 	struct job_record *job_ptr = (struct job_record *) job_entry;
-	struct job_record **job_pptr;
 	int i;
 
 	xassert(job_entry);
 	xassert (job_ptr->magic == JOB_MAGIC);
 	job_ptr->magic = 0;	/* make sure we don't delete record twice */
 
-	/* Remove the record from the hash table */
-	job_pptr = &job_hash[JOB_HASH_INX(job_ptr->job_id)];
-	while ((job_pptr != NULL) &&
-	       ((job_ptr = *job_pptr) != (struct job_record *) job_entry)) {
-		job_pptr = &job_ptr->job_next;
-	}
-	if (job_pptr == NULL)
-		fatal("job hash error");
-	*job_pptr = job_ptr->job_next;
+	_remove_job_hash(job_ptr);
+	_remove_job_array_hash(job_ptr);
+	_remove_job_name_hash(job_ptr);
+	purge_job_dependency(job_ptr);
+	trigger_job_purge(job_ptr);
 
 	delete_job_details(job_ptr);
 	xfree(job_ptr->account);
 	xfree(job_ptr->alloc_node);
+	FREE_NULL_BITMAP(job_ptr->array_task_bitmap);
 	xfree(job_ptr->batch_host);
 	xfree(job_ptr->comment);
 	xfree(job_ptr->gres);
@@ -5390,6 +6248,17 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = xfer_buf_data(buffer);
 }
 
+/* Return true if the user may view the given job record */
+static bool _pack_job_permitted(struct job_record *job_ptr, uid_t uid)
+{
+	if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
+	    (job_ptr->user_id != uid) && !validate_operator(uid) &&
+	    !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
+					  job_ptr->account))
+		return false;
+	return true;
+}
+
 /*
  * pack_one_job - dump information for one jobs in
  *	machine independent form (for network transmission)
@@ -5406,36 +6275,45 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 			uint32_t job_id, uint16_t show_flags, uid_t uid,
 			uint16_t protocol_version)
 {
-	ListIterator job_iterator;
 	struct job_record *job_ptr;
-	uint32_t jobs_packed = 0;
+	uint32_t jobs_packed = 0, tmp_offset;
 	Buf buffer;
 
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		if (job_ptr->job_id != job_id)
-			continue;
-
-		if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
-		    (job_ptr->user_id != uid) && !validate_operator(uid) &&
-		    !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-						  job_ptr->account))
-			break;
+	buffer = init_buf(BUF_SIZE);
+	pack32(jobs_packed, buffer);
+	pack_time(time(NULL), buffer);
 
+	job_ptr = find_job_record(job_id);
+	if (job_ptr && _pack_job_permitted(job_ptr, uid)) {
+		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
 		jobs_packed++;
-		break;
 	}
-	list_iterator_destroy(job_iterator);
-	if (jobs_packed == 0)
+
+	/* The ID of a job array also identifies its other records */
+	job_ptr = job_array_hash[JOB_HASH_INX(job_id)];
+	while (job_ptr) {
+		if ((job_ptr->array_job_id == job_id) &&
+		    (job_ptr->job_id != job_id) &&
+		    _pack_job_permitted(job_ptr, uid)) {
+			pack_job(job_ptr, show_flags, buffer, protocol_version,
+				 uid);
+			jobs_packed++;
+		}
+		job_ptr = job_ptr->array_next;
+	}
+	if (jobs_packed == 0) {
+		free_buf(buffer);
 		return ESLURM_INVALID_JOB_ID;
+	}
 
-	buffer = init_buf(BUF_SIZE);
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
 	pack32(jobs_packed, buffer);
-	pack_time(time(NULL), buffer);
-	pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
+	set_buf_offset(buffer, tmp_offset);
 
 	*buffer_size = get_buf_offset(buffer);
 	buffer_ptr[0] = xfer_buf_data(buffer);
@@ -5465,6 +6343,11 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 	if (protocol_version >= SLURM_2_3_PROTOCOL_VERSION) {
 		pack32(dump_job_ptr->assoc_id, buffer);
 		pack32(dump_job_ptr->job_id, buffer);
+		if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			pack32(dump_job_ptr->array_job_id, buffer);
+			pack32(dump_job_ptr->array_task_id, buffer);
+			pack_bit_fmt(dump_job_ptr->array_task_bitmap, buffer);
+		}
 		pack32(dump_job_ptr->user_id, buffer);
 		pack32(dump_job_ptr->group_id, buffer);
 
@@ -6506,6 +7389,8 @@ int update_job(job_desc_msg_t * job_specs, uid_t uid)
 		      job_specs->job_id);
 		return ESLURM_INVALID_JOB_ID;
 	}
+	/* Job constraints may change, rebuild its usable node sets */
+	node_set_cache_free(job_ptr->details);
 
 	error_code = job_submit_plugin_modify(job_specs, job_ptr,
 					      (uint32_t) uid);
@@ -7450,8 +8335,19 @@ int update_job(job_desc_msg_t * job_specs, uid_t uid)
 			error_code = ESLURM_DISABLED;
 			goto fini;
 		} else {
+			/* Leaving its old name may release a singleton
+			 * dependency, the new one needs to be tested */
+			int singleton_cnt = _job_singleton_depend_cnt(job_ptr);
+			notify_job_dependency(job_ptr);
+			add_job_singleton_depend(job_ptr, -singleton_cnt);
+			_remove_job_name_hash(job_ptr);
+			xfree(job_ptr->name);
 			job_ptr->name = job_specs->name;
 			job_specs->name = NULL;
+			_add_job_name_hash(job_ptr);
+			add_job_singleton_depend(job_ptr, singleton_cnt);
+			if (job_ptr->details)
+				job_ptr->details->depend_blocked = false;
 
 			info("sched: update_job: setting name to %s for "
 			     "job_id %u", job_ptr->name, job_specs->job_id);
@@ -8146,6 +9042,83 @@ validate_jobs_on_node(slurm_node_registration_status_msg_t *reg_msg)
 	return;
 }
 
+/*
+ * validate_jobs_batch_begin - index the active jobs on a set of nodes about
+ *	to register together, so that validate_jobs_on_node() reconciles
+ *	them without a full job list scan per node
+ * IN node_bitmap - nodes in the registration batch, must remain valid
+ *	until validate_jobs_batch_end() is called
+ */
+extern void validate_jobs_batch_begin(bitstr_t *node_bitmap)
+{
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	int i, i_first, i_last;
+
+	validate_jobs_batch_end();
+	reg_node_bitmap  = node_bitmap;
+	reg_node_job_cnt = xmalloc(sizeof(int) * node_record_count);
+	reg_node_jobs    = xmalloc(sizeof(struct job_record **) *
+				   node_record_count);
+
+	/* First pass counts the jobs per node, second fills in the
+	 * arrays preserving the job list order */
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if ((!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr)) ||
+		    !job_ptr->node_bitmap ||
+		    !bit_overlap(job_ptr->node_bitmap, reg_node_bitmap))
+			continue;
+		i_first = bit_ffs(job_ptr->node_bitmap);
+		i_last  = bit_fls(job_ptr->node_bitmap);
+		for (i = i_first; i <= i_last; i++) {
+			if (bit_test(job_ptr->node_bitmap, i) &&
+			    bit_test(reg_node_bitmap, i))
+				reg_node_job_cnt[i]++;
+		}
+	}
+	for (i = 0; i < node_record_count; i++) {
+		if (reg_node_job_cnt[i] == 0)
+			continue;
+		reg_node_jobs[i] = xmalloc(sizeof(struct job_record *) *
+					   reg_node_job_cnt[i]);
+		reg_node_job_cnt[i] = 0;
+	}
+	list_iterator_reset(job_iterator);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if ((!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr)) ||
+		    !job_ptr->node_bitmap ||
+		    !bit_overlap(job_ptr->node_bitmap, reg_node_bitmap))
+			continue;
+		i_first = bit_ffs(job_ptr->node_bitmap);
+		i_last  = bit_fls(job_ptr->node_bitmap);
+		for (i = i_first; i <= i_last; i++) {
+			if (bit_test(job_ptr->node_bitmap, i) &&
+			    bit_test(reg_node_bitmap, i))
+				reg_node_jobs[i][reg_node_job_cnt[i]++] =
+					job_ptr;
+		}
+	}
+	list_iterator_destroy(job_iterator);
+}
+
+/*
+ * validate_jobs_batch_end - release the index built by
+ *	validate_jobs_batch_begin()
+ */
+extern void validate_jobs_batch_end(void)
+{
+	int i;
+
+	if (reg_node_jobs) {
+		for (i = 0; i < node_record_count; i++)
+			xfree(reg_node_jobs[i]);
+		xfree(reg_node_jobs);
+	}
+	xfree(reg_node_job_cnt);
+	reg_node_bitmap = NULL;
+}
+
 /* Purge any batch job that should have its script running on node
  * node_inx, but is not. Allow BatchStartTimeout + ResumeTimeout seconds
  * for startup.
@@ -8156,7 +9129,7 @@ validate_jobs_on_node(slurm_node_registration_status_msg_t *reg_msg)
  * but are not found. */
 static void _purge_missing_jobs(int node_inx, time_t now)
 {
-	ListIterator job_iterator;
+	ListIterator job_iterator = NULL;
 	struct job_record *job_ptr;
 	struct node_record *node_ptr = node_record_table_ptr + node_inx;
 	uint16_t batch_start_timeout	= slurm_get_batch_start_timeout();
@@ -8164,6 +9137,8 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 	uint16_t resume_timeout		= slurm_get_resume_timeout();
 	uint32_t suspend_time		= slurm_get_suspend_time();
 	time_t batch_startup_time, node_boot_time = (time_t) 0, startup_time;
+	struct job_record **job_array = NULL;
+	int job_cnt = 0, job_inx = 0;
 
 	if (node_ptr->boot_time > (msg_timeout + 5)) {
 		/* allow for message timeout and other delays */
@@ -8172,10 +9147,27 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 	batch_startup_time  = now - batch_start_timeout;
 	batch_startup_time -= msg_timeout;
 
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		bool job_active = IS_JOB_RUNNING(job_ptr) ||
-				  IS_JOB_SUSPENDED(job_ptr);
+	/* Registrations processed in a batch use the per-node job index
+	 * rather than scanning the full job list for each node. Entries
+	 * may have since changed state, so they are tested below. */
+	if (reg_node_bitmap && bit_test(reg_node_bitmap, node_inx)) {
+		job_array = reg_node_jobs[node_inx];
+		job_cnt   = reg_node_job_cnt[node_inx];
+	} else
+		job_iterator = list_iterator_create(job_list);
+	while (1) {
+		bool job_active;
+
+		if (job_iterator)
+			job_ptr = (struct job_record *) list_next(job_iterator);
+		else if (job_inx < job_cnt)
+			job_ptr = job_array[job_inx++];
+		else
+			job_ptr = NULL;
+		if (!job_ptr)
+			break;
+		job_active = IS_JOB_RUNNING(job_ptr) ||
+			     IS_JOB_SUSPENDED(job_ptr);
 
 		if ((!job_active) ||
 		    (!bit_test(job_ptr->node_bitmap, node_inx)))
@@ -8199,7 +9191,8 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 						  now, node_boot_time);
 		}
 	}
-	list_iterator_destroy(job_iterator);
+	if (job_iterator)
+		list_iterator_destroy(job_iterator);
 }
 
 static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
@@ -8425,6 +9418,9 @@ static void _validate_job_files(List batch_dirs)
 {
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
+	struct stat sbuf;
+	char *dir_name, job_dir[20];
+	uint32_t dir_id;
 	int del_cnt;
 
 	job_iterator = list_iterator_create(job_list);
@@ -8434,8 +9430,19 @@ static void _validate_job_files(List batch_dirs)
 		if (IS_JOB_FINISHED(job_ptr))
 			continue;
 		/* Want to keep this job's files */
+		dir_id = _job_dir_id(job_ptr);
 		del_cnt = list_delete_all(batch_dirs, _find_batch_dir,
-					  &(job_ptr->job_id));
+					  &dir_id);
+		if ((del_cnt == 0) && job_ptr->array_job_id) {
+			/* Directory may have been claimed by another
+			 * record of the same job array */
+			dir_name = slurm_get_state_save_location();
+			snprintf(job_dir, sizeof(job_dir), "/job.%u", dir_id);
+			xstrcat(dir_name, job_dir);
+			if (stat(dir_name, &sbuf) == 0)
+				del_cnt = 1;
+			xfree(dir_name);
+		}
 		if ((del_cnt == 0) && IS_JOB_PENDING(job_ptr)) {
 			error("Script for job %u lost, state set to FAILED",
 			      job_ptr->job_id);
@@ -8672,6 +9679,9 @@ void job_fini (void)
 		job_list = NULL;
 	}
 	xfree(job_hash);
+	xfree(job_array_hash);
+	xfree(job_name_hash);
+	xfree(job_name_singleton_cnt);
 }
 
 /* log the completion of the specified job */
@@ -8683,6 +9693,10 @@ extern void job_completion_logger(struct job_record  *job_ptr, bool requeue)
 	xassert(job_ptr);
 
 	acct_policy_remove_job_submit(job_ptr);
+	/* Jobs depending upon this one may now be able to run */
+	notify_job_dependency(job_ptr);
+	/* Test any triggers set on this job */
+	trigger_job_fini(job_ptr);
 
 	if (!IS_JOB_RESIZING(job_ptr)) {
 		/* Remove configuring state just to make sure it isn't there
@@ -8884,6 +9898,242 @@ static void _signal_job(struct job_record *job_ptr, int signal)
 	return;
 }
 
+/*
+ * job_suspend_batch_begin - gather the suspend and resume requests for the
+ *	nodes of the jobs acted upon by job_suspend() until
+ *	job_suspend_batch_end() is called, rather than queueing an agent
+ *	request for each job
+ */
+extern void job_suspend_batch_begin(void)
+{
+	if (sus_batch)
+		return;
+	sus_batch = xmalloc(sizeof(suspend_batch_msg_t));
+}
+
+/* Return the name of a node (front end node if HAVE_FRONT_END) */
+static char *_sus_tgt_name(int tgt_inx)
+{
+#ifdef HAVE_FRONT_END
+	return front_end_nodes[tgt_inx].name;
+#else
+	return node_record_table_ptr[tgt_inx].name;
+#endif
+}
+
+/* Add job sus_inx of sus_batch to the jobs of a node, or to old_hl if
+ * the node's slurmd predates REQUEST_SUSPEND_BATCH */
+static void _sus_tgt_add(int tgt_inx, uint16_t protocol_version,
+			 uint32_t sus_inx, hostlist_t *old_hl)
+{
+	uint32_t cnt = sus_tgt_job_cnt[tgt_inx];
+
+	if (protocol_version < SLURM_2_4_PROTOCOL_VERSION) {
+		if (*old_hl == NULL) {
+			*old_hl = hostlist_create("");
+			if (*old_hl == NULL)
+				fatal("hostlist_create: malloc failure");
+		}
+		hostlist_push(*old_hl, _sus_tgt_name(tgt_inx));
+		return;
+	}
+	if ((cnt % 16) == 0) {
+		xrealloc(sus_tgt_jobs[tgt_inx],
+			 sizeof(uint32_t) * (cnt + 16));
+	}
+	sus_tgt_jobs[tgt_inx][cnt] = sus_inx;
+	sus_tgt_job_cnt[tgt_inx]++;
+}
+
+/* qsort/compare function: order nodes by their list of batched jobs */
+static int _sus_tgt_cmp(const void *x, const void *y)
+{
+	uint32_t inx1 = *(uint32_t *) x, inx2 = *(uint32_t *) y;
+	uint32_t i;
+
+	if (sus_tgt_job_cnt[inx1] != sus_tgt_job_cnt[inx2])
+		return (sus_tgt_job_cnt[inx1] < sus_tgt_job_cnt[inx2]) ?
+		       -1 : 1;
+	for (i = 0; i < sus_tgt_job_cnt[inx1]; i++) {
+		if (sus_tgt_jobs[inx1][i] != sus_tgt_jobs[inx2][i])
+			return (sus_tgt_jobs[inx1][i] <
+				sus_tgt_jobs[inx2][i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* Queue a REQUEST_SUSPEND_BATCH holding the jobs shared by tgt_cnt nodes
+ * with identical job lists */
+static void _sus_tgt_send(uint32_t *tgt_inx, int tgt_cnt)
+{
+	agent_arg_t *agent_args;
+	suspend_batch_msg_t *sus_msg;
+	uint32_t *jobs = sus_tgt_jobs[tgt_inx[0]];
+	uint32_t i;
+
+	agent_args = xmalloc(sizeof(agent_arg_t));
+	agent_args->msg_type = REQUEST_SUSPEND_BATCH;
+	agent_args->retry = 0;	/* see _suspend_job() */
+	agent_args->hostlist = hostlist_create("");
+	if (agent_args->hostlist == NULL)
+		fatal("hostlist_create: malloc failure");
+	for (i = 0; i < tgt_cnt; i++) {
+		hostlist_push(agent_args->hostlist,
+			      _sus_tgt_name(tgt_inx[i]));
+	}
+	agent_args->node_count = tgt_cnt;
+
+	sus_msg = xmalloc(sizeof(suspend_batch_msg_t));
+	sus_msg->job_cnt = sus_tgt_job_cnt[tgt_inx[0]];
+	sus_msg->job_id = xmalloc(sizeof(uint32_t) * sus_msg->job_cnt);
+	sus_msg->op = xmalloc(sizeof(uint16_t) * sus_msg->job_cnt);
+	for (i = 0; i < sus_msg->job_cnt; i++) {
+		sus_msg->job_id[i] = sus_batch->job_id[jobs[i]];
+		sus_msg->op[i] = sus_batch->op[jobs[i]];
+	}
+	agent_args->msg_args = sus_msg;
+	agent_queue_request(agent_args);
+}
+
+/* Queue a REQUEST_SUSPEND for one job to the nodes in hl */
+static void _suspend_job_hosts(uint32_t job_id, uint16_t op, hostlist_t hl)
+{
+	agent_arg_t *agent_args;
+	suspend_msg_t *sus_ptr;
+
+	agent_args = xmalloc(sizeof(agent_arg_t));
+	agent_args->msg_type = REQUEST_SUSPEND;
+	agent_args->retry = 0;	/* see _suspend_job() */
+	agent_args->hostlist = hl;
+	agent_args->node_count = hostlist_count(hl);
+	sus_ptr = xmalloc(sizeof(suspend_msg_t));
+	sus_ptr->job_id = job_id;
+	sus_ptr->op = op;
+	agent_args->msg_args = sus_ptr;
+	agent_queue_request(agent_args);
+}
+
+/*
+ * job_suspend_batch_end - send the requests gathered since
+ *	job_suspend_batch_begin(). Each node gets a REQUEST_SUSPEND_BATCH
+ *	with only its own jobs, nodes with the same jobs share one agent
+ *	request. Nodes whose slurmd predates REQUEST_SUSPEND_BATCH get a
+ *	REQUEST_SUSPEND per job instead.
+ */
+extern void job_suspend_batch_end(void)
+{
+	struct job_record *job_ptr;
+#ifdef HAVE_FRONT_END
+	front_end_record_t *front_end_ptr;
+#else
+	struct node_record *node_ptr;
+	int first, last;
+#endif
+	hostlist_t old_hl;
+	uint32_t *tgt_inx, j;
+	int i, k, tgt_cnt = 0, tgt_max, send_cnt = 0;
+
+	if (sus_batch == NULL)
+		return;
+
+#ifdef HAVE_FRONT_END
+	tgt_max = front_end_node_cnt;
+#else
+	tgt_max = node_record_count;
+#endif
+	sus_tgt_jobs = xmalloc(sizeof(uint32_t *) * tgt_max);
+	sus_tgt_job_cnt = xmalloc(sizeof(uint32_t) * tgt_max);
+
+	for (j = 0; j < sus_batch->job_cnt; j++) {
+		job_ptr = find_job_record(sus_batch->job_id[j]);
+		if (job_ptr == NULL)
+			continue;
+		old_hl = NULL;
+#ifdef HAVE_FRONT_END
+		xassert(job_ptr->batch_host);
+		front_end_ptr = find_front_end_record(job_ptr->batch_host);
+		if (front_end_ptr == NULL)
+			continue;
+		_sus_tgt_add(front_end_ptr - front_end_nodes,
+			     front_end_ptr->protocol_version, j, &old_hl);
+#else
+		if ((job_ptr->node_bitmap == NULL) ||
+		    ((first = bit_ffs(job_ptr->node_bitmap)) == -1))
+			continue;
+		last = bit_fls(job_ptr->node_bitmap);
+		for (i = first; i <= last; i++) {
+			if (bit_test(job_ptr->node_bitmap, i) == 0)
+				continue;
+			node_ptr = node_record_table_ptr + i;
+			_sus_tgt_add(i, node_ptr->protocol_version, j,
+				     &old_hl);
+		}
+#endif
+		if (old_hl) {
+			_suspend_job_hosts(sus_batch->job_id[j],
+					   sus_batch->op[j], old_hl);
+			send_cnt++;
+		}
+	}
+
+	tgt_inx = xmalloc(sizeof(uint32_t) * tgt_max);
+	for (i = 0; i < tgt_max; i++) {
+		if (sus_tgt_job_cnt[i])
+			tgt_inx[tgt_cnt++] = i;
+	}
+	qsort(tgt_inx, tgt_cnt, sizeof(uint32_t), _sus_tgt_cmp);
+	for (i = 0; i < tgt_cnt; i = k) {
+		for (k = i + 1; k < tgt_cnt; k++) {
+			if (_sus_tgt_cmp(&tgt_inx[i], &tgt_inx[k]))
+				break;
+		}
+		_sus_tgt_send(tgt_inx + i, k - i);
+		send_cnt++;
+	}
+	if (send_cnt) {
+		debug2("sending suspend/resume for %u jobs in %d requests",
+		       sus_batch->job_cnt, send_cnt);
+	}
+
+	xfree(tgt_inx);
+	for (i = 0; i < tgt_max; i++)
+		xfree(sus_tgt_jobs[i]);
+	xfree(sus_tgt_jobs);
+	xfree(sus_tgt_job_cnt);
+	slurm_free_suspend_batch_msg(sus_batch);
+	sus_batch = NULL;
+}
+
+/* Add a job's suspend or resume request to the batch being gathered */
+static void _suspend_job_batch(struct job_record *job_ptr, uint16_t op)
+{
+	int i;
+
+	/* The slurmd performs all suspends before any resume, so a job
+	 * already in the batch with the other operation must not be sent
+	 * twice. Either order leaves the job's nodes as they are now. */
+	for (i = 0; i < sus_batch->job_cnt; i++) {
+		if (sus_batch->job_id[i] != job_ptr->job_id)
+			continue;
+		sus_batch->job_cnt--;
+		for ( ; i < sus_batch->job_cnt; i++) {
+			sus_batch->job_id[i] = sus_batch->job_id[i+1];
+			sus_batch->op[i] = sus_batch->op[i+1];
+		}
+		return;
+	}
+
+	if ((sus_batch->job_cnt % 64) == 0) {
+		xrealloc(sus_batch->job_id,
+			 sizeof(uint32_t) * (sus_batch->job_cnt + 64));
+		xrealloc(sus_batch->op,
+			 sizeof(uint16_t) * (sus_batch->job_cnt + 64));
+	}
+	sus_batch->job_id[sus_batch->job_cnt] = job_ptr->job_id;
+	sus_batch->op[sus_batch->job_cnt] = op;
+	sus_batch->job_cnt++;
+}
+
 /* Send suspend request to slumrd of all nodes associated with a job */
 static void _suspend_job(struct job_record *job_ptr, uint16_t op)
 {
@@ -8893,6 +10143,11 @@ static void _suspend_job(struct job_record *job_ptr, uint16_t op)
 	agent_arg_t *agent_args;
 	suspend_msg_t *sus_ptr;
 
+	if (sus_batch) {
+		_suspend_job_batch(job_ptr, op);
+		return;
+	}
+
 	agent_args = xmalloc(sizeof(agent_arg_t));
 	agent_args->msg_type = REQUEST_SUSPEND;
 	agent_args->retry = 0;	/* don't resend, gang scheduler
@@ -9888,6 +11143,8 @@ _copy_job_record_to_job_desc(struct job_record *job_ptr)
 	multi_core_data_t *mc_ptr = details->mc_ptr;
 	int i;
 
+	decode_job_launch_details(details);
+
 	/* construct a job_desc_msg_t from job */
 	job_desc = xmalloc(sizeof(job_desc_msg_t));
 
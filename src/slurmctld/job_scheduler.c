@@ -76,54 +76,28 @@
 #define _DEBUG 0
 #define MAX_RETRIES 10
 
+static bool	_add_depend_job(List depend_list, struct job_record *job_ptr,
+				uint16_t depend_type, uint32_t job_id);
+static void	_add_depend_spec(List depend_list, struct job_record *job_ptr,
+				 uint16_t depend_type, uint32_t job_id,
+				 struct job_record *dep_job_ptr);
 static char **	_build_env(struct job_record *job_ptr);
 static void	_depend_list_del(void *dep_ptr);
 static void	_feature_list_delete(void *x);
 static void	_job_queue_append(List job_queue, struct job_record *job_ptr,
 				  struct part_record *part_ptr);
+static bool	_job_queue_add_parts(List job_queue,
+				     struct job_record *job_ptr);
 static void	_job_queue_rec_del(void *x);
 static void *	_run_epilog(void *arg);
 static void *	_run_prolog(void *arg);
 static bool	_scan_depend(List dependency_list, uint32_t job_id);
+static void	_unlink_depend_spec(struct depend_spec *dep_ptr);
 static int	_valid_feature_list(uint32_t job_id, List feature_list);
 static int	_valid_node_feature(char *feature);
 
 static int	save_last_part_update = 0;
 
-/*
- * _build_user_job_list - build list of jobs for a given user
- *			  and an optional job name
- * IN  user_id - user id
- * IN  job_name - job name constraint
- * RET the job queue
- * NOTE: the caller must call list_destroy() on RET value to free memory
- */
-static List _build_user_job_list(uint32_t user_id, char* job_name)
-{
-	List job_queue;
-	ListIterator job_iterator;
-	struct job_record *job_ptr = NULL;
-
-	job_queue = list_create(NULL);
-	if (job_queue == NULL)
-		fatal("list_create memory allocation failure");
-	job_iterator = list_iterator_create(job_list);
-	if (job_iterator == NULL)
-		fatal("list_iterator_create malloc failure");
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		xassert (job_ptr->magic == JOB_MAGIC);
-		if (job_ptr->user_id != user_id)
-			continue;
-		if (job_name && job_ptr->name &&
-		    strcmp(job_name, job_ptr->name))
-			continue;
-		list_append(job_queue, job_ptr);
-	}
-	list_iterator_destroy(job_iterator);
-
-	return job_queue;
-}
-
 static void _job_queue_append(List job_queue, struct job_record *job_ptr,
 			      struct part_record *part_ptr)
 {
@@ -140,6 +114,40 @@ static void _job_queue_rec_del(void *x)
 	xfree(x);
 }
 
+/* Add a pending job to the job queue once for each partition it can use.
+ * RET false if the job's partition can not be found */
+static bool _job_queue_add_parts(List job_queue, struct job_record *job_ptr)
+{
+	ListIterator part_iterator;
+	struct part_record *part_ptr;
+
+	if (job_ptr->part_ptr_list) {
+		part_iterator = list_iterator_create(job_ptr->part_ptr_list);
+		if (part_iterator == NULL)
+			fatal("list_iterator_create malloc failure");
+		while ((part_ptr = (struct part_record *)
+				list_next(part_iterator))) {
+			_job_queue_append(job_queue, job_ptr, part_ptr);
+		}
+		list_iterator_destroy(part_iterator);
+		return true;
+	}
+
+	if (job_ptr->part_ptr == NULL) {
+		part_ptr = find_part_record(job_ptr->partition);
+		if (part_ptr == NULL) {
+			error("Could not find partition %s for job %u",
+			      job_ptr->partition, job_ptr->job_id);
+			return false;
+		}
+		job_ptr->part_ptr = part_ptr;
+		error("partition pointer reset for job %u, part %s",
+		      job_ptr->job_id, job_ptr->partition);
+	}
+	_job_queue_append(job_queue, job_ptr, job_ptr->part_ptr);
+	return true;
+}
+
 /*
  * build_job_queue - build (non-priority ordered) list of pending jobs
  * IN clear_start - if set then clear the start_time for pending jobs
@@ -149,9 +157,8 @@ static void _job_queue_rec_del(void *x)
 extern List build_job_queue(bool clear_start)
 {
 	List job_queue;
-	ListIterator job_iterator, part_iterator;
+	ListIterator job_iterator;
 	struct job_record *job_ptr = NULL;
-	struct part_record *part_ptr;
 	bool job_is_pending;
 	bool job_indepen = false;
 
@@ -193,39 +200,34 @@ extern List build_job_queue(bool clear_start)
 
 		if (!job_indepen)	/* can not run now */
 			continue;
-		if (job_ptr->part_ptr_list) {
-			part_iterator = list_iterator_create(job_ptr->
-							     part_ptr_list);
-			if (part_iterator == NULL)
-				fatal("list_iterator_create malloc failure");
-			while ((part_ptr = (struct part_record *)
-					list_next(part_iterator))) {
-				_job_queue_append(job_queue, job_ptr, part_ptr);
-			}
-			list_iterator_destroy(part_iterator);
-		} else {
-			if (job_ptr->part_ptr == NULL) {
-				part_ptr = find_part_record(job_ptr->partition);
-				if (part_ptr == NULL) {
-					error("Could not find partition %s "
-					      "for job %u", job_ptr->partition,
-					      job_ptr->job_id);
-					continue;
-				}
-				job_ptr->part_ptr = part_ptr;
-				error("partition pointer reset for job %u, "
-				      "part %s", job_ptr->job_id,
-				      job_ptr->partition);
-			}
-			_job_queue_append(job_queue, job_ptr,
-					  job_ptr->part_ptr);
-		}
+		(void) _job_queue_add_parts(job_queue, job_ptr);
 	}
 	list_iterator_destroy(job_iterator);
 
 	return job_queue;
 }
 
+/*
+ * job_queue_add_array - add the pending record of a job array to a job
+ *	queue after one of the array's tasks was started from that queue,
+ *	so the remaining tasks can also start in the same scheduling pass
+ * IN/OUT job_queue - job queue previously made by build_job_queue()
+ * IN job_ptr - job which was just started
+ */
+extern void job_queue_add_array(List job_queue, struct job_record *job_ptr)
+{
+	struct job_record *pend_ptr;
+
+	if (job_ptr->array_job_id == 0)
+		return;
+	pend_ptr = find_job_array_pending(job_ptr->array_job_id);
+	if ((pend_ptr == NULL) || (pend_ptr == job_ptr) ||
+	    !IS_JOB_PENDING(pend_ptr) || (pend_ptr->priority == 0) ||
+	    !job_independent(pend_ptr, 0))
+		return;
+	(void) _job_queue_add_parts(job_queue, pend_ptr);
+}
+
 /*
  * job_is_completing - Determine if jobs are in the process of completing.
  * RET - True of any job is in the process of completing AND
@@ -610,6 +612,7 @@ extern int schedule(uint32_t job_limit)
 			else if (job_ptr->details->prolog_running == 0)
 				launch_job(job_ptr);
 			rebuild_job_part_list(job_ptr);
+			job_queue_add_array(job_queue, job_ptr);
 			job_cnt++;
 		} else if ((error_code !=
 			    ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE) &&
@@ -713,6 +716,7 @@ extern void launch_job(struct job_record *job_ptr)
 		return;
 	}
 
+	decode_job_launch_details(job_ptr->details);
 	launch_msg_ptr->std_err = xstrdup(job_ptr->details->std_err);
 	launch_msg_ptr->std_in = xstrdup(job_ptr->details->std_in);
 	launch_msg_ptr->std_out = xstrdup(job_ptr->details->std_out);
@@ -809,9 +813,169 @@ extern int make_batch_job_cred(batch_job_launch_msg_t *launch_msg_ptr,
 
 static void _depend_list_del(void *dep_ptr)
 {
+	struct depend_spec *dep_spec = (struct depend_spec *) dep_ptr;
+
+	if (dep_spec->depend_type == SLURM_DEPEND_SINGLETON)
+		add_job_singleton_depend(dep_spec->depend_job_ptr, -1);
+	_unlink_depend_spec(dep_spec);
 	xfree(dep_ptr);
 }
 
+/* Add a dependency of job_ptr upon job_id to depend_list. If job_id is a job
+ * array, the dependency is upon every record of the array.
+ * RET false if the job no longer exists (assumed done) */
+static bool _add_depend_job(List depend_list, struct job_record *job_ptr,
+			    uint16_t depend_type, uint32_t job_id)
+{
+	struct job_record *dep_job_ptr = NULL;
+	bool found = false;
+
+	while ((dep_job_ptr = find_next_job_array(job_id, dep_job_ptr))) {
+		_add_depend_spec(depend_list, job_ptr, depend_type,
+				 dep_job_ptr->job_id, dep_job_ptr);
+		found = true;
+	}
+	if (found)
+		return true;
+
+	dep_job_ptr = find_job_record(job_id);
+	if (!dep_job_ptr)
+		return false;
+	_add_depend_spec(depend_list, job_ptr, depend_type, job_id,
+			 dep_job_ptr);
+	return true;
+}
+
+/* Add a dependency of job_ptr upon dep_job_ptr (NULL for a singleton) to
+ * depend_list and to dep_job_ptr's list of dependent jobs */
+static void _add_depend_spec(List depend_list, struct job_record *job_ptr,
+			     uint16_t depend_type, uint32_t job_id,
+			     struct job_record *dep_job_ptr)
+{
+	struct depend_spec *dep_ptr;
+
+	dep_ptr = xmalloc(sizeof(struct depend_spec));
+	dep_ptr->depend_type = depend_type;
+	dep_ptr->job_id = job_id;
+	dep_ptr->job_ptr = dep_job_ptr;
+	dep_ptr->depend_job_ptr = job_ptr;
+	if (depend_type == SLURM_DEPEND_SINGLETON)
+		add_job_singleton_depend(job_ptr, 1);
+	if (dep_job_ptr) {
+		dep_ptr->rev_next = dep_job_ptr->depend_rev;
+		if (dep_ptr->rev_next)
+			dep_ptr->rev_next->rev_prev = dep_ptr;
+		dep_job_ptr->depend_rev = dep_ptr;
+	}
+	if (!list_append(depend_list, dep_ptr))
+		fatal("list_append memory allocation failure");
+}
+
+/* Remove a dependency from its job's list of dependent jobs */
+static void _unlink_depend_spec(struct depend_spec *dep_ptr)
+{
+	if (dep_ptr->job_ptr == NULL)
+		return;
+
+	if (dep_ptr->rev_prev)
+		dep_ptr->rev_prev->rev_next = dep_ptr->rev_next;
+	else
+		dep_ptr->job_ptr->depend_rev = dep_ptr->rev_next;
+	if (dep_ptr->rev_next)
+		dep_ptr->rev_next->rev_prev = dep_ptr->rev_prev;
+	dep_ptr->rev_next = NULL;
+	dep_ptr->rev_prev = NULL;
+}
+
+/*
+ * copy_job_dependents - make every job depending upon a job array's pending
+ *	record also depend upon a new pending record split from it
+ * IN job_ptr - the job array's pending record
+ * IN new_job_ptr - the job array's new pending record
+ */
+extern void copy_job_dependents(struct job_record *job_ptr,
+				struct job_record *new_job_ptr)
+{
+	struct depend_spec *dep_ptr;
+	struct job_record *depend_job_ptr;
+
+	for (dep_ptr = job_ptr->depend_rev; dep_ptr;
+	     dep_ptr = dep_ptr->rev_next) {
+		depend_job_ptr = dep_ptr->depend_job_ptr;
+		if (!depend_job_ptr->details ||
+		    !depend_job_ptr->details->depend_list)
+			continue;
+		_add_depend_spec(depend_job_ptr->details->depend_list,
+				 depend_job_ptr, dep_ptr->depend_type,
+				 new_job_ptr->job_id, new_job_ptr);
+	}
+}
+
+/*
+ * notify_job_dependency - note that a job changed state (started, ended or
+ *	changed name) so jobs depending upon it get their dependencies tested
+ *	again rather than using the result of their last test
+ * IN job_ptr - job which changed state
+ */
+extern void notify_job_dependency(struct job_record *job_ptr)
+{
+	struct depend_spec *dep_ptr;
+	struct job_record *name_ptr = NULL, *oldest_ptr = NULL;
+
+	for (dep_ptr = job_ptr->depend_rev; dep_ptr;
+	     dep_ptr = dep_ptr->rev_next) {
+		if (dep_ptr->depend_job_ptr->details)
+			dep_ptr->depend_job_ptr->details->depend_blocked =false;
+	}
+
+	/* Every pending job of this user and name other than the oldest one
+	 * is held by the oldest one, so only its singleton dependency can
+	 * have been satisfied */
+	if (!test_job_singleton_depend(job_ptr->user_id, job_ptr->name))
+		return;
+	while ((name_ptr = find_next_job_user_name(job_ptr->user_id,
+						   job_ptr->name, name_ptr))) {
+		if ((name_ptr != job_ptr) && IS_JOB_PENDING(name_ptr) &&
+		    ((oldest_ptr == NULL) ||
+		     (name_ptr->job_id < oldest_ptr->job_id)))
+			oldest_ptr = name_ptr;
+	}
+	if (oldest_ptr && oldest_ptr->details)
+		oldest_ptr->details->depend_blocked = false;
+}
+
+/*
+ * purge_job_dependency - lift every dependency upon a job which is about to
+ *	be purged
+ * IN job_ptr - job being purged
+ */
+extern void purge_job_dependency(struct job_record *job_ptr)
+{
+	struct depend_spec *dep_ptr;
+
+	notify_job_dependency(job_ptr);
+	while ((dep_ptr = job_ptr->depend_rev)) {
+		job_ptr->depend_rev = dep_ptr->rev_next;
+		dep_ptr->job_ptr = NULL;
+		dep_ptr->rev_next = NULL;
+		dep_ptr->rev_prev = NULL;
+	}
+}
+
+/*
+ * update_job_dependents_id - note a change of job_ptr's job ID in the
+ *	dependencies of other jobs upon it
+ * IN job_ptr - job whose job ID changed
+ */
+extern void update_job_dependents_id(struct job_record *job_ptr)
+{
+	struct depend_spec *dep_ptr;
+
+	for (dep_ptr = job_ptr->depend_rev; dep_ptr;
+	     dep_ptr = dep_ptr->rev_next)
+		dep_ptr->job_id = job_ptr->job_id;
+}
+
 /* Print a job's dependency information based upon job_ptr->depend_list */
 extern void print_job_dependency(struct job_record *job_ptr)
 {
@@ -857,10 +1021,9 @@ extern void print_job_dependency(struct job_record *job_ptr)
  */
 extern int test_job_dependency(struct job_record *job_ptr)
 {
-	ListIterator depend_iter, job_iterator;
+	ListIterator depend_iter;
 	struct depend_spec *dep_ptr;
 	bool failure = false, depends = false, expands = false;
- 	List job_queue = NULL;
  	bool run_now;
 	int count = 0;
  	struct job_record *qjob_ptr;
@@ -869,24 +1032,26 @@ extern int test_job_dependency(struct job_record *job_ptr)
 	    (job_ptr->details->depend_list == NULL))
 		return 0;
 
+	/* No job depended upon changed state since the last test */
+	if (job_ptr->details->depend_blocked)
+		return 1;
+
 	count = list_count(job_ptr->details->depend_list);
 	depend_iter = list_iterator_create(job_ptr->details->depend_list);
 	if (!depend_iter)
 		fatal("list_iterator_create memory allocation failure");
 	while ((dep_ptr = list_next(depend_iter))) {
 		bool clear_dep = false;
+		uint32_t dep_job_id = dep_ptr->job_id;
 		count--;
  		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
  		    job_ptr->name) {
- 			/* get user jobs with the same user and name */
- 			job_queue = _build_user_job_list(job_ptr->user_id,
-							 job_ptr->name);
+ 			/* test user jobs with the same user and name */
  			run_now = true;
-			job_iterator = list_iterator_create(job_queue);
-			if (job_iterator == NULL)
-				fatal("list_iterator_create malloc failure");
-			while ((qjob_ptr = (struct job_record *)
-					   list_next(job_iterator))) {
+			qjob_ptr = NULL;
+			while ((qjob_ptr = find_next_job_user_name(
+						job_ptr->user_id,
+						job_ptr->name, qjob_ptr))) {
 				/* already running/suspended job or previously
 				 * submitted pending job */
 				if (IS_JOB_RUNNING(qjob_ptr) ||
@@ -897,15 +1062,12 @@ extern int test_job_dependency(struct job_record *job_ptr)
 					break;
  				}
  			}
-			list_iterator_destroy(job_iterator);
-			list_destroy(job_queue);
 			/* job can run now, delete dependency */
  			if (run_now)
  				list_delete_item(depend_iter);
  			else
 				depends = true;
- 		} else if ((dep_ptr->job_ptr->magic != JOB_MAGIC) ||
-			   (dep_ptr->job_ptr->job_id != dep_ptr->job_id)) {
+ 		} else if (dep_ptr->job_ptr == NULL) {
 			/* job is gone, dependency lifted */
 			list_delete_item(depend_iter);
 			clear_dep = true;
@@ -963,8 +1125,7 @@ extern int test_job_dependency(struct job_record *job_ptr)
 			failure = true;
 		if (clear_dep) {
  			char *rmv_dep;
- 			rmv_dep = xstrdup_printf(":%u",
-						 dep_ptr->job_ptr->job_id);
+ 			rmv_dep = xstrdup_printf(":%u", dep_job_id);
 			xstrsubstitute(job_ptr->details->dependency,
 				       rmv_dep, "");
 			xfree(rmv_dep);
@@ -976,8 +1137,12 @@ extern int test_job_dependency(struct job_record *job_ptr)
 
 	if (failure)
 		return 2;
-	if (depends)
+	if (depends) {
+		/* Expanding jobs get their time limit reset on every test */
+		if (!expands)
+			job_ptr->details->depend_blocked = true;
 		return 1;
+	}
 	return 0;
 }
 
@@ -996,7 +1161,6 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
 	uint32_t job_id = 0;
 	char *tok = new_depend, *sep_ptr, *sep_ptr2;
 	List new_depend_list = NULL;
-	struct depend_spec *dep_ptr;
 	struct job_record *dep_job_ptr;
 	char dep_buf[32];
 	bool expand_cnt = 0;
@@ -1005,6 +1169,7 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
 		return EINVAL;
 
 	/* Clear dependencies on NULL, "0", or empty dependency input */
+	job_ptr->details->depend_blocked = false;
 	job_ptr->details->expanding_jobid = 0;
 	if ((new_depend == NULL) || (new_depend[0] == '\0') ||
 	    ((new_depend[0] == '0') && (new_depend[1] == '\0'))) {
@@ -1027,14 +1192,8 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
  		/* test singleton dependency flag */
  		if ( strncasecmp(tok, "singleton", 9) == 0 ) {
 			depend_type = SLURM_DEPEND_SINGLETON;
-			dep_ptr = xmalloc(sizeof(struct depend_spec));
-			dep_ptr->depend_type = depend_type;
-			/* dep_ptr->job_id = 0;		set by xmalloc */
-			/* dep_ptr->job_ptr = NULL;	set by xmalloc */
-			if (!list_append(new_depend_list, dep_ptr)) {
-				fatal("list_append memory allocation "
-				      "failure for singleton");
-			}
+			_add_depend_spec(new_depend_list, job_ptr,
+					 depend_type, 0, NULL);
 			if ( *(tok + 9 ) == ',' ) {
 				tok += 10;
 				continue;
@@ -1052,18 +1211,12 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
 				break;
 			}
 			/* old format, just a single job_id */
-			dep_job_ptr = find_job_record(job_id);
-			if (!dep_job_ptr)	/* assume already done */
-				break;
+			if (!_add_depend_job(new_depend_list, job_ptr,
+					     SLURM_DEPEND_AFTER_ANY, job_id))
+				break;	/* assume already done */
 			snprintf(dep_buf, sizeof(dep_buf),
 				 "afterany:%u", job_id);
 			new_depend = dep_buf;
-			dep_ptr = xmalloc(sizeof(struct depend_spec));
-			dep_ptr->depend_type = SLURM_DEPEND_AFTER_ANY;
-			dep_ptr->job_id = job_id;
-			dep_ptr->job_ptr = dep_job_ptr;
-			if (!list_append(new_depend_list, dep_ptr))
-				fatal("list_append memory allocation failure");
 			break;
 		} else if (sep_ptr == NULL) {
 			rc = ESLURM_DEPENDENCY;
@@ -1122,15 +1275,15 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
 				gres_plugin_job_state_validate(job_ptr->gres,
 						&job_ptr->gres_list);
 			}
-			if (dep_job_ptr) {	/* job still active */
-				dep_ptr = xmalloc(sizeof(struct depend_spec));
-				dep_ptr->depend_type = depend_type;
-				dep_ptr->job_id = job_id;
-				dep_ptr->job_ptr = dep_job_ptr;
-				if (!list_append(new_depend_list, dep_ptr)) {
-					fatal("list_append memory allocation "
-						"failure");
-				}
+			if (depend_type == SLURM_DEPEND_EXPAND) {
+				_add_depend_spec(new_depend_list, job_ptr,
+						 depend_type, job_id,
+						 dep_job_ptr);
+			} else {
+				/* ignored if no longer active */
+				(void) _add_depend_job(new_depend_list,
+						       job_ptr, depend_type,
+						       job_id);
 			}
 			if (sep_ptr2[0] != ':')
 				break;
@@ -1178,7 +1331,7 @@ static bool _scan_depend(List dependency_list, uint32_t job_id)
 	if (iter == NULL)
 		fatal("list_iterator_create malloc failure");
 	while (!rc && (dep_ptr = (struct depend_spec *) list_next(iter))) {
-		if (dep_ptr->job_id == 0)	/* Singleton */
+		if (dep_ptr->job_ptr == NULL)	/* Singleton or purged job */
 			continue;
 		if (dep_ptr->job_id == job_id)
 			rc = true;
@@ -65,6 +65,15 @@ extern int build_feature_list(struct job_record *job_ptr);
  */
 extern List build_job_queue(bool clear_start);
 
+/*
+ * copy_job_dependents - make every job depending upon a job array's pending
+ *	record also depend upon a new pending record split from it
+ * IN job_ptr - the job array's pending record
+ * IN new_job_ptr - the job array's new pending record
+ */
+extern void copy_job_dependents(struct job_record *job_ptr,
+				struct job_record *new_job_ptr);
+
 /*
  * epilog_slurmctld - execute the prolog_slurmctld for a job that has just
  *	terminated.
@@ -82,6 +91,15 @@ extern int epilog_slurmctld(struct job_record *job_ptr);
  */
 extern bool job_is_completing(void);
 
+/*
+ * job_queue_add_array - add the pending record of a job array to a job
+ *	queue after one of the array's tasks was started from that queue,
+ *	so the remaining tasks can also start in the same scheduling pass
+ * IN/OUT job_queue - job queue previously made by build_job_queue()
+ * IN job_ptr - job which was just started
+ */
+extern void job_queue_add_array(List job_queue, struct job_record *job_ptr);
+
 /* Determine if a pending job will run using only the specified nodes
  * (in job_desc_msg->req_nodes), build response message and return
  * SLURM_SUCCESS on success. Otherwise return an error code. Caller
@@ -105,6 +123,14 @@ extern void launch_job(struct job_record *job_ptr);
 extern int make_batch_job_cred(batch_job_launch_msg_t *launch_msg_ptr,
 			       struct job_record *job_ptr);
 
+/*
+ * notify_job_dependency - note that a job changed state (started, ended or
+ *	changed name) so jobs depending upon it get their dependencies tested
+ *	again rather than using the result of their last test
+ * IN job_ptr - job which changed state
+ */
+extern void notify_job_dependency(struct job_record *job_ptr);
+
 /* Print a job's dependency information based upon job_ptr->depend_list */
 extern void print_job_dependency(struct job_record *job_ptr);
 
@@ -116,6 +142,13 @@ extern void print_job_dependency(struct job_record *job_ptr);
  */
 extern int prolog_slurmctld(struct job_record *job_ptr);
 
+/*
+ * purge_job_dependency - lift every dependency upon a job which is about to
+ *	be purged
+ * IN job_ptr - job being purged
+ */
+extern void purge_job_dependency(struct job_record *job_ptr);
+
 /* If a job can run in multiple partitions, make sure that the one 
  * actually used is first in the string. Needed for job state save/restore */
 extern void rebuild_job_part_list(struct job_record *job_ptr);
@@ -169,4 +202,11 @@ extern int test_job_dependency(struct job_record *job_ptr);
  */
 extern int update_job_dependency(struct job_record *job_ptr, char *new_depend);
 
+/*
+ * update_job_dependents_id - note a change of job_ptr's job ID in the
+ *	dependencies of other jobs upon it
+ * IN job_ptr - job whose job ID changed
+ */
+extern void update_job_dependents_id(struct job_record *job_ptr);
+
 #endif /* !_JOB_SCHEDULER_H */
@@ -56,6 +56,15 @@
 List license_list = (List) NULL;
 static pthread_mutex_t license_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* License names interned to small integer IDs. IDs are never reused, so the
+ * IDs recorded in job and reservation license lists remain valid across
+ * reconfiguration. lic_index maps an ID to its configured license record,
+ * NULL if the license is not currently configured. */
+static char **lic_names = NULL;
+static uint32_t lic_name_cnt = 0;
+static licenses_t **lic_index = NULL;
+static uint32_t lic_index_cnt = 0;
+
 /* Print all licenses on a list */
 static inline void _licenses_print(char *header, List licenses, int job_id)
 {
@@ -106,6 +115,94 @@ static int _license_find_rec(void *x, void *key)
 	return 1;
 }
 
+/* Find a license_t record matching another one, by ID when both are known
+ * (for use by list_find_first) */
+static int _license_find_match(void *x, void *key)
+{
+	licenses_t *license_entry = (licenses_t *) x;
+	licenses_t *match = (licenses_t *) key;
+
+	if ((license_entry->id != NO_VAL) && (match->id != NO_VAL))
+		return (license_entry->id == match->id);
+	return _license_find_rec(x, match->name);
+}
+
+/* Return the ID of a license name, NO_VAL if it was never configured */
+static uint32_t _license_id_find(char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < lic_name_cnt; i++) {
+		if (strcmp(lic_names[i], name) == 0)
+			return i;
+	}
+	return NO_VAL;
+}
+
+/* Return the ID of a configured license name, assigning one if new */
+static uint32_t _license_id_intern(char *name)
+{
+	uint32_t id = _license_id_find(name);
+
+	if (id != NO_VAL)
+		return id;
+	xrealloc(lic_names, sizeof(char *) * (lic_name_cnt + 1));
+	lic_names[lic_name_cnt] = xstrdup(name);
+	return lic_name_cnt++;
+}
+
+/* Assign IDs to the records of a job or reservation license list */
+static void _license_list_set_ids(List lic_list)
+{
+	ListIterator iter;
+	licenses_t *license_entry;
+
+	if (lic_list == NULL)
+		return;
+
+	iter = list_iterator_create(lic_list);
+	if (iter == NULL)
+		fatal("malloc failure from list_iterator_create");
+	while ((license_entry = (licenses_t *) list_next(iter)))
+		license_entry->id = _license_id_find(license_entry->name);
+	list_iterator_destroy(iter);
+}
+
+/* Intern the names of all configured licenses and rebuild the ID index.
+ * Call with license_mutex locked. */
+static void _license_index_build(void)
+{
+	ListIterator iter;
+	licenses_t *license_entry;
+
+	xfree(lic_index);
+	lic_index_cnt = 0;
+	if (license_list == NULL)
+		return;
+
+	iter = list_iterator_create(license_list);
+	if (iter == NULL)
+		fatal("malloc failure from list_iterator_create");
+	while ((license_entry = (licenses_t *) list_next(iter))) {
+		license_entry->id = _license_id_intern(license_entry->name);
+	}
+	lic_index_cnt = lic_name_cnt;
+	lic_index = xmalloc(sizeof(licenses_t *) * lic_index_cnt);
+	list_iterator_reset(iter);
+	while ((license_entry = (licenses_t *) list_next(iter)))
+		lic_index[license_entry->id] = license_entry;
+	list_iterator_destroy(iter);
+}
+
+/* Return the configured license record for a job's license record,
+ * NULL if not configured. Call with license_mutex locked. */
+static inline licenses_t *_license_lookup(licenses_t *license_entry)
+{
+	if (license_entry->id >= lic_index_cnt)	/* includes NO_VAL */
+		return NULL;
+	return lic_index[license_entry->id];
+}
+
 /* Given a license string, return a list of license_t records */
 static List _build_license_list(char *licenses, bool *valid)
 {
@@ -146,6 +243,7 @@ static List _build_license_list(char *licenses, bool *valid)
 			license_entry = xmalloc(sizeof(licenses_t));
 			license_entry->name = xstrdup(token);
 			license_entry->total = num;
+			license_entry->id = NO_VAL;
 			list_push(lic_list, license_entry);
 		}
 		token = strtok_r(NULL, ",;", &last);
@@ -202,6 +300,7 @@ extern int license_init(char *licenses)
 	if (!valid)
 		fatal("Invalid configured licenses: %s", licenses);
 
+	_license_index_build();
 	_licenses_print("init_license", license_list, 0);
 	slurm_mutex_unlock(&license_mutex);
 	return SLURM_SUCCESS;
@@ -224,6 +323,7 @@ extern int license_update(char *licenses)
 	slurm_mutex_lock(&license_mutex);
 	if (!license_list) {	/* no licenses before now */
 		license_list = new_list;
+		_license_index_build();
 		slurm_mutex_unlock(&license_mutex);
 		return SLURM_SUCCESS;
 	}
@@ -249,6 +349,7 @@ extern int license_update(char *licenses)
 
 	list_destroy(license_list);
 	license_list = new_list;
+	_license_index_build();
 	_licenses_print("update_license", license_list, 0);
 	slurm_mutex_unlock(&license_mutex);
 	return SLURM_SUCCESS;
@@ -262,6 +363,23 @@ extern void license_free(void)
 		list_destroy(license_list);
 		license_list = (List) NULL;
 	}
+	xfree(lic_index);
+	lic_index_cnt = 0;
+	slurm_mutex_unlock(&license_mutex);
+}
+
+/* Free all license memory, including the license names kept across
+ * reconfiguration. Call only at slurmctld shutdown. */
+extern void license_fini(void)
+{
+	uint32_t i;
+
+	license_free();
+	slurm_mutex_lock(&license_mutex);
+	for (i = 0; i < lic_name_cnt; i++)
+		xfree(lic_names[i]);
+	xfree(lic_names);
+	lic_name_cnt = 0;
 	slurm_mutex_unlock(&license_mutex);
 }
 
@@ -288,11 +406,8 @@ extern List license_validate(char *licenses, bool *valid)
 	if (iter == NULL)
 		fatal("malloc failure from list_iterator_create");
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		if (license_list) {
-			match = list_find_first(license_list,
-				_license_find_rec, license_entry->name);
-		} else
-			match = NULL;
+		license_entry->id = _license_id_find(license_entry->name);
+		match = _license_lookup(license_entry);
 		if (!match) {
 			debug("could not find license %s for job",
 			      license_entry->name);
@@ -327,6 +442,9 @@ extern void license_job_merge(struct job_record *job_ptr)
 
 	FREE_NULL_LIST(job_ptr->license_list);
 	job_ptr->license_list = _build_license_list(job_ptr->licenses, &valid);
+	slurm_mutex_lock(&license_mutex);
+	_license_list_set_ids(job_ptr->license_list);
+	slurm_mutex_unlock(&license_mutex);
 	xfree(job_ptr->licenses);
 	job_ptr->licenses = _build_license_string(job_ptr->license_list);
 }
@@ -351,8 +469,7 @@ extern int license_job_test(struct job_record *job_ptr, time_t when)
 	if (iter == NULL)
 		fatal("malloc failure from list_iterator_create");
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (!match) {
 			error("could not find license %s for job %u",
 			      license_entry->name, job_ptr->job_id);
@@ -369,7 +486,7 @@ extern int license_job_test(struct job_record *job_ptr, time_t when)
 			break;
 		} else {
 			resv_licenses = job_test_lic_resv(job_ptr,
-							  license_entry->name,
+							  license_entry->id,
 							  when);
 			if ((license_entry->total + match->used +
 			     resv_licenses) > match->total) {
@@ -402,8 +519,7 @@ extern int license_job_get(struct job_record *job_ptr)
 	if (iter == NULL)
 		fatal("malloc failure from list_iterator_create");
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (match) {
 			match->used += license_entry->total;
 			license_entry->used += license_entry->total;
@@ -438,8 +554,7 @@ extern int license_job_return(struct job_record *job_ptr)
 	if (iter == NULL)
 		fatal("malloc failure from list_iterator_create");
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = _license_lookup(license_entry);
 		if (match) {
 			if (match->used >= license_entry->total)
 				match->used -= license_entry->total;
@@ -462,6 +577,98 @@ extern int license_job_return(struct job_record *job_ptr)
 	return rc;
 }
 
+/*
+ * license_id_cnt - Return the size of the license ID space. License IDs are
+ *	assigned from slurm.conf and never reused, so arrays indexed by ID
+ *	and sized with this value stay valid for configured licenses.
+ */
+extern uint32_t license_id_cnt(void)
+{
+	uint32_t cnt;
+
+	slurm_mutex_lock(&license_mutex);
+	cnt = lic_index_cnt;
+	slurm_mutex_unlock(&license_mutex);
+	return cnt;
+}
+
+/*
+ * license_avail_get - Load the count of licenses now available by ID
+ * OUT avail     - array of avail_cnt entries indexed by license ID
+ * IN  avail_cnt - size of avail, normally from license_id_cnt()
+ */
+extern void license_avail_get(uint32_t *avail, uint32_t avail_cnt)
+{
+	licenses_t *match;
+	uint32_t i;
+
+	slurm_mutex_lock(&license_mutex);
+	for (i = 0; i < avail_cnt; i++) {
+		if ((i < lic_index_cnt) && (match = lic_index[i]) &&
+		    (match->total > match->used))
+			avail[i] = match->total - match->used;
+		else
+			avail[i] = 0;
+	}
+	slurm_mutex_unlock(&license_mutex);
+}
+
+/*
+ * license_job_avail_test - Test if the licenses required for a job fit in a
+ *	license availability array built by license_avail_get()
+ * RET true if the job's licenses fit
+ */
+extern bool license_job_avail_test(struct job_record *job_ptr,
+				   uint32_t *avail, uint32_t avail_cnt)
+{
+	ListIterator iter;
+	licenses_t *license_entry;
+	bool fit = true;
+
+	if (!job_ptr->license_list || !avail)
+		return fit;
+
+	iter = list_iterator_create(job_ptr->license_list);
+	if (iter == NULL)
+		fatal("malloc failure from list_iterator_create");
+	while ((license_entry = (licenses_t *) list_next(iter))) {
+		if ((license_entry->id >= avail_cnt) ||
+		    (license_entry->total > avail[license_entry->id])) {
+			fit = false;
+			break;
+		}
+	}
+	list_iterator_destroy(iter);
+	return fit;
+}
+
+/*
+ * license_job_avail_deduct - Remove the licenses required for a job from a
+ *	license availability array built by license_avail_get()
+ */
+extern void license_job_avail_deduct(struct job_record *job_ptr,
+				     uint32_t *avail, uint32_t avail_cnt)
+{
+	ListIterator iter;
+	licenses_t *license_entry;
+
+	if (!job_ptr->license_list || !avail)
+		return;
+
+	iter = list_iterator_create(job_ptr->license_list);
+	if (iter == NULL)
+		fatal("malloc failure from list_iterator_create");
+	while ((license_entry = (licenses_t *) list_next(iter))) {
+		if (license_entry->id >= avail_cnt)
+			continue;
+		if (license_entry->total >= avail[license_entry->id])
+			avail[license_entry->id] = 0;
+		else
+			avail[license_entry->id] -= license_entry->total;
+	}
+	list_iterator_destroy(iter);
+}
+
 /*
  * license_list_overlap - test if there is any overlap in licenses
  *	names found in the two lists
@@ -479,8 +686,8 @@ extern bool license_list_overlap(List list_1, List list_2)
 	if (iter == NULL)
 		fatal("malloc failure from list_iterator_create");
 	while ((license_entry = (licenses_t *) list_next(iter))) {
-		if (list_find_first(list_2, _license_find_rec,
-				    license_entry->name)) {
+		if (list_find_first(list_2, _license_find_match,
+				    license_entry)) {
 			match = true;
 			break;
 		}
@@ -46,6 +46,8 @@ typedef struct licenses {
 	char *		name;		/* name associated with a license */
 	uint32_t	total;		/* total license configued */
 	uint32_t	used;		/* used licenses */
+	uint32_t	id;		/* interned license ID, NO_VAL if the
+					 * name is not configured */
 } licenses_t;
 
 extern List license_list;
@@ -61,6 +63,10 @@ extern int license_update(char *licenses);
 /* Free memory associated with licenses on this system */
 extern void license_free(void);
 
+/* Free all license memory, including the license names kept across
+ * reconfiguration. Call only at slurmctld shutdown. */
+extern void license_fini(void);
+
 /* Free a license_t record (for use by list_destroy) */
 extern void license_free_rec(void *x);
 
@@ -103,6 +109,35 @@ extern int license_job_test(struct job_record *job_ptr, time_t when);
  */
 extern List license_validate(char *licenses, bool *valid);
 
+/*
+ * license_id_cnt - Return the size of the license ID space. License IDs are
+ *	assigned from slurm.conf and never reused, so arrays indexed by ID
+ *	and sized with this value stay valid for configured licenses.
+ */
+extern uint32_t license_id_cnt(void);
+
+/*
+ * license_avail_get - Load the count of licenses now available by ID
+ * OUT avail     - array of avail_cnt entries indexed by license ID
+ * IN  avail_cnt - size of avail, normally from license_id_cnt()
+ */
+extern void license_avail_get(uint32_t *avail, uint32_t avail_cnt);
+
+/*
+ * license_job_avail_test - Test if the licenses required for a job fit in a
+ *	license availability array built by license_avail_get()
+ * RET true if the job's licenses fit
+ */
+extern bool license_job_avail_test(struct job_record *job_ptr,
+				   uint32_t *avail, uint32_t avail_cnt);
+
+/*
+ * license_job_avail_deduct - Remove the licenses required for a job from a
+ *	license availability array built by license_avail_get()
+ */
+extern void license_job_avail_deduct(struct job_record *job_ptr,
+				     uint32_t *avail, uint32_t avail_cnt);
+
 /*
  * license_list_overlap - test if there is any overlap in licenses
  *	names found in the two lists
@@ -262,19 +262,19 @@ static int _open_node_state_file(char **state_file)
  */
 extern int load_all_node_state ( bool state_only )
 {
-	char *node_name = NULL, *reason = NULL, *data = NULL, *state_file;
+	char *node_name = NULL, *reason = NULL, *state_file;
 	char *features = NULL, *gres = NULL;
-	int data_allocated, data_read = 0, error_code = 0, node_cnt = 0;
+	int error_code = 0, node_cnt = 0;
 	uint16_t node_state;
 	uint16_t cpus = 1, sockets = 1, cores = 1, threads = 1;
-	uint32_t real_memory, tmp_disk, data_size = 0, name_len;
+	uint32_t real_memory, tmp_disk, name_len;
 	uint32_t reason_uid = NO_VAL;
 	time_t reason_time = 0;
 	List gres_list = NULL;
 	struct node_record *node_ptr;
 	int state_fd;
 	time_t time_stamp, now = time(NULL);
-	Buf buffer;
+	Buf buffer = NULL;
 	char *ver_str = NULL;
 	hostset_t hs = NULL;
 	bool power_save_mode = false;
@@ -291,30 +291,15 @@ extern int load_all_node_state ( bool state_only )
 		error_code = ENOENT;
 	}
 	else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size], BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error ("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		if (!(buffer = create_mmap_buf(state_fd)))
+			error("Read error on %s: %m", state_file);
 		close (state_fd);
 	}
 	xfree (state_file);
 	unlock_state_files ();
 
-	buffer = create_buf (data, data_size);
+	if (!buffer)
+		buffer = create_buf(NULL, 0);
 
 	safe_unpackstr_xmalloc( &ver_str, &name_len, buffer);
 	debug3("Version string in node_state header is %s", ver_str);
@@ -1205,6 +1190,7 @@ static int _update_node_weight(char *node_names, uint32_t weight)
 	list_iterator_destroy(config_iterator);
 	FREE_NULL_BITMAP(node_bitmap);
 
+	node_config_gen++;
 	info("_update_node_weight: nodes %s weight set to: %u",
 		node_names, weight);
 	return SLURM_SUCCESS;
@@ -1280,6 +1266,7 @@ static int _update_node_features(char *node_names, char *features)
 	list_iterator_destroy(config_iterator);
 	FREE_NULL_BITMAP(node_bitmap);
 
+	node_config_gen++;
 	info("_update_node_features: nodes %s features set to: %s",
 		node_names, features);
 	return SLURM_SUCCESS;
@@ -1499,6 +1486,83 @@ static bool _valid_node_state_change(uint16_t old, uint16_t new)
 	return false;
 }
 
+/*
+ * validate_node_registration - process a node registration message, either
+ *	sent by the slurmd as an RPC or returned as its reply to a
+ *	REQUEST_NODE_REGISTRATION_STATUS gathered through the forwarding tree
+ * IN reg_msg - node registration message
+ * RET 0 if no error, SLURM error code otherwise
+ * NOTE: READ lock_slurmctld config, WRITE job and node before entry
+ */
+extern int validate_node_registration(
+		slurm_node_registration_status_msg_t *reg_msg)
+{
+	if (!(slurm_get_debug_flags() & DEBUG_FLAG_NO_CONF_HASH) &&
+	    (reg_msg->hash_val != NO_VAL) &&
+	    (reg_msg->hash_val != slurm_get_hash_val())) {
+		error("Node %s appears to have a different slurm.conf "
+		      "than the slurmctld.  This could cause issues "
+		      "with communication and functionality.  "
+		      "Please review both files and make sure they "
+		      "are the same.  If this is expected ignore, and "
+		      "set DebugFlags=NO_CONF_HASH in your slurm.conf.",
+		      reg_msg->node_name);
+	}
+#ifdef HAVE_FRONT_END		/* Operates only on front-end */
+	return validate_nodes_via_front_end(reg_msg);
+#else
+	validate_jobs_on_node(reg_msg);
+	return validate_node_specs(reg_msg);
+#endif
+}
+
+/*
+ * validate_node_registrations - process a batch of node registration
+ *	messages under a single lock acquisition, reconciling the jobs on
+ *	all of the nodes with one pass over the job list
+ * IN reg_msgs - node registration messages
+ * IN reg_cnt - number of entries in reg_msgs
+ * NOTE: READ lock_slurmctld config, WRITE job and node before entry
+ */
+extern void validate_node_registrations(
+		slurm_node_registration_status_msg_t **reg_msgs, int reg_cnt)
+{
+	int i, rc;
+#ifndef HAVE_FRONT_END
+	bitstr_t *node_bitmap = NULL;
+	struct node_record *node_ptr;
+
+	if (reg_cnt > 1) {
+		node_bitmap = bit_alloc(node_record_count);
+		if (node_bitmap == NULL)
+			fatal("bit_alloc malloc failure");
+		for (i = 0; i < reg_cnt; i++) {
+			node_ptr = find_node_record(reg_msgs[i]->node_name);
+			if (node_ptr) {
+				bit_set(node_bitmap,
+					node_ptr - node_record_table_ptr);
+			}
+		}
+		validate_jobs_batch_begin(node_bitmap);
+	}
+#endif
+
+	for (i = 0; i < reg_cnt; i++) {
+		rc = validate_node_registration(reg_msgs[i]);
+		if (rc) {
+			error("node registration for %s: %s",
+			      reg_msgs[i]->node_name, slurm_strerror(rc));
+		}
+	}
+
+#ifndef HAVE_FRONT_END
+	if (node_bitmap) {
+		validate_jobs_batch_end();
+		FREE_NULL_BITMAP(node_bitmap);
+	}
+#endif
+}
+
 /*
  * validate_node_specs - validate the node's specifications as valid,
  *	if not set state to down, in any case update last_response
@@ -1612,6 +1676,14 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 				(reg_msg->cpus - node_ptr->cpus);
 		}
 	}
+	if ((slurmctld_conf.fast_schedule == 0) &&
+	    ((node_ptr->cpus        != reg_msg->cpus)        ||
+	     (node_ptr->sockets     != reg_msg->sockets)     ||
+	     (node_ptr->cores       != reg_msg->cores)       ||
+	     (node_ptr->threads     != reg_msg->threads)     ||
+	     (node_ptr->real_memory != reg_msg->real_memory) ||
+	     (node_ptr->tmp_disk    != reg_msg->tmp_disk)))
+		node_config_gen++;	/* job node sets use node specs */
 	if (error_code == SLURM_SUCCESS) {
 		node_ptr->sockets = reg_msg->sockets;
 		node_ptr->cores   = reg_msg->cores;
@@ -1771,6 +1843,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 	}
 
 	node_ptr->last_response = now;
+	node_ptr->protocol_version = reg_msg->protocol_version;
 
 	return error_code;
 }
@@ -1805,6 +1878,7 @@ static front_end_record_t * _front_end_reg(
 	}
 
 	front_end_ptr->last_response = now;
+	front_end_ptr->protocol_version = reg_msg->protocol_version;
 	front_end_ptr->slurmd_start_time = reg_msg->slurmd_start_time;
 	state_base  = front_end_ptr->node_state & JOB_STATE_BASE;
 	state_flags = front_end_ptr->node_state & JOB_STATE_FLAGS;
@@ -96,13 +96,39 @@ struct node_set {		/* set of nodes with same configuration */
 	bitstr_t *my_bitmap;		/* node bitmap */
 };
 
+struct node_set_cache {		/* node sets of a pending job which depend
+				 * only upon its constraints and the node
+				 * and partition configuration */
+	uint32_t config_gen;		/* node_config_gen when built */
+	struct part_record *part_ptr;	/* partition the sets are for */
+	bitstr_t *exc_node_bitmap;	/* job's excluded nodes when built */
+	int error_code;			/* result of _build_node_sets() */
+	int node_set_size;
+	struct node_set *node_set_ptr;
+};
+
+uint32_t node_config_gen = 0;	/* node/partition configuration generation */
+
 static int  _build_node_list(struct job_record *job_ptr,
 			     struct node_set **node_set_pptr,
 			     int *node_set_size);
+static int  _build_node_sets(struct job_record *job_ptr,
+			     bitstr_t *usable_node_mask,
+			     struct node_set **node_set_pptr,
+			     int *node_set_size);
+static struct node_set *_copy_node_sets(struct node_set *node_set_ptr,
+					int node_set_size);
 static void _filter_nodes_in_set(struct node_set *node_set_ptr,
 				 struct job_details *detail_ptr);
+static void _free_node_sets(struct node_set *node_set_ptr, int node_set_size);
 static int _list_find_feature(void *feature_entry, void *key);
 static int _match_feature(char *seek, struct node_set *node_set_ptr);
+static bool _node_set_cache_get(struct job_record *job_ptr,
+				struct node_set **node_set_pptr,
+				int *node_set_size, int *error_code);
+static void _node_set_cache_put(struct job_record *job_ptr,
+				struct node_set *node_set_ptr,
+				int node_set_size, int error_code);
 static int _nodes_in_sets(bitstr_t *req_bitmap,
 			  struct node_set * node_set_ptr,
 			  int node_set_size);
@@ -1325,6 +1351,11 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		goto cleanup;
 	}
 
+	/* Start the next task of a job array, the remaining tasks stay
+	 * pending in a new job record */
+	if (job_ptr->array_task_bitmap)
+		job_array_split(job_ptr);
+
 	/* This job may be getting requeued, clear vestigial
 	 * state information before over-writing and leaking
 	 * memory. */
@@ -1375,6 +1406,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 	select_bitmap = NULL;	/* nothing left to free */
 	allocate_nodes(job_ptr);
 	build_node_details(job_ptr);
+	node_set_cache_free(job_ptr->details);
 
 	/* This could be set in the select plugin so we want to keep
 	   the flag. */
@@ -1384,6 +1416,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 	if (configuring
 	    || bit_overlap(job_ptr->node_bitmap, power_node_bitmap))
 		job_ptr->job_state |= JOB_CONFIGURING;
+	notify_job_dependency(job_ptr);
 	if (select_g_select_nodeinfo_set(job_ptr) != SLURM_SUCCESS) {
 		error("select_g_select_nodeinfo_set(%u): %m", job_ptr->job_id);
 		/* not critical ... by now */
@@ -1410,14 +1443,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		*select_node_bitmap = select_bitmap;
 	else
 		FREE_NULL_BITMAP(select_bitmap);
-	if (node_set_ptr) {
-		for (i = 0; i < node_set_size; i++) {
-			xfree(node_set_ptr[i].features);
-			FREE_NULL_BITMAP(node_set_ptr[i].my_bitmap);
-			FREE_NULL_BITMAP(node_set_ptr[i].feature_bits);
-		}
-		xfree(node_set_ptr);
-	}
+	_free_node_sets(node_set_ptr, node_set_size);
 	return error_code;
 }
 
@@ -1632,18 +1658,11 @@ static int _build_node_list(struct job_record *job_ptr,
 			    struct node_set **node_set_pptr,
 			    int *node_set_size)
 {
-	int i, node_set_inx, power_cnt, rc;
-	struct node_set *node_set_ptr;
-	struct config_record *config_ptr;
-	struct part_record *part_ptr = job_ptr->part_ptr;
-	ListIterator config_iterator;
-	int check_node_config, config_filter = 0;
+	int i, node_set_inx = 0, power_cnt, rc = SLURM_SUCCESS;
+	struct node_set *node_set_ptr = NULL;
 	struct job_details *detail_ptr = job_ptr->details;
 	bitstr_t *power_up_bitmap = NULL, *usable_node_mask = NULL;
-	multi_core_data_t *mc_ptr = detail_ptr->mc_ptr;
-	bitstr_t *tmp_feature;
 	uint32_t max_weight = 0;
-	bool has_xor = false;
 
 	if (job_ptr->resv_name) {
 		/* Limit node selection to those in selected reservation */
@@ -1669,6 +1688,98 @@ static int _build_node_list(struct job_record *job_ptr,
 		}
 	}
 
+	/* The node sets depend only upon the job's constraints and the node
+	 * and partition configuration, so reuse them across scheduling
+	 * attempts unless a reservation limits the job's nodes. */
+	if (job_ptr->resv_name ||
+	    !_node_set_cache_get(job_ptr, &node_set_ptr, &node_set_inx,
+				 &rc)) {
+		rc = _build_node_sets(job_ptr, usable_node_mask,
+				      &node_set_ptr, &node_set_inx);
+		if (!job_ptr->resv_name) {
+			_node_set_cache_put(job_ptr, node_set_ptr,
+					    node_set_inx, rc);
+		}
+	}
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
+	for (i = 0; i < node_set_inx; i++)
+		max_weight = MAX(max_weight, node_set_ptr[i].weight);
+
+	/* If any nodes are powered down, put them into a new node_set
+	 * record with a higher scheduling weight. This means we avoid
+	 * scheduling jobs on powered down nodes where possible. */
+	for (i = (node_set_inx-1); i >= 0; i--) {
+		power_cnt = bit_overlap(node_set_ptr[i].my_bitmap,
+				        power_node_bitmap);
+		if (power_cnt == 0)
+			continue;	/* no nodes powered down */
+		if (power_cnt == node_set_ptr[i].nodes) {
+			node_set_ptr[i].weight += max_weight;	/* avoid all */
+			continue;	/* all nodes powered down */
+		}
+
+		/* Some nodes powered down, others up, split record */
+		node_set_ptr[node_set_inx].cpus_per_node =
+			node_set_ptr[i].cpus_per_node;
+		node_set_ptr[node_set_inx].real_memory =
+			node_set_ptr[i].real_memory;
+		node_set_ptr[node_set_inx].nodes = power_cnt;
+		node_set_ptr[i].nodes -= power_cnt;
+		node_set_ptr[node_set_inx].weight =
+			node_set_ptr[i].weight + max_weight;
+		node_set_ptr[node_set_inx].features =
+			xstrdup(node_set_ptr[i].features);
+		node_set_ptr[node_set_inx].feature_bits =
+			bit_copy(node_set_ptr[i].feature_bits);
+		node_set_ptr[node_set_inx].my_bitmap =
+			bit_copy(node_set_ptr[i].my_bitmap);
+		bit_and(node_set_ptr[node_set_inx].my_bitmap,
+			power_node_bitmap);
+		if (power_up_bitmap == NULL) {
+			power_up_bitmap = bit_copy(power_node_bitmap);
+			bit_not(power_up_bitmap);
+		}
+		bit_and(node_set_ptr[i].my_bitmap, power_up_bitmap);
+
+		node_set_inx++;
+		xrealloc(node_set_ptr,
+			 sizeof(struct node_set) * (node_set_inx + 2));
+		node_set_ptr[node_set_inx + 1].my_bitmap = NULL;
+	}
+	FREE_NULL_BITMAP(power_up_bitmap);
+
+	*node_set_size = node_set_inx;
+	*node_set_pptr = node_set_ptr;
+	return SLURM_SUCCESS;
+}
+
+/*
+ * _build_node_sets - build sets of nodes with the same configuration which
+ *	satisfy the job's partition, exclusion and feature constraints
+ * IN job_ptr - job being scheduled
+ * IN usable_node_mask - nodes the job may use or NULL for all, freed here
+ * OUT node_set_pptr - node sets, must be xfreed by caller
+ * OUT node_set_size - count of node sets
+ * RET SLURM_SUCCESS or error code
+ */
+static int _build_node_sets(struct job_record *job_ptr,
+			    bitstr_t *usable_node_mask,
+			    struct node_set **node_set_pptr,
+			    int *node_set_size)
+{
+	int node_set_inx;
+	struct node_set *node_set_ptr;
+	struct config_record *config_ptr;
+	struct part_record *part_ptr = job_ptr->part_ptr;
+	ListIterator config_iterator;
+	int check_node_config, config_filter = 0;
+	struct job_details *detail_ptr = job_ptr->details;
+	multi_core_data_t *mc_ptr = detail_ptr->mc_ptr;
+	bitstr_t *tmp_feature;
+	bool has_xor = false;
+
 	node_set_inx = 0;
 	node_set_ptr = (struct node_set *)
 			xmalloc(sizeof(struct node_set) * 2);
@@ -1696,6 +1807,7 @@ static int _build_node_list(struct job_record *job_ptr,
 		info("No job %u feature requirements can not be met",
 		     job_ptr->job_id);
 		FREE_NULL_BITMAP(usable_node_mask);
+		xfree(node_set_ptr);
 		return ESLURM_REQUESTED_NODE_CONFIG_UNAVAILABLE;
 	}
 
@@ -1776,7 +1888,6 @@ static int _build_node_list(struct job_record *job_ptr,
 			config_ptr->real_memory;
 		node_set_ptr[node_set_inx].weight =
 			config_ptr->weight;
-		max_weight = MAX(max_weight, config_ptr->weight);
 		node_set_ptr[node_set_inx].features =
 			xstrdup(config_ptr->feature);
 		node_set_ptr[node_set_inx].feature_bits = tmp_feature;
@@ -1802,52 +1913,126 @@ static int _build_node_list(struct job_record *job_ptr,
 		return ESLURM_REQUESTED_NODE_CONFIG_UNAVAILABLE;
 	}
 
-	/* If any nodes are powered down, put them into a new node_set
-	 * record with a higher scheduling weight. This means we avoid
-	 * scheduling jobs on powered down nodes where possible. */
-	for (i = (node_set_inx-1); i >= 0; i--) {
-		power_cnt = bit_overlap(node_set_ptr[i].my_bitmap,
-				        power_node_bitmap);
-		if (power_cnt == 0)
-			continue;	/* no nodes powered down */
-		if (power_cnt == node_set_ptr[i].nodes) {
-			node_set_ptr[i].weight += max_weight;	/* avoid all */
-			continue;	/* all nodes powered down */
-		}
+	*node_set_size = node_set_inx;
+	*node_set_pptr = node_set_ptr;
+	return SLURM_SUCCESS;
+}
 
-		/* Some nodes powered down, others up, split record */
-		node_set_ptr[node_set_inx].cpus_per_node =
-			node_set_ptr[i].cpus_per_node;
-		node_set_ptr[node_set_inx].real_memory =
-			node_set_ptr[i].real_memory;
-		node_set_ptr[node_set_inx].nodes = power_cnt;
-		node_set_ptr[i].nodes -= power_cnt;
-		node_set_ptr[node_set_inx].weight =
-			node_set_ptr[i].weight + max_weight;
-		node_set_ptr[node_set_inx].features =
-			xstrdup(node_set_ptr[i].features);
-		node_set_ptr[node_set_inx].feature_bits =
+/* Return a copy of node sets, with room for the power-down split */
+static struct node_set *_copy_node_sets(struct node_set *node_set_ptr,
+					int node_set_size)
+{
+	struct node_set *copy_ptr;
+	int i;
+
+	copy_ptr = xmalloc(sizeof(struct node_set) * (node_set_size + 2));
+	for (i = 0; i < node_set_size; i++) {
+		copy_ptr[i].cpus_per_node = node_set_ptr[i].cpus_per_node;
+		copy_ptr[i].real_memory   = node_set_ptr[i].real_memory;
+		copy_ptr[i].nodes         = node_set_ptr[i].nodes;
+		copy_ptr[i].weight        = node_set_ptr[i].weight;
+		copy_ptr[i].features = xstrdup(node_set_ptr[i].features);
+		copy_ptr[i].feature_bits =
 			bit_copy(node_set_ptr[i].feature_bits);
-		node_set_ptr[node_set_inx].my_bitmap =
-			bit_copy(node_set_ptr[i].my_bitmap);
-		bit_and(node_set_ptr[node_set_inx].my_bitmap,
-			power_node_bitmap);
-		if (power_up_bitmap == NULL) {
-			power_up_bitmap = bit_copy(power_node_bitmap);
-			bit_not(power_up_bitmap);
-		}
-		bit_and(node_set_ptr[i].my_bitmap, power_up_bitmap);
+		copy_ptr[i].my_bitmap = bit_copy(node_set_ptr[i].my_bitmap);
+		if ((copy_ptr[i].feature_bits == NULL) ||
+		    (copy_ptr[i].my_bitmap == NULL))
+			fatal("bit_copy malloc failure");
+	}
+	return copy_ptr;
+}
 
-		node_set_inx++;
-		xrealloc(node_set_ptr,
-			 sizeof(struct node_set) * (node_set_inx + 2));
-		node_set_ptr[node_set_inx + 1].my_bitmap = NULL;
+static void _free_node_sets(struct node_set *node_set_ptr, int node_set_size)
+{
+	int i;
+
+	if (node_set_ptr == NULL)
+		return;
+	for (i = 0; i < node_set_size; i++) {
+		xfree(node_set_ptr[i].features);
+		FREE_NULL_BITMAP(node_set_ptr[i].my_bitmap);
+		FREE_NULL_BITMAP(node_set_ptr[i].feature_bits);
 	}
-	FREE_NULL_BITMAP(power_up_bitmap);
+	xfree(node_set_ptr);
+}
 
-	*node_set_size = node_set_inx;
-	*node_set_pptr = node_set_ptr;
-	return SLURM_SUCCESS;
+/*
+ * _node_set_cache_get - load a job's node sets from its cache
+ * OUT node_set_pptr, node_set_size - copy of the cached node sets
+ * OUT error_code - cached result of _build_node_sets()
+ * RET true if the cache was valid
+ */
+static bool _node_set_cache_get(struct job_record *job_ptr,
+				struct node_set **node_set_pptr,
+				int *node_set_size, int *error_code)
+{
+	struct job_details *detail_ptr = job_ptr->details;
+	struct node_set_cache *cache_ptr = detail_ptr->node_set_cache;
+
+	if (cache_ptr == NULL)
+		return false;
+	if ((cache_ptr->config_gen != node_config_gen) ||
+	    (cache_ptr->part_ptr != job_ptr->part_ptr) ||
+	    ((cache_ptr->exc_node_bitmap == NULL) !=
+	     (detail_ptr->exc_node_bitmap == NULL)) ||
+	    (cache_ptr->exc_node_bitmap &&
+	     !bit_equal(cache_ptr->exc_node_bitmap,
+			detail_ptr->exc_node_bitmap))) {
+		node_set_cache_free(detail_ptr);
+		return false;
+	}
+
+	*error_code = cache_ptr->error_code;
+	if (*error_code == SLURM_SUCCESS) {
+		*node_set_pptr = _copy_node_sets(cache_ptr->node_set_ptr,
+						 cache_ptr->node_set_size);
+		*node_set_size = cache_ptr->node_set_size;
+	}
+	return true;
+}
+
+/* Save a job's node sets as built by _build_node_sets() in its cache */
+static void _node_set_cache_put(struct job_record *job_ptr,
+				struct node_set *node_set_ptr,
+				int node_set_size, int error_code)
+{
+	struct job_details *detail_ptr = job_ptr->details;
+	struct node_set_cache *cache_ptr;
+
+	node_set_cache_free(detail_ptr);
+	cache_ptr = xmalloc(sizeof(struct node_set_cache));
+	cache_ptr->config_gen = node_config_gen;
+	cache_ptr->part_ptr = job_ptr->part_ptr;
+	if (detail_ptr->exc_node_bitmap) {
+		cache_ptr->exc_node_bitmap =
+			bit_copy(detail_ptr->exc_node_bitmap);
+		if (cache_ptr->exc_node_bitmap == NULL)
+			fatal("bit_copy malloc failure");
+	}
+	cache_ptr->error_code = error_code;
+	if (error_code == SLURM_SUCCESS) {
+		cache_ptr->node_set_ptr = _copy_node_sets(node_set_ptr,
+							  node_set_size);
+		cache_ptr->node_set_size = node_set_size;
+	}
+	detail_ptr->node_set_cache = cache_ptr;
+}
+
+/*
+ * node_set_cache_free - free a job's cached node sets
+ * IN detail_ptr - job details, may be NULL
+ */
+extern void node_set_cache_free(struct job_details *detail_ptr)
+{
+	struct node_set_cache *cache_ptr;
+
+	if ((detail_ptr == NULL) ||
+	    ((cache_ptr = detail_ptr->node_set_cache) == NULL))
+		return;
+	_free_node_sets(cache_ptr->node_set_ptr, cache_ptr->node_set_size);
+	FREE_NULL_BITMAP(cache_ptr->exc_node_bitmap);
+	xfree(cache_ptr);
+	detail_ptr->node_set_cache = NULL;
 }
 
 /* Remove from the node set any nodes which lack sufficient resources
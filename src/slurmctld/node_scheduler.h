@@ -67,6 +67,13 @@ extern void build_node_details(struct job_record *job_ptr);
 extern void deallocate_nodes(struct job_record *job_ptr, bool timeout,
 		bool suspended, bool preempted);
 
+/*
+ * node_set_cache_free - free a job's cached node sets, call when the job's
+ *	constraints change or it is no longer pending
+ * IN detail_ptr - job details, may be NULL
+ */
+extern void node_set_cache_free(struct job_details *detail_ptr);
+
 /*
  * re_kill_job - for a given job, deallocate its nodes for a second time,
  *	basically a cleanup for failed deallocate() calls
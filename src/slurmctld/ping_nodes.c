@@ -50,6 +50,7 @@
 
 #include "src/common/hostlist.h"
 #include "src/common/read_config.h"
+#include "src/common/timers.h"
 #include "src/slurmctld/agent.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/ping_nodes.h"
@@ -63,6 +64,7 @@
 
 static pthread_mutex_t lock_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int ping_count = 0;
+static struct timeval ping_start_tv;	/* start of current ping cycle */
 
 
 /*
@@ -92,7 +94,8 @@ bool is_ping_done (void)
 void ping_begin (void)
 {
 	slurm_mutex_lock(&lock_mutex);
-	ping_count++;
+	if (ping_count++ == 0)
+		gettimeofday(&ping_start_tv, NULL);
 	slurm_mutex_unlock(&lock_mutex);
 }
 
@@ -104,11 +107,18 @@ void ping_begin (void)
  */
 void ping_end (void)
 {
+	struct timeval now_tv;
+
 	slurm_mutex_lock(&lock_mutex);
 	if (ping_count > 0)
 		ping_count--;
 	else
 		fatal ("ping_count < 0");
+	if (ping_count == 0) {
+		gettimeofday(&now_tv, NULL);
+		debug("ping cycle completed in %ld usec",
+		      slurm_diff_tv(&ping_start_tv, &now_tv));
+	}
 	slurm_mutex_unlock(&lock_mutex);
 }
 
@@ -168,9 +178,14 @@ void ping_nodes (void)
 	still_live_time = now - (slurmctld_conf.slurmd_timeout / 3);
 	last_ping_time  = now;
 
-	if (max_reg_threads == 0) {
-		max_reg_threads = MAX(slurm_get_tree_width(), 1);
-	}
+	/* Registrations are returned through the forwarding tree rather
+	 * than as separate RPCs, so poll enough nodes per cycle to refresh
+	 * every node about once per MAX_REG_FREQUENCY pings regardless of
+	 * cluster size */
+	max_reg_threads = MAX(slurm_get_tree_width(), 1);
+	max_reg_threads = MAX(max_reg_threads,
+			      (node_record_count + MAX_REG_FREQUENCY - 1) /
+			      MAX_REG_FREQUENCY);
 	offset += max_reg_threads;
 	if ((offset > node_record_count) &&
 	    (offset >= (max_reg_threads * MAX_REG_FREQUENCY)))
@@ -212,7 +227,7 @@ void ping_nodes (void)
 		 * this mechanism avoids an additional (per node) timer or
 		 * counter and gets updated configuration information
 		 * once in a while). We limit these requests since they
-		 * can generate a flood of incoming RPCs. */
+		 * can include DOWN nodes and delay the whole tree. */
 		if (IS_NODE_UNKNOWN(front_end_ptr) || restart_flag ||
 		    ((i >= offset) && (i < (offset + max_reg_threads)))) {
 			hostlist_push(reg_agent_args->hostlist,
@@ -270,7 +285,7 @@ void ping_nodes (void)
 		 * this mechanism avoids an additional (per node) timer or
 		 * counter and gets updated configuration information
 		 * once in a while). We limit these requests since they
-		 * can generate a flood of incoming RPCs. */
+		 * can include DOWN nodes and delay the whole tree. */
 		if (IS_NODE_UNKNOWN(node_ptr) || restart_flag ||
 		    ((i >= offset) && (i < (offset + max_reg_threads)))) {
 			hostlist_push(reg_agent_args->hostlist,
@@ -158,8 +158,16 @@ inline static void  _slurm_rpc_update_partition(slurm_msg_t * msg);
 inline static void  _slurm_rpc_update_block(slurm_msg_t * msg);
 inline static void _slurm_rpc_dump_spank(slurm_msg_t * msg);
 
+static void         _proc_node_registrations(void);
 inline static void  _update_cred_key(void);
 
+/* Node registrations waiting to be applied in a batch, see
+ * _slurm_rpc_node_registration() */
+#define MAX_REG_BATCH 1024
+static pthread_mutex_t reg_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List reg_queue = NULL;
+static bool reg_queue_busy = false;
+
 
 /*
  * slurmctld_req  - Process an individual RPC request
@@ -588,6 +596,7 @@ void _fill_ctld_conf(slurm_ctl_conf_t * conf_ptr)
 	conf_ptr->slurm_user_name     = xstrdup(conf->slurm_user_name);
 	conf_ptr->slurmctld_debug     = conf->slurmctld_debug;
 	conf_ptr->slurmctld_logfile   = xstrdup(conf->slurmctld_logfile);
+	conf_ptr->slurmctld_log_queue = conf->slurmctld_log_queue;
 	conf_ptr->slurmctld_pidfile   = xstrdup(conf->slurmctld_pidfile);
 	conf_ptr->slurmctld_port      = conf->slurmctld_port;
 	conf_ptr->slurmctld_port_count = conf->slurmctld_port_count;
@@ -1323,10 +1332,10 @@ static void _slurm_rpc_job_step_kill(slurm_msg_t * msg)
 	/* do RPC call */
 	if (job_step_kill_msg->job_step_id == SLURM_BATCH_SCRIPT) {
 		/* NOTE: SLURM_BATCH_SCRIPT == NO_VAL */
-		error_code = job_signal(job_step_kill_msg->job_id,
-					job_step_kill_msg->signal,
-					job_step_kill_msg->batch_flag, uid,
-					false);
+		error_code = job_array_signal(job_step_kill_msg->job_id,
+					      job_step_kill_msg->signal,
+					      job_step_kill_msg->batch_flag,
+					      uid);
 		unlock_slurmctld(job_write_lock);
 		END_TIMER2("_slurm_rpc_job_step_kill");
 
@@ -1847,10 +1856,8 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg)
 	int error_code = SLURM_SUCCESS;
 	slurm_node_registration_status_msg_t *node_reg_stat_msg =
 		(slurm_node_registration_status_msg_t *) msg->data;
-	/* Locks: Read config, write job, write node */
-	slurmctld_lock_t job_write_lock = {
-		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+	bool proc_queue = false;
 
 	START_TIMER;
 	debug2("Processing RPC: MESSAGE_NODE_REGISTRATION_STATUS from uid=%d",
@@ -1860,26 +1867,21 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg)
 		error("Security violation, NODE_REGISTER RPC from uid=%d", uid);
 	}
 	if (error_code == SLURM_SUCCESS) {
-		/* do RPC call */
-		if (!(slurm_get_debug_flags() & DEBUG_FLAG_NO_CONF_HASH) &&
-		    (node_reg_stat_msg->hash_val != NO_VAL) &&
-		    (node_reg_stat_msg->hash_val != slurm_get_hash_val())) {
-			error("Node %s appears to have a different slurm.conf "
-			      "than the slurmctld.  This could cause issues "
-			      "with communication and functionality.  "
-			      "Please review both files and make sure they "
-			      "are the same.  If this is expected ignore, and "
-			      "set DebugFlags=NO_CONF_HASH in your slurm.conf.",
-			      node_reg_stat_msg->node_name);
-		}
-		lock_slurmctld(job_write_lock);
-#ifdef HAVE_FRONT_END		/* Operates only on front-end */
-		error_code = validate_nodes_via_front_end(node_reg_stat_msg);
-#else
-		validate_jobs_on_node(node_reg_stat_msg);
-		error_code = validate_node_specs(node_reg_stat_msg);
-#endif
-		unlock_slurmctld(job_write_lock);
+		/* Queue the registration rather than taking the job and
+		 * node write locks for each one. The first thread to find
+		 * the queue idle applies everything queued in batches,
+		 * the others reply at once. The slurmd does not act upon
+		 * the return code, errors are logged when applied. */
+		debug2("_slurm_rpc_node_registration queued for %s",
+		       node_reg_stat_msg->node_name);
+		slurm_mutex_lock(&reg_queue_mutex);
+		if (reg_queue == NULL)
+			reg_queue = list_create(NULL);
+		list_enqueue(reg_queue, node_reg_stat_msg);
+		msg->data = NULL;	/* now owned by reg_queue */
+		if (!reg_queue_busy)
+			proc_queue = reg_queue_busy = true;
+		slurm_mutex_unlock(&reg_queue_mutex);
 		END_TIMER2("_slurm_rpc_node_registration");
 	}
 
@@ -1889,11 +1891,51 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg)
 		      node_reg_stat_msg->node_name,
 		      slurm_strerror(error_code));
 		slurm_send_rc_msg(msg, error_code);
-	} else {
-		debug2("_slurm_rpc_node_registration complete for %s %s",
-		       node_reg_stat_msg->node_name, TIME_STR);
+	} else
 		slurm_send_rc_msg(msg, SLURM_SUCCESS);
+
+	if (proc_queue)
+		_proc_node_registrations();
+}
+
+/* Apply queued node registrations, up to MAX_REG_BATCH of them for each
+ * acquisition of the job and node write locks */
+static void _proc_node_registrations(void)
+{
+	DEF_TIMERS;
+	slurm_node_registration_status_msg_t **reg_msgs;
+	int i, reg_cnt;
+	/* Locks: Read config, write job, write node */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK };
+
+	reg_msgs = xmalloc(sizeof(slurm_node_registration_status_msg_t *) *
+			   MAX_REG_BATCH);
+	while (1) {
+		slurm_mutex_lock(&reg_queue_mutex);
+		for (reg_cnt = 0; reg_cnt < MAX_REG_BATCH; reg_cnt++) {
+			reg_msgs[reg_cnt] = list_dequeue(reg_queue);
+			if (reg_msgs[reg_cnt] == NULL)
+				break;
+		}
+		if (reg_cnt == 0)
+			reg_queue_busy = false;
+		slurm_mutex_unlock(&reg_queue_mutex);
+		if (reg_cnt == 0)
+			break;
+
+		START_TIMER;
+		lock_slurmctld(job_write_lock);
+		validate_node_registrations(reg_msgs, reg_cnt);
+		unlock_slurmctld(job_write_lock);
+		END_TIMER2("_proc_node_registrations");
+		debug2("_proc_node_registrations applied %d registrations %s",
+		       reg_cnt, TIME_STR);
+
+		for (i = 0; i < reg_cnt; i++)
+			slurm_free_node_registration_status_msg(reg_msgs[i]);
 	}
+	xfree(reg_msgs);
 }
 
 /* _slurm_rpc_job_alloc_info - process RPC to get details on existing job */
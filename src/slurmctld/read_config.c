@@ -59,6 +59,7 @@
 #include <unistd.h>
 
 #include "src/common/assoc_mgr.h"
+#include "src/common/forward.h"
 #include "src/common/gres.h"
 #include "src/common/hostlist.h"
 #include "src/common/list.h"
@@ -104,6 +105,7 @@ static int  _preserve_plugins(slurm_ctl_conf_t * ctl_conf_ptr,
 static void _purge_old_node_state(struct node_record *old_node_table_ptr,
 				int old_node_record_count);
 static void _purge_old_part_state(List old_part_list, char *old_def_part_name);
+static void _set_forward_switches(void);
 static int  _restore_job_dependencies(void);
 static int  _restore_node_state(int recover,
 				struct node_record *old_node_table_ptr,
@@ -471,11 +473,32 @@ static int _build_all_nodeline_info(void)
 }
 #else	/* HAVE_BG */
 	slurm_topo_build_config();
+	_set_forward_switches();
 #endif	/* HAVE_BG */
 
 	return rc;
 }
 
+/*
+ * _set_forward_switches - tell the message forwarding logic which nodes
+ *	are connected to each leaf switch, so the trees used to send RPCs to
+ *	many nodes keep their subtrees within a switch
+ */
+static void _set_forward_switches(void)
+{
+	char **switch_nodes = NULL;
+	int i, switch_cnt = 0;
+
+	if (switch_record_cnt)
+		switch_nodes = xmalloc(sizeof(char *) * switch_record_cnt);
+	for (i = 0; i < switch_record_cnt; i++) {
+		if (switch_record_table[i].level == 0)
+			switch_nodes[switch_cnt++] = switch_record_table[i].nodes;
+	}
+	forward_set_switches(switch_nodes, switch_cnt);
+	xfree(switch_nodes);
+}
+
 /*
  * _build_single_partitionline_info - get a array of slurm_conf_partition_t
  *	structures from the slurm.conf reader, build table, and set values
@@ -892,6 +915,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	/* Sync select plugin with synchronized job/node/part data */
 	select_g_reconfigure();
 
+	node_config_gen++;
 	slurmctld_conf.last_update = time(NULL);
 	END_TIMER2("read_slurm_conf");
 	return error_code;
@@ -986,6 +1010,7 @@ static int _restore_node_state(int recover,
 		node_ptr->sockets       = old_node_ptr->sockets;
 		node_ptr->threads       = old_node_ptr->threads;
 		node_ptr->real_memory   = old_node_ptr->real_memory;
+		node_ptr->protocol_version = old_node_ptr->protocol_version;
 		node_ptr->slurmd_start_time = old_node_ptr->slurmd_start_time; 
 		node_ptr->tmp_disk      = old_node_ptr->tmp_disk;
 		node_ptr->weight        = old_node_ptr->weight;
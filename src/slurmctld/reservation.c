@@ -76,6 +76,7 @@
 #include "src/slurmctld/state_save.h"
 
 #define ONE_YEAR	(365 * 24 * 60 * 60)
+#define ONE_WEEK	(7 * 24 * 60 * 60)
 #define RESV_MAGIC	0x3b82
 
 /* Change RESV_STATE_VERSION value when changing the state save format
@@ -91,17 +92,41 @@ uint32_t  top_suffix = 0;
 uint32_t  cnodes_per_bp = 0;
 #endif
 
+/* Index of resv_list rebuilt whenever reservations are added, removed or
+ * have their times changed. resv_index is ordered by start_time and read as
+ * an implicit balanced binary tree (the middle element of a range is its
+ * root), with resv_index_end holding the latest end_time of each subtree,
+ * making it an interval tree. Names and IDs are in open addressed hash
+ * tables of resv_hash_size entries. */
+static slurmctld_resv_t **resv_index = NULL;
+static time_t *resv_index_end = NULL;
+static int resv_index_cnt = 0;
+static time_t resv_index_advance = (time_t) 0;	/* first end_time of a daily
+						 * or weekly reservation */
+static bool resv_index_valid = false;
+static slurmctld_resv_t **resv_id_hash = NULL;
+static slurmctld_resv_t **resv_name_hash = NULL;
+static int resv_hash_size = 0;
+
 static void _advance_resv_time(slurmctld_resv_t *resv_ptr);
 static void _advance_time(time_t *res_time, int day_cnt);
 static int  _build_account_list(char *accounts, int *account_cnt,
 				char ***account_list);
+static void _build_resv_index(void);
+static time_t _build_resv_index_end(int lo, int hi);
 static int  _build_uid_list(char *users, int *user_cnt, uid_t **user_list);
 static void _clear_job_resv(slurmctld_resv_t *resv_ptr);
 static slurmctld_resv_t *_copy_resv(slurmctld_resv_t *resv_orig_ptr);
 static void _del_resv_rec(void *x);
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode);
-static int  _find_resv_id(void *x, void *key);
-static int  _find_resv_name(void *x, void *key);
+static slurmctld_resv_t *_find_resv_id(uint32_t resv_id);
+static slurmctld_resv_t *_find_resv_name(char *name);
+static int  _find_resv_overlap(time_t start_time, time_t end_time,
+			       slurmctld_resv_t ***resv_array);
+static void _find_resv_overlap_range(int lo, int hi, time_t start_time,
+				     time_t end_time,
+				     slurmctld_resv_t ***resv_array,
+				     int *resv_cnt);
 static void _generate_resv_id(void);
 static void _generate_resv_name(resv_desc_msg_t *resv_ptr);
 static uint32_t _get_job_duration(struct job_record *job_ptr);
@@ -120,6 +145,9 @@ static int  _post_resv_delete(slurmctld_resv_t *resv_ptr);
 static int  _post_resv_update(slurmctld_resv_t *resv_ptr,
 			      slurmctld_resv_t *old_resv_ptr);
 static int  _resize_resv(slurmctld_resv_t *resv_ptr, uint32_t node_cnt);
+static int  _resv_hash_inx(uint32_t key);
+static uint32_t _resv_name_key(char *name);
+static int  _resv_start_cmp(const void *x, const void *y);
 static bool _resv_overlap(time_t start_time, time_t end_time,
 			  uint16_t flags, bitstr_t *node_bitmap,
 			  slurmctld_resv_t *this_resv_ptr);
@@ -133,6 +161,7 @@ static void _swap_resv(slurmctld_resv_t *resv_backup,
 		       slurmctld_resv_t *resv_ptr);
 static int  _update_account_list(slurmctld_resv_t *resv_ptr,
 				 char *accounts);
+static void _update_resv_index(time_t now);
 static int  _update_uid_list(slurmctld_resv_t *resv_ptr, char *users);
 static void _validate_all_reservations(void);
 static int  _valid_job_access_resv(struct job_record *job_ptr,
@@ -176,7 +205,9 @@ static List _list_dup(List license_list)
 	while ((license_src = (licenses_t *) list_next(iter))) {
 		license_dest = xmalloc(sizeof(licenses_t));
 		license_dest->name = xstrdup(license_src->name);
+		license_dest->total = license_src->total;
 		license_dest->used = license_src->used;
+		license_dest->id = license_src->id;
 		list_push(lic_list, license_dest);
 	}
 	list_iterator_destroy(iter);
@@ -252,6 +283,7 @@ static void _del_resv_rec(void *x)
 	if (resv_ptr) {
 		xassert(resv_ptr->magic == RESV_MAGIC);
 		resv_ptr->magic = 0;
+		resv_index_valid = false;
 		xfree(resv_ptr->accounts);
 		for (i=0; i<resv_ptr->account_cnt; i++)
 			xfree(resv_ptr->account_list[i]);
@@ -271,29 +303,205 @@ static void _del_resv_rec(void *x)
 	}
 }
 
-static int _find_resv_id(void *x, void *key)
+static int _resv_start_cmp(const void *x, const void *y)
 {
-	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
-	uint32_t *resv_id = (uint32_t *) key;
+	slurmctld_resv_t *resv_ptr1 = *(slurmctld_resv_t **) x;
+	slurmctld_resv_t *resv_ptr2 = *(slurmctld_resv_t **) y;
 
-	xassert(resv_ptr->magic == RESV_MAGIC);
+	if (resv_ptr1->start_time < resv_ptr2->start_time)
+		return -1;
+	if (resv_ptr1->start_time > resv_ptr2->start_time)
+		return 1;
+	return 0;
+}
 
-	if (resv_ptr->resv_id != *resv_id)
-		return 0;
-	else
-		return 1;	/* match */
+static uint32_t _resv_name_key(char *name)
+{
+	uint32_t key = 0;
+
+	while (*name)
+		key = (key * 31) + (unsigned char) *name++;
+	return key;
 }
 
-static int _find_resv_name(void *x, void *key)
+static int _resv_hash_inx(uint32_t key)
 {
-	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
+	return (int) ((key * 2654435761U) & (resv_hash_size - 1));
+}
 
-	xassert(resv_ptr->magic == RESV_MAGIC);
+/* Set the latest end_time of every subtree of resv_index within [lo, hi)
+ * RET latest end_time of the range */
+static time_t _build_resv_index_end(int lo, int hi)
+{
+	int mid;
+	time_t end_time;
+
+	if (lo >= hi)
+		return (time_t) 0;
+	mid = (lo + hi) / 2;
+	end_time = resv_index[mid]->end_time;
+	end_time = MAX(end_time, _build_resv_index_end(lo, mid));
+	end_time = MAX(end_time, _build_resv_index_end(mid + 1, hi));
+	resv_index_end[mid] = end_time;
+	return end_time;
+}
 
-	if (strcmp(resv_ptr->name, (char *) key))
-		return 0;
-	else
-		return 1;	/* match */
+/* Rebuild the reservation interval tree and name/ID hash tables */
+static void _build_resv_index(void)
+{
+	ListIterator iter;
+	slurmctld_resv_t *resv_ptr;
+	int i, cnt, hash_size = 16;
+
+	cnt = resv_list ? list_count(resv_list) : 0;
+	while (hash_size < (cnt * 2))
+		hash_size *= 2;
+	if (hash_size != resv_hash_size) {
+		xfree(resv_id_hash);
+		xfree(resv_name_hash);
+		resv_id_hash = xmalloc(sizeof(slurmctld_resv_t *) * hash_size);
+		resv_name_hash = xmalloc(sizeof(slurmctld_resv_t *) *
+					 hash_size);
+		resv_hash_size = hash_size;
+	} else {
+		memset(resv_id_hash, 0, sizeof(slurmctld_resv_t *) *
+		       hash_size);
+		memset(resv_name_hash, 0, sizeof(slurmctld_resv_t *) *
+		       hash_size);
+	}
+	xrealloc(resv_index, sizeof(slurmctld_resv_t *) * (cnt + 1));
+	xrealloc(resv_index_end, sizeof(time_t) * (cnt + 1));
+	resv_index_cnt = 0;
+	resv_index_advance = (time_t) INFINITE;
+
+	if (cnt) {
+		iter = list_iterator_create(resv_list);
+		if (!iter)
+			fatal("malloc: list_iterator_create");
+		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+			resv_index[resv_index_cnt++] = resv_ptr;
+			if ((resv_ptr->flags & (RESERVE_FLAG_DAILY |
+						RESERVE_FLAG_WEEKLY)) &&
+			    (resv_ptr->end_time < resv_index_advance))
+				resv_index_advance = resv_ptr->end_time;
+
+			i = _resv_hash_inx(resv_ptr->resv_id);
+			while (resv_id_hash[i])
+				i = (i + 1) & (resv_hash_size - 1);
+			resv_id_hash[i] = resv_ptr;
+
+			if (resv_ptr->name == NULL)	/* not yet validated */
+				continue;
+			i = _resv_hash_inx(_resv_name_key(resv_ptr->name));
+			while (resv_name_hash[i])
+				i = (i + 1) & (resv_hash_size - 1);
+			resv_name_hash[i] = resv_ptr;
+		}
+		list_iterator_destroy(iter);
+	}
+
+	qsort(resv_index, resv_index_cnt, sizeof(slurmctld_resv_t *),
+	      _resv_start_cmp);
+	(void) _build_resv_index_end(0, resv_index_cnt);
+	resv_index_valid = true;
+}
+
+/* Advance daily and weekly reservations which have ended, then rebuild the
+ * reservation index if needed. Call before any time based search. */
+static void _update_resv_index(time_t now)
+{
+	ListIterator iter;
+	slurmctld_resv_t *resv_ptr;
+
+	if (resv_index_valid && (resv_index_advance > now))
+		return;
+
+	if (resv_list) {
+		iter = list_iterator_create(resv_list);
+		if (!iter)
+			fatal("malloc: list_iterator_create");
+		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+			if (resv_ptr->end_time <= now)
+				_advance_resv_time(resv_ptr);
+		}
+		list_iterator_destroy(iter);
+	}
+	_build_resv_index();
+}
+
+static slurmctld_resv_t *_find_resv_id(uint32_t resv_id)
+{
+	slurmctld_resv_t *resv_ptr;
+	int i;
+
+	if (!resv_index_valid)
+		_build_resv_index();
+	for (i = _resv_hash_inx(resv_id); (resv_ptr = resv_id_hash[i]);
+	     i = (i + 1) & (resv_hash_size - 1)) {
+		xassert(resv_ptr->magic == RESV_MAGIC);
+		if (resv_ptr->resv_id == resv_id)
+			return resv_ptr;
+	}
+	return NULL;
+}
+
+static slurmctld_resv_t *_find_resv_name(char *name)
+{
+	slurmctld_resv_t *resv_ptr;
+	int i;
+
+	if (!resv_index_valid)
+		_build_resv_index();
+	for (i = _resv_hash_inx(_resv_name_key(name));
+	     (resv_ptr = resv_name_hash[i]);
+	     i = (i + 1) & (resv_hash_size - 1)) {
+		xassert(resv_ptr->magic == RESV_MAGIC);
+		if (!strcmp(resv_ptr->name, name))
+			return resv_ptr;
+	}
+	return NULL;
+}
+
+static void _find_resv_overlap_range(int lo, int hi, time_t start_time,
+				     time_t end_time,
+				     slurmctld_resv_t ***resv_array,
+				     int *resv_cnt)
+{
+	int mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (resv_index_end[mid] <= start_time)
+			return;		/* everything here ends too soon */
+		_find_resv_overlap_range(lo, mid, start_time, end_time,
+					 resv_array, resv_cnt);
+		if (resv_index[mid]->start_time >= end_time)
+			return;		/* the rest starts too late */
+		if (resv_index[mid]->end_time > start_time) {
+			xrealloc(*resv_array, sizeof(slurmctld_resv_t *) *
+				 (*resv_cnt + 1));
+			(*resv_array)[(*resv_cnt)++] = resv_index[mid];
+		}
+		lo = mid + 1;
+	}
+}
+
+/*
+ * Find all reservations active at some time within [start_time, end_time)
+ * OUT resv_array - matching reservations ordered by start time, caller must
+ *		    xfree, NULL if none
+ * RET count of matching reservations
+ * NOTE: the index must be current, call _update_resv_index() first
+ */
+static int _find_resv_overlap(time_t start_time, time_t end_time,
+			      slurmctld_resv_t ***resv_array)
+{
+	int resv_cnt = 0;
+
+	*resv_array = NULL;
+	_find_resv_overlap_range(0, resv_index_cnt, start_time, end_time,
+				 resv_array, &resv_cnt);
+	return resv_cnt;
 }
 
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode)
@@ -339,7 +547,7 @@ static void _generate_resv_id(void)
 			top_suffix = 1;		/* wrap around */
 		else
 			top_suffix++;
-		if (!list_find_first(resv_list, _find_resv_id, &top_suffix))
+		if (!_find_resv_id(top_suffix))
 			break;
 	}
 }
@@ -1094,10 +1302,9 @@ static bool _resv_overlap(time_t start_time, time_t end_time,
 			  uint16_t flags, bitstr_t *node_bitmap,
 			  slurmctld_resv_t *this_resv_ptr)
 {
-	ListIterator iter;
-	slurmctld_resv_t *resv_ptr;
+	slurmctld_resv_t *resv_ptr, **resv_array;
 	bool rc = false;
-	int i, j;
+	int i, j, k, resv_cnt;
 	time_t s_time1, s_time2, e_time1, e_time2;
 
 	if ((flags & RESERVE_FLAG_MAINT)   ||
@@ -1105,11 +1312,13 @@ static bool _resv_overlap(time_t start_time, time_t end_time,
 	    (!node_bitmap))
 		return rc;
 
-	iter = list_iterator_create(resv_list);
-	if (!iter)
-		fatal("malloc: list_iterator_create");
-
-	while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+	/* Daily reservations are tested for one week ahead */
+	if (!resv_index_valid)
+		_build_resv_index();
+	resv_cnt = _find_resv_overlap(start_time - ONE_WEEK,
+				      end_time + ONE_WEEK, &resv_array);
+	for (k = 0; ((k < resv_cnt) && (!rc)); k++) {
+		resv_ptr = resv_array[k];
 		if (resv_ptr == this_resv_ptr)
 			continue;	/* skip self */
 		if (resv_ptr->node_bitmap == NULL)
@@ -1141,7 +1350,7 @@ static bool _resv_overlap(time_t start_time, time_t end_time,
 				break;
 		}
 	}
-	list_iterator_destroy(iter);
+	xfree(resv_array);
 
 	return rc;
 }
@@ -1317,8 +1526,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 
 	_generate_resv_id();
 	if (resv_desc_ptr->name) {
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, resv_desc_ptr->name);
+		resv_ptr = _find_resv_name(resv_desc_ptr->name);
 		if (resv_ptr) {
 			info("Reservation request name duplication (%s)",
 			     resv_desc_ptr->name);
@@ -1328,9 +1536,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	} else {
 		while (1) {
 			_generate_resv_name(resv_desc_ptr);
-			resv_ptr = (slurmctld_resv_t *)
-					list_find_first (resv_list,
-					_find_resv_name, resv_desc_ptr->name);
+			resv_ptr = _find_resv_name(resv_desc_ptr->name);
 			if (!resv_ptr)
 				break;
 			_generate_resv_id();	/* makes new suffix */
@@ -1393,6 +1599,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	     resv_ptr->name, name1, val1, name2, val2,
 	     resv_ptr->node_list, start_time, end_time);
 	list_append(resv_list, resv_ptr);
+	resv_index_valid = false;
 	last_resv_update = now;
 	schedule_resv_save();
 
@@ -1416,6 +1623,13 @@ extern void resv_fini(void)
 		list_destroy(resv_list);
 		resv_list = (List) NULL;
 	}
+	xfree(resv_index);
+	xfree(resv_index_end);
+	resv_index_cnt = 0;
+	xfree(resv_id_hash);
+	xfree(resv_name_hash);
+	resv_hash_size = 0;
+	resv_index_valid = false;
 }
 
 /* Update an exiting resource reservation */
@@ -1434,8 +1648,7 @@ extern int update_resv(resv_desc_msg_t *resv_desc_ptr)
 	/* Find the specified reservation */
 	if ((resv_desc_ptr->name == NULL))
 		return ESLURM_RESERVATION_INVALID;
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, resv_desc_ptr->name);
+	resv_ptr = _find_resv_name(resv_desc_ptr->name);
 	if (!resv_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
@@ -1582,6 +1795,7 @@ extern int update_resv(resv_desc_msg_t *resv_desc_ptr)
 				     (resv_desc_ptr->duration * 60);
 	}
 
+	resv_index_valid = false;	/* times may have changed */
 	if (resv_ptr->start_time >= resv_ptr->end_time) {
 		error_code = ESLURM_INVALID_TIME_VALUE;
 		goto update_failure;
@@ -2040,10 +2254,8 @@ static void _validate_all_reservations(void)
 
 		if ((job_ptr->resv_ptr == NULL) ||
 		    (job_ptr->resv_ptr->magic != RESV_MAGIC)) {
-			job_ptr->resv_ptr = (slurmctld_resv_t *)
-					list_find_first(resv_list,
-							_find_resv_name,
-							job_ptr->resv_name);
+			job_ptr->resv_ptr = _find_resv_name(job_ptr->
+							     resv_name);
 		}
 		if (!job_ptr->resv_ptr) {
 			error("JobId %u linked to defunct reservation %s",
@@ -2144,11 +2356,11 @@ static int _open_resv_state_file(char **state_file)
  */
 extern int load_all_resv_state(int recover)
 {
-	char *state_file, *data = NULL, *ver_str = NULL;
+	char *state_file, *ver_str = NULL;
 	time_t now;
-	uint32_t data_size = 0, uint32_tmp;
-	int data_allocated, data_read = 0, error_code = 0, state_fd;
-	Buf buffer;
+	uint32_t uint32_tmp;
+	int error_code = 0, state_fd;
+	Buf buffer = NULL;
 	slurmctld_resv_t *resv_ptr = NULL;
 
 	last_resv_update = time(NULL);
@@ -2171,31 +2383,15 @@ extern int load_all_resv_state(int recover)
 		     state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					BUF_SIZE);
-			if (data_read < 0) {
-				if  (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		if (!(buffer = create_mmap_buf(state_fd)))
+			error("Read error on %s: %m", state_file);
 		close(state_fd);
 	}
 	xfree(state_file);
 	unlock_state_files();
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)
+		buffer = create_buf(NULL, 0);
 
 	safe_unpackstr_xmalloc( &ver_str, &uint32_tmp, buffer);
 	debug3("Version string in resv_state header is %s", ver_str);
@@ -2242,6 +2438,7 @@ extern int load_all_resv_state(int recover)
 		safe_unpack32(&resv_ptr->duration,	buffer);
 
 		list_append(resv_list, resv_ptr);
+		resv_index_valid = false;
 		info("Recovered state of reservation %s", resv_ptr->name);
 	}
 
@@ -2286,8 +2483,7 @@ extern int validate_job_resv(struct job_record *job_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
 	/* Find the named reservation */
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = _find_resv_name(job_ptr->resv_name);
 	if (!resv_ptr) {
 		info("Reservation name not found (%s)", job_ptr->resv_name);
 		return ESLURM_RESERVATION_INVALID;
@@ -2377,10 +2573,9 @@ static int  _select_nodes(resv_desc_msg_t *resv_desc_ptr,
 			  struct part_record **part_ptr,
 			  bitstr_t **resv_bitmap)
 {
-	slurmctld_resv_t *resv_ptr;
+	slurmctld_resv_t *resv_ptr, **resv_array;
 	bitstr_t *node_bitmap;
-	ListIterator iter;
-	int i, rc = SLURM_SUCCESS;
+	int i, resv_cnt, rc = SLURM_SUCCESS;
 	time_t now = time(NULL);
 
 	if (*part_ptr == NULL) {
@@ -2396,21 +2591,19 @@ static int  _select_nodes(resv_desc_msg_t *resv_desc_ptr,
 
 	/* Don't use node already reserved */
 	if (!(resv_desc_ptr->flags & RESERVE_FLAG_OVERLAP)) {
-		iter = list_iterator_create(resv_list);
-		if (!iter)
-			fatal("malloc: list_iterator_create");
-		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
-			if (resv_ptr->end_time <= now)
-				_advance_resv_time(resv_ptr);
-			if ((resv_ptr->node_bitmap == NULL) ||
-			    (resv_ptr->start_time >= resv_desc_ptr->end_time) ||
-			    (resv_ptr->end_time   <= resv_desc_ptr->start_time))
+		_update_resv_index(now);
+		resv_cnt = _find_resv_overlap(resv_desc_ptr->start_time,
+					      resv_desc_ptr->end_time,
+					      &resv_array);
+		for (i = 0; i < resv_cnt; i++) {
+			resv_ptr = resv_array[i];
+			if (resv_ptr->node_bitmap == NULL)
 				continue;
 			bit_not(resv_ptr->node_bitmap);
 			bit_and(node_bitmap, resv_ptr->node_bitmap);
 			bit_not(resv_ptr->node_bitmap);
 		}
-		list_iterator_destroy(iter);
+		xfree(resv_array);
 	}
 
 	/* Satisfy feature specification */
@@ -2653,8 +2846,7 @@ extern int job_test_resv_now(struct job_record *job_ptr)
 	if (job_ptr->resv_name == NULL)
 		return SLURM_SUCCESS;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = _find_resv_name(job_ptr->resv_name);
 	job_ptr->resv_ptr = resv_ptr;
 	if (!resv_ptr)
 		return ESLURM_RESERVATION_INVALID;
@@ -2683,17 +2875,15 @@ extern int job_test_resv_now(struct job_record *job_ptr)
  *	reserved resources. Don't go below job's time_min value. */
 extern void job_time_adj_resv(struct job_record *job_ptr)
 {
-	ListIterator iter;
-	slurmctld_resv_t * resv_ptr;
+	slurmctld_resv_t *resv_ptr, **resv_array;
 	time_t now = time(NULL);
 	int32_t resv_begin_time;
+	int i, resv_cnt;
 
-	iter = list_iterator_create(resv_list);
-	if (!iter)
-		fatal("malloc: list_iterator_create");
-	while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
-		if (resv_ptr->end_time <= now)
-			_advance_resv_time(resv_ptr);
+	_update_resv_index(now);
+	resv_cnt = _find_resv_overlap(now, job_ptr->end_time, &resv_array);
+	for (i = 0; i < resv_cnt; i++) {
+		resv_ptr = resv_array[i];
 		if (job_ptr->resv_ptr == resv_ptr)
 			continue;	/* authorized user of reservation */
 		if (resv_ptr->start_time <= now)
@@ -2709,14 +2899,14 @@ extern void job_time_adj_resv(struct job_record *job_ptr)
 		resv_begin_time = difftime(resv_ptr->start_time, now) / 60;
 		job_ptr->time_limit = MIN(job_ptr->time_limit,resv_begin_time);
 	}
-	list_iterator_destroy(iter);
+	xfree(resv_array);
 	job_ptr->time_limit = MAX(job_ptr->time_limit, job_ptr->time_min);
 	job_ptr->end_time = job_ptr->start_time + (job_ptr->time_limit * 60);
 }
 
 /* For a given license_list, return the total count of licenses of the
- *	specified name */
-static int _license_cnt(List license_list, char *lic_name)
+ *	specified ID */
+static int _license_cnt(List license_list, uint32_t lic_id)
 {
 	int lic_cnt = 0;
 	ListIterator iter;
@@ -2729,7 +2919,7 @@ static int _license_cnt(List license_list, char *lic_name)
 	if (!iter)
 		fatal("list_interator_create malloc failure");
 	while ((license_ptr = list_next(iter))) {
-		if (strcmp(license_ptr->name, lic_name) == 0)
+		if (license_ptr->id == lic_id)
 			lic_cnt += license_ptr->total;
 	}
 	list_iterator_destroy(iter);
@@ -2769,41 +2959,35 @@ static uint32_t _get_job_duration(struct job_record *job_ptr)
  *	prevented from using due to reservations
  *
  * IN job_ptr   - job to test
- * IN lic_name  - name of license
+ * IN lic_id    - ID of license
  * IN when      - when the job is expected to start
  * RET number of licenses of this type the job is prevented from using
  */
-extern int job_test_lic_resv(struct job_record *job_ptr, char *lic_name,
+extern int job_test_lic_resv(struct job_record *job_ptr, uint32_t lic_id,
 			     time_t when)
 {
-	slurmctld_resv_t * resv_ptr;
+	slurmctld_resv_t *resv_ptr, **resv_array;
 	time_t job_start_time, job_end_time, now = time(NULL);
-	ListIterator iter;
-	int resv_cnt = 0;
+	int i, resv_cnt = 0, lic_cnt = 0;
 
 	job_start_time = when;
 	job_end_time   = when + _get_job_duration(job_ptr);
-	iter = list_iterator_create(resv_list);
-	if (!iter)
-		fatal("malloc: list_iterator_create");
-	while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
-		if (resv_ptr->end_time <= now)
-			_advance_resv_time(resv_ptr);
-		if ((resv_ptr->start_time >= job_end_time) ||
-		    (resv_ptr->end_time   <= job_start_time))
-			continue;	/* reservation at different time */
-
+	_update_resv_index(now);
+	resv_cnt = _find_resv_overlap(job_start_time, job_end_time,
+				      &resv_array);
+	for (i = 0; i < resv_cnt; i++) {
+		resv_ptr = resv_array[i];
 		if (job_ptr->resv_name &&
 		    (strcmp(job_ptr->resv_name, resv_ptr->name) == 0))
 			continue;	/* job can use this reservation */
 
-		resv_cnt += _license_cnt(resv_ptr->license_list, lic_name);
+		lic_cnt += _license_cnt(resv_ptr->license_list, lic_id);
 	}
-	list_iterator_destroy(iter);
+	xfree(resv_array);
 
-	/* info("job %u blocked from %d licenses of type %s",
-	     job_ptr->job_id, resv_cnt, lic_name); */
-	return resv_cnt;
+	/* info("job %u blocked from %d licenses of type %u",
+	     job_ptr->job_id, lic_cnt, lic_id); */
+	return lic_cnt;
 }
 
 /*
@@ -2824,11 +3008,10 @@ extern int job_test_lic_resv(struct job_record *job_ptr, char *lic_name,
 extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 			 bool move_time, bitstr_t **node_bitmap)
 {
-	slurmctld_resv_t * resv_ptr, *res2_ptr;
+	slurmctld_resv_t * resv_ptr, *res2_ptr, **resv_array = NULL;
 	time_t job_start_time, job_end_time, lic_resv_time;
 	time_t now = time(NULL);
-	ListIterator iter;
-	int i, rc = SLURM_SUCCESS;
+	int i, j, resv_cnt, rc = SLURM_SUCCESS;
 
 	job_start_time = *when;
 	job_end_time   = *when + _get_job_duration(job_ptr);
@@ -2836,8 +3019,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 
 	if (job_ptr->resv_name) {
 		bool overlap_resv = false;
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, job_ptr->resv_name);
+		resv_ptr = _find_resv_name(job_ptr->resv_name);
 		job_ptr->resv_ptr = resv_ptr;
 		if (!resv_ptr)
 			return ESLURM_RESERVATION_INVALID;
@@ -2878,23 +3060,27 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 
 		/* if there are any overlapping reservations, we need to
 		 * prevent the job from using those nodes (e.g. MAINT nodes) */
-		iter = list_iterator_create(resv_list);
-		if (!iter)
-			fatal("malloc: list_iterator_create");
-		while ((res2_ptr = (slurmctld_resv_t *) list_next(iter))) {
-			if ((resv_ptr->flags & RESERVE_FLAG_MAINT) ||
-			    (resv_ptr->flags & RESERVE_FLAG_OVERLAP) ||
-			    (res2_ptr == resv_ptr) ||
-			    (res2_ptr->node_bitmap == NULL) ||
-			    (res2_ptr->start_time >= job_end_time) ||
-			    (res2_ptr->end_time   <= job_start_time))
+		if ((resv_ptr->flags & RESERVE_FLAG_MAINT) ||
+		    (resv_ptr->flags & RESERVE_FLAG_OVERLAP))
+			resv_cnt = 0;
+		else {
+			if (!resv_index_valid)
+				_build_resv_index();
+			resv_cnt = _find_resv_overlap(job_start_time,
+						      job_end_time,
+						      &resv_array);
+		}
+		for (j = 0; j < resv_cnt; j++) {
+			res2_ptr = resv_array[j];
+			if ((res2_ptr == resv_ptr) ||
+			    (res2_ptr->node_bitmap == NULL))
 				continue;
 			bit_not(res2_ptr->node_bitmap);
 			bit_and(*node_bitmap, res2_ptr->node_bitmap);
 			bit_not(res2_ptr->node_bitmap);
 			overlap_resv = true;
 		}
-		list_iterator_destroy(iter);
+		xfree(resv_array);
 
 		if (slurm_get_debug_flags() & DEBUG_FLAG_RESERVATION) {
 			char *nodes=bitmap2node_name(*node_bitmap);
@@ -2918,15 +3104,12 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 	for (i=0; ; i++) {
 		lic_resv_time = (time_t) 0;
 
-		iter = list_iterator_create(resv_list);
-		if (!iter)
-			fatal("malloc: list_iterator_create");
-		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
-			if (resv_ptr->end_time <= now)
-				_advance_resv_time(resv_ptr);
-			if ((resv_ptr->node_bitmap == NULL) ||
-			    (resv_ptr->start_time >= job_end_time) ||
-			    (resv_ptr->end_time   <= job_start_time))
+		_update_resv_index(now);
+		resv_cnt = _find_resv_overlap(job_start_time, job_end_time,
+					      &resv_array);
+		for (j = 0; j < resv_cnt; j++) {
+			resv_ptr = resv_array[j];
+			if (resv_ptr->node_bitmap == NULL)
 				continue;
 			if (job_ptr->details->req_node_bitmap &&
 			    bit_overlap(job_ptr->details->req_node_bitmap,
@@ -2948,7 +3131,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 			bit_and(*node_bitmap, resv_ptr->node_bitmap);
 			bit_not(resv_ptr->node_bitmap);
 		}
-		list_iterator_destroy(iter);
+		xfree(resv_array);
 
 		if ((rc == SLURM_SUCCESS) && move_time) {
 			if (license_job_test(job_ptr, job_start_time)
@@ -3056,6 +3239,7 @@ static void _advance_resv_time(slurmctld_resv_t *resv_ptr)
 		resv_ptr->start_time_prev = resv_ptr->start_time;
 		resv_ptr->start_time_first = resv_ptr->start_time;
 		_advance_time(&resv_ptr->end_time, day_cnt);
+		resv_index_valid = false;
 		_post_resv_create(resv_ptr);
 		last_resv_update = time(NULL);
 		schedule_resv_save();
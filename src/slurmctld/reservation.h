@@ -102,11 +102,11 @@ extern int validate_job_resv(struct job_record *job_ptr);
  *	prevented from using due to reservations
  *
  * IN job_ptr   - job to test
- * IN lic_name  - name of license
+ * IN lic_id    - ID of license
  * IN when      - when the job is expected to start
  * RET number of licenses of this type the job is prevented from using
  */
-extern int job_test_lic_resv(struct job_record *job_ptr, char *lic_name,
+extern int job_test_lic_resv(struct job_record *job_ptr, uint32_t lic_id,
 			     time_t when);
 
 /*
@@ -227,6 +227,8 @@ typedef struct front_end_record {
 					 * clear after logging this */
 	slurm_addr_t slurm_addr;	/* network address */
 	uint16_t port;			/* frontend specific port */
+	uint16_t protocol_version;	/* slurmd's protocol version from
+					 * its registration, 0 if unknown */
 	char *reason;			/* reason for down frontend node */
 	time_t reason_time;		/* Time stamp when reason was set,
 					 * ignore if no reason is set. */
@@ -280,6 +282,9 @@ struct part_record {
 
 extern List part_list;			/* list of part_record entries */
 extern time_t last_part_update;		/* time of last part_list update */
+extern uint32_t node_config_gen;	/* changed with node or partition
+					 * configuration which affects the
+					 * nodes usable by a job */
 extern struct part_record default_part;	/* default configuration values */
 extern char *default_part_name;		/* name of default partition */
 extern struct part_record *default_part_loc;	/* default partition ptr */
@@ -358,6 +363,9 @@ struct job_details {
 	uint16_t cpu_bind_type;		/* see cpu_bind_type_t */
 	uint16_t cpus_per_task;		/* number of processors required for
 					 * each task */
+	bool depend_blocked;		/* dependencies were tested and remain,
+					 * cleared when a job depended upon
+					 * changes state */
 	List depend_list;		/* list of job_ptr:state pairs */
 	char *dependency;		/* wait for other jobs */
 	char *orig_dependency;		/* original value (for archiving) */
@@ -370,6 +378,10 @@ struct job_details {
 	List feature_list;		/* required features with
 					 * node counts */
 	char *features;			/* required features */
+	uint32_t lazy_offset;		/* offset of std_err, std_in, std_out
+					 * and env_sup in the job state file
+					 * while not yet decoded */
+	uint32_t lazy_size;		/* size of that data, 0 if decoded */
 	uint32_t magic;			/* magic cookie for data integrity */
 	uint32_t max_cpus;		/* maximum number of cpus */
 	uint32_t max_nodes;		/* maximum number of nodes */
@@ -380,6 +392,8 @@ struct job_details {
 	uint32_t min_nodes;		/* minimum number of nodes */
 	uint16_t nice;		        /* requested priority change,
 					 * NICE_OFFSET == no change */
+	struct node_set_cache *node_set_cache; /* usable node sets cached by
+					 * node_scheduler.c while pending */
 	uint16_t ntasks_per_node;	/* number of tasks on each node */
 	uint32_t num_tasks;		/* number of tasks to start */
 	uint8_t open_mode;		/* stdout/err append or trunctate */
@@ -424,6 +438,14 @@ struct job_record {
 	char    *alloc_node;		/* local node making resource alloc */
 	uint16_t alloc_resp_port;	/* RESPONSE_RESOURCE_ALLOCATION port */
 	uint32_t alloc_sid;		/* local sid making resource alloc */
+	uint32_t array_job_id;		/* job_id of a job array or 0 if N/A */
+	struct job_record *array_next;	/* next entry with same array_job_id
+					 * hash index */
+	bitstr_t *array_task_bitmap;	/* task_ids of a job array which have
+					 * not yet been started, set only for
+					 * the pending job array record */
+	uint32_t array_task_id;		/* task_id of a job array element,
+					 * NO_VAL for the pending record */
 	uint32_t assoc_id;              /* used for accounting plugins */
 	void    *assoc_ptr;		/* job's association record ptr, it is
 					 * void* because of interdependencies
@@ -452,6 +474,8 @@ struct job_record {
 	uint32_t db_index;              /* used only for database
 					 * plugins */
 	uint32_t derived_ec;		/* highest exit code of all job steps */
+	struct depend_spec *depend_rev;	/* dependencies of other jobs upon
+					 * this job */
 	struct job_details *details;	/* job details */
 	uint16_t direct_set_prio;	/* Priority set directly if
 					 * set the system will not
@@ -487,6 +511,8 @@ struct job_record {
 	char *mail_user;		/* user to get e-mail notification */
 	uint32_t magic;			/* magic cookie for data integrity */
 	char *name;			/* name of the job */
+	struct job_record *name_next;	/* next entry with same user_id and
+					 * name hash index */
 	char *network;			/* network/switch requirement spec */
 	uint32_t next_step_id;		/* next step id to be used */
 	char *nodes;			/* list of nodes allocated to job */
@@ -576,7 +602,11 @@ struct job_record {
 struct	depend_spec {
 	uint16_t	depend_type;	/* SLURM_DEPEND_* type */
 	uint32_t	job_id;		/* SLURM job_id */
-	struct job_record *job_ptr;	/* pointer to this job */
+	struct job_record *job_ptr;	/* pointer to this job, NULL once
+					 * purged */
+	struct job_record *depend_job_ptr; /* job having this dependency */
+	struct depend_spec *rev_next;	/* next dependency upon job_ptr */
+	struct depend_spec *rev_prev;	/* previous dependency upon job_ptr */
 };
 
 struct 	step_record {
@@ -705,6 +735,15 @@ extern struct part_record *create_part_record (void);
  */
 extern int job_limits_check(struct job_record **job_pptr);
 
+/*
+ * decode_job_launch_details - unpack a job's std_err, std_in, std_out and
+ *	env_sup, which load_all_job_state() leaves in the job state file
+ *	until used. Call before using any of them.
+ * IN detail_ptr - pointer to the job's details, may be NULL
+ * NOTE: Job write lock must be set before calling
+ */
+extern void decode_job_launch_details(struct job_details *detail_ptr);
+
 /*
  * delete_job_details - delete a job's detail record and clear it's pointer
  *	this information can be deleted as soon as the job is allocated
@@ -792,6 +831,54 @@ extern void excise_node_from_job(struct job_record *job_ptr,
  */
 extern struct job_record *find_job_record (uint32_t job_id);
 
+/*
+ * find_job_array_pending - return the record of a job array holding the
+ *	tasks not yet started
+ * IN array_job_id - job ID of the job array
+ * RET pointer to the job array's pending record, NULL if none remains
+ * global: job_array_hash - hash table of job records by array_job_id
+ */
+extern struct job_record *find_job_array_pending(uint32_t array_job_id);
+
+/*
+ * find_next_job_array - iterate over the records of a job array
+ * IN array_job_id - job ID of the job array
+ * IN job_ptr - job last returned or NULL to get the first job
+ * RET pointer to the next record of the job array, NULL when none remain
+ * global: job_array_hash - hash table of job records by array_job_id
+ */
+extern struct job_record *find_next_job_array(uint32_t array_job_id,
+					      struct job_record *job_ptr);
+
+/*
+ * find_next_job_user_name - iterate over the jobs of a user with a given name
+ * IN user_id - job owner
+ * IN name - job name
+ * IN job_ptr - job last returned or NULL to get the first job
+ * RET pointer to the next matching job record, NULL when none remain
+ * global: job_name_hash - hash table of job records by user_id and name
+ */
+extern struct job_record *find_next_job_user_name(uint32_t user_id,
+						  char *name,
+						  struct job_record *job_ptr);
+
+/*
+ * add_job_singleton_depend - change the count of singleton dependencies held
+ *	by the jobs of a user with a given name
+ * IN job_ptr - job whose singleton dependencies were added or removed
+ * IN cnt - number added, negative if removed
+ */
+extern void add_job_singleton_depend(struct job_record *job_ptr, int cnt);
+
+/*
+ * test_job_singleton_depend - test if any job of a user with a given name
+ *	may hold a singleton dependency
+ * IN user_id - job owner
+ * IN name - job name
+ * RET false if none does, true may be a false positive
+ */
+extern bool test_job_singleton_depend(uint32_t user_id, char *name);
+
 /*
  * find_first_node_record - find a record for first node in the bitmap
  * IN node_bitmap
@@ -933,6 +1020,27 @@ extern int job_allocate(job_desc_msg_t * job_specs, int immediate,
 		int will_run, will_run_response_msg_t **resp,
 		int allocate, uid_t submit_uid, struct job_record **job_pptr);
 
+/*
+ * job_array_signal - signal every record of a job array, or the specified
+ *	job if job_id does not identify a job array
+ * IN job_id - array_job_id of the job array or job_id of a job
+ * IN signal - signal to send, SIGKILL == cancel the job
+ * IN batch_flag - signal batch shell only if set
+ * IN uid - uid of requesting user
+ * RET 0 on success, otherwise ESLURM error code
+ */
+extern int job_array_signal(uint32_t job_id, uint16_t signal,
+			    uint16_t batch_flag, uid_t uid);
+
+/*
+ * job_array_split - job_ptr is the pending record of a job array and is
+ *	about to be started. Assign it the lowest pending task_id and move
+ *	the remaining task_ids into a new pending record.
+ * IN job_ptr - pointer to the job array's pending record
+ * NOTE: lock_slurmctld on entry: Read config Write job, Write node, Read part
+ */
+extern void job_array_split(struct job_record *job_ptr);
+
 /*
  * job_cancel_by_assoc_id - Cancel all pending and running jobs with a given
  *	association ID. This happens when an association is deleted (e.g. when
@@ -1071,6 +1179,21 @@ extern int job_step_checkpoint_comp(checkpoint_comp_msg_t *ckpt_ptr,
 extern int job_step_checkpoint_task_comp(checkpoint_task_comp_msg_t *ckpt_ptr,
                 uid_t uid, slurm_fd_t conn_fd, uint16_t protocol_version);
 
+/*
+ * job_suspend_batch_begin - gather the suspend and resume requests for the
+ *	nodes of the jobs acted upon by job_suspend() until
+ *	job_suspend_batch_end() is called, rather than queueing an agent
+ *	request for each job
+ */
+extern void job_suspend_batch_begin(void);
+
+/*
+ * job_suspend_batch_end - send the requests gathered since
+ *	job_suspend_batch_begin() as a single agent request to the union
+ *	of the jobs' nodes
+ */
+extern void job_suspend_batch_end(void);
+
 /*
  * job_suspend - perform some suspend/resume operation
  * IN sus_ptr - suspend/resume request message
@@ -1744,6 +1867,21 @@ extern int validate_alloc_node(struct part_record *part_ptr, char* alloc_node);
  */
 extern int validate_group (struct part_record *part_ptr, uid_t run_uid);
 
+/*
+ * validate_jobs_batch_begin - index the active jobs on a set of nodes about
+ *	to register together, so that validate_jobs_on_node() reconciles
+ *	them without a full job list scan per node
+ * IN node_bitmap - nodes in the registration batch, must remain valid
+ *	until validate_jobs_batch_end() is called
+ */
+extern void validate_jobs_batch_begin(bitstr_t *node_bitmap);
+
+/*
+ * validate_jobs_batch_end - release the index built by
+ *	validate_jobs_batch_begin()
+ */
+extern void validate_jobs_batch_end(void);
+
 /*
  * validate_jobs_on_node - validate that any jobs that should be on the node
  *	are actually running, if not clean up the job records and/or node
@@ -1753,6 +1891,28 @@ extern int validate_group (struct part_record *part_ptr, uid_t run_uid);
  */
 extern void validate_jobs_on_node(slurm_node_registration_status_msg_t *reg_msg);
 
+/*
+ * validate_node_registration - process a node registration message, either
+ *	sent by the slurmd as an RPC or returned as its reply to a
+ *	REQUEST_NODE_REGISTRATION_STATUS gathered through the forwarding tree
+ * IN reg_msg - node registration message
+ * RET 0 if no error, SLURM error code otherwise
+ * NOTE: READ lock_slurmctld config, WRITE job and node before entry
+ */
+extern int validate_node_registration(
+		slurm_node_registration_status_msg_t *reg_msg);
+
+/*
+ * validate_node_registrations - process a batch of node registration
+ *	messages under a single lock acquisition, reconciling the jobs on
+ *	all of the nodes with one pass over the job list
+ * IN reg_msgs - node registration messages
+ * IN reg_cnt - number of entries in reg_msgs
+ * NOTE: READ lock_slurmctld config, WRITE job and node before entry
+ */
+extern void validate_node_registrations(
+		slurm_node_registration_status_msg_t **reg_msgs, int reg_cnt);
+
 /*
  * validate_node_specs - validate the node's specifications as valid,
  *	if not set state to down, in any case update last_response
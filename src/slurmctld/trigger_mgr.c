@@ -56,6 +56,7 @@
 #include "src/common/list.h"
 #include "src/common/slurmdbd_defs.h"
 #include "src/common/slurm_protocol_defs.h"
+#include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -66,6 +67,7 @@
 #include "src/slurmctld/trigger_mgr.h"
 
 #define MAX_PROG_TIME 300	/* maximum run time for program */
+#define TRIG_JOB_HASH_SIZE 1024	/* buckets in job trigger index */
 
 /* Change TRIGGER_STATE_VERSION value when changing the state save format */
 #define TRIGGER_STATE_VERSION      "VER003"
@@ -114,17 +116,103 @@ typedef struct trig_mgr_info {
 	uint32_t group_id;	/* user's group id (pending) or pid (complete) */
 	char *   program;	/* program to execute */
 	uint8_t  state;		/* 0=pending, 1=pulled, 2=completed */
+	bool     active;	/* on trig_active_list */
+	bool     purge;		/* remove from trigger_list */
+	struct trig_mgr_info *job_next;	/* next in trig_job_hash chain */
+	struct trig_mgr_info **job_pprev; /* link to this in the chain */
 } trig_mgr_info_t;
 
+/* Pending job triggers are indexed by job ID in trig_job_hash and are
+ * evaluated only when an event touches their job: the job ends (see
+ * trigger_job_fini) or a node or front end changes state. All other
+ * triggers (non-job triggers, job time triggers and triggers which have
+ * been pulled) are on trig_active_list and are examined every cycle. */
+static trig_mgr_info_t **trig_job_hash = NULL;
+static List trig_active_list = NULL;
+static uint32_t *trig_fini_job_id = NULL;	/* ended jobs with triggers */
+static int trig_fini_job_cnt = 0, trig_fini_job_size = 0;
+static bool trig_job_scan = false;	/* test all job triggers */
+static int trig_purge_cnt = 0;		/* triggers of purged jobs */
+
+static int _find_trig_ptr(void *x, void *key)
+{
+	return (x == key);
+}
+
+static int _trig_purge_test(void *x, void *key)
+{
+	trig_mgr_info_t *trig_ptr = (trig_mgr_info_t *) x;
+
+	return trig_ptr->purge;
+}
+
 /* Prototype for ListDelF */
 void _trig_del(void *x) {
 	trig_mgr_info_t * tmp = (trig_mgr_info_t *) x;
+
+	/* A job's triggers all share one chain, unlink without walking it */
+	if (tmp->job_pprev) {
+		*tmp->job_pprev = tmp->job_next;
+		if (tmp->job_next)
+			tmp->job_next->job_pprev = tmp->job_pprev;
+	}
+	if (tmp->active && trig_active_list)
+		list_delete_all(trig_active_list, _find_trig_ptr, tmp);
 	xfree(tmp->res_id);
 	xfree(tmp->program);
 	FREE_NULL_BITMAP(tmp->nodes_bitmap);
 	xfree(tmp);
 }
 
+/* Create the trigger list and its indexes as needed */
+static void _trig_init(void)
+{
+	if (trigger_list == NULL) {
+		trigger_list = list_create(_trig_del);
+		if (trigger_list == NULL)
+			fatal("list_create: malloc failure");
+	}
+	if (trig_active_list == NULL) {
+		trig_active_list = list_create(NULL);
+		if (trig_active_list == NULL)
+			fatal("list_create: malloc failure");
+	}
+	if (trig_job_hash == NULL) {
+		trig_job_hash = xmalloc(sizeof(trig_mgr_info_t *) *
+					TRIG_JOB_HASH_SIZE);
+	}
+}
+
+/* Move a trigger onto the list examined every cycle */
+static void _trig_activate(trig_mgr_info_t *trig_ptr)
+{
+	if (trig_ptr->active)
+		return;
+	list_append(trig_active_list, trig_ptr);
+	trig_ptr->active = true;
+}
+
+/* Add a trigger to trigger_list and index it */
+static void _trig_add(trig_mgr_info_t *trig_ptr)
+{
+	int inx;
+
+	_trig_init();
+	list_append(trigger_list, trig_ptr);
+	if (trig_ptr->res_type == TRIGGER_RES_TYPE_JOB) {
+		inx = trig_ptr->job_id % TRIG_JOB_HASH_SIZE;
+		trig_ptr->job_next = trig_job_hash[inx];
+		if (trig_ptr->job_next)
+			trig_ptr->job_next->job_pprev = &trig_ptr->job_next;
+		trig_ptr->job_pprev = &trig_job_hash[inx];
+		trig_job_hash[inx] = trig_ptr;
+	}
+	if ((trig_ptr->state != 0) ||
+	    (trig_ptr->res_type != TRIGGER_RES_TYPE_JOB) ||
+	    (trig_ptr->trig_type & TRIGGER_TYPE_TIME))
+		_trig_activate(trig_ptr);
+}
+
 static int _trig_offset(uint16_t offset)
 {
 	static int rc;
@@ -200,11 +288,7 @@ extern int trigger_pull(trigger_info_msg_t *msg)
 	trigger_info_t *trig_in;
 	trig_mgr_info_t *trig_test;
 
-	if (trigger_list == NULL) {
-		trigger_list = list_create(_trig_del);
-		if (trigger_list == NULL)
-			fatal("list_create: malloc failure");
-	}
+	_trig_init();
 
 	/* validate the request, designated trigger must be set */
 	_dump_trigger_msg("trigger_pull", msg);
@@ -270,8 +354,7 @@ extern int trigger_clear(uid_t uid, trigger_info_msg_t *msg)
 	uint32_t job_id = 0;
 
 	slurm_mutex_lock(&trigger_mutex);
-	if (trigger_list == NULL)
-		trigger_list = list_create(_trig_del);
+	_trig_init();
 
 	/* validate the request, need a job_id and/or trigger_id */
 	_dump_trigger_msg("trigger_clear", msg);
@@ -323,8 +406,7 @@ extern trigger_info_msg_t * trigger_get(uid_t uid, trigger_info_msg_t *msg)
 	int recs_written = 0;
 
 	slurm_mutex_lock(&trigger_mutex);
-	if (trigger_list == NULL)
-		trigger_list = list_create(_trig_del);
+	_trig_init();
 
 	_dump_trigger_msg("trigger_get", NULL);
 	resp_data = xmalloc(sizeof(trigger_info_msg_t));
@@ -335,7 +417,7 @@ extern trigger_info_msg_t * trigger_get(uid_t uid, trigger_info_msg_t *msg)
 	trig_out = resp_data->trigger_array;
 	while ((trig_in = list_next(trig_iter))) {
 		/* Note: Filtering currently done by strigger */
-		if (trig_in->state >= 1)
+		if ((trig_in->state >= 1) || trig_in->purge)
 			continue;	/* no longer pending */
 		trig_out->trig_id   = trig_in->trig_id;
 		trig_out->res_type  = trig_in->res_type;
@@ -382,10 +464,9 @@ extern int trigger_set(uid_t uid, gid_t gid, trigger_info_msg_t *msg)
 		goto fini;
 	}
 
-	if (trigger_list == NULL) {
-		trigger_list = list_create(_trig_del);
-	} else if ((uid != 0) &&
-		   (list_count(trigger_list) >= slurmctld_conf.max_job_cnt)) {
+	_trig_init();
+	if ((uid != 0) &&
+	    (list_count(trigger_list) >= slurmctld_conf.max_job_cnt)) {
 		rc = EAGAIN;
 		goto fini;
 	}
@@ -441,7 +522,7 @@ extern int trigger_set(uid_t uid, gid_t gid, trigger_info_msg_t *msg)
 			xfree(trig_add);
 			continue;
 		}
-		list_append(trigger_list, trig_add);
+		_trig_add(trig_add);
 		schedule_trigger_save();
 	}
 
@@ -517,6 +598,66 @@ extern void trigger_node_up(struct node_record *node_ptr)
 	slurm_mutex_unlock(&trigger_mutex);
 }
 
+/* Have the triggers of an ended job tested on the next cycle */
+static void _trig_fini_job_add(uint32_t job_id)
+{
+	if (trig_fini_job_cnt >= trig_fini_job_size) {
+		trig_fini_job_size = MAX(64, trig_fini_job_size * 2);
+		xrealloc(trig_fini_job_id, sizeof(uint32_t) *
+			 trig_fini_job_size);
+	}
+	trig_fini_job_id[trig_fini_job_cnt++] = job_id;
+}
+
+extern void trigger_job_fini(struct job_record *job_ptr)
+{
+	trig_mgr_info_t *trig_ptr = NULL;
+
+	slurm_mutex_lock(&trigger_mutex);
+	if (trig_job_hash) {
+		trig_ptr = trig_job_hash[job_ptr->job_id % TRIG_JOB_HASH_SIZE];
+		while (trig_ptr && (trig_ptr->job_id != job_ptr->job_id))
+			trig_ptr = trig_ptr->job_next;
+	}
+	if (trig_ptr)
+		_trig_fini_job_add(job_ptr->job_id);
+	slurm_mutex_unlock(&trigger_mutex);
+}
+
+/* The job record is going away: its pending fini triggers fire on the
+ * next cycle, its other pending triggers can never fire and are
+ * removed then */
+extern void trigger_job_purge(struct job_record *job_ptr)
+{
+	trig_mgr_info_t *trig_ptr;
+	bool fini = false;
+
+	slurm_mutex_lock(&trigger_mutex);
+	if (trig_job_hash) {
+		for (trig_ptr = trig_job_hash[job_ptr->job_id %
+					      TRIG_JOB_HASH_SIZE];
+		     trig_ptr; trig_ptr = trig_ptr->job_next) {
+			if ((trig_ptr->job_id != job_ptr->job_id) ||
+			    trig_ptr->active || trig_ptr->purge)
+				continue;
+			trig_ptr->job_ptr = NULL;
+			if (trig_ptr->trig_type & TRIGGER_TYPE_FINI) {
+				fini = true;
+				continue;
+			}
+			if (slurm_get_debug_flags() & DEBUG_FLAG_TRIGGERS) {
+				info("trigger[%u] for purged job %u",
+				     trig_ptr->trig_id, trig_ptr->job_id);
+			}
+			trig_ptr->purge = true;
+			trig_purge_cnt++;
+		}
+	}
+	if (fini)
+		_trig_fini_job_add(job_ptr->job_id);
+	slurm_mutex_unlock(&trigger_mutex);
+}
+
 extern void trigger_reconfig(void)
 {
 	slurm_mutex_lock(&trigger_mutex);
@@ -709,9 +850,7 @@ static int _load_trigger_state(Buf buffer, uint16_t protocol_version)
 	}
 
 	slurm_mutex_lock(&trigger_mutex);
-	if (trigger_list == NULL)
-		trigger_list = list_create(_trig_del);
-	list_append(trigger_list, trig_ptr);
+	_trig_add(trig_ptr);
 	next_trigger_id = MAX(next_trigger_id, trig_ptr->trig_id + 1);
 	slurm_mutex_unlock(&trigger_mutex);
 
@@ -744,8 +883,7 @@ extern int trigger_state_save(void)
 
 	/* write individual trigger records */
 	slurm_mutex_lock(&trigger_mutex);
-	if (trigger_list == NULL)
-		trigger_list = list_create(_trig_del);
+	_trig_init();
 
 	trig_iter = list_iterator_create(trigger_list);
 	while ((trig_in = list_next(trig_iter)))
@@ -844,12 +982,11 @@ static int _open_resv_state_file(char **state_file)
 
 extern int trigger_state_restore(void)
 {
-	int data_allocated, data_read = 0, error_code = 0;
-	uint32_t data_size = 0;
+	int error_code = 0;
 	uint16_t protocol_version = (uint16_t) NO_VAL;
 	int state_fd, trigger_cnt = 0;
-	char *data = NULL, *state_file;
-	Buf buffer;
+	char *state_file;
+	Buf buffer = NULL;
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
@@ -861,31 +998,15 @@ extern int trigger_state_restore(void)
 		info("No trigger state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		if (!(buffer = create_mmap_buf(state_fd)))
+			error("Read error on %s: %m", state_file);
 		close(state_fd);
 	}
 	xfree(state_file);
 	unlock_state_files();
 
-	buffer = create_buf(data, data_size);
+	if (!buffer)
+		buffer = create_buf(NULL, 0);
 	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
 	if (ver_str) {
 		if (!strcmp(ver_str, TRIGGER_STATE_VERSION)) {
@@ -907,6 +1028,8 @@ extern int trigger_state_restore(void)
 	safe_unpack_time(&buf_time, buffer);
 	if (trigger_list)
 		list_delete_all (trigger_list, _match_all_triggers, NULL);
+	/* Jobs may have ended while we were down */
+	trig_job_scan = true;
 	while (remaining_buf(buffer) > 0) {
 		error_code = _load_trigger_state(buffer, protocol_version);
 		if (error_code != SLURM_SUCCESS)
@@ -947,7 +1070,7 @@ static void _trigger_job_event(trig_mgr_info_t *trig_in, time_t now)
 	if ((trig_in->job_ptr == NULL) ||
 	    (trig_in->job_ptr->magic != JOB_MAGIC) ||
 	    (trig_in->job_ptr->job_id != trig_in->job_id))
-		trig_in->job_ptr = find_job_record(trig_in->job_ptr->job_id);
+		trig_in->job_ptr = find_job_record(trig_in->job_id);
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_FINI) &&
 	    ((trig_in->job_ptr == NULL) ||
@@ -1472,6 +1595,73 @@ static void _trigger_run_program(trig_mgr_info_t *trig_in)
 		error("fork: %m");
 }
 
+/* Return true if a node or front end event may pull a job trigger */
+static bool _job_node_event(void)
+{
+	if (trigger_down_front_end_bitmap &&
+	    (bit_ffs(trigger_down_front_end_bitmap) != -1))
+		return true;
+	if (trigger_down_nodes_bitmap &&
+	    (bit_ffs(trigger_down_nodes_bitmap) != -1))
+		return true;
+	if (trigger_fail_nodes_bitmap &&
+	    (bit_ffs(trigger_fail_nodes_bitmap) != -1))
+		return true;
+	if (trigger_up_nodes_bitmap &&
+	    (bit_ffs(trigger_up_nodes_bitmap) != -1))
+		return true;
+	return false;
+}
+
+/* Test the indexed job triggers which are touched by events since the
+ * last cycle. Pulled triggers move to trig_active_list. */
+static void _trigger_job_events(time_t now)
+{
+	trig_mgr_info_t *trig_in;
+	struct job_record *job_ptr;
+	uint32_t job_id, node_types;
+	int i, j;
+
+	node_types = TRIGGER_TYPE_DOWN | TRIGGER_TYPE_FAIL | TRIGGER_TYPE_UP;
+	if (!trig_job_scan && !_job_node_event())
+		node_types = 0;
+	if (trig_job_scan || node_types) {
+		for (i = 0; i < TRIG_JOB_HASH_SIZE; i++) {
+			for (trig_in = trig_job_hash[i]; trig_in;
+			     trig_in = trig_in->job_next) {
+				if (trig_in->active || trig_in->purge)
+					continue;
+				if (!trig_job_scan &&
+				    !(trig_in->trig_type & node_types))
+					continue;
+				_trigger_job_event(trig_in, now);
+				if (trig_in->state != 0)
+					_trig_activate(trig_in);
+			}
+		}
+		trig_job_scan = false;
+	}
+
+	for (i = 0, j = 0; i < trig_fini_job_cnt; i++) {
+		job_id = trig_fini_job_id[i];
+		for (trig_in = trig_job_hash[job_id % TRIG_JOB_HASH_SIZE];
+		     trig_in; trig_in = trig_in->job_next) {
+			if ((trig_in->job_id != job_id) || trig_in->active ||
+			    trig_in->purge)
+				continue;
+			_trigger_job_event(trig_in, now);
+			if (trig_in->state != 0)
+				_trig_activate(trig_in);
+		}
+		/* Fini triggers wait for the job to finish completing */
+		job_ptr = find_job_record(job_id);
+		if (job_ptr && IS_JOB_FINISHED(job_ptr) &&
+		    IS_JOB_COMPLETING(job_ptr))
+			trig_fini_job_id[j++] = job_id;
+	}
+	trig_fini_job_cnt = j;
+}
+
 static void _clear_event_triggers(void)
 {
 	if (trigger_down_front_end_bitmap) {
@@ -1490,6 +1680,10 @@ static void _clear_event_triggers(void)
 		bit_nclear(trigger_drained_nodes_bitmap,
 			   0, (bit_size(trigger_drained_nodes_bitmap) - 1));
 	}
+	if (trigger_fail_nodes_bitmap) {
+		bit_nclear(trigger_fail_nodes_bitmap,
+			   0, (bit_size(trigger_fail_nodes_bitmap) - 1));
+	}
 	if (trigger_up_nodes_bitmap) {
 		bit_nclear(trigger_up_nodes_bitmap,
 			   0, (bit_size(trigger_up_nodes_bitmap) - 1));
@@ -1516,13 +1710,15 @@ extern void trigger_process(void)
 	time_t now = time(NULL);
 	bool state_change = false;
 	pid_t rc;
-	int prog_stat;
+	int prog_stat, purge_cnt = 0;
+	DEF_TIMERS;
 
+	START_TIMER;
 	slurm_mutex_lock(&trigger_mutex);
-	if (trigger_list == NULL)
-		trigger_list = list_create(_trig_del);
+	_trig_init();
+	_trigger_job_events(now);
 
-	trig_iter = list_iterator_create(trigger_list);
+	trig_iter = list_iterator_create(trig_active_list);
 	while ((trig_in = list_next(trig_iter))) {
 		if (trig_in->state == 0) {
 			if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
@@ -1583,6 +1779,9 @@ extern void trigger_process(void)
 					     trig_in->trig_id);
 				}
 				list_delete_item(trig_iter);
+				trig_in->active = false;
+				trig_in->purge = true;
+				purge_cnt++;
 				state_change = true;
 			}
 		} else if (trig_in->state == 2) {
@@ -1603,7 +1802,19 @@ extern void trigger_process(void)
 		}
 	}
 	list_iterator_destroy(trig_iter);
+	if (purge_cnt || trig_purge_cnt) {
+		list_delete_all(trigger_list, _trig_purge_test, NULL);
+		if (trig_purge_cnt)
+			state_change = true;
+		trig_purge_cnt = 0;
+	}
 	_clear_event_triggers();
+	END_TIMER2("trigger_process");
+	if (slurm_get_debug_flags() & DEBUG_FLAG_TRIGGERS) {
+		info("trigger_process: %d triggers, %d active, %s",
+		     list_count(trigger_list), list_count(trig_active_list),
+		     TIME_STR);
+	}
 	slurm_mutex_unlock(&trigger_mutex);
 	if (state_change)
 		schedule_trigger_save();
@@ -1612,6 +1823,10 @@ extern void trigger_process(void)
 /* Free all allocated memory */
 extern void trigger_fini(void)
 {
+	if (trig_active_list != NULL) {
+		list_destroy(trig_active_list);
+		trig_active_list = NULL;
+	}
 	if (trigger_list != NULL) {
 		list_destroy(trigger_list);
 		trigger_list = NULL;
@@ -1622,4 +1837,7 @@ extern void trigger_fini(void)
 	FREE_NULL_BITMAP(trigger_drained_nodes_bitmap);
 	FREE_NULL_BITMAP(trigger_fail_nodes_bitmap);
 	FREE_NULL_BITMAP(trigger_up_nodes_bitmap);
+	xfree(trig_job_hash);
+	xfree(trig_fini_job_id);
+	trig_fini_job_cnt = trig_fini_job_size = 0;
 }
@@ -56,6 +56,8 @@ extern int trigger_pull(trigger_info_msg_t *msg);
 extern void trigger_block_error(void);
 extern void trigger_front_end_down(front_end_record_t *front_end_ptr);
 extern void trigger_front_end_up(front_end_record_t *front_end_ptr);
+extern void trigger_job_fini(struct job_record *job_ptr);
+extern void trigger_job_purge(struct job_record *job_ptr);
 extern void trigger_node_down(struct node_record *node_ptr);
 extern void trigger_node_drained(struct node_record *node_ptr);
 extern void trigger_node_failing(struct node_record *node_ptr);
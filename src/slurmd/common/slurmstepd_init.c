@@ -60,6 +60,15 @@ extern void pack_slurmd_conf_lite(slurmd_conf_t *conf, Buf buffer)
 	pack16(conf->task_plugin_param, buffer);
 	packstr(conf->node_topo_addr, buffer);
 	packstr(conf->node_topo_pattern, buffer);
+	/* node topology, so that slurmstepd does not probe it again */
+	pack16(conf->actual_cpus, buffer);
+	pack16(conf->actual_sockets, buffer);
+	pack16(conf->actual_cores, buffer);
+	pack16(conf->actual_threads, buffer);
+	pack16_array(conf->block_map, conf->block_map_size, buffer);
+	pack16_array(conf->block_map_inv, conf->block_map_size, buffer);
+	pack16_array(conf->numa_map,
+		     conf->numa_map ? conf->block_map_size : 0, buffer);
 }
 
 extern int unpack_slurmd_conf_lite_no_alloc(slurmd_conf_t *conf, Buf buffer)
@@ -88,6 +97,20 @@ extern int unpack_slurmd_conf_lite_no_alloc(slurmd_conf_t *conf, Buf buffer)
 	safe_unpack16(&conf->task_plugin_param, buffer);
 	safe_unpackstr_xmalloc(&conf->node_topo_addr, &uint32_tmp, buffer);
 	safe_unpackstr_xmalloc(&conf->node_topo_pattern, &uint32_tmp, buffer);
+	safe_unpack16(&conf->actual_cpus, buffer);
+	safe_unpack16(&conf->actual_sockets, buffer);
+	safe_unpack16(&conf->actual_cores, buffer);
+	safe_unpack16(&conf->actual_threads, buffer);
+	safe_unpack16_array(&conf->block_map, &uint32_tmp, buffer);
+	conf->block_map_size = uint32_tmp;
+	safe_unpack16_array(&conf->block_map_inv, &uint32_tmp, buffer);
+	if (uint32_tmp != conf->block_map_size)
+		goto unpack_error;
+	safe_unpack16_array(&conf->numa_map, &uint32_tmp, buffer);
+	if (uint32_tmp == 0)
+		xfree(conf->numa_map);
+	else if (uint32_tmp != conf->block_map_size)
+		goto unpack_error;
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -100,5 +123,9 @@ unpack_error:
 	xfree(conf->task_epilog);
 	xfree(conf->node_topo_addr);
 	xfree(conf->node_topo_pattern);
+	xfree(conf->block_map);
+	xfree(conf->block_map_inv);
+	xfree(conf->numa_map);
+	conf->block_map_size = 0;
 	return SLURM_ERROR;
 }
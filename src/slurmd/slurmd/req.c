@@ -144,6 +144,9 @@ static void _rpc_timelimit(slurm_msg_t *);
 static void _rpc_reattach_tasks(slurm_msg_t *);
 static void _rpc_signal_job(slurm_msg_t *);
 static void _rpc_suspend_job(slurm_msg_t *);
+static void _rpc_suspend_batch(slurm_msg_t *msg);
+static void _suspend_job_steps(uint32_t job_id, uint16_t op,
+			       bool launch_sleep);
 static void _rpc_terminate_job(slurm_msg_t *);
 static void _rpc_update_time(slurm_msg_t *);
 static void _rpc_shutdown(slurm_msg_t *msg);
@@ -151,6 +154,7 @@ static void _rpc_reconfig(slurm_msg_t *msg);
 static void _rpc_pid2jid(slurm_msg_t *msg);
 static int  _rpc_file_bcast(slurm_msg_t *msg);
 static int  _rpc_ping(slurm_msg_t *);
+static int  _rpc_node_registration(slurm_msg_t *);
 static int  _rpc_health_check(slurm_msg_t *);
 static int  _rpc_step_complete(slurm_msg_t *msg);
 static int  _rpc_stat_jobacct(slurm_msg_t *msg);
@@ -287,6 +291,11 @@ slurmd_req(slurm_msg_t *msg)
 		last_slurmctld_msg = time(NULL);
 		slurm_free_suspend_msg(msg->data);
 		break;
+	case REQUEST_SUSPEND_BATCH:
+		_rpc_suspend_batch(msg);
+		last_slurmctld_msg = time(NULL);
+		slurm_free_suspend_batch_msg(msg->data);
+		break;
 	case REQUEST_ABORT_JOB:
 		debug2("Processing RPC: REQUEST_ABORT_JOB");
 		last_slurmctld_msg = time(NULL);
@@ -314,6 +323,14 @@ slurmd_req(slurm_msg_t *msg)
 		/* No body to free */
 		break;
 	case REQUEST_NODE_REGISTRATION_STATUS:
+		if (msg->protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
+			/* Reply with our registration, which gets
+			 * collected up the forwarding tree */
+			_rpc_node_registration(msg);
+			last_slurmctld_msg = time(NULL);
+			/* No body to free */
+			break;
+		}
 		/* Treat as ping (for slurmctld agent, just return SUCCESS) */
 		rc = _rpc_ping(msg);
 		last_slurmctld_msg = time(NULL);
@@ -1776,6 +1793,30 @@ _rpc_ping(slurm_msg_t *msg)
 	return rc;
 }
 
+static int
+_rpc_node_registration(slurm_msg_t *msg)
+{
+	int        rc = SLURM_SUCCESS;
+	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+
+	if (!_slurm_authorized_user(req_uid)) {
+		error("Security violation, registration RPC from uid %d",
+		      req_uid);
+		rc = ESLURM_USER_ID_MISSING;	/* or bad in this case */
+		slurm_send_rc_msg(msg, rc);
+		return rc;
+	}
+
+	/* If the reply can't be sent, fall back to registering through
+	 * a separate RPC as done for a failed ping reply */
+	if (reply_registration_msg(msg, SLURM_SUCCESS, true) != SLURM_SUCCESS)
+		send_registration_msg(SLURM_SUCCESS, true);
+
+	/* Take this opportunity to enforce any job memory limits */
+	_enforce_job_mem_limit();
+	return rc;
+}
+
 static int
 _rpc_health_check(slurm_msg_t *msg)
 {
@@ -3058,11 +3099,7 @@ _rpc_suspend_job(slurm_msg_t *msg)
 {
 	suspend_msg_t *req = msg->data;
 	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
-	List steps;
-	ListIterator i;
-	step_loc_t *stepd;
-	int step_cnt  = 0;
-	int first_time, rc = SLURM_SUCCESS;
+	int rc = SLURM_SUCCESS;
 
 	if (req->op != SUSPEND_JOB && req->op != RESUME_JOB) {
 		error("REQUEST_SUSPEND: bad op code %u", req->op);
@@ -3094,13 +3131,29 @@ _rpc_suspend_job(slurm_msg_t *msg)
 	 * which could take a few seconds to complete */
 	debug("_rpc_suspend_job jobid=%u uid=%d action=%s", req->job_id,
 	      req_uid, req->op == SUSPEND_JOB ? "suspend" : "resume");
+	_suspend_job_steps(req->job_id, req->op, true);
+}
+
+/* Suspend or resume all of a job's steps on this node
+ * IN job_id - job to act upon
+ * IN op - SUSPEND_JOB or RESUME_JOB
+ * IN launch_sleep - if set and suspending, wait one second for any
+ *	launch requests to get started */
+static void
+_suspend_job_steps(uint32_t job_id, uint16_t op, bool launch_sleep)
+{
+	List steps;
+	ListIterator i;
+	step_loc_t *stepd;
+	int step_cnt  = 0;
+	int first_time;
 
 	/* Try to get a thread lock for this job. If the lock
 	 * is not available then sleep and try again */
 	first_time = 1;
-	while (!_get_suspend_job_lock(req->job_id)) {
+	while (!_get_suspend_job_lock(job_id)) {
 	 	first_time = 0;
-		debug3("suspend lock sleep for %u", req->job_id);
+		debug3("suspend lock sleep for %u", job_id);
 		sleep(1);
 	}
 
@@ -3109,16 +3162,16 @@ _rpc_suspend_job(slurm_msg_t *msg)
 	 * to get started and avoid a race condition that would
 	 * effectively cause the suspend request to get ignored
 	 * because "there's no job to suspend" */
-	if (first_time && req->op == SUSPEND_JOB) {
-		debug3("suspend first sleep for %u", req->job_id);
+	if (launch_sleep && first_time && op == SUSPEND_JOB) {
+		debug3("suspend first sleep for %u", job_id);
 		sleep(1);
 	}
 
 	/* Release or reclaim resources bound to these tasks (task affinity) */
-	if (req->op == SUSPEND_JOB)
-		(void) slurmd_suspend_job(req->job_id);
+	if (op == SUSPEND_JOB)
+		(void) slurmd_suspend_job(job_id);
 	else
-		(void) slurmd_resume_job(req->job_id);
+		(void) slurmd_resume_job(job_id);
 
 	/*
 	 * Loop through all job steps and call stepd_suspend or stepd_resume
@@ -3132,11 +3185,11 @@ _rpc_suspend_job(slurm_msg_t *msg)
 		int x, fdi, fd[NUM_PARALLEL_SUSPEND];
 		fdi = 0;
 		while ((stepd = list_next(i))) {
-			if (stepd->jobid != req->job_id) {
+			if (stepd->jobid != job_id) {
 				/* multiple jobs expected on shared nodes */
 				debug3("Step from other job: jobid=%u "
 				       "(this jobid=%u)",
-				       stepd->jobid, req->job_id);
+				       stepd->jobid, job_id);
 				continue;
 			}
 			step_cnt++;
@@ -3159,13 +3212,13 @@ _rpc_suspend_job(slurm_msg_t *msg)
 		if (fdi == 0)
 			break;
 
-		if (req->op == SUSPEND_JOB) {
-			stepd_suspend(fd, fdi, req->job_id);
+		if (op == SUSPEND_JOB) {
+			stepd_suspend(fd, fdi, job_id);
 		} else {
 			/* "resume" remains a serial action (for now) */
 			for (x = 0; x < fdi; x++) {
 				debug2("Resuming job %u (cached step count %d)",
-				       req->job_id, x);
+				       job_id, x);
 				if (stepd_resume(fd[x]) < 0)
 					debug("  resume failed: %m");
 			}
@@ -3181,12 +3234,106 @@ _rpc_suspend_job(slurm_msg_t *msg)
 	}
 	list_iterator_destroy(i);
 	list_destroy(steps);
-	_unlock_suspend_job(req->job_id);
+	_unlock_suspend_job(job_id);
 
 	if (step_cnt == 0) {
 		debug2("No steps in jobid %u to suspend/resume",
-		       req->job_id);
+		       job_id);
+	}
+}
+
+static void *
+_suspend_batch_thread(void *arg)
+{
+	suspend_msg_t *sus_ptr = (suspend_msg_t *) arg;
+
+	_suspend_job_steps(sus_ptr->job_id, sus_ptr->op, false);
+	return NULL;
+}
+
+/* Perform the suspend or resume operations of a REQUEST_SUSPEND_BATCH for
+ * the jobs with steps on this node. All suspends are completed before any
+ * resume starts, up to NUM_PARALLEL_SUSPEND jobs at a time. */
+static void
+_rpc_suspend_batch(slurm_msg_t *msg)
+{
+	suspend_batch_msg_t *req = msg->data;
+	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+	List steps;
+	ListIterator i;
+	step_loc_t *stepd;
+	suspend_msg_t sus_args[NUM_PARALLEL_SUSPEND];
+	pthread_t thread_id[NUM_PARALLEL_SUSPEND];
+	pthread_attr_t attr;
+	uint16_t op, ops[2] = { SUSPEND_JOB, RESUME_JOB };
+	int j, k, t, thread_cnt, rc = SLURM_SUCCESS;
+
+	if (!_slurm_authorized_user(req_uid)) {
+		error("Security violation: suspend_batch from uid %d",
+		      req_uid);
+		rc =  ESLURM_USER_ID_MISSING;
 	}
+
+	if (msg->conn_fd >= 0) {
+		slurm_send_rc_msg(msg, rc);
+		if (slurm_close_accepted_conn(msg->conn_fd) < 0)
+			error("_rpc_suspend_batch: close(%d): %m",
+			      msg->conn_fd);
+		msg->conn_fd = -1;
+	}
+	if (rc != SLURM_SUCCESS)
+		return;
+
+	debug("_rpc_suspend_batch job_cnt=%u uid=%d", req->job_cnt, req_uid);
+
+	/* Give any launch requests a chance to get started before looking
+	 * for the steps, see _suspend_job_steps() */
+	for (j = 0; j < req->job_cnt; j++) {
+		if (req->op[j] == SUSPEND_JOB) {
+			sleep(1);
+			break;
+		}
+	}
+
+	/* Most of the jobs are usually not on this node, skip them */
+	steps = stepd_available(conf->spooldir, conf->node_name);
+	slurm_attr_init(&attr);
+	for (k = 0; k < 2; k++) {
+		op = ops[k];
+		thread_cnt = 0;
+		for (j = 0; j <= req->job_cnt; j++) {
+			if (j < req->job_cnt) {
+				if (req->op[j] != op)
+					continue;
+				i = list_iterator_create(steps);
+				while ((stepd = list_next(i))) {
+					if (stepd->jobid == req->job_id[j])
+						break;
+				}
+				list_iterator_destroy(i);
+				if (!stepd)
+					continue;
+				sus_args[thread_cnt].job_id = req->job_id[j];
+				sus_args[thread_cnt].op = op;
+				if (pthread_create(&thread_id[thread_cnt],
+						   &attr,
+						   _suspend_batch_thread,
+						   &sus_args[thread_cnt])) {
+					error("pthread_create: %m");
+					_suspend_batch_thread(
+						&sus_args[thread_cnt]);
+					continue;
+				}
+				if (++thread_cnt < NUM_PARALLEL_SUSPEND)
+					continue;
+			}
+			for (t = 0; t < thread_cnt; t++)
+				pthread_join(thread_id[t], NULL);
+			thread_cnt = 0;
+		}
+	}
+	slurm_attr_destroy(&attr);
+	list_destroy(steps);
 }
 
 /* Job shouldn't even be runnin here, abort it immediately */
@@ -568,6 +568,32 @@ send_registration_msg(uint32_t status, bool startup)
 	return ret_val;
 }
 
+extern int
+reply_registration_msg(slurm_msg_t *req, uint32_t status, bool startup)
+{
+	int ret_val = SLURM_SUCCESS;
+	slurm_msg_t resp;
+	slurm_node_registration_status_msg_t *msg =
+		xmalloc (sizeof (slurm_node_registration_status_msg_t));
+
+	msg->startup = (uint16_t) startup;
+	_fill_registration_msg(msg);
+	msg->status  = status;
+
+	slurm_msg_t_copy(&resp, req);
+	resp.msg_type = MESSAGE_NODE_REGISTRATION_STATUS;
+	resp.data     = msg;
+
+	if (slurm_send_node_msg(req->conn_fd, &resp) < 0) {
+		error("Unable to reply with registration: %m");
+		ret_val = SLURM_FAILURE;
+	} else
+		sent_reg_time = time(NULL);
+	slurm_free_node_registration_status_msg (msg);
+
+	return ret_val;
+}
+
 static void
 _fill_registration_msg(slurm_node_registration_status_msg_t *msg)
 {
@@ -759,6 +785,7 @@ _read_config(void)
 	/* store hardware properties in slurmd_config */
 	xfree(conf->block_map);
 	xfree(conf->block_map_inv);
+	xfree(conf->numa_map);
 
 	conf->block_map_size = 0;
 
@@ -772,6 +799,7 @@ _read_config(void)
 		    &conf->actual_threads,
 		    &conf->block_map_size,
 		    &conf->block_map, &conf->block_map_inv);
+	get_numa_map(conf->block_map_size, &conf->numa_map);
 #ifdef HAVE_FRONT_END
 	/*
 	 * When running with multiple frontends, the slurmd S:C:T values are not
@@ -1034,6 +1062,7 @@ _destroy_conf(void)
 	if(conf) {
 		xfree(conf->block_map);
 		xfree(conf->block_map_inv);
+		xfree(conf->numa_map);
 		xfree(conf->conffile);
 		xfree(conf->epilog);
 		xfree(conf->health_check_program);
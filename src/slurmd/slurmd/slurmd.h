@@ -94,6 +94,8 @@ typedef struct slurmd_config {
 	uint16_t     block_map_size;	/* size of block map               */
 	uint16_t     *block_map;	/* abstract->machine block map     */
 	uint16_t     *block_map_inv;	/* machine->abstract (inverse) map */
+	uint16_t     *numa_map;		/* machine->NUMA node map, NULL if *
+					 * the node does not report them   */
 	uint16_t      cr_type;		/* Consumable Resource Type:       *
 					 * CR_SOCKET, CR_CORE, CR_MEMORY,  *
 					 * CR_DEFAULT, etc.                */
@@ -152,6 +154,15 @@ extern slurmd_conf_t * conf;
  */
 int send_registration_msg(uint32_t status, bool startup);
 
+/* Return node registration message with status as the reply to a
+ * controller's REQUEST_NODE_REGISTRATION_STATUS, so that it is gathered
+ * up the message forwarding tree along with those of the other nodes
+ * IN req - the registration request being answered
+ * IN status - same values slurm error codes (for node shutdown)
+ * IN startup - non-zero if slurmd just restarted
+ */
+int reply_registration_msg(slurm_msg_t *req, uint32_t status, bool startup);
+
 /*
  * save_cred_state - save the current credential list to a file
  * IN list - list of credentials
@@ -52,6 +52,7 @@
 #include "src/common/slurm_rlimits_info.h"
 #include "src/common/stepd_api.h"
 #include "src/common/switch.h"
+#include "src/common/xcpuinfo.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xsignal.h"
 
@@ -169,6 +170,9 @@ ending:
 	xfree(conf->node_name);
 	xfree(conf->node_topo_addr);
 	xfree(conf->node_topo_pattern);
+	xfree(conf->block_map);
+	xfree(conf->block_map_inv);
+	xfree(conf->numa_map);
 	xfree(conf->logfile);
 	xfree(conf);
 #endif
@@ -250,6 +254,15 @@ _init_from_slurmd(int sock, char **argv,
 	}
 	free_buf(buffer);
 
+	/* the task plugins get the node topology from slurmd
+	 * rather than probing it again for each step */
+	if (conf->block_map_size) {
+		xcpuinfo_preload(conf->actual_cpus, conf->actual_sockets,
+				 conf->actual_cores, conf->actual_threads,
+				 conf->block_map_size, conf->block_map,
+				 conf->block_map_inv);
+	}
+
 	conf->log_opts.stderr_level = conf->debug_level;
 	conf->log_opts.logfile_level = conf->debug_level;
 	conf->log_opts.syslog_level = conf->debug_level;
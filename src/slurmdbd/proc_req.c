@@ -49,6 +49,21 @@
 #include "src/slurmdbd/proc_req.h"
 #include "src/slurmctld/slurmctld.h"
 
+/* Jobs and steps started or completed back to back in a
+ * DBD_SEND_MULT_MSG are stored together, this holds what is needed for
+ * one of them along with its return code. */
+typedef struct {
+	dbd_job_start_msg_t *job_start_msg;
+	dbd_job_comp_msg_t *job_comp_msg;
+	dbd_step_start_msg_t *start_msg;
+	dbd_step_comp_msg_t *comp_msg;
+	int rc;
+	struct step_record step;
+	struct job_record job;
+	struct job_details details;
+	slurm_step_layout_t layout;
+} mult_step_t;
+
 /* Local functions */
 static int   _add_accounts(slurmdbd_conn_t *slurmdbd_conn,
 			   Buf in_buffer, Buf *out_buffer, uint32_t *uid);
@@ -74,6 +89,7 @@ static int   _cluster_cpus(slurmdbd_conn_t *slurmdbd_conn,
 			   Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static int   _get_accounts(slurmdbd_conn_t *slurmdbd_conn,
 			   Buf in_buffer, Buf *out_buffer, uint32_t *uid);
+static void  _free_mult_step(void *object);
 static int   _get_assocs(slurmdbd_conn_t *slurmdbd_conn,
 			 Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static int   _get_clusters(slurmdbd_conn_t *slurmdbd_conn,
@@ -106,6 +122,8 @@ static int   _fini_conn(slurmdbd_conn_t *slurmdbd_conn, Buf in_buffer,
 			Buf *out_buffer);
 static int   _job_complete(slurmdbd_conn_t *slurmdbd_conn,
 			   Buf in_buffer, Buf *out_buffer, uint32_t *uid);
+static void  _job_complete_setup(dbd_job_comp_msg_t *job_comp_msg,
+				 mult_step_t *mult_step);
 static int   _job_start(slurmdbd_conn_t *slurmdbd_conn,
 			Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static int   _job_suspend(slurmdbd_conn_t *slurmdbd_conn,
@@ -129,6 +147,8 @@ static int   _modify_reservation(slurmdbd_conn_t *slurmdbd_conn,
 static int   _node_state(slurmdbd_conn_t *slurmdbd_conn,
 			 Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static char *_node_state_string(uint16_t node_state);
+static void  _job_start_setup(dbd_job_start_msg_t *job_start_msg,
+			      mult_step_t *mult_step);
 static void  _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
 				dbd_job_start_msg_t *job_start_msg,
 				dbd_id_rc_msg_t *id_rc_msg);
@@ -159,10 +179,19 @@ static int   _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			    Buf in_buffer, Buf *out_buffer,
 			    uint32_t *uid);
+static int   _send_mult_run(slurmdbd_conn_t *slurmdbd_conn,
+			    uint16_t msg_type, ListIterator itr,
+			    Buf *req_buf, List ret_list);
 static int   _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 			    Buf in_buffer, Buf *out_buffer, uint32_t *uid);
+static void  _step_complete_setup(dbd_step_comp_msg_t *step_comp_msg,
+				  mult_step_t *mult_step);
 static int   _step_start(slurmdbd_conn_t *slurmdbd_conn,
 			 Buf in_buffer, Buf *out_buffer, uint32_t *uid);
+static void  _step_start_setup(dbd_step_start_msg_t *step_start_msg,
+			       mult_step_t *mult_step);
+static void  _store_mult(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+			 List mult_list);
 
 /* Process an incoming RPC
  * slurmdbd_conn IN/OUT - in will that the newsockfd set before
@@ -1237,6 +1266,7 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 
 	list_msg.my_list = jobacct_storage_g_get_jobs_cond(
 		slurmdbd_conn->db_conn, *uid, cond_msg->cond);
+	list_msg.return_code = SLURM_SUCCESS;
 
 	if (!errno) {
 		if (!list_msg.my_list)
@@ -1749,8 +1779,7 @@ static int  _job_complete(slurmdbd_conn_t *slurmdbd_conn,
 			  Buf in_buffer, Buf *out_buffer, uint32_t *uid)
 {
 	dbd_job_comp_msg_t *job_comp_msg = NULL;
-	struct job_record job;
-	struct job_details details;
+	mult_step_t mult_step;
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 
@@ -1770,37 +1799,17 @@ static int  _job_complete(slurmdbd_conn_t *slurmdbd_conn,
 		goto end_it;
 	}
 
-	memset(&job, 0, sizeof(struct job_record));
-	memset(&details, 0, sizeof(struct job_details));
+	memset(&mult_step, 0, sizeof(mult_step_t));
+	_job_complete_setup(job_comp_msg, &mult_step);
 
-	job.assoc_id = job_comp_msg->assoc_id;
-	job.comment = job_comp_msg->comment;
-	job.db_index = job_comp_msg->db_index;
-	job.derived_ec = job_comp_msg->derived_ec;
-	job.end_time = job_comp_msg->end_time;
-	job.exit_code = job_comp_msg->exit_code;
-	job.job_id = job_comp_msg->job_id;
-	job.job_state = job_comp_msg->job_state;
-	job.requid = job_comp_msg->req_uid;
-	job.nodes = job_comp_msg->nodes;
-	job.start_time = job_comp_msg->start_time;
-	details.submit_time = job_comp_msg->submit_time;
-
-	job.details = &details;
-
-	if (job.job_state & JOB_RESIZING) {
-		job.resize_time = job_comp_msg->end_time;
-		debug2("DBD_JOB_COMPLETE: RESIZE ID:%u", job_comp_msg->job_id);
-	} else
-		debug2("DBD_JOB_COMPLETE: ID:%u", job_comp_msg->job_id);
-
-	rc = jobacct_storage_g_job_complete(slurmdbd_conn->db_conn, &job);
+	rc = jobacct_storage_g_job_complete(slurmdbd_conn->db_conn,
+					    &mult_step.job);
 
 	if (rc && errno == 740) /* meaning data is already there */
 		rc = SLURM_SUCCESS;
 
 	/* just incase this gets set we need to clear it */
-	xfree(job.wckey);
+	xfree(mult_step.job.wckey);
 
 	if (!slurmdbd_conn->ctld_port) {
 		info("DBD_JOB_COMPLETE: cluster not registered");
@@ -1816,6 +1825,36 @@ end_it:
 	return SLURM_SUCCESS;
 }
 
+/* Fill in the job and details of mult_step from a DBD_JOB_COMPLETE
+ * message, mult_step must be zeroed */
+static void _job_complete_setup(dbd_job_comp_msg_t *job_comp_msg,
+				mult_step_t *mult_step)
+{
+	struct job_record *job = &mult_step->job;
+	struct job_details *details = &mult_step->details;
+
+	job->assoc_id = job_comp_msg->assoc_id;
+	job->comment = job_comp_msg->comment;
+	job->db_index = job_comp_msg->db_index;
+	job->derived_ec = job_comp_msg->derived_ec;
+	job->end_time = job_comp_msg->end_time;
+	job->exit_code = job_comp_msg->exit_code;
+	job->job_id = job_comp_msg->job_id;
+	job->job_state = job_comp_msg->job_state;
+	job->requid = job_comp_msg->req_uid;
+	job->nodes = job_comp_msg->nodes;
+	job->start_time = job_comp_msg->start_time;
+	details->submit_time = job_comp_msg->submit_time;
+
+	job->details = details;
+
+	if (job->job_state & JOB_RESIZING) {
+		job->resize_time = job_comp_msg->end_time;
+		debug2("DBD_JOB_COMPLETE: RESIZE ID:%u", job_comp_msg->job_id);
+	} else
+		debug2("DBD_JOB_COMPLETE: ID:%u", job_comp_msg->job_id);
+}
+
 static int  _job_start(slurmdbd_conn_t *slurmdbd_conn,
 		       Buf in_buffer, Buf *out_buffer, uint32_t *uid)
 {
@@ -2564,65 +2603,74 @@ static char *_node_state_string(uint16_t node_state)
 	return "UNKNOWN";
 }
 
-static void _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
-			       dbd_job_start_msg_t *job_start_msg,
-			       dbd_id_rc_msg_t *id_rc_msg)
+/* Fill in the job and details of mult_step from a DBD_JOB_START
+ * message, mult_step must be zeroed */
+static void _job_start_setup(dbd_job_start_msg_t *job_start_msg,
+			     mult_step_t *mult_step)
 {
-	struct job_record job, *job_ptr;
-	struct job_details details;
-
-	memset(&job, 0, sizeof(struct job_record));
-	memset(&details, 0, sizeof(struct job_details));
-	memset(id_rc_msg, 0, sizeof(dbd_id_rc_msg_t));
-
-	job.total_cpus = job_start_msg->alloc_cpus;
-	job.total_nodes = job_start_msg->alloc_nodes;
-	job.account = _replace_double_quotes(job_start_msg->account);
-	job.assoc_id = job_start_msg->assoc_id;
-	job.comment = job_start_msg->block_id;
-	job.db_index = job_start_msg->db_index;
-	details.begin_time = job_start_msg->eligible_time;
-	job.user_id = job_start_msg->uid;
-	job.group_id = job_start_msg->gid;
-	job.job_id = job_start_msg->job_id;
-	job.job_state = job_start_msg->job_state;
-	job.name = _replace_double_quotes(job_start_msg->name);
-	job.nodes = job_start_msg->nodes;
-	job.network = job_start_msg->node_inx;
-	job.partition = job_start_msg->partition;
-	details.min_cpus = job_start_msg->req_cpus;
-	job.qos_id = job_start_msg->qos_id;
-	job.resv_id = job_start_msg->resv_id;
-	job.priority = job_start_msg->priority;
-	job.start_time = job_start_msg->start_time;
-	job.time_limit = job_start_msg->timelimit;
-	job.wckey = _replace_double_quotes(job_start_msg->wckey);
-	details.submit_time = job_start_msg->submit_time;
-
-	job.details = &details;
-	job_ptr = &job;
-
-	if (job.job_state & JOB_RESIZING) {
-		job.resize_time = job_start_msg->eligible_time;
+	struct job_record *job = &mult_step->job;
+	struct job_details *details = &mult_step->details;
+
+	job->total_cpus = job_start_msg->alloc_cpus;
+	job->total_nodes = job_start_msg->alloc_nodes;
+	job->account = _replace_double_quotes(job_start_msg->account);
+	job->assoc_id = job_start_msg->assoc_id;
+	job->comment = job_start_msg->block_id;
+	job->db_index = job_start_msg->db_index;
+	details->begin_time = job_start_msg->eligible_time;
+	job->user_id = job_start_msg->uid;
+	job->group_id = job_start_msg->gid;
+	job->job_id = job_start_msg->job_id;
+	job->job_state = job_start_msg->job_state;
+	job->name = _replace_double_quotes(job_start_msg->name);
+	job->nodes = job_start_msg->nodes;
+	job->network = job_start_msg->node_inx;
+	job->partition = job_start_msg->partition;
+	details->min_cpus = job_start_msg->req_cpus;
+	job->qos_id = job_start_msg->qos_id;
+	job->resv_id = job_start_msg->resv_id;
+	job->priority = job_start_msg->priority;
+	job->start_time = job_start_msg->start_time;
+	job->time_limit = job_start_msg->timelimit;
+	job->wckey = _replace_double_quotes(job_start_msg->wckey);
+	details->submit_time = job_start_msg->submit_time;
+
+	job->details = details;
+
+	if (job->job_state & JOB_RESIZING) {
+		job->resize_time = job_start_msg->eligible_time;
 		debug2("DBD_JOB_START: RESIZE CALL ID:%u NAME:%s INX:%u",
 		       job_start_msg->job_id, job_start_msg->name,
-		       job.db_index);
-	} else if (job.start_time && !IS_JOB_PENDING(job_ptr)) {
+		       job->db_index);
+	} else if (job->start_time && !IS_JOB_PENDING(job)) {
 		debug2("DBD_JOB_START: START CALL ID:%u NAME:%s INX:%u",
 		       job_start_msg->job_id, job_start_msg->name,
-		       job.db_index);
+		       job->db_index);
 	} else {
 		debug2("DBD_JOB_START: ELIGIBLE CALL ID:%u NAME:%s",
 		       job_start_msg->job_id, job_start_msg->name);
 	}
+}
+
+static void _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
+			       dbd_job_start_msg_t *job_start_msg,
+			       dbd_id_rc_msg_t *id_rc_msg)
+{
+	mult_step_t mult_step;
+
+	memset(&mult_step, 0, sizeof(mult_step_t));
+	memset(id_rc_msg, 0, sizeof(dbd_id_rc_msg_t));
+
+	_job_start_setup(job_start_msg, &mult_step);
+
 	id_rc_msg->return_code = jobacct_storage_g_job_start(
-		slurmdbd_conn->db_conn, &job);
-	id_rc_msg->job_id = job.job_id;
-	id_rc_msg->id = job.db_index;
+		slurmdbd_conn->db_conn, &mult_step.job);
+	id_rc_msg->job_id = mult_step.job.job_id;
+	id_rc_msg->id = mult_step.job.db_index;
 
 	/* just incase job.wckey was set because we didn't send one */
 	if (!job_start_msg->wckey)
-		xfree(job.wckey);
+		xfree(mult_step.job.wckey);
 
 	if (!slurmdbd_conn->ctld_port) {
 		info("DBD_JOB_START: cluster not registered");
@@ -3301,7 +3349,8 @@ static int   _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 	dbd_list_msg_t list_msg;
 	char *comment = NULL;
 	ListIterator itr = NULL;
-	dbd_job_start_msg_t *job_start_msg;
+	List mult_list;
+	mult_step_t *mult_step;
 	dbd_id_rc_msg_t *id_rc_msg;
 
 	if (*uid != slurmdbd_conf->slurm_user_id) {
@@ -3324,19 +3373,33 @@ static int   _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 		return SLURM_ERROR;
 	}
 
-	list_msg.my_list = list_create(slurmdbd_free_id_rc_msg);
-
+	/* The job start messages move over to mult_list */
+	mult_list = list_create(_free_mult_step);
 	itr = list_iterator_create(get_msg->my_list);
-	while ((job_start_msg = list_next(itr))) {
-	        id_rc_msg = xmalloc(sizeof(dbd_id_rc_msg_t));
-		list_append(list_msg.my_list, id_rc_msg);
-
-		_process_job_start(slurmdbd_conn, job_start_msg, id_rc_msg);
+	while (list_next(itr)) {
+		mult_step = xmalloc(sizeof(mult_step_t));
+		mult_step->job_start_msg = list_remove(itr);
+		_job_start_setup(mult_step->job_start_msg, mult_step);
+		list_append(mult_list, mult_step);
 	}
 	list_iterator_destroy(itr);
-
 	slurmdbd_free_list_msg(get_msg);
 
+	if (list_count(mult_list))
+		_store_mult(slurmdbd_conn, DBD_JOB_START, mult_list);
+
+	list_msg.my_list = list_create(slurmdbd_free_id_rc_msg);
+	itr = list_iterator_create(mult_list);
+	while ((mult_step = list_next(itr))) {
+		id_rc_msg = xmalloc(sizeof(dbd_id_rc_msg_t));
+		id_rc_msg->job_id = mult_step->job.job_id;
+		id_rc_msg->id = mult_step->job.db_index;
+		id_rc_msg->return_code = mult_step->rc;
+		list_append(list_msg.my_list, id_rc_msg);
+	}
+	list_iterator_destroy(itr);
+	list_destroy(mult_list);
+
 	*out_buffer = init_buf(1024);
 	pack16((uint16_t) DBD_GOT_MULT_JOB_START, *out_buffer);
 	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
@@ -3347,6 +3410,262 @@ static int   _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 	return SLURM_SUCCESS;
 }
 
+/* Return the type of a message packed in a DBD_SEND_MULT_MSG */
+static uint16_t _mult_msg_type(Buf req_buf)
+{
+	uint16_t msg_type = 0;
+	Buf in_buffer = create_buf(get_buf_data(req_buf), size_buf(req_buf));
+
+	if (unpack16(&msg_type, in_buffer) != SLURM_SUCCESS)
+		msg_type = 0;
+	xfer_buf_data(in_buffer);	/* delete in_buffer struct without
+					 * xfree of msg */
+	return msg_type;
+}
+
+static void _free_mult_step(void *object)
+{
+	mult_step_t *mult_step = (mult_step_t *)object;
+
+	if (mult_step) {
+		/* just incase this gets set we need to clear it, a job
+		 * start's own wckey goes with its message */
+		if (!mult_step->job_start_msg ||
+		    !mult_step->job_start_msg->wckey)
+			xfree(mult_step->job.wckey);
+		slurmdbd_free_job_start_msg(mult_step->job_start_msg);
+		slurmdbd_free_job_complete_msg(mult_step->job_comp_msg);
+		slurmdbd_free_step_start_msg(mult_step->start_msg);
+		slurmdbd_free_step_complete_msg(mult_step->comp_msg);
+		xfree(mult_step);
+	}
+}
+
+/* Store one record of mult_list on its own */
+static int _store_one(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+		      mult_step_t *mult_step)
+{
+	switch (msg_type) {
+	case DBD_JOB_START:
+		return jobacct_storage_g_job_start(slurmdbd_conn->db_conn,
+						   &mult_step->job);
+	case DBD_JOB_COMPLETE:
+		return jobacct_storage_g_job_complete(slurmdbd_conn->db_conn,
+						      &mult_step->job);
+	case DBD_STEP_START:
+		return jobacct_storage_g_step_start(slurmdbd_conn->db_conn,
+						    &mult_step->step);
+	default:
+		return jobacct_storage_g_step_complete(slurmdbd_conn->db_conn,
+						       &mult_step->step);
+	}
+}
+
+/* Store the msg_type records of mult_list with one call to the storage
+ * plugin and set the return code of each.  If that call fails the
+ * records it did not store are stored one at a time so each gets its own
+ * return code, like proc_req a step failing leaves the steps after it
+ * unstored.
+ */
+static void _store_mult(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+			List mult_list)
+{
+	List rec_list = list_create(NULL);
+	ListIterator itr, rec_itr;
+	mult_step_t *mult_step;
+	void *rec, *next_rec;
+	bool steps = ((msg_type == DBD_STEP_START) ||
+		      (msg_type == DBD_STEP_COMPLETE));
+	int batch_rc, rc = SLURM_SUCCESS;
+
+	itr = list_iterator_create(mult_list);
+	while ((mult_step = list_next(itr))) {
+		if (steps)
+			list_append(rec_list, &mult_step->step);
+		else
+			list_append(rec_list, &mult_step->job);
+	}
+
+	debug2("%s: storing %d records together",
+	       slurmdbd_msg_type_2_str(msg_type, 1), list_count(rec_list));
+	errno = 0;
+	switch (msg_type) {
+	case DBD_JOB_START:
+		batch_rc = jobacct_storage_g_job_start_mult(
+			slurmdbd_conn->db_conn, rec_list);
+		break;
+	case DBD_JOB_COMPLETE:
+		batch_rc = jobacct_storage_g_job_complete_mult(
+			slurmdbd_conn->db_conn, rec_list);
+		break;
+	case DBD_STEP_START:
+		batch_rc = jobacct_storage_g_step_start_mult(
+			slurmdbd_conn->db_conn, rec_list);
+		break;
+	default:
+		batch_rc = jobacct_storage_g_step_complete_mult(
+			slurmdbd_conn->db_conn, rec_list);
+		break;
+	}
+
+	if (batch_rc && errno == 740) /* meaning data is already there */
+		batch_rc = SLURM_SUCCESS;
+	if (batch_rc != SLURM_SUCCESS)
+		debug("%s: storing %d records together failed, "
+		      "storing the %d left one at a time",
+		      slurmdbd_msg_type_2_str(msg_type, 1),
+		      list_count(mult_list), list_count(rec_list));
+
+	/* rec_list now holds the records not stored, in mult_list order.
+	 * Storing a record again is not safe, a resized job's start would
+	 * complete its new row. */
+	rec_itr = list_iterator_create(rec_list);
+	next_rec = list_next(rec_itr);
+	list_iterator_reset(itr);
+	while ((mult_step = list_next(itr))) {
+		if (batch_rc == SLURM_SUCCESS) {
+			mult_step->rc = rc;
+			continue;
+		}
+		if (steps)
+			rec = &mult_step->step;
+		else
+			rec = &mult_step->job;
+		if (rec != next_rec) {
+			mult_step->rc = SLURM_SUCCESS;
+			continue;
+		}
+		next_rec = list_next(rec_itr);
+		if (rc != SLURM_SUCCESS) {
+			mult_step->rc = rc;
+			continue;
+		}
+		errno = 0;
+		mult_step->rc = _store_one(slurmdbd_conn, msg_type, mult_step);
+		if (mult_step->rc && errno == 740)
+			mult_step->rc = SLURM_SUCCESS;
+		if (steps)
+			rc = mult_step->rc;
+	}
+	list_iterator_destroy(itr);
+	list_iterator_destroy(rec_itr);
+	list_destroy(rec_list);
+
+	if (!slurmdbd_conn->ctld_port) {
+		info("%s: cluster not registered",
+		     slurmdbd_msg_type_2_str(msg_type, 1));
+		slurmdbd_conn->ctld_port =
+			clusteracct_storage_g_register_disconn_ctld(
+				slurmdbd_conn->db_conn, slurmdbd_conn->ip);
+	}
+}
+
+/* Store the run of msg_type messages starting at *req_buf together.  On
+ * return *req_buf is the first message not handled here, NULL at the
+ * end of the list.  A response is added to ret_list for each message
+ * handled, the return code is that of the first step which failed.
+ * Job messages always return SLURM_SUCCESS as they do from proc_req.
+ */
+static int _send_mult_run(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+			  ListIterator itr, Buf *req_buf, List ret_list)
+{
+	List mult_list = list_create(_free_mult_step);
+	ListIterator mult_itr;
+	mult_step_t *mult_step;
+	dbd_id_rc_msg_t id_rc_msg;
+	Buf in_buffer, ret_buf;
+	uint16_t type;
+	int rc = SLURM_SUCCESS, unpack_rc;
+
+	while (*req_buf && (_mult_msg_type(*req_buf) == msg_type)) {
+		Buf msg_buf = *req_buf;
+
+		mult_step = xmalloc(sizeof(mult_step_t));
+		in_buffer = create_buf(get_buf_data(msg_buf),
+				       size_buf(msg_buf));
+		unpack16(&type, in_buffer);
+		switch (msg_type) {
+		case DBD_JOB_START:
+			unpack_rc = slurmdbd_unpack_job_start_msg(
+				(void **)&mult_step->job_start_msg,
+				slurmdbd_conn->rpc_version, in_buffer);
+			break;
+		case DBD_JOB_COMPLETE:
+			unpack_rc = slurmdbd_unpack_job_complete_msg(
+				&mult_step->job_comp_msg,
+				slurmdbd_conn->rpc_version, in_buffer);
+			break;
+		case DBD_STEP_START:
+			unpack_rc = slurmdbd_unpack_step_start_msg(
+				&mult_step->start_msg,
+				slurmdbd_conn->rpc_version, in_buffer);
+			break;
+		default:
+			unpack_rc = slurmdbd_unpack_step_complete_msg(
+				&mult_step->comp_msg,
+				slurmdbd_conn->rpc_version, in_buffer);
+			break;
+		}
+		xfer_buf_data(in_buffer);
+		/* Leave this one for proc_req to report */
+		if (unpack_rc != SLURM_SUCCESS) {
+			_free_mult_step(mult_step);
+			break;
+		}
+
+		switch (msg_type) {
+		case DBD_JOB_START:
+			_job_start_setup(mult_step->job_start_msg, mult_step);
+			break;
+		case DBD_JOB_COMPLETE:
+			_job_complete_setup(mult_step->job_comp_msg,
+					    mult_step);
+			break;
+		case DBD_STEP_START:
+			_step_start_setup(mult_step->start_msg, mult_step);
+			break;
+		default:
+			_step_complete_setup(mult_step->comp_msg, mult_step);
+			break;
+		}
+		list_append(mult_list, mult_step);
+		*req_buf = list_next(itr);
+	}
+
+	if (!list_count(mult_list))
+		goto end_it;
+
+	_store_mult(slurmdbd_conn, msg_type, mult_list);
+
+	mult_itr = list_iterator_create(mult_list);
+	while ((mult_step = list_next(mult_itr))) {
+		if (msg_type == DBD_JOB_START) {
+			memset(&id_rc_msg, 0, sizeof(dbd_id_rc_msg_t));
+			id_rc_msg.job_id = mult_step->job.job_id;
+			id_rc_msg.id = mult_step->job.db_index;
+			id_rc_msg.return_code = mult_step->rc;
+			ret_buf = init_buf(1024);
+			pack16((uint16_t) DBD_ID_RC, ret_buf);
+			slurmdbd_pack_id_rc_msg(&id_rc_msg,
+						slurmdbd_conn->rpc_version,
+						ret_buf);
+		} else
+			ret_buf = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
+						  mult_step->rc, NULL,
+						  msg_type);
+		list_append(ret_list, ret_buf);
+		if ((rc == SLURM_SUCCESS) &&
+		    ((msg_type == DBD_STEP_START) ||
+		     (msg_type == DBD_STEP_COMPLETE)))
+			rc = mult_step->rc;
+	}
+	list_iterator_destroy(mult_itr);
+
+end_it:
+	list_destroy(mult_list);
+	return rc;
+}
+
 static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			    Buf in_buffer, Buf *out_buffer,
 			    uint32_t *uid)
@@ -3356,7 +3675,8 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 	char *comment = NULL;
 	ListIterator itr = NULL;
 	Buf req_buf = NULL, ret_buf = NULL;
-	int rc = SLURM_SUCCESS;
+	uint16_t msg_type;
+	int cnt, rc = SLURM_SUCCESS;
 
 	if (*uid != slurmdbd_conf->slurm_user_id) {
 		comment = "DBD_SEND_MULT_MSG message from invalid uid";
@@ -3381,7 +3701,28 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 
 	itr = list_iterator_create(get_msg->my_list);
-	while ((req_buf = list_next(itr))) {
+	req_buf = list_next(itr);
+	while (req_buf) {
+		msg_type = _mult_msg_type(req_buf);
+		/* Runs of job and step start and completion messages
+		 * are stored together, anything else goes through
+		 * proc_req one by one.  If the first message of a run
+		 * can't be batched proc_req deals with it and its
+		 * error. */
+		if ((msg_type == DBD_JOB_START)
+		    || (msg_type == DBD_JOB_COMPLETE)
+		    || (msg_type == DBD_STEP_START)
+		    || (msg_type == DBD_STEP_COMPLETE)) {
+			cnt = list_count(list_msg.my_list);
+			rc = _send_mult_run(slurmdbd_conn, msg_type, itr,
+					    &req_buf, list_msg.my_list);
+			if (list_count(list_msg.my_list) > cnt) {
+				if (rc != SLURM_SUCCESS)
+					break;
+				continue;
+			}
+		}
+
 		ret_buf = NULL;
 		rc = proc_req(slurmdbd_conn, get_buf_data(req_buf),
 			      size_buf(req_buf), 0, &ret_buf, uid);
@@ -3389,6 +3730,7 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			list_append(list_msg.my_list, ret_buf);
 		if (rc != SLURM_SUCCESS)
 			break;
+		req_buf = list_next(itr);
 	}
 	list_iterator_destroy(itr);
 
@@ -3408,9 +3750,7 @@ static int  _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 			   Buf in_buffer, Buf *out_buffer, uint32_t *uid)
 {
 	dbd_step_comp_msg_t *step_comp_msg = NULL;
-	struct step_record step;
-	struct job_record job;
-	struct job_details details;
+	mult_step_t mult_step;
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 
@@ -3430,36 +3770,16 @@ static int  _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 		goto end_it;
 	}
 
-	debug2("DBD_STEP_COMPLETE: ID:%u.%u SUBMIT:%lu",
-	       step_comp_msg->job_id, step_comp_msg->step_id,
-	       (unsigned long) step_comp_msg->job_submit_time);
-
-	memset(&step, 0, sizeof(struct step_record));
-	memset(&job, 0, sizeof(struct job_record));
-	memset(&details, 0, sizeof(struct job_details));
+	memset(&mult_step, 0, sizeof(mult_step_t));
+	_step_complete_setup(step_comp_msg, &mult_step);
 
-	job.assoc_id = step_comp_msg->assoc_id;
-	job.db_index = step_comp_msg->db_index;
-	job.end_time = step_comp_msg->end_time;
-	step.exit_code = step_comp_msg->exit_code;
-	step.jobacct = step_comp_msg->jobacct;
-	job.job_id = step_comp_msg->job_id;
-	step.requid = step_comp_msg->req_uid;
-	job.start_time = step_comp_msg->start_time;
-	details.submit_time = step_comp_msg->job_submit_time;
-	step.step_id = step_comp_msg->step_id;
-	step.cpu_count = step_comp_msg->total_cpus;
-	details.num_tasks = step_comp_msg->total_tasks;
-
-	job.details = &details;
-	step.job_ptr = &job;
-
-	rc = jobacct_storage_g_step_complete(slurmdbd_conn->db_conn, &step);
+	rc = jobacct_storage_g_step_complete(slurmdbd_conn->db_conn,
+					     &mult_step.step);
 
 	if (rc && errno == 740) /* meaning data is already there */
 		rc = SLURM_SUCCESS;
 	/* just incase this gets set we need to clear it */
-	xfree(job.wckey);
+	xfree(mult_step.job.wckey);
 
 	if (!slurmdbd_conn->ctld_port) {
 		info("DBD_STEP_COMPLETE: cluster not registered");
@@ -3475,14 +3795,41 @@ end_it:
 	return rc;
 }
 
+/* Fill in the step, job and details of mult_step from a
+ * DBD_STEP_COMPLETE message, mult_step must be zeroed */
+static void _step_complete_setup(dbd_step_comp_msg_t *step_comp_msg,
+				 mult_step_t *mult_step)
+{
+	struct step_record *step = &mult_step->step;
+	struct job_record *job = &mult_step->job;
+	struct job_details *details = &mult_step->details;
+
+	debug2("DBD_STEP_COMPLETE: ID:%u.%u SUBMIT:%lu",
+	       step_comp_msg->job_id, step_comp_msg->step_id,
+	       (unsigned long) step_comp_msg->job_submit_time);
+
+	job->assoc_id = step_comp_msg->assoc_id;
+	job->db_index = step_comp_msg->db_index;
+	job->end_time = step_comp_msg->end_time;
+	step->exit_code = step_comp_msg->exit_code;
+	step->jobacct = step_comp_msg->jobacct;
+	job->job_id = step_comp_msg->job_id;
+	step->requid = step_comp_msg->req_uid;
+	job->start_time = step_comp_msg->start_time;
+	details->submit_time = step_comp_msg->job_submit_time;
+	step->step_id = step_comp_msg->step_id;
+	step->cpu_count = step_comp_msg->total_cpus;
+	details->num_tasks = step_comp_msg->total_tasks;
+
+	job->details = details;
+	step->job_ptr = job;
+}
+
 static int  _step_start(slurmdbd_conn_t *slurmdbd_conn,
 			Buf in_buffer, Buf *out_buffer, uint32_t *uid)
 {
 	dbd_step_start_msg_t *step_start_msg = NULL;
-	struct step_record step;
-	struct job_record job;
-	struct job_details details;
-	slurm_step_layout_t layout;
+	mult_step_t mult_step;
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 
@@ -3501,42 +3848,17 @@ static int  _step_start(slurmdbd_conn_t *slurmdbd_conn,
 		goto end_it;
 	}
 
-	debug2("DBD_STEP_START: ID:%u.%u NAME:%s SUBMIT:%lu",
-	       step_start_msg->job_id, step_start_msg->step_id,
-	       step_start_msg->name,
-	       (unsigned long) step_start_msg->job_submit_time);
+	memset(&mult_step, 0, sizeof(mult_step_t));
+	_step_start_setup(step_start_msg, &mult_step);
 
-	memset(&step, 0, sizeof(struct step_record));
-	memset(&job, 0, sizeof(struct job_record));
-	memset(&details, 0, sizeof(struct job_details));
-	memset(&layout, 0, sizeof(slurm_step_layout_t));
-
-	job.assoc_id = step_start_msg->assoc_id;
-	job.db_index = step_start_msg->db_index;
-	job.job_id = step_start_msg->job_id;
-	step.name = step_start_msg->name;
-	job.nodes = step_start_msg->nodes;
-	step.network = step_start_msg->node_inx;
-	step.start_time = step_start_msg->start_time;
-	details.submit_time = step_start_msg->job_submit_time;
-	step.step_id = step_start_msg->step_id;
-	step.cpu_count = step_start_msg->total_cpus;
-	details.num_tasks = step_start_msg->total_tasks;
-
-	layout.node_cnt = step_start_msg->node_cnt;
-	layout.task_dist = step_start_msg->task_dist;
-
-	job.details = &details;
-	step.job_ptr = &job;
-	step.step_layout = &layout;
-
-	rc = jobacct_storage_g_step_start(slurmdbd_conn->db_conn, &step);
+	rc = jobacct_storage_g_step_start(slurmdbd_conn->db_conn,
+					  &mult_step.step);
 
 	if (rc && errno == 740) /* meaning data is already there */
 		rc = SLURM_SUCCESS;
 
 	/* just incase this gets set we need to clear it */
-	xfree(job.wckey);
+	xfree(mult_step.job.wckey);
 
 	if (!slurmdbd_conn->ctld_port) {
 		info("DBD_STEP_START: cluster not registered");
@@ -3552,3 +3874,37 @@ end_it:
 	return rc;
 }
 
+/* Fill in the step, job, details and layout of mult_step from a
+ * DBD_STEP_START message, mult_step must be zeroed */
+static void _step_start_setup(dbd_step_start_msg_t *step_start_msg,
+			      mult_step_t *mult_step)
+{
+	struct step_record *step = &mult_step->step;
+	struct job_record *job = &mult_step->job;
+	struct job_details *details = &mult_step->details;
+	slurm_step_layout_t *layout = &mult_step->layout;
+
+	debug2("DBD_STEP_START: ID:%u.%u NAME:%s SUBMIT:%lu",
+	       step_start_msg->job_id, step_start_msg->step_id,
+	       step_start_msg->name,
+	       (unsigned long) step_start_msg->job_submit_time);
+
+	job->assoc_id = step_start_msg->assoc_id;
+	job->db_index = step_start_msg->db_index;
+	job->job_id = step_start_msg->job_id;
+	step->name = step_start_msg->name;
+	job->nodes = step_start_msg->nodes;
+	step->network = step_start_msg->node_inx;
+	step->start_time = step_start_msg->start_time;
+	details->submit_time = step_start_msg->job_submit_time;
+	step->step_id = step_start_msg->step_id;
+	step->cpu_count = step_start_msg->total_cpus;
+	details->num_tasks = step_start_msg->total_tasks;
+
+	layout->node_cnt = step_start_msg->node_cnt;
+	layout->task_dist = step_start_msg->task_dist;
+
+	job->details = details;
+	step->job_ptr = job;
+	step->step_layout = layout;
+}
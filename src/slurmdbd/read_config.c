@@ -763,6 +763,17 @@ extern List dump_config(void)
 	key_pair->value = _get_conf_path();
 	list_append(my_list, key_pair);
 
+	/* Only the mysql plugin pages job queries, sacct checks this */
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("SLURMDBD_JOB_PAGING");
+	if (slurmdbd_conf->storage_type &&
+	    !strcasecmp(slurmdbd_conf->storage_type,
+			"accounting_storage/mysql"))
+		key_pair->value = xstrdup("Yes");
+	else
+		key_pair->value = xstrdup("No");
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("SLURMDBD_VERSION");
 	key_pair->value = xstrdup(SLURM_VERSION_STRING);
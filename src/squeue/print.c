@@ -83,68 +83,127 @@ int print_steps(List steps, List format)
 
 int print_jobs_array(job_info_t * jobs, int size, List format)
 {
-	int i = 0;
-	List l;
-	node_info_msg_t *ni = NULL;
+	int i, job_cnt = 0;
+	job_info_t **job_ptrs;
 
-	l = list_create(NULL);
 	if (!params.no_header)
 		print_job_from_format(NULL, format);
 
 	/* Filter out the jobs of interest */
-	for (; i < size; i++) {
+	job_ptrs = xmalloc(sizeof(job_info_t *) * (size + 1));
+	for (i = 0; i < size; i++) {
 		if (_filter_job(&jobs[i]))
 			continue;
-		list_append(l, (void *) &jobs[i]);
+		job_ptrs[job_cnt++] = &jobs[i];
 	}
-	sort_jobs_by_start_time (l);
-	if (ni)
-		slurm_free_node_info_msg (ni);
 
-	sort_job_list (l);
+	sort_job_array(job_ptrs, job_cnt);
 
 	/* Print the jobs of interest */
-	list_for_each (l, (ListForF) print_job_from_format, (void *) format);
-	list_destroy (l);
+	for (i = 0; i < job_cnt; i++)
+		print_job_from_format(job_ptrs[i], format);
+	xfree(job_ptrs);
 
 	return SLURM_SUCCESS;
 }
 
 int print_steps_array(job_step_info_t * steps, int size, List format)
 {
+	int i, step_cnt = 0;
+	job_step_info_t **step_ptrs;
 
 	if (!params.no_header)
 		print_step_from_format(NULL, format);
 
 	if (size > 0) {
-		int i = 0;
-		List step_list;
-		ListIterator step_iterator;
-		job_step_info_t *step_ptr;
-
-		step_list = list_create(NULL);
-
-		/* Filter out the jobs of interest */
-		for (; i < size; i++) {
+		/* Filter out the steps of interest */
+		step_ptrs = xmalloc(sizeof(job_step_info_t *) * size);
+		for (i = 0; i < size; i++) {
 			if (_filter_step(&steps[i]))
 				continue;
-			list_append(step_list, (void *) &steps[i]);
+			step_ptrs[step_cnt++] = &steps[i];
 		}
 
-		sort_step_list(step_list);
+		sort_step_array(step_ptrs, step_cnt);
 
 		/* Print the steps of interest */
-		step_iterator = list_iterator_create(step_list);
-		while ((step_ptr = list_next(step_iterator))) {
-			print_step_from_format(step_ptr, format);
-		}
-		list_iterator_destroy(step_iterator);
-		list_destroy(step_list);
+		for (i = 0; i < step_cnt; i++)
+			print_step_from_format(step_ptrs[i], format);
+		xfree(step_ptrs);
 	}
 
 	return SLURM_SUCCESS;
 }
 
+/*****************************************************************************
+ * User and Group Name Cache Functions
+ *****************************************************************************/
+#define NAME_HASH_SIZE 256
+
+typedef struct name_cache_rec {
+	uint32_t id;
+	char *name;			/* NULL if the id could not be resolved */
+	struct name_cache_rec *next;
+} name_cache_rec_t;
+
+static name_cache_rec_t *user_name_hash[NAME_HASH_SIZE];
+static name_cache_rec_t *group_name_hash[NAME_HASH_SIZE];
+
+static name_cache_rec_t *_name_cache_find(name_cache_rec_t **hash,
+					  uint32_t id)
+{
+	name_cache_rec_t *rec;
+
+	for (rec = hash[id % NAME_HASH_SIZE]; rec; rec = rec->next) {
+		if (rec->id == id)
+			return rec;
+	}
+	return NULL;
+}
+
+static name_cache_rec_t *_name_cache_add(name_cache_rec_t **hash,
+					 uint32_t id, char *name)
+{
+	name_cache_rec_t *rec = xmalloc(sizeof(name_cache_rec_t));
+
+	rec->id   = id;
+	rec->name = name;
+	rec->next = hash[id % NAME_HASH_SIZE];
+	hash[id % NAME_HASH_SIZE] = rec;
+	return rec;
+}
+
+/* user_name_cached - return the user name for a uid, resolving each uid
+ *	only once. The returned string must not be freed. */
+char *user_name_cached(uint32_t uid)
+{
+	name_cache_rec_t *rec = _name_cache_find(user_name_hash, uid);
+
+	if (rec == NULL) {
+		rec = _name_cache_add(user_name_hash, uid,
+				      uid_to_string((uid_t) uid));
+	}
+	return rec->name;
+}
+
+/* group_name_cached - return the group name for a gid, resolving each gid
+ *	only once. Returns NULL if the gid has no name. The returned string
+ *	must not be freed. */
+char *group_name_cached(uint32_t gid)
+{
+	name_cache_rec_t *rec = _name_cache_find(group_name_hash, gid);
+	struct group *group_info;
+	char *name = NULL;
+
+	if (rec == NULL) {
+		group_info = getgrgid((gid_t) gid);
+		if (group_info && group_info->gr_name[0])
+			name = xstrdup(group_info->gr_name);
+		rec = _name_cache_add(group_name_hash, gid, name);
+	}
+	return rec->name;
+}
+
 static int _print_str(char *str, int width, bool right, bool cut_output)
 {
 	char format[64];
@@ -312,9 +371,19 @@ int _print_job_job_id(job_info_t * job, int width, bool right, char* suffix)
 	if (job == NULL)	/* Print the Header instead */
 		_print_str("JOBID", width, right, true);
 	else {
-		char id[FORMAT_STRING_SIZE];
-		snprintf(id, FORMAT_STRING_SIZE, "%u", job->job_id);
+		char *id;
+		/* The task list of a job array can be any length */
+		if (job->array_job_id == 0) {
+			id = xstrdup_printf("%u", job->job_id);
+		} else if (job->array_task_str) {
+			id = xstrdup_printf("%u_[%s]", job->array_job_id,
+					    job->array_task_str);
+		} else {
+			id = xstrdup_printf("%u_%u", job->array_job_id,
+					    job->array_task_id);
+		}
 		_print_str(id, width, right, true);
+		xfree(id);
 	}
 	if (suffix)
 		printf("%s", suffix);
@@ -411,11 +480,8 @@ int _print_job_user_name(job_info_t * job, int width, bool right, char* suffix)
 {
 	if (job == NULL)	/* Print the Header instead */
 		_print_str("USER", width, right, true);
-	else {
-		char *uname = uid_to_string((uid_t) job->user_id);
-		_print_str(uname, width, right, true);
-		xfree(uname);
-	}
+	else
+		_print_str(user_name_cached(job->user_id), width, right, true);
 	if (suffix)
 		printf("%s", suffix);
 	return SLURM_SUCCESS;
@@ -445,14 +511,14 @@ int _print_job_group_id(job_info_t * job, int width, bool right, char* suffix)
 
 int _print_job_group_name(job_info_t * job, int width, bool right, char* suffix)
 {
-	struct group *group_info = NULL;
+	char *group_name;
 
 	if (job == NULL)	/* Print the Header instead */
 		_print_str("GROUP", width, right, true);
 	else {
-		group_info = getgrgid((gid_t) job->group_id);
-		if (group_info && group_info->gr_name[0])
-			_print_str(group_info->gr_name, width, right, true);
+		group_name = group_name_cached(job->group_id);
+		if (group_name)
+			_print_str(group_name, width, right, true);
 		else
 			_print_int(job->group_id, width, right, true);
 	}
@@ -1241,11 +1307,8 @@ int _print_step_user_name(job_step_info_t * step, int width, bool right,
 {
 	if (step == NULL)	/* Print the Header instead */
 		_print_str("USER", width, right, true);
-	else {
-		char *uname = uid_to_string((uid_t) step->user_id);
-		_print_str(uname, width, right, true);
-		xfree(uname);
-	}
+	else
+		_print_str(user_name_cached(step->user_id), width, right, true);
 	if (suffix)
 		printf("%s", suffix);
 	return SLURM_SUCCESS;
@@ -1373,7 +1436,8 @@ static int _filter_job(job_info_t * job)
 		filter = 1;
 		iterator = list_iterator_create(params.job_list);
 		while ((job_id = list_next(iterator))) {
-			if (*job_id == job->job_id) {
+			if ((*job_id == job->job_id) ||
+			    (*job_id == job->array_job_id)) {
 				filter = 0;
 				break;
 			}
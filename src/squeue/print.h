@@ -65,6 +65,9 @@ typedef struct step_format {
 
 long job_time_used(job_info_t * job_ptr);
 
+char *user_name_cached(uint32_t uid);
+char *group_name_cached(uint32_t gid);
+
 int print_jobs_list(List jobs, List format);
 int print_steps_list(List steps, List format);
 
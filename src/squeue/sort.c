@@ -49,306 +49,212 @@
 /* If you want "linux12" to sort before "linux2", then set PURE_ALPHA_SORT */
 #define PURE_ALPHA_SORT 0
 
-static bool reverse_order;
-
-static int _sort_job_by_batch_host(void *void1, void *void2);
-static int _sort_job_by_gres(void *void1, void *void2);
-static int _sort_job_by_group_id(void *void1, void *void2);
-static int _sort_job_by_group_name(void *void1, void *void2);
-static int _sort_job_by_id(void *void1, void *void2);
-static int _sort_job_by_name(void *void1, void *void2);
-static int _sort_job_by_state(void *void1, void *void2);
-static int _sort_job_by_state_compact(void *void1, void *void2);
-static int _sort_job_by_time_end(void *void1, void *void2);
-static int _sort_job_by_time_left(void *void1, void *void2);
-static int _sort_job_by_time_limit(void *void1, void *void2);
-static int _sort_job_by_time_start(void *void1, void *void2);
-static int _sort_job_by_time_used(void *void1, void *void2);
-static int _sort_job_by_node_list(void *void1, void *void2);
-static int _sort_job_by_num_nodes(void *void1, void *void2);
-static int _sort_job_by_num_cpus(void *void1, void *void2);
-static int _sort_job_by_num_sct(void *void1, void *void2);
-static int _sort_job_by_sockets(void *void1, void *void2);
-static int _sort_job_by_cores(void *void1, void *void2);
-static int _sort_job_by_threads(void *void1, void *void2);
-static int _sort_job_by_min_memory(void *void1, void *void2);
-static int _sort_job_by_min_tmp_disk(void *void1, void *void2);
-static int _sort_job_by_partition(void *void1, void *void2);
-static int _sort_job_by_priority(void *void1, void *void2);
-static int _sort_job_by_user_id(void *void1, void *void2);
-static int _sort_job_by_user_name(void *void1, void *void2);
-static int _sort_job_by_reservation(void *void1, void *void2);
-
-static int _sort_step_by_gres(void *void1, void *void2);
-static int _sort_step_by_id(void *void1, void *void2);
-static int _sort_step_by_node_list(void *void1, void *void2);
-static int _sort_step_by_partition(void *void1, void *void2);
-static int _sort_step_by_time_start(void *void1, void *void2);
-static int _sort_step_by_time_limit(void *void1, void *void2);
-static int _sort_step_by_time_used(void *void1, void *void2);
-static int _sort_step_by_user_id(void *void1, void *void2);
-static int _sort_step_by_user_name(void *void1, void *void2);
+/*
+ * Sorting is done decorate-sort-undecorate style: every sort key of every
+ * record is extracted exactly once into a sort_rec_t, the records are
+ * sorted with a single qsort() comparing the pre-extracted keys, and the
+ * caller's array is rewritten in the resulting order. The original index
+ * is used as the final key so the result matches the stable, one pass per
+ * key ordering previously produced by list_sort().
+ */
+typedef struct sort_key {
+	int64_t num;		/* numeric key value */
+	char *str;		/* string key value, NULL for numeric keys */
+	bool free_str;		/* str was malloc()ed and must be free()d */
+	bool node_name;		/* compare str using node name ordering */
+} sort_key_t;
+
+typedef struct sort_rec {
+	void *data;		/* job_info_t or job_step_info_t */
+	uint32_t inx;		/* original position, keeps sort stable */
+	sort_key_t *keys;	/* one entry per sort field */
+} sort_rec_t;
+
+static char *sort_fields = NULL;	/* sort field letters, major first */
+static bool *sort_reverse = NULL;	/* reverse order for each field */
+static int   sort_field_cnt = 0;
+
+static int  _cmp_node_name(char *val1, char *val2);
+static int  _cmp_sort_rec(const void *rec1, const void *rec2);
+static void _first_node_key(char *nodes, sort_key_t *key);
+static void _free_sort_recs(sort_rec_t *recs, sort_key_t *keys, int cnt);
+static bool _job_key_valid(char field);
+static void _job_sort_key(job_info_t *job, char field, time_t now,
+			  sort_key_t *key);
+static void _parse_sort_fields(char *sort, bool (*valid) (char));
+static void _sort_recs(void **data, int cnt,
+		       void (*get_key) (void *, char, time_t, sort_key_t *),
+		       void (*get_last_key) (void *, time_t, sort_key_t *));
+static void _step_sort_key(job_step_info_t *step, char field, time_t now,
+			   sort_key_t *key);
+static bool _step_key_valid(char field);
 
 /*****************************************************************************
- * Global Print Functions
+ * Global Sort Functions
  *****************************************************************************/
 
-void sort_job_list(List job_list)
+/* _job_start_key - the default secondary ordering of jobs is by descending
+ *	start time, applied before any of the user specified sort fields */
+static void _job_start_key(void *data, time_t now, sort_key_t *key)
 {
-	int i;
+	_job_sort_key((job_info_t *) data, 'S', now, key);
+	key->num = -key->num;
+}
 
+void sort_job_array(job_info_t **jobs, int job_cnt)
+{
 	if (params.sort == NULL)
 		params.sort = xstrdup("P,t,-p"); /* Partition,state,priority */
 
-	for (i=(strlen(params.sort)-1); i >= 0; i--) {
-		reverse_order = false;
-		if ((params.sort[i] == ',') ||
-		    (params.sort[i] == '+') || params.sort[i] == '-')
-			continue;
-		if ((i > 0) && (params.sort[i-1] == '-'))
-			reverse_order = true;
-
-		if      (params.sort[i] == 'B')
-			list_sort(job_list, _sort_job_by_batch_host);
-		else if (params.sort[i] == 'b')
-			list_sort(job_list, _sort_job_by_gres);
-		else if (params.sort[i] == 'c')
-			;	/* sort_job_by_min_cpus_per_node */
-		else if (params.sort[i] == 'C')
-			list_sort(job_list, _sort_job_by_num_cpus);
-		else if (params.sort[i] == 'd')
-			list_sort(job_list, _sort_job_by_min_tmp_disk);
-		else if (params.sort[i] == 'D')
-			list_sort(job_list, _sort_job_by_num_nodes);
-		else if (params.sort[i] == 'e')
-			list_sort(job_list, _sort_job_by_time_end);
-		else if (params.sort[i] == 'f')
-			;	/* sort_job_by_featuers */
-		else if (params.sort[i] == 'g')
-			list_sort(job_list, _sort_job_by_group_name);
-		else if (params.sort[i] == 'G')
-			list_sort(job_list, _sort_job_by_group_id);
-		else if (params.sort[i] == 'h')
-			;	/* sort_job_by_shared */
-		else if (params.sort[i] == 'H')
-			list_sort(job_list, _sort_job_by_sockets);
-		else if (params.sort[i] == 'i')
-			list_sort(job_list, _sort_job_by_id);
-		else if (params.sort[i] == 'I')
-			list_sort(job_list, _sort_job_by_cores);
-		else if (params.sort[i] == 'j')
-			list_sort(job_list, _sort_job_by_name);
-		else if (params.sort[i] == 'J')
-			list_sort(job_list, _sort_job_by_threads);
-		else if (params.sort[i] == 'l')
-			list_sort(job_list, _sort_job_by_time_limit);
-		else if (params.sort[i] == 'L')
-			list_sort(job_list, _sort_job_by_time_left);
-		else if (params.sort[i] == 'm')
-			list_sort(job_list, _sort_job_by_min_memory);
-		else if (params.sort[i] == 'M')
-			list_sort(job_list, _sort_job_by_time_used);
-		else if (params.sort[i] == 'n')
-			;	/* sort_job_by_nodes_requested */
-		else if (params.sort[i] == 'N')
-			list_sort(job_list, _sort_job_by_node_list);
-		else if (params.sort[i] == 'O')
-			;	/* sort_job_by_contiguous */
-		else if (params.sort[i] == 'p')
-			list_sort(job_list, _sort_job_by_priority);
-		else if (params.sort[i] == 'P')
-			list_sort(job_list, _sort_job_by_partition);
-		else if (params.sort[i] == 'S')
-			list_sort(job_list, _sort_job_by_time_start);
-		else if (params.sort[i] == 't')
-			list_sort(job_list, _sort_job_by_state_compact);
-		else if (params.sort[i] == 'T')
-			list_sort(job_list, _sort_job_by_state);
-		else if (params.sort[i] == 'u')
-			list_sort(job_list, _sort_job_by_user_name);
-		else if (params.sort[i] == 'U')
-			list_sort(job_list, _sort_job_by_user_id);
-		else if (params.sort[i] == 'v')
-			list_sort(job_list, _sort_job_by_reservation);
-		else if (params.sort[i] == 'z')
-			list_sort(job_list, _sort_job_by_num_sct);
-		else {
-			error("Invalid sort specification: %c",
-			      params.sort[i]);
-			exit(1);
-		}
-	}
-}
-
-void sort_jobs_by_start_time (List jobs)
-{
-	reverse_order = true;
-	list_sort (jobs, _sort_job_by_time_start);
-	return;
+	_parse_sort_fields(params.sort, _job_key_valid);
+	_sort_recs((void **) jobs, job_cnt,
+		   (void (*) (void *, char, time_t, sort_key_t *))
+		   _job_sort_key, _job_start_key);
 }
 
-void sort_step_list(List step_list)
+void sort_step_array(job_step_info_t **steps, int step_cnt)
 {
-	int i;
-
 	if (params.sort == NULL)
 		params.sort = xstrdup("P,i");	/* Partition, step id */
-	for (i=(strlen(params.sort)-1); i >= 0; i--) {
-		reverse_order = false;
-		if ((params.sort[i] == ',') ||
-		    (params.sort[i] == '+') || params.sort[i] == '-')
-			continue;
-		if ((i > 0) && (params.sort[i-1] == '-'))
-			reverse_order = true;
-
-		if      (params.sort[i] == 'b')
-			list_sort(step_list, _sort_step_by_gres);
-		else if (params.sort[i] == 'i')
-			list_sort(step_list, _sort_step_by_id);
-		else if (params.sort[i] == 'N')
-			list_sort(step_list, _sort_step_by_node_list);
-		else if (params.sort[i] == 'P')
-			list_sort(step_list, _sort_step_by_partition);
-		else if (params.sort[i] == 'l')
-			list_sort(step_list, _sort_step_by_time_limit);
-		else if (params.sort[i] == 'S')
-			list_sort(step_list, _sort_step_by_time_start);
-		else if (params.sort[i] == 'M')
-			list_sort(step_list, _sort_step_by_time_used);
-		else if (params.sort[i] == 'u')
-			list_sort(step_list, _sort_step_by_user_name);
-		else if (params.sort[i] == 'U')
-			list_sort(step_list, _sort_step_by_user_id);
-	}
+
+	_parse_sort_fields(params.sort, _step_key_valid);
+	_sort_recs((void **) steps, step_cnt,
+		   (void (*) (void *, char, time_t, sort_key_t *))
+		   _step_sort_key, NULL);
 }
 
 /*****************************************************************************
- * Local Job Sort Functions
+ * Local Sort Functions
  *****************************************************************************/
-static int _sort_job_by_batch_host(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (job1->batch_host)
-		val1 = job1->batch_host;
-	if (job2->batch_host)
-		val2 = job2->batch_host;
-	diff = strcmp(val1, val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
 
-static int _sort_job_by_gres(void *void1, void *void2)
+/* _parse_sort_fields - convert a sort specification such as "P,t,-p" into
+ *	the sort_fields and sort_reverse arrays, ignoring any field for which
+ *	valid() returns false */
+static void _parse_sort_fields(char *sort, bool (*valid) (char))
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (job1->gres)
-		val1 = job1->gres;
-	if (job2->gres)
-		val2 = job2->gres;
-	diff = strcmp(val1, val2);
+	int i, len = strlen(sort);
 
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	xfree(sort_fields);
+	xfree(sort_reverse);
+	sort_fields  = xmalloc(len + 1);
+	sort_reverse = xmalloc(sizeof(bool) * (len + 1));
+	sort_field_cnt = 0;
+
+	for (i = 0; i < len; i++) {
+		if ((sort[i] == ',') || (sort[i] == '+') || (sort[i] == '-'))
+			continue;
+		if (!valid(sort[i]))
+			continue;
+		sort_fields[sort_field_cnt]  = sort[i];
+		sort_reverse[sort_field_cnt] = ((i > 0) && (sort[i-1] == '-'));
+		sort_field_cnt++;
+	}
 }
 
-static int _sort_job_by_group_id(void *void1, void *void2)
+static void _sort_recs(void **data, int cnt,
+		       void (*get_key) (void *, char, time_t, sort_key_t *),
+		       void (*get_last_key) (void *, time_t, sort_key_t *))
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
+	sort_rec_t *recs;
+	sort_key_t *keys;
+	int i, j, key_cnt;
+	time_t now = time(NULL);
 
-	diff = job1->group_id - job2->group_id;
+	if (cnt < 2)
+		return;
+
+	key_cnt = sort_field_cnt + 1;
+	recs = xmalloc(sizeof(sort_rec_t) * cnt);
+	keys = xmalloc(sizeof(sort_key_t) * cnt * key_cnt);
+	for (i = 0; i < cnt; i++) {
+		recs[i].data = data[i];
+		recs[i].inx  = i;
+		recs[i].keys = keys + (i * key_cnt);
+		for (j = 0; j < sort_field_cnt; j++) {
+			(*get_key)(data[i], sort_fields[j], now,
+				   &recs[i].keys[j]);
+		}
+		if (get_last_key)
+			(*get_last_key)(data[i], now, &recs[i].keys[j]);
+	}
 
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
+	qsort(recs, cnt, sizeof(sort_rec_t), _cmp_sort_rec);
 
-static int _sort_job_by_group_name(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	struct group *group_info = NULL;
-	char *name1 = "", *name2 = "";
-
-	if ((group_info = getgrgid((gid_t) job1->group_id)))
-		name1 = group_info->gr_name;
-	if ((group_info = getgrgid((gid_t) job2->group_id)))
-		name2 = group_info->gr_name;
-	diff = strcmp(name1, name2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	for (i = 0; i < cnt; i++)
+		data[i] = recs[i].data;
+	_free_sort_recs(recs, keys, cnt);
 }
 
-static int _sort_job_by_id(void *void1, void *void2)
+static void _free_sort_recs(sort_rec_t *recs, sort_key_t *keys, int cnt)
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
+	int i, j;
 
-	diff = job1->job_id - job2->job_id;
+	for (i = 0; i < cnt; i++) {
+		for (j = 0; j <= sort_field_cnt; j++) {
+			if (recs[i].keys[j].free_str)
+				free(recs[i].keys[j].str);
+		}
+	}
+	xfree(keys);
+	xfree(recs);
+}
+
+static int _cmp_sort_rec(const void *rec1, const void *rec2)
+{
+	sort_rec_t *r1 = (sort_rec_t *) rec1;
+	sort_rec_t *r2 = (sort_rec_t *) rec2;
+	sort_key_t *k1, *k2;
+	int i, diff;
+
+	for (i = 0; i <= sort_field_cnt; i++) {
+		k1 = &r1->keys[i];
+		k2 = &r2->keys[i];
+		if (k1->str || k2->str) {
+			char *val1 = k1->str ? k1->str : "";
+			char *val2 = k2->str ? k2->str : "";
+			if (k1->node_name)
+				diff = _cmp_node_name(val1, val2);
+			else
+				diff = strcmp(val1, val2);
+		} else if (k1->num > k2->num)
+			diff = 1;
+		else if (k1->num < k2->num)
+			diff = -1;
+		else
+			diff = 0;
+
+		if ((i < sort_field_cnt) && sort_reverse[i])
+			diff = -diff;
+		if (diff)
+			return diff;
+	}
 
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	if (r1->inx > r2->inx)
+		return 1;
+	if (r1->inx < r2->inx)
+		return -1;
+	return 0;
 }
 
-static int _sort_job_by_name(void *void1, void *void2)
+/* _first_node_key - set the key to the first name of the sorted hostlist */
+static void _first_node_key(char *nodes, sort_key_t *key)
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (job1->name)
-		val1 = job1->name;
-	if (job2->name)
-		val2 = job2->name;
-	diff = strcmp(val1, val2);
+	hostlist_t hostlist = hostlist_create(nodes);
 
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	hostlist_sort(hostlist);
+	key->str = hostlist_shift(hostlist);
+	key->free_str = (key->str != NULL);
+	key->node_name = true;
+	hostlist_destroy(hostlist);
 }
 
-static int _sort_job_by_node_list(void *void1, void *void2)
+static int _cmp_node_name(char *val1, char *val2)
 {
 	int diff = 0;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	hostlist_t hostlist1, hostlist2;
-	char *val1, *val2;
 #if	PURE_ALPHA_SORT == 0
 	int inx;
 #endif
 
-	hostlist1 = hostlist_create(job1->nodes);
-	hostlist_sort(hostlist1);
-	val1 = hostlist_shift(hostlist1);
-	if (val1 == NULL)
-		val1 = "";
-	hostlist_destroy(hostlist1);
-
-	hostlist2 = hostlist_create(job2->nodes);
-	hostlist_sort(hostlist2);
-	val2 = hostlist_shift(hostlist2);
-	if (val2 == NULL)
-		val2 = "";
-	hostlist_destroy(hostlist2);
-
 #if	PURE_ALPHA_SORT
 	diff = strcmp(val1, val2);
 #else
@@ -369,222 +275,24 @@ static int _sort_job_by_node_list(void *void1, void *void2)
 		break;
 	}
 #endif
-	if (strlen(val1))
-		free(val1);
-	if (strlen(val2))
-		free(val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_num_nodes(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->num_nodes - job2->num_nodes;
-
-	if (reverse_order)
-		diff = -diff;
 	return diff;
 }
 
-static int _sort_job_by_num_cpus(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->num_cpus - job2->num_cpus;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_num_sct(void *void1, void *void2)
-{
-	int diffs, diffc, difft;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diffs = job1->sockets_per_node - job2->sockets_per_node;
-	diffc = job1->cores_per_socket - job2->cores_per_socket;
-	difft = job1->threads_per_core - job2->threads_per_core;
-
-	if (reverse_order) {
-		diffs = -diffs;
-		diffc = -diffc;
-		difft = -difft;
-	}
-	if (diffs)
-		return diffs;
-	else if (diffc)
-		return diffc;
-	else
-		return difft;
-}
-
-static int _sort_job_by_sockets(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->sockets_per_node - job2->sockets_per_node;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_cores(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->cores_per_socket - job2->cores_per_socket;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_threads(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->threads_per_core - job2->threads_per_core;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_min_memory(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	job1->pn_min_memory &= (~MEM_PER_CPU);
-	job2->pn_min_memory &= (~MEM_PER_CPU);
-	diff = job1->pn_min_memory - job2->pn_min_memory;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_min_tmp_disk(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->pn_min_tmp_disk - job2->pn_min_tmp_disk;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_state(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = strcmp(job_state_string(job1->job_state),
-			 job_state_string(job2->job_state));
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_state_compact(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = strcmp(job_state_string_compact(job1->job_state),
-			 job_state_string_compact(job2->job_state));
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_time_end(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->end_time - job2->end_time;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_time_left(void *void1, void *void2)
+/*****************************************************************************
+ * Local Job Sort Key Functions
+ *****************************************************************************/
+static bool _job_key_valid(char field)
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	time_t time1, time2;
-
-	if ((job1->time_limit == INFINITE) || (job1->time_limit == NO_VAL))
-		time1 = INFINITE;
-	else
-		time1 = job1->time_limit - job_time_used(job1);
-	if ((job2->time_limit == INFINITE) || (job2->time_limit == NO_VAL))
-		time2 = INFINITE;
-	else
-		time2 = job2->time_limit - job_time_used(job2);
-	if (time1 > time2)
-		diff = 1;
-	else if (time1 == time2)
-		diff = 0;
-	else
-		diff = -1;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
+	if (strchr("BbcCdDefgGhHiIjJlLmMnNOpPStTuUvz", field))
+		return true;
 
-static int _sort_job_by_time_limit(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	if (job1->time_limit > job2->time_limit)
-		diff = 1;
-	else if (job1->time_limit == job2->time_limit)
-		diff = 0;
-	else
-		diff = -1;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	error("Invalid sort specification: %c", field);
+	exit(1);
+	return false;
 }
 
-static uint32_t _get_start_time(job_info_t *job)
+static uint32_t _get_start_time(job_info_t *job, time_t now)
 {
-	time_t now = time(NULL);
-
 	if (job->start_time == (time_t) 0)
 		return 0xffffffff;
 	if ((job->job_state == JOB_PENDING) && (job->start_time < now))
@@ -592,304 +300,152 @@ static uint32_t _get_start_time(job_info_t *job)
 	return (uint32_t) job->start_time;
 }
 
-static int _sort_job_by_time_start(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	uint32_t start_time1, start_time2;
-
-	start_time1 = _get_start_time(job1);
-	start_time2 = _get_start_time(job2);
-
-	if (start_time1 > start_time2)
-		diff = 1;
-	else if (start_time1 < start_time2)
-		diff = -1;
-	else
-		diff = 0;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_time_used(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	long time1, time2;
-
-	time1 = job_time_used(job1);
-	time2 = job_time_used(job2);
-	diff = time1 - time2;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_partition(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (job1->partition)
-		val1 = job1->partition;
-	if (job2->partition)
-		val2 = job2->partition;
-	diff = strcmp(val1, val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_priority(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->priority - job2->priority;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_user_id(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-
-	diff = job1->user_id - job2->user_id;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_user_name(void *void1, void *void2)
-{
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *name1, *name2;
-
-	name1 = uid_to_string((uid_t) job1->user_id);
-	name2 = uid_to_string((uid_t) job2->user_id);
-	diff = strcmp(name1, name2);
-	xfree(name1);
-	xfree(name2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_job_by_reservation(void *void1, void *void2)
+static void _job_sort_key(job_info_t *job, char field, time_t now,
+			  sort_key_t *key)
 {
-	int diff;
-	job_info_t *job1 = (job_info_t *) void1;
-	job_info_t *job2 = (job_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (job1->resv_name)
-		val1 = job1->resv_name;
-	if (job2->resv_name)
-		val2 = job2->resv_name;
-	diff = strcmp(val1, val2);
+	memset(key, 0, sizeof(sort_key_t));
 
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	switch (field) {
+	case 'B':
+		key->str = job->batch_host;
+		break;
+	case 'b':
+		key->str = job->gres;
+		break;
+	case 'C':
+		key->num = job->num_cpus;
+		break;
+	case 'd':
+		key->num = job->pn_min_tmp_disk;
+		break;
+	case 'D':
+		key->num = job->num_nodes;
+		break;
+	case 'e':
+		key->num = job->end_time;
+		break;
+	case 'g':
+		key->str = group_name_cached(job->group_id);
+		break;
+	case 'G':
+		key->num = job->group_id;
+		break;
+	case 'H':
+		key->num = job->sockets_per_node;
+		break;
+	case 'i':
+		key->num = job->job_id;
+		break;
+	case 'I':
+		key->num = job->cores_per_socket;
+		break;
+	case 'j':
+		key->str = job->name;
+		break;
+	case 'J':
+		key->num = job->threads_per_core;
+		break;
+	case 'l':
+		key->num = job->time_limit;
+		break;
+	case 'L':
+		if ((job->time_limit == INFINITE) ||
+		    (job->time_limit == NO_VAL))
+			key->num = INFINITE;
+		else
+			key->num = job->time_limit - job_time_used(job);
+		break;
+	case 'm':
+		key->num = job->pn_min_memory & (~MEM_PER_CPU);
+		break;
+	case 'M':
+		key->num = job_time_used(job);
+		break;
+	case 'N':
+		_first_node_key(job->nodes, key);
+		break;
+	case 'p':
+		key->num = job->priority;
+		break;
+	case 'P':
+		key->str = job->partition;
+		break;
+	case 'S':
+		key->num = _get_start_time(job, now);
+		break;
+	case 't':
+		key->str = job_state_string_compact(job->job_state);
+		break;
+	case 'T':
+		key->str = job_state_string(job->job_state);
+		break;
+	case 'u':
+		key->str = user_name_cached(job->user_id);
+		break;
+	case 'U':
+		key->num = job->user_id;
+		break;
+	case 'v':
+		key->str = job->resv_name;
+		break;
+	case 'z':
+		/* sockets, cores and threads packed into one ordered key */
+		key->num = ((int64_t) job->sockets_per_node << 32) |
+			   ((int64_t) job->cores_per_socket << 16) |
+			   job->threads_per_core;
+		break;
+	default:
+		/* 'c' min_cpus_per_node, 'f' features, 'h' shared,
+		 * 'n' nodes_requested and 'O' contiguous are accepted
+		 * but do not affect the order */
+		break;
+	}
+	if ((key->str == NULL) && strchr("BbgjPtTuv", field))
+		key->str = "";
 }
 
 /*****************************************************************************
- * Local Step Sort Functions
+ * Local Step Sort Key Functions
  *****************************************************************************/
-static int _sort_step_by_gres(void *void1, void *void2)
+static bool _step_key_valid(char field)
 {
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (step1->gres)
-		val1 = step1->gres;
-	if (step2->gres)
-		val2 = step2->gres;
-	diff = strcmp(val1, val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
+	if (strchr("biNPlSMuU", field))
+		return true;
+	return false;
 }
 
-static int _sort_step_by_id(void *void1, void *void2)
+static void _step_sort_key(job_step_info_t *step, char field, time_t now,
+			   sort_key_t *key)
 {
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-
-	diff = step1->job_id - step2->job_id;
-	if (diff == 0)
-		diff = step1->step_id - step2->step_id;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_node_list(void *void1, void *void2)
-{
-	int diff = 0;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-
-	hostlist_t hostlist1, hostlist2;
-	char *val1, *val2;
-#if	PURE_ALPHA_SORT == 0
-	int inx;
-#endif
+	memset(key, 0, sizeof(sort_key_t));
 
-	hostlist1 = hostlist_create(step1->nodes);
-	hostlist_sort(hostlist1);
-	val1 = hostlist_shift(hostlist1);
-	if (val1 == NULL)
-		val1 = "";
-	hostlist_destroy(hostlist1);
-
-	hostlist2 = hostlist_create(step2->nodes);
-	hostlist_sort(hostlist2);
-	val2 = hostlist_shift(hostlist2);
-	if (val2 == NULL)
-		val2 = "";
-	hostlist_destroy(hostlist2);
-
-#if	PURE_ALPHA_SORT
-	diff = strcmp(val1, val2);
-#else
-	for (inx=0; ; inx++) {
-		if (val1[inx] == val2[inx]) {
-			if (val1[inx] == '\0')
-				break;
-			continue;
-		}
-		if ((isdigit((int)val1[inx])) &&
-		    (isdigit((int)val2[inx]))) {
-			int num1, num2;
-			num1 = atoi(val1+inx);
-			num2 = atoi(val2+inx);
-			diff = num1 - num2;
-		} else
-			diff = strcmp(val1, val2);
+	switch (field) {
+	case 'b':
+		key->str = step->gres ? step->gres : "";
+		break;
+	case 'i':
+		key->num = ((int64_t) step->job_id << 32) | step->step_id;
+		break;
+	case 'N':
+		_first_node_key(step->nodes, key);
+		break;
+	case 'P':
+		key->str = step->partition ? step->partition : "";
+		break;
+	case 'l':
+		key->num = step->time_limit;
+		break;
+	case 'S':
+		key->num = step->start_time;
+		break;
+	case 'M':
+		key->num = (int64_t) difftime(now, step->start_time);
+		break;
+	case 'u':
+		key->str = user_name_cached(step->user_id);
+		break;
+	case 'U':
+		key->num = step->user_id;
 		break;
 	}
-#endif
-	if (strlen(val1))
-		free(val1);
-	if (strlen(val2))
-		free(val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_partition(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-	char *val1 = "", *val2 = "";
-
-	if (step1->partition)
-		val1 = step1->partition;
-	if (step2->partition)
-		val2 = step2->partition;
-	diff = strcmp(val1, val2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_time_limit(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-
-	diff = step1->time_limit - step2->time_limit;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_time_start(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-
-	diff = step1->start_time - step2->start_time;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_time_used(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-	time_t now, used1, used2;
-
-	now = time(NULL);
-	used1 = difftime(now, step1->start_time);
-	used2 = difftime(now, step2->start_time);
-	diff = used1 - used2;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_user_id(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-
-	diff = step1->user_id - step2->user_id;
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
-}
-
-static int _sort_step_by_user_name(void *void1, void *void2)
-{
-	int diff;
-	job_step_info_t *step1 = (job_step_info_t *) void1;
-	job_step_info_t *step2 = (job_step_info_t *) void2;
-	char *name1, *name2;
-
-	name1 = uid_to_string((uid_t) step1->user_id);
-	name2 = uid_to_string((uid_t) step2->user_id);
-	diff = strcmp(name1, name2);
-	xfree(name1);
-	xfree(name2);
-
-	if (reverse_order)
-		diff = -diff;
-	return diff;
 }
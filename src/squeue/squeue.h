@@ -115,8 +115,7 @@ extern struct squeue_parameters params;
 
 extern void parse_command_line( int argc, char* argv[] );
 extern int  parse_format( char* format );
-extern void sort_job_list( List job_list );
-extern void sort_jobs_by_start_time( List job_list );
-extern void sort_step_list( List step_list );
+extern void sort_job_array( job_info_t **jobs, int job_cnt );
+extern void sort_step_array( job_step_info_t **steps, int step_cnt );
 
 #endif